@@ -0,0 +1,179 @@
+// Copyright (c) 2021 Jeff Lebrun
+//
+//  Licensed under the MIT License.
+//
+//  The full text of the license can be found in the file named LICENSE.
+
+#include "Allocator.hpp"
+#include "toml.hpp"
+#include <CTOML/CTOML.h>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+	struct AllocatorHooks {
+		CTOMLMallocFunction mallocFunction;
+		CTOMLReallocFunction reallocFunction;
+		CTOMLFreeFunction freeFunction;
+		void * context;
+	};
+
+	void * defaultMalloc(size_t size, void *) { return malloc(size); }
+	void * defaultRealloc(void * ptr, size_t size, void *) { return realloc(ptr, size); }
+	void defaultFree(void * ptr, void *) { free(ptr); }
+
+	const AllocatorHooks defaultHooks = { defaultMalloc, defaultRealloc, defaultFree, NULL };
+
+	/// Routes toml++'s node and container allocations through the hooks passed to \c ctomlSetAllocator , which
+	/// are updated in place every time it's called.
+	class HookedMemoryResource final : public toml::impl::memory_resource {
+	public:
+		AllocatorHooks hooks = defaultHooks;
+
+		static HookedMemoryResource & shared() {
+			// Never destroyed, since every block toml++ allocated through it points back at it.
+			static auto resource = new HookedMemoryResource();
+			return *resource;
+		}
+
+		void * allocate(size_t size) override {
+			auto ptr = this->hooks.mallocFunction(size, this->hooks.context);
+			if (!ptr) { throw std::bad_alloc(); }
+
+			return ptr;
+		}
+
+		void deallocate(void * ptr, size_t) noexcept override {
+			this->hooks.freeFunction(ptr, this->hooks.context);
+		}
+	};
+}
+
+// MARK: - Allocation
+
+void * ctomlAllocate(size_t size) {
+	const auto & hooks = HookedMemoryResource::shared().hooks;
+	return hooks.mallocFunction(size, hooks.context);
+}
+
+void * ctomlReallocate(void * ptr, size_t size) {
+	const auto & hooks = HookedMemoryResource::shared().hooks;
+	return hooks.reallocFunction(ptr, size, hooks.context);
+}
+
+char * ctomlStrdup(std::string_view str) {
+	auto mem = static_cast<char *>(ctomlAllocate(str.size() + 1));
+
+	if (mem) {
+		memcpy(mem, str.data(), str.size());
+		mem[str.size()] = '\0';
+	}
+
+	return mem;
+}
+
+// MARK: - Output
+
+CTOMLOutputBuffer::~CTOMLOutputBuffer() {
+	if (this->buffer) { ctomlFree(this->buffer); }
+}
+
+void CTOMLOutputBuffer::advance(size_t count) {
+	// `pbump` only takes an `int`.
+	while (count > 0) {
+		auto step = std::min(count, static_cast<size_t>(std::numeric_limits<int>::max()));
+		this->pbump(static_cast<int>(step));
+		count -= step;
+	}
+}
+
+bool CTOMLOutputBuffer::reserve(size_t size) {
+	if (size <= this->capacity) { return true; }
+
+	auto newCapacity = this->capacity ? this->capacity : 256;
+	while (newCapacity < size) {
+		newCapacity *= 2;
+	}
+
+	auto used = static_cast<size_t>(this->pptr() - this->pbase());
+	auto newBuffer = static_cast<char *>(ctomlReallocate(this->buffer, newCapacity));
+	if (!newBuffer) { return false; }
+
+	this->buffer = newBuffer;
+	this->capacity = newCapacity;
+
+	// The last byte is kept free for the null terminator added by `release`.
+	this->setp(this->buffer, this->buffer + this->capacity - 1);
+	this->advance(used);
+	return true;
+}
+
+CTOMLOutputBuffer::int_type CTOMLOutputBuffer::overflow(int_type ch) {
+	if (traits_type::eq_int_type(ch, traits_type::eof())) { return traits_type::not_eof(ch); }
+
+	auto used = static_cast<size_t>(this->pptr() - this->pbase());
+	if (!this->reserve(used + 2)) { return traits_type::eof(); }
+
+	*this->pptr() = traits_type::to_char_type(ch);
+	this->pbump(1);
+	return ch;
+}
+
+std::streamsize CTOMLOutputBuffer::xsputn(const char * s, std::streamsize count) {
+	auto used = static_cast<size_t>(this->pptr() - this->pbase());
+	if (!this->reserve(used + static_cast<size_t>(count) + 1)) { return 0; }
+
+	memcpy(this->pptr(), s, static_cast<size_t>(count));
+	this->advance(static_cast<size_t>(count));
+	return count;
+}
+
+char * CTOMLOutputBuffer::release() {
+	if (!this->reserve(1)) { return NULL; }
+
+	auto used = static_cast<size_t>(this->pptr() - this->pbase());
+	this->buffer[used] = '\0';
+
+	auto output = this->buffer;
+	this->buffer = nullptr;
+	this->capacity = 0;
+	this->setp(nullptr, nullptr);
+	return output;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	// MARK: - Allocator
+
+	/// Routes CTOML's allocations, and toml++'s node, key and container allocations, through
+	/// \c mallocFunction , \c reallocFunction and \c freeFunction .
+	void ctomlSetAllocator(
+		CTOMLMallocFunction _Nullable mallocFunction,
+		CTOMLReallocFunction _Nullable reallocFunction,
+		CTOMLFreeFunction _Nullable freeFunction,
+		void * _Nullable context) {
+		auto & resource = HookedMemoryResource::shared();
+		if (!mallocFunction || !reallocFunction || !freeFunction) {
+			resource.hooks = defaultHooks;
+			toml::impl::set_default_memory_resource(nullptr);
+			return;
+		}
+
+		resource.hooks = AllocatorHooks { mallocFunction, reallocFunction, freeFunction, context };
+		toml::impl::set_default_memory_resource(&resource);
+	}
+
+	/// Frees memory returned by a CTOML function.
+	void ctomlFree(void * _Nullable ptr) {
+		if (!ptr) { return; }
+
+		const auto & hooks = HookedMemoryResource::shared().hooks;
+		hooks.freeFunction(ptr, hooks.context);
+	}
+
+#ifdef __cplusplus
+}
+#endif
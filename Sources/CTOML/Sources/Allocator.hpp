@@ -0,0 +1,66 @@
+// Copyright (c) 2021 Jeff Lebrun
+//
+//  Licensed under the MIT License.
+//
+//  The full text of the license can be found in the file named LICENSE.
+
+#ifndef Allocator_hpp
+#define Allocator_hpp
+
+#ifdef __cplusplus
+
+	#include "toml.hpp"
+	#include <CTOML/CTOML.h>
+	#include <streambuf>
+	#include <string_view>
+
+// MARK: - Allocation
+
+/// Allocates \c size bytes using the functions passed to \c ctomlSetAllocator .
+void * ctomlAllocate(size_t size);
+
+/// Resizes \c ptr using the functions passed to \c ctomlSetAllocator .
+void * ctomlReallocate(void * ptr, size_t size);
+
+/// Copies \c str into a null-terminated buffer allocated with \c ctomlAllocate .
+char * ctomlStrdup(std::string_view str);
+
+/// Allocates a \c T with \c ctomlAllocate and copies \c value into it.
+template <typename T> T * ctomlAllocateCopy(const T & value) {
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	auto mem = static_cast<T *>(ctomlAllocate(sizeof(T)));
+	if (mem) { memcpy(mem, &value, sizeof(T)); }
+
+	return mem;
+}
+
+// MARK: - Output
+
+/// A \c std::streambuf that writes into a single buffer grown with \c ctomlReallocate , so that
+/// converted documents can be handed to the caller without copying them out of a \c std::string .
+class CTOMLOutputBuffer : public std::streambuf {
+public:
+	CTOMLOutputBuffer() = default;
+	CTOMLOutputBuffer(const CTOMLOutputBuffer &) = delete;
+	CTOMLOutputBuffer & operator=(const CTOMLOutputBuffer &) = delete;
+	~CTOMLOutputBuffer() override;
+
+	/// Null-terminates the output and transfers ownership of it to the caller, who must release it
+	/// with \c ctomlFree .
+	char * release();
+
+protected:
+	int_type overflow(int_type ch) override;
+	std::streamsize xsputn(const char * s, std::streamsize count) override;
+
+private:
+	char * buffer = nullptr;
+	size_t capacity = 0;
+
+	void advance(size_t count);
+	bool reserve(size_t size);
+};
+
+#endif
+#endif /* Allocator_hpp */
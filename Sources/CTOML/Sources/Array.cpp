@@ -4,6 +4,7 @@
 //
 //  The full text of the license can be found in the file named LICENSE.
 
+#include "Allocator.hpp"
 #include "Conversion.hpp"
 #include "toml.hpp"
 #include <CTOML/CTOML.h>
@@ -23,8 +24,8 @@ extern "C" {
 	/// @param array1 This first \c toml::array that will be used in the comparison.
 	/// @param array2 This second \c toml::array that will be used in the comparison.
 	bool arrayEqual(CTOMLArray * array1, CTOMLArray * array2) {
-		auto arr1 = *reinterpret_cast<toml::array *>(array1);
-		auto arr2 = *reinterpret_cast<toml::array *>(array2);
+		const auto & arr1 = *reinterpret_cast<toml::array *>(array1);
+		const auto & arr2 = *reinterpret_cast<toml::array *>(array2);
 		return arr1 == arr2;
 	}
 
@@ -36,6 +37,10 @@ extern "C" {
 	/// The amount of elements in \c array .
 	size_t arraySize(CTOMLArray * array) { return reinterpret_cast<toml::array *>(array)->size(); }
 
+	/// Stores \c array compactly if its elements allow it, returning whether they are stored that way. The parser
+	/// already does this for every array it reads.
+	bool arrayCompact(CTOMLArray * array) { return reinterpret_cast<toml::array *>(array)->pack(); }
+
 	/// Clears all the values in \c array .
 	/// @param array The \c toml::array to clear.
 	void arrayClear(CTOMLArray * array) { reinterpret_cast<toml::array *>(array)->clear(); }
@@ -175,8 +180,16 @@ extern "C" {
 	// MARK: - Value Retrieval
 
 	/// Retrieves a \c toml::node from \c array at \c index .
+	///
+	/// The node could be modified through what's returned, so a frozen array is given elements of its own first
+	/// (like \c tableGetNode does). An array that isn't frozen already owns its elements, and is read through the
+	/// \c const overload of \c toml::array::get so that reading from it when it's packed doesn't unpack it.
 	CTOMLNode * _Nonnull arrayGetNode(CTOMLArray * array, int64_t index) {
-		return reinterpret_cast<CTOMLNode *>(reinterpret_cast<toml::array *>(array)->get(index));
+		auto arr = reinterpret_cast<toml::array *>(array);
+		if (arr->frozen()) { return reinterpret_cast<CTOMLNode *>(arr->get(index)); }
+
+		const auto & owned = *arr;
+		return reinterpret_cast<CTOMLNode *>(const_cast<toml::node *>(owned.get(index)));
 	}
 
 	// MARK: - Value Removal
@@ -190,11 +203,12 @@ extern "C" {
 	// MARK: - Array Printing
 
 	const char * _Nonnull arrayConvertToTOML(CTOMLArray * _Nonnull array) {
-		std::stringstream ss;
+		CTOMLOutputBuffer buffer;
+		std::ostream os(&buffer);
 
-		ss << toml::toml_formatter(*reinterpret_cast<toml::array *>(array));
+		os << toml::toml_formatter(*reinterpret_cast<toml::array *>(array));
 
-		return strdup(ss.str().c_str());
+		return buffer.release();
 	}
 
 #ifdef __cplusplus
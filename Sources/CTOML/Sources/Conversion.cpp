@@ -7,6 +7,7 @@
 #ifdef __cplusplus
 
 	#include "Conversion.hpp"
+	#include "Allocator.hpp"
 
 CTOMLDate tomlDateToCTOMLDate(toml::date date) {
 	return CTOMLDate { .year = date.year, .month = date.month, .day = date.day };
@@ -32,7 +33,8 @@ CTOMLDateTime tomlDateTimeToCTOMLDateTime(toml::date_time dateTime) {
 		.date = tomlDateToCTOMLDate(dateTime.date),
 		.time = tomlTimeToCTOMLTime(dateTime.time),
 		.offset = dateTime.offset.has_value()
-					  ? new CTOMLTimeOffset { .minutes = dateTime.offset.value().minutes }
+					  ? ctomlAllocateCopy(
+							CTOMLTimeOffset { .minutes = dateTime.offset.value().minutes })
 					  : NULL
 	};
 }
@@ -1,4 +1,5 @@
 
+#include "Allocator.hpp"
 #include "Conversion.hpp"
 #include "toml.hpp"
 #include <CTOML/CTOML.h>
@@ -6,27 +7,30 @@
 
 /// Convert \c date to TOML.
 const char * _Nonnull cTOMLDateToTOML(CTOMLDate date) {
-	std::stringstream ss;
+	CTOMLOutputBuffer buffer;
+	std::ostream os(&buffer);
 
-	ss << cTOMLDateToTomlDate(date);
+	os << cTOMLDateToTomlDate(date);
 
-	return strdup(ss.str().c_str());
+	return buffer.release();
 }
 
 /// Convert \c time to TOML.
 const char * _Nonnull cTOMLTimeToTOML(CTOMLTime time) {
-	std::stringstream ss;
+	CTOMLOutputBuffer buffer;
+	std::ostream os(&buffer);
 
-	ss << cTOMLTimeToTomlTime(time);
+	os << cTOMLTimeToTomlTime(time);
 
-	return strdup(ss.str().c_str());
+	return buffer.release();
 }
 
 /// Convert \c dateTime to TOML.
 const char * _Nonnull cTOMLDateTimeToTOML(CTOMLDateTime dateTime) {
-	std::stringstream ss;
+	CTOMLOutputBuffer buffer;
+	std::ostream os(&buffer);
 
-	ss << cTOMLDateTimeToTomlDateTime(dateTime);
+	os << cTOMLDateTimeToTomlDateTime(dateTime);
 
-	return strdup(ss.str().c_str());
+	return buffer.release();
 }
@@ -4,6 +4,7 @@
 //
 //  The full text of the license can be found in the file named LICENSE.
 
+#include "Allocator.hpp"
 #include "Conversion.hpp"
 #include "toml.hpp"
 #include <CTOML/CTOML.h>
@@ -55,7 +56,8 @@ extern "C" {
 		}
 	}
 
-	/// Copies \c n and returns the copy.
+	/// Copies \c n and returns the copy. Copying a table frozen with \c tableFreeze , or anything in one, takes
+	/// constant time.
 	CTOMLNode * copyNode(CTOMLNode * n) {
 		auto node = reinterpret_cast<toml::node *>(n);
 		switch (node->type()) {
@@ -102,6 +104,16 @@ extern "C" {
 		}
 	}
 
+	/// A 64-bit hash of \c node and everything in it, which is the same for nodes that are equal (so tables that
+	/// are equal hash the same however they were written) and doesn't change between runs on machines with the same
+	/// byte order. \c node can be a \c CTOMLTable or \c CTOMLArray too. The hashes of the tables and arrays in a
+	/// table frozen with \c tableFreeze are cached, so hashing it again after changing it only visits what was
+	/// changed and the tables and arrays on the way to it. Frozen tables that have been hashed are compared by their
+	/// hashes first by \c tableEqual .
+	uint64_t nodeHash(CTOMLNode * _Nonnull node) {
+		return toml::impl::hasher::of(*reinterpret_cast<toml::node *>(node));
+	}
+
 	// MARK: - Creation
 
 	/// Creates a \c CTOMLNode from \c b .
@@ -158,11 +170,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto boolMem = (bool *) malloc(sizeof(bool));
-
-		memcpy(boolMem, &res->get(), sizeof(bool));
-
-		return boolMem;
+		return ctomlAllocateCopy(res->get());
 	}
 
 	/// Retrieves a \c int64_t from the \c node .
@@ -171,11 +179,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto intMem = (int64_t *) malloc(sizeof(int64_t));
-
-		memcpy(intMem, &res->get(), sizeof(int64_t));
-
-		return intMem;
+		return ctomlAllocateCopy(res->get());
 	}
 
 	/// Retrieves a \c double from the \c node .
@@ -184,11 +188,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto doubleMem = (double *) malloc(sizeof(double));
-
-		memcpy(doubleMem, &res->get(), sizeof(double));
-
-		return doubleMem;
+		return ctomlAllocateCopy(res->get());
 	}
 
 	/// Retrieves a \c char * from the \c node .
@@ -197,7 +197,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		return strdup(res->get().c_str());
+		return ctomlStrdup(res->view());
 	}
 
 	/// Retrieves a \c CTOMLDate from the \c node .
@@ -206,15 +206,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto date = res->get();
-
-		auto dateMem = (CTOMLDate *) malloc(sizeof(CTOMLDate));
-
-		CTOMLDate cTOMLDate = tomlDateToCTOMLDate(date);
-
-		memcpy(dateMem, &cTOMLDate, sizeof(CTOMLDate));
-
-		return dateMem;
+		return ctomlAllocateCopy(tomlDateToCTOMLDate(res->get()));
 	}
 
 	/// Retrieves a \c CTOMLTime from the \c node .
@@ -223,15 +215,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto time = res->get();
-
-		auto timeMem = (CTOMLTime *) malloc(sizeof(CTOMLTime));
-
-		CTOMLTime cTOMLTime = tomlTimeToCTOMLTime(time);
-
-		memcpy(timeMem, &cTOMLTime, sizeof(CTOMLTime));
-
-		return timeMem;
+		return ctomlAllocateCopy(tomlTimeToCTOMLTime(res->get()));
 	}
 
 	/// Retrieves a \c CTOMLDateTime from the \c node .
@@ -240,15 +224,7 @@ extern "C" {
 
 		if (res == NULL) { return NULL; }
 
-		auto dateTime = res->get();
-
-		auto dateTimeMem = (CTOMLDateTime *) malloc(sizeof(CTOMLDateTime));
-
-		CTOMLDateTime cTOMLDateTime = tomlDateTimeToCTOMLDateTime(dateTime);
-
-		memcpy(dateTimeMem, &cTOMLDateTime, sizeof(CTOMLDateTime));
-
-		return dateTimeMem;
+		return ctomlAllocateCopy(tomlDateTimeToCTOMLDateTime(res->get()));
 	}
 
 	/// Retrieves a \c CTOMLTable from the \c node .
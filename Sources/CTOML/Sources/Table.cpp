@@ -4,10 +4,611 @@
 //
 //  The full text of the license can be found in the file named LICENSE.
 
+#include "Allocator.hpp"
 #include "Conversion.hpp"
 #include "toml.hpp"
 #include <CTOML/CTOML.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace {
+	/// The arena of a table parsed with \c ctomlParseShared , along with the references to the table held by
+	/// \c SharedTableCache and everyone it's been handed to.
+	class SharedDocument final : public toml::impl::memory_resource {
+	public:
+		toml::table * table = nullptr;
+
+		void * allocate(size_t size) override { return this->arena.allocate(size); }
+
+		void deallocate(void * ptr, size_t size) noexcept override { this->arena.deallocate(ptr, size); }
+
+		bool frees_individually() const noexcept override { return false; }
+
+		void retain() { this->references.fetch_add(1, std::memory_order_relaxed); }
+
+		void release() {
+			if (this->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete this->table;
+				delete this;
+			}
+		}
+
+	private:
+		toml::impl::arena arena;
+		std::atomic<size_t> references { 1 };
+	};
+
+	/// A table copied by \c tableCreateSharedImage into a shared memory mapping, which is made read-only once the
+	/// table is in it. The mapping starts with this object, followed by a snapshot of the table (which its long
+	/// strings refer to) and the table's nodes, all allocated from this object, so \c tableDestroy can tell a table
+	/// is an image from its allocation header.
+	class SharedImage final : public toml::impl::memory_resource {
+	public:
+		/// Copies the table saved in \c snapshot into a new image of at most \c capacity bytes, returning \c NULL
+		/// if the mapping can't be made and throwing \c std::bad_alloc if the table doesn't fit.
+		static toml::table * create(std::string_view snapshot, size_t capacity) {
+#ifdef _WIN32
+			return NULL;
+#else
+			auto base = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+			if (base == MAP_FAILED) { return NULL; }
+
+			auto image = ::new (base) SharedImage(capacity);
+			try {
+				toml::impl::memory_resource_scope scope(*image);
+				auto bytes = static_cast<char *>(image->allocate(snapshot.size()));
+				memcpy(bytes, snapshot.data(), snapshot.size());
+
+				// Packed arrays create nodes for their elements when they're accessed, which can't be done once
+				// the image is read-only.
+				auto table = new toml::table();
+				if (!toml::impl::snapshot::read(std::string_view(bytes, snapshot.size()), *table, false)) {
+					image->unmap();
+					return NULL;
+				}
+
+				image->seal();
+				return table;
+			} catch (...) {
+				image->unmap();
+				throw;
+			}
+#endif
+		}
+
+		void * allocate(size_t size) override {
+			size = roundUp(size, toml::impl::allocation_header_size);
+			if (this->capacity - this->used < size) { throw std::bad_alloc(); }
+
+			auto ptr = reinterpret_cast<unsigned char *>(this) + this->used;
+			this->used += size;
+			return ptr;
+		}
+
+		/// Nothing in an image is freed on its own; the whole mapping is unmapped by \c unmap .
+		void deallocate(void *, size_t) noexcept override {}
+
+		bool frees_individually() const noexcept override { return false; }
+
+		/// Unmaps the image from this process. Other processes that have it keep it.
+		void unmap() {
+#ifndef _WIN32
+			munmap(this, this->capacity);
+#endif
+		}
+
+	private:
+		size_t capacity;
+		size_t used;
+
+		explicit SharedImage(size_t capacity)
+			: capacity(capacity), used(roundUp(sizeof(SharedImage), toml::impl::allocation_header_size)) {}
+
+		static size_t roundUp(size_t size, size_t multiple) { return (size + multiple - 1) / multiple * multiple; }
+
+		/// Gives back the pages past the end of the table and makes the rest read-only.
+		void seal() {
+#ifndef _WIN32
+			const auto end = roundUp(this->used, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+			if (end < this->capacity) {
+				munmap(reinterpret_cast<unsigned char *>(this) + end, this->capacity - end);
+				this->capacity = end;
+			}
+			mprotect(this, this->capacity, PROT_READ);
+#endif
+		}
+	};
+
+	/// Frees tables passed to \c tableDestroyDeferred on a background thread, one at a time and in the
+	/// order they were passed.
+	class DeferredDestroyer {
+	public:
+		static DeferredDestroyer & shared() {
+			// Never destroyed, so that tables still queued at exit don't race with static destructors.
+			static auto destroyer = new DeferredDestroyer();
+			return *destroyer;
+		}
+
+		void add(toml::table * table) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->queue.push_back(table);
+				if (!this->started) {
+					std::thread([this] { this->run(); }).detach();
+					this->started = true;
+				}
+			}
+			this->changed.notify_all();
+		}
+
+		void wait() {
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->changed.wait(lock, [this] { return this->queue.empty() && !this->busy; });
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::deque<toml::table *> queue;
+		bool started = false;
+		bool busy = false;
+
+		void run() {
+			std::unique_lock<std::mutex> lock(this->mutex);
+			while (true) {
+				this->changed.wait(lock, [this] { return !this->queue.empty(); });
+				auto table = this->queue.front();
+				this->queue.pop_front();
+				this->busy = true;
+				lock.unlock();
+
+				auto resource = toml::impl::allocation_resource(table);
+				if (auto shared = dynamic_cast<SharedDocument *>(resource)) {
+					// Only frees the table if nothing else refers to it.
+					shared->release();
+				} else if (auto image = dynamic_cast<SharedImage *>(resource)) {
+					image->unmap();
+				} else {
+					{
+						toml::impl::reclaimer reclaimer;
+						try {
+							reclaimer.add(toml::impl::node_ptr(table));
+							reclaimer.collect();
+						} catch (...) {
+							// Whatever couldn't be queued is freed when `reclaimer` is.
+						}
+					}
+					delete dynamic_cast<toml::impl::arena *>(resource);
+				}
+
+				lock.lock();
+				this->busy = false;
+				this->changed.notify_all();
+			}
+		}
+	};
+
+	void reportParseError(const toml::parse_error & e, CTOMLParseError * errorPointer) {
+		*errorPointer = CTOMLParseError {
+			.description = ctomlStrdup(e.description()),
+			.source =
+				CTOMLSourceRegion {
+					.begin = CTOMLSourcePosition { .line = e.source().begin.line,
+												   .column = e.source().begin.column },
+					.end = CTOMLSourcePosition { .line = e.source().end.line,
+												 .column = e.source().end.column } }
+		};
+	}
+
+	/// Parses \c document with its nodes and container storage allocated from \c resource , which the table
+	/// owns from then on; \c tableDestroy finds it through the table's allocation header.
+	template <typename Resource>
+	CTOMLTable * parseInto(
+		std::unique_ptr<Resource> resource,
+		std::string_view document,
+		std::string_view path,
+		uint64_t options,
+		CTOMLParseError * errorPointer) {
+		try {
+			auto flags = (options & ctomlParseNoSourceRegions) ? toml::parse_flags::no_source_regions
+															   : toml::parse_flags::none;
+			toml::impl::memory_resource_scope scope(*resource);
+
+			// String values, and values converted on first access, refer to the resource's copy of the
+			// document, which lives as long as the table does. (An empty one has nothing to copy, and
+			// allocating zero bytes may return NULL.)
+			if (options & (ctomlParseStringViews | ctomlParseLazyValues)) {
+				if (!document.empty()) {
+					auto text = static_cast<char *>(resource->allocate(document.size()));
+					memcpy(text, document.data(), document.size());
+					document = std::string_view(text, document.size());
+				}
+				flags |= (options & ctomlParseLazyValues) ? toml::parse_flags::lazy_values
+														  : toml::parse_flags::string_views;
+			}
+
+			auto table = new toml::table(toml::parse(document, path, flags));
+			resource.release();
+			return reinterpret_cast<CTOMLTable *>(table);
+		} catch (toml::parse_error & e) {
+			reportParseError(e, errorPointer);
+			return NULL;
+		}
+	}
+
+	/// A 64-bit hash of \c bytes that is the same in every process (unlike \c std::hash ), for naming cache files.
+	uint64_t contentHash(std::string_view bytes) {
+		uint64_t hash = 0x9E3779B97F4A7C15ull ^ bytes.size();
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+			uint64_t word;
+			memcpy(&word, bytes.data() + i, sizeof(word));
+			hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+
+		uint64_t tail = 0;
+		if (i < bytes.size()) { memcpy(&tail, bytes.data() + i, bytes.size() - i); }
+		hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull;
+		return hash ^ (hash >> 29);
+	}
+
+	/// The documents most recently parsed with \c ctomlParseShared , so that parsing one again returns the same
+	/// table instead of another copy of it. The least recently used are evicted past the limit set by
+	/// \c ctomlSetSharedTableCacheLimit ; tables that have been handed out stay alive until they're destroyed.
+	class SharedTableCache {
+	public:
+		static SharedTableCache & shared() {
+			// Never destroyed, so that tables still in use at exit don't race with static destructors.
+			static auto cache = new SharedTableCache();
+			return *cache;
+		}
+
+		CTOMLTable * get(
+			std::string_view document, std::string_view path, uint64_t options, CTOMLParseError * errorPointer) {
+			const auto hash = contentHash(document) ^ (contentHash(path) * 31) ^ options;
+			if (auto table = this->find(hash, document, path, options)) { return table; }
+
+			auto table = parseInto(std::make_unique<SharedDocument>(), document, path, options, errorPointer);
+			if (!table) { return NULL; }
+
+			auto shared = static_cast<SharedDocument *>(toml::impl::allocation_resource(table));
+			shared->table = reinterpret_cast<toml::table *>(table);
+
+			std::vector<SharedDocument *> evicted;
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				// Another thread might have parsed the same document in the meantime.
+				if (auto existing = this->findLocked(hash, document, path, options)) {
+					evicted.push_back(shared);
+					table = existing;
+				} else if (this->limit) {
+					shared->retain();
+					this->entries.push_front(Entry { hash, std::string(document), std::string(path), options, shared });
+					this->index.emplace(hash, this->entries.begin());
+					while (this->entries.size() > this->limit) {
+						evicted.push_back(this->entries.back().shared);
+						this->unindex(std::prev(this->entries.end()));
+						this->entries.pop_back();
+					}
+				}
+			}
+
+			for (auto document : evicted) { document->release(); }
+			return table;
+		}
+
+		void setLimit(size_t limit) {
+			std::vector<SharedDocument *> evicted;
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->limit = limit;
+				while (this->entries.size() > this->limit) {
+					evicted.push_back(this->entries.back().shared);
+					this->unindex(std::prev(this->entries.end()));
+					this->entries.pop_back();
+				}
+			}
+
+			for (auto document : evicted) { document->release(); }
+		}
+
+	private:
+		struct Entry {
+			uint64_t hash;
+			std::string document;
+			std::string path;
+			uint64_t options;
+			SharedDocument * shared;
+		};
+
+		std::mutex mutex;
+		std::list<Entry> entries; // Most recently used first.
+		std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index;
+		size_t limit = 256;
+
+		CTOMLTable * find(uint64_t hash, std::string_view document, std::string_view path, uint64_t options) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			return this->findLocked(hash, document, path, options);
+		}
+
+		/// Returns the cached table for \c document with another reference, if there is one.
+		CTOMLTable * findLocked(uint64_t hash, std::string_view document, std::string_view path, uint64_t options) {
+			const auto [begin, end] = this->index.equal_range(hash);
+			for (auto it = begin; it != end; it++) {
+				const auto & entry = *it->second;
+				if (entry.options == options && entry.document == document && entry.path == path) {
+					this->entries.splice(this->entries.begin(), this->entries, it->second);
+					entry.shared->retain();
+					return reinterpret_cast<CTOMLTable *>(entry.shared->table);
+				}
+			}
+
+			return NULL;
+		}
+
+		void unindex(std::list<Entry>::iterator entry) {
+			const auto [begin, end] = this->index.equal_range(entry->hash);
+			for (auto it = begin; it != end; it++) {
+				if (it->second == entry) {
+					this->index.erase(it);
+					return;
+				}
+			}
+		}
+	};
+
+	/// Parses \c document as described by \c tableCreateFromString .
+	CTOMLTable * parseDocument(
+		std::string_view document, std::string_view path, uint64_t options, CTOMLParseError * errorPointer) {
+		if (options & ctomlParseShared) {
+			return SharedTableCache::shared().get(document, path, options, errorPointer);
+		}
+
+		if (options & (ctomlParseArena | ctomlParseStringViews | ctomlParseLazyValues)) {
+			return parseInto(std::make_unique<toml::impl::arena>(), document, path, options, errorPointer);
+		}
+
+		try {
+			auto flags = (options & ctomlParseNoSourceRegions) ? toml::parse_flags::no_source_regions
+															   : toml::parse_flags::none;
+			return reinterpret_cast<CTOMLTable *>(new toml::table(toml::parse(document, path, flags)));
+		} catch (toml::parse_error & e) {
+			reportParseError(e, errorPointer);
+			return NULL;
+		}
+	}
+
+	/// Saves a snapshot of \c table to \c path by writing it to a temporary file next to it and renaming that
+	/// over \c path , so other processes reading the cache never see a partly written snapshot.
+	void saveSnapshotAtomically(CTOMLTable * table, const std::string & path) {
+		static std::atomic<uint64_t> counter { std::random_device {}() };
+		const auto unique = counter.fetch_add(1, std::memory_order_relaxed)
+						  ^ std::hash<std::thread::id> {}(std::this_thread::get_id());
+
+		char suffix[32];
+		snprintf(suffix, sizeof(suffix), ".%016llx.tmp", static_cast<unsigned long long>(unique));
+		const auto temporary = path + suffix;
+		if (!tableSaveSnapshot(table, temporary.c_str()) || std::rename(temporary.c_str(), path.c_str()) != 0) {
+			std::remove(temporary.c_str());
+		}
+	}
+
+	/// Appends \c key to the dotted key \c path the way a TOML document would write it: bare if it can be,
+	/// otherwise quoted.
+	void appendKey(std::string & path, std::string_view key) {
+		if (!path.empty()) { path += '.'; }
+
+		const bool bare = !key.empty() && std::all_of(key.begin(), key.end(), [](char c) {
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+		});
+		if (bare) {
+			path += key;
+			return;
+		}
+
+		path += '"';
+		for (const char c : key) {
+			if (c == '"' || c == '\\') {
+				path += '\\';
+				path += c;
+			} else if (static_cast<unsigned char>(c) < 0x20u) {
+				path += toml::impl::control_char_escapes[static_cast<unsigned char>(c)];
+			} else if (c == '\x7F') {
+				path += "\\u007F";
+			} else {
+				path += c;
+			}
+		}
+		path += '"';
+	}
+
+	/// A key that differs between the tables compared by \c tableDiff .
+	struct TableChange {
+		CTOMLChangeKind kind;
+
+		/// The keys on the way to it from the root table, ending with its own.
+		std::vector<toml::key> keys;
+
+		/// \c keys as a dotted key.
+		std::string path;
+
+		/// A copy of its new value, unless it was removed.
+		toml::impl::node_ptr value;
+	};
+
+	/// The changes returned by \c tableDiff , found by walking both tables' keys in order together.
+	class TableDiff {
+	public:
+		std::vector<TableChange> changes;
+
+		void compare(const toml::table & from, const toml::table & to) {
+			auto f = from.cbegin();
+			auto t = to.cbegin();
+			while (f != from.cend() || t != to.cend()) {
+				int order = 0;
+				if (f == from.cend()) {
+					order = 1;
+				} else if (t == to.cend()) {
+					order = -1;
+				} else {
+					order = f->first.str().compare(t->first.str());
+				}
+
+				if (order < 0) {
+					this->add(ctomlKeyRemoved, f->first, nullptr);
+					f++;
+					continue;
+				}
+				if (order > 0) {
+					this->add(ctomlKeyAdded, t->first, &t->second);
+					t++;
+					continue;
+				}
+
+				const auto fromTable = f->second.as_table();
+				const auto toTable = t->second.as_table();
+				if (fromTable && toTable) {
+					if (!fromTable->shares_entries(*toTable)) {
+						this->keys.push_back(f->first);
+						this->compare(*fromTable, *toTable);
+						this->keys.pop_back();
+					}
+				} else if (!toml::impl::node_deep_equality(&f->second, &t->second)) {
+					this->add(ctomlKeyChanged, t->first, &t->second);
+				}
+				f++;
+				t++;
+			}
+		}
+
+	private:
+		std::vector<toml::key> keys;
+
+		void add(CTOMLChangeKind kind, const toml::key & key, const toml::node * value) {
+			TableChange change { kind, this->keys, {}, value ? toml::impl::make_node(*value) : nullptr };
+			change.keys.push_back(key);
+			for (const auto & k : change.keys) {
+				appendKey(change.path, k.str());
+			}
+			this->changes.push_back(std::move(change));
+		}
+	};
+
+	/// The path of the first key that's in both tables without being a table in both, as a dotted key, or an empty
+	/// string if there isn't one.
+	std::string findMergeConflict(const toml::table & into, const toml::table & from) {
+		for (auto && [k, v] : from) {
+			const auto existing = into.get(k.str());
+			if (!existing) { continue; }
+
+			std::string path;
+			if (existing->is_table() && v.is_table()) {
+				path = findMergeConflict(*existing->as_table(), *v.as_table());
+				if (path.empty()) { continue; }
+				path.insert(0, 1, '.');
+			}
+
+			std::string key;
+			appendKey(key, k.str());
+			return key + path;
+		}
+		return {};
+	}
+
+	/// The tables given to \c layeredViewCreate , looked up in from the top layer down.
+	class LayeredView {
+	public:
+		LayeredView(CTOMLTable * _Nonnull const * _Nonnull layers, size_t count, bool cacheMisses)
+			: cacheMisses(cacheMisses) {
+			this->layers.reserve(count);
+			for (size_t i = count; i > 0; i--) {
+				this->layers.push_back(reinterpret_cast<const toml::table *>(layers[i - 1]));
+			}
+		}
+
+		const toml::node * get(const char * _Nonnull const * _Nonnull keys, size_t count) {
+			if (count == 0) { return nullptr; }
+			if (this->cacheMisses) {
+				this->missKey.clear();
+				for (size_t i = 0; i < count; i++) { this->missKey.append(keys[i]).push_back('\0'); }
+				if (this->misses.count(this->missKey)) { return nullptr; }
+			}
+
+			const toml::node * found = nullptr;
+			for (const auto layer : this->layers) {
+				bool shadowed = false;
+				const auto parent = this->find(*layer, keys, count - 1, shadowed);
+				if (shadowed) { break; }
+				if (parent && (found = parent->get(keys[count - 1]))) { break; }
+			}
+
+			if (!found && this->cacheMisses) { this->misses.insert(this->missKey); }
+			return found;
+		}
+
+		std::vector<std::string_view> keys(const char * _Nonnull const * _Nullable path, size_t count) const {
+			std::vector<std::string_view> keys;
+			for (const auto layer : this->layers) {
+				bool shadowed = false;
+				auto table = this->find(*layer, path, count, shadowed);
+				if (shadowed) { break; }
+				if (!table) { continue; }
+
+				for (auto && [k, v] : *table) { keys.push_back(k.str()); }
+			}
+
+			std::sort(keys.begin(), keys.end());
+			keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+			return keys;
+		}
+
+	private:
+		std::vector<const toml::table *> layers;
+		bool cacheMisses;
+		std::unordered_set<std::string> misses;
+		std::string missKey;
+
+		/// The table at \c path in \c layer , or \c nullptr if it isn't there. \c shadowed is set if something
+		/// other than a table is on the way, hiding the layers below.
+		const toml::table * find(
+			const toml::table & layer,
+			const char * _Nonnull const * _Nullable path,
+			size_t count,
+			bool & shadowed) const {
+			auto table = &layer;
+			for (size_t i = 0; i < count; i++) {
+				const auto node = table->get(path[i]);
+				if (!node) { return nullptr; }
+
+				table = node->as_table();
+				if (!table) {
+					shadowed = true;
+					return nullptr;
+				}
+			}
+			return table;
+		}
+	};
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,35 +620,189 @@ extern "C" {
 
 	/// Creates a \c toml::table from a string containing a TOML document.
 	/// @param tomlStr The string containing the TOML document.
+	/// @param options A combination of \c CTOMLParseOptions .
 	/// @param errorPointer Te pointer that will contain the \c CTOMLParseError if an error occurs
 	/// during parsing.
 	CTOMLTable * _Nullable tableCreateFromString(
-		const char * _Nonnull tomlStr, CTOMLParseError * _Nonnull errorPointer) {
-		try {
-			return reinterpret_cast<CTOMLTable *>(new toml::table(toml::parse(tomlStr)));
-		} catch (toml::parse_error & e) {
+		const char * _Nonnull tomlStr, uint64_t options, CTOMLParseError * _Nonnull errorPointer) {
+		return parseDocument(tomlStr, std::string_view {}, options, errorPointer);
+	}
+
+	/// Creates a \c toml::table from the TOML document in the file at \c path , like \c tableCreateFromString .
+	///
+	/// If \c cacheDirectory isn't \c NULL , a snapshot of the table (see \c tableSaveSnapshot ) is saved in that
+	/// directory under a hash of the file's contents, and loaded instead of parsing the file again as long as its
+	/// contents don't change. Tables loaded from the cache are allocated like ones parsed with
+	/// \c ctomlParseStringViews whatever \c options are, and don't have source regions. Snapshots are written to
+	/// a temporary file and renamed into place, so several processes can share a cache directory. The directory
+	/// isn't used with \c ctomlParseShared .
+	/// @param errorPointer The pointer that will contain the \c CTOMLParseError if the file can't be read or an
+	/// error occurs during parsing.
+	CTOMLTable * _Nullable tableCreateFromFile(
+		const char * _Nonnull path,
+		uint64_t options,
+		const char * _Nullable cacheDirectory,
+		CTOMLParseError * _Nonnull errorPointer) {
+		std::string contents;
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (file) {
+			contents.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+		}
+		if (!file) {
 			*errorPointer = CTOMLParseError {
-				.description = strdup(std::string(e.description()).c_str()),
-				.source =
-					CTOMLSourceRegion {
-						.begin = CTOMLSourcePosition { .line = e.source().begin.line,
-													   .column = e.source().begin.column },
-						.end = CTOMLSourcePosition { .line = e.source().end.line,
-													 .column = e.source().end.column } }
+				.description = ctomlStrdup("Could not read " + std::string(path)),
+				.source = CTOMLSourceRegion {},
 			};
+			return NULL;
+		}
+
+		// Shared tables come from the in-memory cache, which is quicker still.
+		const bool useCache = cacheDirectory && !(options & ctomlParseShared);
+		std::string cachePath;
+		if (useCache) {
+			char name[64];
+			snprintf(name,
+					 sizeof(name),
+					 "/%016llx-%llx.tomlsnap",
+					 static_cast<unsigned long long>(contentHash(contents)),
+					 static_cast<unsigned long long>(contents.size()));
+			cachePath = std::string(cacheDirectory) + name;
+
+			if (auto table = tableOpenSnapshot(cachePath.c_str())) { return table; }
+		}
+
+		auto table = parseDocument(contents, path, options, errorPointer);
+		if (table && useCache) { saveSnapshotAtomically(table, cachePath); }
+
+		return table;
+	}
 
+	/// Destroys \c table , which must have been returned by \c tableCreate , \c tableCreateFromString ,
+	/// \c tableCreateFromFile , \c tableOpenSnapshot or \c tableCreateSharedImage . If \c table was parsed with
+	/// \c ctomlParseArena , its arena is released as well. A table parsed with \c ctomlParseShared is only freed
+	/// once every call that returned it has been matched by a \c tableDestroy and it has left the cache.
+	void tableDestroy(CTOMLTable * table) {
+		auto t = reinterpret_cast<toml::table *>(table);
+		auto resource = toml::impl::allocation_resource(t);
+		if (auto shared = dynamic_cast<SharedDocument *>(resource)) {
+			shared->release();
+			return;
+		}
+		if (auto image = dynamic_cast<SharedImage *>(resource)) {
+			image->unmap();
+			return;
+		}
+
+		auto arena = dynamic_cast<toml::impl::arena *>(resource);
+
+		// Nodes and storage that came from the arena are not freed individually (deallocating from an
+		// arena does nothing); only values added after parsing go back to the heap.
+		delete t;
+		delete arena;
+	}
+
+	/// Loads a table saved with \c tableSaveSnapshot , which is much faster than parsing the document again.
+	/// The table is allocated like one parsed with \c ctomlParseStringViews and must be destroyed with
+	/// \c tableDestroy . Returns \c NULL if \c path can't be read, isn't a snapshot written by this version of
+	/// CTOML on a machine with the same byte order, or has been truncated or damaged since it was written.
+	CTOMLTable * _Nullable tableOpenSnapshot(const char * _Nonnull path) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) { return NULL; }
+
+		const auto size = static_cast<size_t>(file.tellg());
+		file.seekg(0);
+
+		auto arena = std::make_unique<toml::impl::arena>();
+		toml::impl::memory_resource_scope scope(*arena);
+
+		// Long strings refer to the arena's copy of the snapshot, like they do with `ctomlParseStringViews`.
+		auto bytes = static_cast<char *>(arena->allocate(size));
+		if (!file.read(bytes, static_cast<std::streamsize>(size))) { return NULL; }
+
+		auto table = new toml::table();
+		if (!toml::impl::snapshot::read(std::string_view(bytes, size), *table)) {
+			delete table;
 			return NULL;
 		}
+
+		arena.release();
+		return reinterpret_cast<CTOMLTable *>(table);
+	}
+
+	/// Saves \c table to the file at \c path in a binary format that \c tableOpenSnapshot loads without parsing,
+	/// returning whether it was written. Source regions aren't saved.
+	bool tableSaveSnapshot(CTOMLTable * _Nonnull table, const char * _Nonnull path) {
+		std::string snapshot;
+		toml::impl::snapshot::write(*reinterpret_cast<toml::table *>(table), snapshot);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+		return static_cast<bool>(file.flush());
+	}
+
+	/// Copies \c table into memory that is shared with the processes forked after this call and is read-only,
+	/// so that a large document parsed once before forking workers takes up memory only once, however many of
+	/// them there are. The workers use the returned table as it is, since their copy of the mapping is at the same
+	/// address. Modifying it crashes. Calling \c tableDestroy unmaps it from that process only, and the memory is
+	/// freed once every process has done that or exited.
+	///
+	/// Returns \c NULL if the memory can't be mapped, which is always the case on Windows.
+	CTOMLTable * _Nullable tableCreateSharedImage(CTOMLTable * _Nonnull table) {
+		std::string snapshot;
+		toml::impl::snapshot::write(*reinterpret_cast<toml::table *>(table), snapshot);
+
+		// The nodes usually take up a few times as much as the snapshot; the mapping is only backed by memory as
+		// it's used, and what's left over is given back.
+		for (size_t capacity = snapshot.size() * 16 + 64 * 1024; capacity >= snapshot.size(); capacity *= 2) {
+			try {
+				return reinterpret_cast<CTOMLTable *>(SharedImage::create(snapshot, capacity));
+			} catch (std::bad_alloc &) {}
+		}
+
+		return NULL;
+	}
+
+	/// Freezes \c table so that copying it, or a table or array in it, with \c copyNode takes constant time: the
+	/// copy shares everything with the original until one of them is modified, which copies only the tables and
+	/// arrays on the way to what changed. Getting a node from a frozen table or array (with \c tableGetNode or
+	/// \c arrayGetNode ) counts as modifying it, since the node could be modified through what's returned. Nodes
+	/// gotten from \c table before freezing it mustn't be used to modify it afterwards.
+	///
+	/// Returns \c false (and leaves \c table as it is) if \c table was parsed with \c ctomlParseArena ,
+	/// \c ctomlParseStringViews , \c ctomlParseLazyValues or \c ctomlParseShared , or came from
+	/// \c tableOpenSnapshot or \c tableCreateSharedImage , since copies could outlive the memory it's in.
+	bool tableFreeze(CTOMLTable * _Nonnull table) {
+		auto t = reinterpret_cast<toml::table *>(table);
+		if (!toml::impl::allocation_resource(t)->frees_individually()) { return false; }
+
+		t->freeze();
+		return true;
+	}
+
+	/// Sets the most documents parsed with \c ctomlParseShared that are kept to be shared (256 by default),
+	/// evicting the least recently used ones past that. \c 0 turns sharing off.
+	void ctomlSetSharedTableCacheLimit(size_t limit) { SharedTableCache::shared().setLimit(limit); }
+
+	/// Destroys \c table like \c tableDestroy , but on a background thread, so that the caller doesn't wait for
+	/// a large document to be freed. Documents are taken apart one table or array at a time, so deeply nested
+	/// ones don't overflow the stack.
+	void tableDestroyDeferred(CTOMLTable * table) {
+		DeferredDestroyer::shared().add(reinterpret_cast<toml::table *>(table));
 	}
 
+	/// Blocks until every table passed to \c tableDestroyDeferred so far has been freed.
+	void tableWaitForDeferredDestruction() { DeferredDestroyer::shared().wait(); }
+
 	// MARK: - Table Information
 
 	/// Checks whether \c table1 is equal to \c table2 .
 	/// @param table1 This first \c toml::table that will be used in the comparison.
 	/// @param table2 This second \c toml::table that will be used in the comparison.
 	bool tableEqual(CTOMLTable * table1, CTOMLTable * table2) {
-		auto tbl1 = *reinterpret_cast<toml::table *>(table1);
-		auto tbl2 = *reinterpret_cast<toml::table *>(table2);
+		const auto & tbl1 = *reinterpret_cast<toml::table *>(table1);
+		const auto & tbl2 = *reinterpret_cast<toml::table *>(table2);
 		return tbl1 == tbl2;
 	}
 
@@ -88,6 +843,10 @@ extern "C" {
 	/// @param table The \c toml::table to clear.
 	void tableClear(CTOMLTable * table) { reinterpret_cast<toml::table *>(table)->clear(); }
 
+	/// Moves everything in \c table into contiguous memory in depth-first order, which makes walking it
+	/// faster. Pointers to anything inside \c table are invalidated.
+	void tableCompact(CTOMLTable * table) { reinterpret_cast<toml::table *>(table)->compact(); }
+
 	/// Inserts \c integer into \c table at \c key .
 	void tableInsertInt(CTOMLTable * table, const char * key, int64_t integer, uint16_t flags) {
 		auto t = reinterpret_cast<toml::table *>(table);
@@ -143,7 +902,7 @@ extern "C" {
 	CTOMLNode * _Nullable tableGetNode(CTOMLTable * table, const char * key) {
 		auto tbl = reinterpret_cast<toml::table *>(table);
 
-		if (tbl->get(key)) { return reinterpret_cast<CTOMLNode *>(tbl->get(key)); }
+		if (auto node = tbl->get(key)) { return reinterpret_cast<CTOMLNode *>(node); }
 
 		return NULL;
 	}
@@ -151,11 +910,11 @@ extern "C" {
 	/// Retrieve all the keys from \c table . The size of the return value is the size of \c table .
 	const char * const * tableGetKeys(CTOMLTable * table) {
 		auto t = reinterpret_cast<toml::table *>(table);
-		auto keyArray = (char **) malloc(sizeof(char **) * t->size());
+		auto keyArray = static_cast<char **>(ctomlAllocate(sizeof(char *) * t->size()));
 		int64_t index = 0;
 
 		for (auto && [k, v] : *t) {
-			keyArray[index] = strdup(std::string(k.str()).c_str());
+			keyArray[index] = ctomlStrdup(k.str());
 			index++;
 		}
 
@@ -166,7 +925,7 @@ extern "C" {
 	/// .
 	CTOMLNode const * const * tableGetValues(CTOMLTable * table) {
 		auto t = reinterpret_cast<toml::table *>(table);
-		auto valueArray = (CTOMLNode **) malloc(sizeof(CTOMLNode **) * t->size());
+		auto valueArray = static_cast<CTOMLNode **>(ctomlAllocate(sizeof(CTOMLNode *) * t->size()));
 		int64_t index = 0;
 
 		for (auto && [k, v] : *t) {
@@ -184,35 +943,188 @@ extern "C" {
 		reinterpret_cast<toml::table *>(table)->erase(key);
 	}
 
+	// MARK: - Table - Diff and Patch
+
+	/// Compares \c oldTable with \c newTable , returning the keys that were added, removed or changed, which must be
+	/// destroyed with \c tableDiffDestroy . Both tables are walked together in key order, and tables in both are
+	/// compared key by key, so a change deep in a table is reported by its full path rather than as a change to the
+	/// table. Arrays are compared as a whole. Tables that share their contents because one was copied from the other
+	/// after \c tableFreeze are skipped without being walked, so diffing two versions of a frozen document takes
+	/// time proportional to what changed.
+	CTOMLTableDiff * _Nonnull tableDiff(CTOMLTable * _Nonnull oldTable, CTOMLTable * _Nonnull newTable) {
+		auto diff = std::make_unique<TableDiff>();
+		diff->compare(*reinterpret_cast<toml::table *>(oldTable), *reinterpret_cast<toml::table *>(newTable));
+		return reinterpret_cast<CTOMLTableDiff *>(diff.release());
+	}
+
+	/// The number of keys in \c diff .
+	size_t tableDiffSize(CTOMLTableDiff * _Nonnull diff) { return reinterpret_cast<TableDiff *>(diff)->changes.size(); }
+
+	/// How the key at \c index in \c diff changed.
+	CTOMLChangeKind tableDiffKind(CTOMLTableDiff * _Nonnull diff, size_t index) {
+		return reinterpret_cast<TableDiff *>(diff)->changes[index].kind;
+	}
+
+	/// The path of the key at \c index in \c diff from the root table, written as a TOML dotted key (keys that
+	/// aren't bare are quoted). The string belongs to \c diff .
+	const char * _Nonnull tableDiffPath(CTOMLTableDiff * _Nonnull diff, size_t index) {
+		return reinterpret_cast<TableDiff *>(diff)->changes[index].path.c_str();
+	}
+
+	/// The new value of the key at \c index in \c diff , or \c NULL if it was removed. The node belongs to
+	/// \c diff .
+	const CTOMLNode * _Nullable tableDiffValue(CTOMLTableDiff * _Nonnull diff, size_t index) {
+		return reinterpret_cast<const CTOMLNode *>(reinterpret_cast<TableDiff *>(diff)->changes[index].value.get());
+	}
+
+	/// Applies \c diff to \c table , so that a table equal to the old table given to \c tableDiff becomes equal
+	/// to the new one. Tables on the way to an added or changed key are created if they're missing (or aren't
+	/// tables), and removing a key that isn't there does nothing. \c diff can be applied any number of times.
+	void tablePatch(CTOMLTable * _Nonnull table, CTOMLTableDiff * _Nonnull diff) {
+		for (const auto & change : reinterpret_cast<TableDiff *>(diff)->changes) {
+			auto parent = reinterpret_cast<toml::table *>(table);
+			for (auto key = change.keys.begin(); parent && key + 1 != change.keys.end(); key++) {
+				auto child = parent->get_as<toml::table>(key->str());
+				if (!child && change.value) {
+					child = parent->insert_or_assign(*key, toml::table {}).first->second.as_table();
+				}
+				parent = child;
+			}
+
+			if (!parent) { continue; }
+			if (change.value) {
+				parent->insert_or_assign(change.keys.back(), *change.value);
+			} else {
+				parent->erase(change.keys.back().str());
+			}
+		}
+	}
+
+	/// Destroys \c diff , which must have been returned by \c tableDiff .
+	void tableDiffDestroy(CTOMLTableDiff * _Nonnull diff) { delete reinterpret_cast<TableDiff *>(diff); }
+
+	// MARK: - Table - Merging
+
+	/// Merges \c source into \c destination in a single pass, merging tables that are in both key by key and
+	/// resolving any other key that's in both according to \c policy . The values in \c source are moved rather
+	/// than copied, so \c source is left empty, unless it's in memory \c destination can't take values from (it was
+	/// parsed with \c ctomlParseArena , \c ctomlParseStringViews , \c ctomlParseLazyValues or
+	/// \c ctomlParseShared , or came from \c tableOpenSnapshot or \c tableCreateSharedImage ), in which case they're
+	/// copied and \c source is left as it was.
+	///
+	/// Returns \c false if \c policy is \c ctomlMergeErrorOnConflict and a key is in both tables, leaving both as
+	/// they were. If \c conflictPath isn't \c NULL , it's then set to the key's path as a TOML dotted key, which
+	/// must be freed with \c ctomlFree .
+	bool tableMergeInto(
+		CTOMLTable * _Nonnull destination,
+		CTOMLTable * _Nonnull source,
+		CTOMLMergePolicy policy,
+		char * _Nullable * _Nullable conflictPath) {
+		auto into = reinterpret_cast<toml::table *>(destination);
+		auto from = reinterpret_cast<toml::table *>(source);
+		if (into == from) { return true; }
+
+		if (policy == ctomlMergeErrorOnConflict) {
+			const auto conflict = findMergeConflict(*into, *from);
+			if (!conflict.empty()) {
+				if (conflictPath) { *conflictPath = ctomlStrdup(conflict); }
+				return false;
+			}
+		}
+
+		auto mergePolicy = toml::impl::merger::policy::replace;
+		if (policy == ctomlMergeKeep) { mergePolicy = toml::impl::merger::policy::keep; }
+		if (policy == ctomlMergeAppendArrays) { mergePolicy = toml::impl::merger::policy::append_arrays; }
+		const toml::impl::merger merge(mergePolicy);
+
+		// Nodes in an arena (or other memory that's freed with its table) can't outlive their table, so they're
+		// copied to the heap first.
+		if (!toml::impl::allocation_resource(from)->frees_individually()) {
+			toml::table copy(*from);
+			merge(*into, copy);
+		} else {
+			merge(*into, *from);
+		}
+		return true;
+	}
+
+	// MARK: - Table - Layered Views
+
+	/// Creates a view of \c layers as if they had been merged into one table in order with \c ctomlMergeOverride ,
+	/// without merging or copying anything. Lookups probe the layers from the last one down, and the view must be
+	/// destroyed with \c layeredViewDestroy before any of the tables are changed or destroyed. If \c cacheMisses is
+	/// \c true , paths that aren't in any layer are remembered so that looking them up again doesn't probe the
+	/// layers, and the view can then only be used from one thread at a time.
+	CTOMLLayeredView * _Nonnull layeredViewCreate(
+		CTOMLTable * _Nonnull const * _Nonnull layers, size_t count, bool cacheMisses) {
+		return reinterpret_cast<CTOMLLayeredView *>(new LayeredView(layers, count, cacheMisses));
+	}
+
+	/// Retrieves the value at \c key from the highest layer of \c view that has it.
+	const CTOMLNode * _Nullable layeredViewGetNode(CTOMLLayeredView * _Nonnull view, const char * _Nonnull key) {
+		return reinterpret_cast<const CTOMLNode *>(reinterpret_cast<LayeredView *>(view)->get(&key, 1));
+	}
+
+	/// Retrieves the value at the path made of the \c count keys in \c keys from the highest layer of \c view
+	/// that has it. A path that goes through a value other than a table in a layer isn't looked up in the layers
+	/// below it, as merging would have replaced their tables. A table that's in more than one layer is returned
+	/// from the highest of them, so look its keys up through \c view .
+	const CTOMLNode * _Nullable layeredViewGetNodeAtPath(
+		CTOMLLayeredView * _Nonnull view, const char * _Nonnull const * _Nonnull keys, size_t count) {
+		return reinterpret_cast<const CTOMLNode *>(reinterpret_cast<LayeredView *>(view)->get(keys, count));
+	}
+
+	/// Retrieves the keys of the table at the path made of the \c count keys in \c path (the root table if
+	/// \c count is 0), sorted and taken from every layer it's in, setting \c size to the number of keys. The keys
+	/// and the array must be freed with \c ctomlFree .
+	char * _Nonnull * _Nonnull layeredViewGetKeys(
+		CTOMLLayeredView * _Nonnull view,
+		const char * _Nonnull const * _Nullable path,
+		size_t count,
+		size_t * _Nonnull size) {
+		const auto keys = reinterpret_cast<LayeredView *>(view)->keys(path, count);
+		auto keyArray = static_cast<char **>(ctomlAllocate(sizeof(char *) * std::max<size_t>(keys.size(), 1)));
+		for (size_t i = 0; i < keys.size(); i++) { keyArray[i] = ctomlStrdup(keys[i]); }
+
+		*size = keys.size();
+		return keyArray;
+	}
+
+	/// Destroys \c view , which must have been returned by \c layeredViewCreate .
+	void layeredViewDestroy(CTOMLLayeredView * _Nonnull view) { delete reinterpret_cast<LayeredView *>(view); }
+
 	// MARK: - Table Conversion
 
 	/// Convert \c table to a TOML document.
 	char * tableConvertToTOML(CTOMLTable * table, uint64_t options) {
-		std::stringstream ss;
+		CTOMLOutputBuffer buffer;
+		std::ostream os(&buffer);
 
-		ss << toml::toml_formatter(
+		os << toml::toml_formatter(
 			*reinterpret_cast<toml::table *>(table), toml::format_flags(options));
 
-		return strdup(ss.str().c_str());
+		return buffer.release();
 	}
 
 	char * tableConvertToJSON(CTOMLTable * table, uint64_t options) {
-		std::stringstream ss;
+		CTOMLOutputBuffer buffer;
+		std::ostream os(&buffer);
 
-		ss << toml::json_formatter(
+		os << toml::json_formatter(
 			*reinterpret_cast<toml::table *>(table), toml::format_flags(options));
 
-		return strdup(ss.str().c_str());
+		return buffer.release();
 	}
 
 	/// Convert \c table to a YAML document.
 	char * tableConvertToYAML(CTOMLTable * table, uint64_t options) {
-		std::stringstream ss;
+		CTOMLOutputBuffer buffer;
+		std::ostream os(&buffer);
 
-		ss << toml::yaml_formatter(
+		os << toml::yaml_formatter(
 			*reinterpret_cast<toml::table *>(table), toml::format_flags(options));
 
-		return strdup(ss.str().c_str());
+		return buffer.release();
 	}
 
 #ifdef __cplusplus
@@ -635,17 +635,17 @@
 
 #define TOML_ASYMMETRICAL_EQUALITY_OPS(LHS, RHS, ...)                                                                  \
 	__VA_ARGS__ TOML_NODISCARD                                                                                         \
-	friend bool operator==(RHS rhs, LHS lhs) noexcept                                                                  \
+	friend bool operator==(RHS rhs, LHS lhs) noexcept(noexcept(lhs == rhs))                                            \
 	{                                                                                                                  \
 		return lhs == rhs;                                                                                             \
 	}                                                                                                                  \
 	__VA_ARGS__ TOML_NODISCARD                                                                                         \
-	friend bool operator!=(LHS lhs, RHS rhs) noexcept                                                                  \
+	friend bool operator!=(LHS lhs, RHS rhs) noexcept(noexcept(lhs == rhs))                                            \
 	{                                                                                                                  \
 		return !(lhs == rhs);                                                                                          \
 	}                                                                                                                  \
 	__VA_ARGS__ TOML_NODISCARD                                                                                         \
-	friend bool operator!=(RHS rhs, LHS lhs) noexcept                                                                  \
+	friend bool operator!=(RHS rhs, LHS lhs) noexcept(noexcept(lhs == rhs))                                            \
 	{                                                                                                                  \
 		return !(lhs == rhs);                                                                                          \
 	}                                                                                                                  \
@@ -1004,6 +1004,22 @@
 #define TOML_ENABLE_FORMATTERS 1
 #endif
 
+// homogeneous arrays with at least this many integers, floats, booleans, dates, times or date-times, or tables that all
+// have the same keys, are stored packed (0 disables packing)
+#ifndef TOML_ARRAY_PACK_THRESHOLD
+#define TOML_ARRAY_PACK_THRESHOLD 16
+#endif
+
+// tables with at most this many keys keep them in a flat array searched linearly instead of a map (0 always uses the map)
+#ifndef TOML_TABLE_SMALL_SIZE
+#define TOML_TABLE_SMALL_SIZE 8
+#endif
+
+// tables with at least this many keys get a hash index for lookups (0 disables it)
+#ifndef TOML_TABLE_HASH_INDEX_THRESHOLD
+#define TOML_TABLE_HASH_INDEX_THRESHOLD 16
+#endif
+
 // SIMD
 #if !defined(TOML_ENABLE_SIMD) || (defined(TOML_ENABLE_SIMD) && TOML_ENABLE_SIMD) || TOML_INTELLISENSE
 #undef TOML_ENABLE_SIMD
@@ -1495,6 +1511,13 @@ TOML_IMPL_NAMESPACE_START
 	class parser;
 	TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
 
+	class packed_array;
+	class compactor;
+	class reclaimer;
+	class snapshot;
+	class hasher;
+	class merger;
+
 	// clang-format off
 
 	inline constexpr std::string_view control_char_escapes[] =
@@ -1633,6 +1656,15 @@ TOML_NAMESPACE_START // abi namespace
 	};
 	TOML_MAKE_FLAGS(format_flags);
 
+	enum class TOML_CLOSED_FLAGS_ENUM parse_flags : uint8_t
+	{
+		none,
+		no_source_regions = (1u << 0),
+		string_views = (1u << 1),
+		lazy_values = (1u << 2), // implies string_views
+	};
+	TOML_MAKE_FLAGS(parse_flags);
+
 	template <typename T>
 	struct TOML_TRIVIAL_ABI inserter
 	{
@@ -2348,6 +2380,436 @@ TOML_IMPL_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
+//********  impl/memory.hpp  *******************************************************************************************
+
+TOML_DISABLE_WARNINGS;
+#include <atomic>
+#include <utility>
+TOML_ENABLE_WARNINGS;
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+TOML_IMPL_NAMESPACE_START
+{
+	// Q: "why do nodes and containers allocate through this instead of new/std::allocator?"
+	// A: so that a whole document can be built inside an arena (see impl::arena) without changing any of the public
+	//    types. every block is prefixed with the resource that produced it, so blocks are always handed back to the
+	//    right place no matter which resource is current when they're freed, and documents can freely mix blocks
+	//    from several resources (e.g. values inserted into an arena-backed document after parsing). the prefix is paid
+	//    by documents that never use an arena too: 8 bytes a block, which is about 10% more heap for a document of
+	//    small tables.
+
+	class memory_resource
+	{
+	  public:
+		virtual ~memory_resource() noexcept = default;
+
+		TOML_NODISCARD
+		virtual void* allocate(size_t size) = 0;
+
+		virtual void deallocate(void* ptr, size_t size) noexcept = 0;
+
+		// whether each block lives until it's deallocated, rather than until the resource itself goes away (like an
+		// arena's). only things allocated from resources like that can be shared with copies that outlive them.
+		TOML_PURE_GETTER
+		virtual bool frees_individually() const noexcept
+		{
+			return true;
+		}
+	};
+
+	class new_delete_resource final : public memory_resource
+	{
+	  public:
+		TOML_NODISCARD
+		void* allocate(size_t size) override
+		{
+			return ::operator new(size);
+		}
+
+		void deallocate(void* ptr, size_t) noexcept override
+		{
+			::operator delete(ptr);
+		}
+	};
+
+	TOML_NODISCARD
+	inline memory_resource& new_delete_memory_resource() noexcept
+	{
+		static new_delete_resource resource;
+		return resource;
+	}
+
+	TOML_NODISCARD
+	inline std::atomic<memory_resource*>& default_memory_resource_ref() noexcept
+	{
+		static std::atomic<memory_resource*> resource{ nullptr };
+		return resource;
+	}
+
+	// the resource used by threads with no memory_resource_scope active (new/delete unless replaced).
+	TOML_NODISCARD
+	inline memory_resource& default_memory_resource() noexcept
+	{
+		const auto resource = default_memory_resource_ref().load(std::memory_order_acquire);
+		return resource ? *resource : new_delete_memory_resource();
+	}
+
+	// replaces the default resource (nullptr restores new/delete) and returns the previous one. blocks remember
+	// where they came from, so a replaced resource must stay alive until everything it allocated has been freed.
+	inline memory_resource* set_default_memory_resource(memory_resource* resource) noexcept
+	{
+		return default_memory_resource_ref().exchange(resource, std::memory_order_acq_rel);
+	}
+
+	TOML_NODISCARD
+	inline memory_resource*& current_memory_resource_ref() noexcept
+	{
+		static thread_local memory_resource* resource = nullptr;
+		return resource;
+	}
+
+	TOML_NODISCARD
+	inline memory_resource& current_memory_resource() noexcept
+	{
+		const auto resource = current_memory_resource_ref();
+		return resource ? *resource : default_memory_resource();
+	}
+
+	// makes `resource` the source of all node and container allocations on this thread for the scope's lifetime.
+	class memory_resource_scope
+	{
+	  private:
+		memory_resource* previous_;
+
+	  public:
+		TOML_NODISCARD_CTOR
+		explicit memory_resource_scope(memory_resource& resource) noexcept //
+			: previous_{ std::exchange(current_memory_resource_ref(), &resource) }
+		{}
+
+		memory_resource_scope(const memory_resource_scope&)			   = delete;
+		memory_resource_scope& operator=(const memory_resource_scope&) = delete;
+
+		~memory_resource_scope() noexcept
+		{
+			current_memory_resource_ref() = previous_;
+		}
+	};
+
+	// the header is a whole pointer-aligned slot; everything allocated through here (nodes, map nodes,
+	// vectors of node_ptr) needs no more than that.
+	inline constexpr size_t allocation_header_size = sizeof(void*) > alignof(double) ? sizeof(void*) : alignof(double);
+
+	TOML_NODISCARD
+	inline void* allocate(size_t size)
+	{
+		auto& resource = current_memory_resource();
+		const auto block = static_cast<unsigned char*>(resource.allocate(size + allocation_header_size));
+		*reinterpret_cast<memory_resource**>(block) = &resource;
+		return block + allocation_header_size;
+	}
+
+	inline void deallocate(void* ptr, size_t size) noexcept
+	{
+		if (!ptr)
+			return;
+		const auto block = static_cast<unsigned char*>(ptr) - allocation_header_size;
+		(*reinterpret_cast<memory_resource**>(block))->deallocate(block, size + allocation_header_size);
+	}
+
+	// returns the resource that allocated `ptr`, which must have come from impl::allocate().
+	TOML_PURE_GETTER
+	TOML_ATTR(nonnull)
+	inline memory_resource* allocation_resource(const void* ptr) noexcept
+	{
+		return *reinterpret_cast<memory_resource* const*>(static_cast<const unsigned char*>(ptr)
+														   - allocation_header_size);
+	}
+
+	template <typename T>
+	class allocator
+	{
+		static_assert(alignof(T) <= allocation_header_size,
+					  "toml::impl::allocator can't provide stricter alignment than its allocation header");
+
+	  public:
+		using value_type							 = T;
+		using propagate_on_container_move_assignment = std::true_type;
+		using is_always_equal						 = std::true_type;
+
+		allocator() noexcept = default;
+
+		template <typename U>
+		constexpr allocator(const allocator<U>&) noexcept
+		{}
+
+		TOML_NODISCARD
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(impl::allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept
+		{
+			impl::deallocate(ptr, n * sizeof(T));
+		}
+
+		template <typename U>
+		TOML_CONST_INLINE_GETTER
+		friend constexpr bool operator==(const allocator&, const allocator<U>&) noexcept
+		{
+			return true;
+		}
+
+		template <typename U>
+		TOML_CONST_INLINE_GETTER
+		friend constexpr bool operator!=(const allocator&, const allocator<U>&) noexcept
+		{
+			return false;
+		}
+	};
+
+	// a bump allocator over chunks from an upstream resource; deallocation is a no-op and everything is
+	// released at once when the arena is destroyed.
+	// an arena must only be current on one thread at a time, and must outlive everything allocated from it.
+	class arena final : public memory_resource
+	{
+	  private:
+		struct chunk
+		{
+			chunk* next;
+			size_t size;
+		};
+		static constexpr size_t chunk_header_size =
+			(sizeof(chunk) + allocation_header_size - 1u) / allocation_header_size * allocation_header_size;
+		static constexpr size_t max_chunk_size = size_t{ 16u } * 1024u * 1024u;
+
+		memory_resource& upstream_;
+		chunk* chunks_ = nullptr;
+		unsigned char* cursor_{};
+		unsigned char* end_{};
+		size_t next_chunk_size_;
+		size_t bytes_reserved_{};
+
+		void add_chunk(size_t min_size)
+		{
+			size_t size = next_chunk_size_;
+			while (size - chunk_header_size < min_size)
+				size *= 2u;
+			next_chunk_size_ = impl::min(next_chunk_size_ * 2u, max_chunk_size);
+
+			const auto c = static_cast<chunk*>(upstream_.allocate(size));
+			c->next		 = chunks_;
+			c->size		 = size;
+			chunks_		 = c;
+			cursor_		 = reinterpret_cast<unsigned char*>(c) + chunk_header_size;
+			end_		 = reinterpret_cast<unsigned char*>(c) + size;
+			bytes_reserved_ += size;
+		}
+
+	  public:
+		TOML_NODISCARD_CTOR
+		explicit arena(size_t initial_chunk_size = 64u * 1024u,
+					   memory_resource& upstream  = default_memory_resource()) noexcept //
+			: upstream_{ upstream },
+			  next_chunk_size_{ initial_chunk_size > chunk_header_size * 2u ? initial_chunk_size
+																			 : chunk_header_size * 2u }
+		{}
+
+		arena(const arena&)			   = delete;
+		arena& operator=(const arena&) = delete;
+
+		~arena() noexcept override
+		{
+			while (chunks_)
+			{
+				const auto c = std::exchange(chunks_, chunks_->next);
+				upstream_.deallocate(c, c->size);
+			}
+		}
+
+		TOML_NODISCARD
+		void* allocate(size_t size) override
+		{
+			size = (size + allocation_header_size - 1u) / allocation_header_size * allocation_header_size;
+			if (static_cast<size_t>(end_ - cursor_) < size)
+				add_chunk(size);
+			return std::exchange(cursor_, cursor_ + size);
+		}
+
+		void deallocate(void*, size_t) noexcept override
+		{}
+
+		TOML_PURE_GETTER
+		bool frees_individually() const noexcept override
+		{
+			return false;
+		}
+
+		// total bytes obtained from the upstream resource so far.
+		TOML_PURE_INLINE_GETTER
+		size_t bytes_reserved() const noexcept
+		{
+			return bytes_reserved_;
+		}
+	};
+
+	// a single chunk from an upstream resource that allocations are bumped out of (anything that doesn't fit goes
+	// straight upstream). everything allocated from it, plus the reference its creator holds until release(), keeps
+	// it alive, and it goes back upstream once all of that has been freed. unlike an arena, a region can outlive
+	// whoever made it and the things allocated from it can be freed from any thread.
+	// a region must only be allocated from on one thread at a time.
+	class region final : public memory_resource
+	{
+	  private:
+		memory_resource& upstream_;
+		size_t size_;
+		std::atomic<size_t> live_{ 1u };
+		unsigned char* cursor_;
+		unsigned char* end_;
+
+		TOML_NODISCARD_CTOR
+		region(memory_resource& upstream, size_t size) noexcept //
+			: upstream_{ upstream },
+			  size_{ size },
+			  cursor_{ reinterpret_cast<unsigned char*>(this) + header_size },
+			  end_{ reinterpret_cast<unsigned char*>(this) + size }
+		{}
+
+		TOML_CONST_INLINE_GETTER
+		static constexpr size_t round_up(size_t size) noexcept
+		{
+			return (size + allocation_header_size - 1u) / allocation_header_size * allocation_header_size;
+		}
+
+	  public:
+		static constexpr size_t header_size = (sizeof(void*) * 6u + allocation_header_size - 1u)
+											/ allocation_header_size * allocation_header_size;
+
+		// `size` includes the region's own header.
+		TOML_NODISCARD
+		static region* create(size_t size, memory_resource& upstream = current_memory_resource())
+		{
+			static_assert(sizeof(region) <= header_size);
+			size = round_up((std::max)(size, header_size * 2u));
+			return ::new (upstream.allocate(size)) region{ upstream, size };
+		}
+
+		region(const region&)			 = delete;
+		region& operator=(const region&) = delete;
+
+		TOML_PURE_INLINE_GETTER
+		size_t available() const noexcept
+		{
+			return static_cast<size_t>(end_ - cursor_);
+		}
+
+		TOML_NODISCARD
+		void* allocate(size_t size) override
+		{
+			size = round_up(size);
+			if (available() < size)
+				return upstream_.allocate(size);
+
+			live_.fetch_add(1u, std::memory_order_relaxed);
+			return std::exchange(cursor_, cursor_ + size);
+		}
+
+		void deallocate(void* ptr, size_t size) noexcept override
+		{
+			const auto addr = reinterpret_cast<uintptr_t>(ptr);
+			if (addr > reinterpret_cast<uintptr_t>(this) && addr < reinterpret_cast<uintptr_t>(this) + size_)
+				release();
+			else
+				upstream_.deallocate(ptr, round_up(size));
+		}
+
+		// drops the creator's reference.
+		void release() noexcept
+		{
+			if (live_.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+			{
+				auto& upstream	 = upstream_;
+				const auto bytes = size_;
+				this->~region();
+				upstream.deallocate(this, bytes);
+			}
+		}
+	};
+
+	// packs small allocations (the parser's scalar nodes) next to each other in regions from the current resource.
+	// every allocation's header points at its region, so freeing one just counts it off, and a region goes back
+	// upstream once everything in it has been freed and the slab has moved on to another one. the slab itself can
+	// be destroyed before the things allocated from it.
+	// a slab must only be allocated from on one thread at a time.
+	class slab
+	{
+	  private:
+		static constexpr size_t max_region_size = size_t{ 64u } * 1024u;
+
+		region* current_		 = nullptr;
+		size_t next_region_size_ = 1024u;
+
+		void add_region(size_t min_size)
+		{
+			size_t size = next_region_size_;
+			while (size - region::header_size < min_size)
+				size *= 2u;
+			next_region_size_ = impl::min(next_region_size_ * 2u, max_region_size);
+
+			const auto r = region::create(size);
+			if (current_)
+				current_->release();
+			current_ = r;
+		}
+
+	  public:
+		slab() noexcept = default;
+
+		slab(const slab&)			 = delete;
+		slab& operator=(const slab&) = delete;
+
+		~slab() noexcept
+		{
+			if (current_)
+				current_->release();
+		}
+
+		// the same as impl::allocate(), but from the current region; the memory is freed with impl::deallocate().
+		TOML_NODISCARD
+		void* allocate(size_t size)
+		{
+			size = (size + allocation_header_size - 1u) / allocation_header_size * allocation_header_size
+				 + allocation_header_size;
+			if (!current_ || current_->available() < size)
+				add_region(size);
+
+			const auto block							= static_cast<unsigned char*>(current_->allocate(size));
+			*reinterpret_cast<memory_resource**>(block) = current_;
+			return block + allocation_header_size;
+		}
+	};
+}
+TOML_IMPL_NAMESPACE_END;
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
 //********  impl/print_to_stream.hpp  **********************************************************************************
 
 TOML_PUSH_WARNINGS;
@@ -2490,6 +2952,10 @@ TOML_POP_WARNINGS;
 
 //********  impl/source_region.hpp  ************************************************************************************
 
+TOML_DISABLE_WARNINGS;
+#include <mutex>
+#include <set>
+TOML_ENABLE_WARNINGS;
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
 #ifndef __clang__
@@ -2505,7 +2971,9 @@ TOML_NAMESPACE_START
 {
 	using source_index = uint32_t;
 
-	using source_path_ptr = std::shared_ptr<const std::string>;
+	// points at a path interned by impl::intern_source_path, which lives until the program exits, so regions can
+	// copy it freely (no reference counting) and it can never dangle.
+	using source_path_ptr = const std::string*;
 
 	struct TOML_TRIVIAL_ABI source_position
 	{
@@ -2580,7 +3048,7 @@ TOML_NAMESPACE_START
 
 		source_position end;
 
-		source_path_ptr path;
+		source_path_ptr path = {};
 
 #if TOML_ENABLE_WINDOWS_COMPAT
 
@@ -2603,6 +3071,34 @@ TOML_NAMESPACE_START
 }
 TOML_NAMESPACE_END;
 
+TOML_IMPL_NAMESPACE_START
+{
+	// stores each distinct source path once for the whole program. documents are parsed with the path looked up once
+	// (the same path parsed again on the same thread doesn't even take the lock), after which every node and key
+	// region just copies the pointer.
+	TOML_NODISCARD
+	inline source_path_ptr intern_source_path(std::string_view path)
+	{
+		if (path.empty())
+			return nullptr;
+
+		static thread_local source_path_ptr last = nullptr;
+		if (last && *last == path)
+			return last;
+
+		static std::mutex mutex;
+		static std::set<std::string, std::less<>> paths;
+
+		std::lock_guard<std::mutex> lock{ mutex };
+		auto it = paths.find(path);
+		if (it == paths.end())
+			it = paths.emplace(path).first;
+		last = &*it;
+		return last;
+	}
+}
+TOML_IMPL_NAMESPACE_END;
+
 #ifdef _MSC_VER
 #pragma pop_macro("min")
 #pragma pop_macro("max")
@@ -2975,11 +3471,11 @@ TOML_NAMESPACE_START
 {
 	TOML_NODISCARD
 	TOML_EXPORTED_FREE_FUNCTION
-	node_view<node> TOML_CALLCONV at_path(node & root, std::string_view path) noexcept;
+	node_view<node> TOML_CALLCONV at_path(node & root, std::string_view path);
 
 	TOML_NODISCARD
 	TOML_EXPORTED_FREE_FUNCTION
-	node_view<const node> TOML_CALLCONV at_path(const node& root, std::string_view path) noexcept;
+	node_view<const node> TOML_CALLCONV at_path(const node& root, std::string_view path);
 
 #if TOML_ENABLE_WINDOWS_COMPAT
 
@@ -3578,11 +4074,11 @@ TOML_NAMESPACE_START
 
 	TOML_NODISCARD
 	TOML_EXPORTED_FREE_FUNCTION
-	node_view<node> TOML_CALLCONV at_path(node & root, const toml::path& path) noexcept;
+	node_view<node> TOML_CALLCONV at_path(node & root, const toml::path& path);
 
 	TOML_NODISCARD
 	TOML_EXPORTED_FREE_FUNCTION
-	node_view<const node> TOML_CALLCONV at_path(const node& root, const toml::path& path) noexcept;
+	node_view<const node> TOML_CALLCONV at_path(const node& root, const toml::path& path);
 }
 TOML_NAMESPACE_END;
 
@@ -3621,6 +4117,7 @@ TOML_NAMESPACE_START
 	  private:
 
 		friend class TOML_PARSER_TYPENAME;
+		friend class impl::compactor;
 		source_region source_{};
 
 		template <typename T>
@@ -3734,14 +4231,27 @@ TOML_NAMESPACE_START
 		TOML_EXPORTED_MEMBER_FUNCTION
 		virtual ~node() noexcept;
 
-		TOML_PURE_GETTER
-		virtual bool is_homogeneous(node_type ntype, node*& first_nonmatch) noexcept = 0;
+		// nodes come from the thread's current impl::memory_resource (see impl::memory_resource_scope)
+		TOML_NODISCARD
+		static void* operator new(size_t size)
+		{
+			return impl::allocate(size);
+		}
 
-		TOML_PURE_GETTER
-		virtual bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept = 0;
+		static void operator delete(void* ptr, size_t size) noexcept
+		{
+			impl::deallocate(ptr, size);
+		}
 
-		TOML_PURE_GETTER
-		virtual bool is_homogeneous(node_type ntype) const noexcept = 0;
+		// (these two can allocate in an array, whose elements might have to be created as nodes to point at one)
+		TOML_NODISCARD
+		virtual bool is_homogeneous(node_type ntype, node*& first_nonmatch) = 0;
+
+		TOML_NODISCARD
+		virtual bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const = 0;
+
+		TOML_PURE_GETTER
+		virtual bool is_homogeneous(node_type ntype) const noexcept = 0;
 
 		template <typename ElemType = void>
 		TOML_PURE_GETTER
@@ -4162,19 +4672,19 @@ TOML_NAMESPACE_START
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<node> at_path(std::string_view path) noexcept;
+		node_view<node> at_path(std::string_view path);
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<const node> at_path(std::string_view path) const noexcept;
+		node_view<const node> at_path(std::string_view path) const;
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<node> at_path(const toml::path& path) noexcept;
+		node_view<node> at_path(const toml::path& path);
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<const node> at_path(const toml::path& path) const noexcept;
+		node_view<const node> at_path(const toml::path& path) const;
 
 #if TOML_ENABLE_WINDOWS_COMPAT
 
@@ -4190,11 +4700,11 @@ TOML_NAMESPACE_START
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<node> operator[](const toml::path& path) noexcept;
+		node_view<node> operator[](const toml::path& path);
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node_view<const node> operator[](const toml::path& path) const noexcept;
+		node_view<const node> operator[](const toml::path& path) const;
 	};
 }
 TOML_NAMESPACE_END;
@@ -4203,7 +4713,7 @@ TOML_IMPL_NAMESPACE_START
 {
 	TOML_PURE_GETTER
 	TOML_EXPORTED_FREE_FUNCTION
-	bool TOML_CALLCONV node_deep_equality(const node*, const node*) noexcept;
+	bool TOML_CALLCONV node_deep_equality(const node*, const node*);
 }
 TOML_IMPL_NAMESPACE_END;
 
@@ -4378,7 +4888,7 @@ TOML_NAMESPACE_START
 		}
 
 		TOML_NODISCARD
-		bool is_homogeneous(node_type ntype, viewed_type*& first_nonmatch) const noexcept
+		bool is_homogeneous(node_type ntype, viewed_type*& first_nonmatch) const
 		{
 			if (!node_)
 			{
@@ -4549,20 +5059,20 @@ TOML_NAMESPACE_START
 
 		template <typename T>
 		TOML_PURE_GETTER
-		friend bool operator==(const node_view& lhs, const node_view<T>& rhs) noexcept
+		friend bool operator==(const node_view& lhs, const node_view<T>& rhs)
 		{
 			return impl::node_deep_equality(lhs.node_, rhs.node_);
 		}
 
 		template <typename T>
 		TOML_PURE_GETTER
-		friend bool operator!=(const node_view& lhs, const node_view<T>& rhs) noexcept
+		friend bool operator!=(const node_view& lhs, const node_view<T>& rhs)
 		{
 			return !impl::node_deep_equality(lhs.node_, rhs.node_);
 		}
 
 		TOML_NODISCARD
-		friend bool operator==(const node_view& lhs, const table& rhs) noexcept
+		friend bool operator==(const node_view& lhs, const table& rhs)
 		{
 			if (lhs.node_ == &rhs)
 				return true;
@@ -4572,7 +5082,7 @@ TOML_NAMESPACE_START
 		TOML_ASYMMETRICAL_EQUALITY_OPS(const node_view&, const table&, );
 
 		TOML_NODISCARD
-		friend bool operator==(const node_view& lhs, const array& rhs) noexcept
+		friend bool operator==(const node_view& lhs, const array& rhs)
 		{
 			if (lhs.node_ == &rhs)
 				return true;
@@ -4647,19 +5157,19 @@ TOML_NAMESPACE_START
 		}
 
 		TOML_NODISCARD
-		node_view operator[](const toml::path& path) const noexcept
+		node_view operator[](const toml::path& path) const
 		{
 			return node_ ? node_->at_path(path) : node_view{};
 		}
 
 		TOML_NODISCARD
-		node_view at_path(std::string_view path) const noexcept
+		node_view at_path(std::string_view path) const
 		{
 			return node_ ? node_->at_path(path) : node_view{};
 		}
 
 		TOML_NODISCARD
-		node_view at_path(const toml::path& path) const noexcept
+		node_view at_path(const toml::path& path) const
 		{
 			return node_ ? node_->at_path(path) : node_view{};
 		}
@@ -4683,7 +5193,7 @@ TOML_NAMESPACE_START
 #endif // TOML_ENABLE_WINDOWS_COMPAT
 
 		TOML_NODISCARD
-		node_view operator[](size_t index) const noexcept
+		node_view operator[](size_t index) const
 		{
 			if (auto arr = this->as_array())
 				return node_view{ arr->get(index) };
@@ -4940,6 +5450,68 @@ TOML_IMPL_NAMESPACE_START
 	template <typename T, typename... Args>
 	struct value_variadic_ctor_allowed<value<T>, value<T>, Args...> : std::false_type
 	{};
+
+	// how the characters of a raw string have to be decoded (see decode_string())
+	inline constexpr uint8_t decode_escapes		= 1u; // a basic string
+	inline constexpr uint8_t decode_line_breaks = 2u; // a multi-line string
+
+	// decode the text of values that were only checked when they were parsed (see parse_flags::lazy_values)
+	TOML_NODISCARD
+	std::string decode_string(std::string_view raw, uint8_t decoding);
+
+	TOML_NODISCARD
+	double decode_float(std::string_view raw);
+
+	// the characters of a string value that are still part of the document it was parsed from (see
+	// parse_flags::string_views). the std::string that get() returns a reference to is only made if something asks.
+	struct borrowed_string
+	{
+		const char* data;
+		size_t length;
+		mutable std::atomic<std::string*> copy;
+
+		TOML_NODISCARD
+		const std::string& str(uint8_t decoding) const
+		{
+			if (const auto existing = copy.load(std::memory_order_acquire))
+				return *existing;
+
+			// const access is safe from several threads at once, so a thread that loses the race drops its copy
+			const auto made = ::new (impl::allocate(sizeof(std::string)))
+				std::string(decoding ? decode_string({ data, length }, decoding) : std::string(data, length));
+			std::string* winner = nullptr;
+			if (copy.compare_exchange_strong(winner, made, std::memory_order_acq_rel, std::memory_order_acquire))
+				return *made;
+
+			destroy_copy(made);
+			return *winner;
+		}
+
+		static void destroy_copy(std::string* str) noexcept
+		{
+			str->~basic_string();
+			impl::deallocate(str, sizeof(std::string));
+		}
+	};
+
+	struct raw_value_tag
+	{};
+
+	enum class raw_state : uint8_t
+	{
+		none,		// the value's been converted (or was never raw)
+		raw,		// the value is still the text it was parsed from
+		converting, // (floats only) another thread is converting it
+	};
+
+	struct no_raw_value
+	{};
+
+	// strings refer to their characters, floats to their literal (whose length is kept in value::raw_info_)
+	template <typename T>
+	using raw_value = std::conditional_t<std::is_same_v<T, std::string>,
+										 borrowed_string,
+										 std::conditional_t<std::is_same_v<T, double>, const char*, no_raw_value>>;
 }
 TOML_IMPL_NAMESPACE_END;
 
@@ -4954,6 +5526,8 @@ TOML_NAMESPACE_START
 	  private:
 
 		friend class TOML_PARSER_TYPENAME;
+		friend class impl::packed_array;
+		friend class impl::snapshot;
 
 		template <typename T, typename U>
 		TOML_CONST_INLINE_GETTER
@@ -4965,8 +5539,180 @@ TOML_NAMESPACE_START
 				return nullptr;
 		}
 
-		ValueType val_;
+		union
+		{
+			ValueType val_;
+			impl::raw_value<ValueType> raw_; // while raw_state_ isn't none
+		};
 		value_flags flags_ = value_flags::none;
+		mutable std::atomic<impl::raw_state> raw_state_ = {};
+		uint8_t raw_info_								= {}; // strings: how to decode them, floats: the literal's length
+
+		static constexpr bool holds_string = std::is_same_v<ValueType, std::string>;
+		static constexpr bool holds_double = std::is_same_v<ValueType, double>;
+
+		// strings that refer to their characters in the document (see parse_flags::string_views), and strings and
+		// floats that are only decoded when something first asks for them (see parse_flags::lazy_values)
+		TOML_NODISCARD_CTOR
+		value(impl::raw_value_tag, std::string_view text, uint8_t decoding = 0) noexcept //
+			: raw_state_{ impl::raw_state::raw }
+		{
+			if constexpr (holds_string)
+			{
+				::new (static_cast<void*>(&raw_)) impl::borrowed_string{ text.data(), text.length(), nullptr };
+				raw_info_ = decoding;
+			}
+			else
+			{
+				static_assert(holds_double);
+				TOML_ASSERT(text.length() <= 0xFFu);
+				raw_	  = text.data();
+				raw_info_ = static_cast<uint8_t>(text.length());
+			}
+#if TOML_LIFETIME_HOOKS
+			TOML_VALUE_CREATED;
+#endif
+		}
+
+		TOML_PURE_INLINE_GETTER
+		bool is_raw() const noexcept
+		{
+			if constexpr (holds_string || holds_double)
+				return raw_state_.load(std::memory_order_acquire) != impl::raw_state::none;
+			else
+				return false;
+		}
+
+		// floats are converted in place: const access is safe from several threads at once, so one of them converts it
+		// while the others wait
+		TOML_NEVER_INLINE
+		void convert() const noexcept
+		{
+			static_assert(holds_double);
+			for (;;)
+			{
+				auto expected = impl::raw_state::raw;
+				if (raw_state_.compare_exchange_weak(expected,
+													 impl::raw_state::converting,
+													 std::memory_order_acquire,
+													 std::memory_order_acquire))
+				{
+					const_cast<value*>(this)->val_ = impl::decode_float({ raw_, raw_info_ });
+					raw_state_.store(impl::raw_state::none, std::memory_order_release);
+					return;
+				}
+				if (expected == impl::raw_state::none)
+					return;
+			}
+		}
+
+		// const access to a raw string goes through a copy made on demand
+		TOML_PURE_INLINE_GETTER
+		const ValueType& val() const noexcept
+		{
+			if constexpr (holds_string)
+			{
+				if TOML_UNLIKELY(is_raw())
+					return raw_.str(raw_info_);
+			}
+			else if constexpr (holds_double)
+			{
+				if TOML_UNLIKELY(is_raw())
+					convert();
+			}
+			return val_;
+		}
+
+		// non-const access decodes a raw value for good (or drops it, when it's about to be overwritten anyway)
+		TOML_INLINE_GETTER
+		ValueType& val(bool keep = true) noexcept
+		{
+			if constexpr (holds_string)
+			{
+				if TOML_UNLIKELY(is_raw())
+				{
+					const auto text = std::string_view{ raw_.data, raw_.length };
+					const auto copy = raw_.copy.load(std::memory_order_relaxed);
+					if (!keep)
+						::new (static_cast<void*>(&val_)) std::string{};
+					else if (copy)
+						::new (static_cast<void*>(&val_)) std::string(std::move(*copy));
+					else if (raw_info_)
+						::new (static_cast<void*>(&val_)) std::string(impl::decode_string(text, raw_info_));
+					else
+						::new (static_cast<void*>(&val_)) std::string(text);
+					if (copy)
+						impl::borrowed_string::destroy_copy(copy);
+					raw_state_.store(impl::raw_state::none, std::memory_order_relaxed);
+				}
+			}
+			else if constexpr (holds_double)
+			{
+				if TOML_UNLIKELY(is_raw())
+				{
+					if (keep)
+						convert();
+					else
+						raw_state_.store(impl::raw_state::none, std::memory_order_relaxed);
+				}
+			}
+			return val_;
+		}
+
+		void destroy() noexcept
+		{
+			if constexpr (holds_string)
+			{
+				if (is_raw())
+				{
+					if (const auto copy = raw_.copy.load(std::memory_order_relaxed))
+						impl::borrowed_string::destroy_copy(copy);
+					return;
+				}
+			}
+			val_.~ValueType();
+		}
+
+		// copies own their (decoded) values, moves keep them raw
+		TOML_NODISCARD
+		ValueType copy_val() const
+		{
+			if constexpr (holds_string)
+				return std::string{ view() };
+			else
+				return val();
+		}
+
+		void take(value&& other) noexcept
+		{
+			if constexpr (holds_string || holds_double)
+			{
+				if (other.is_raw())
+				{
+					if constexpr (holds_string)
+						::new (static_cast<void*>(&raw_)) impl::borrowed_string{
+							other.raw_.data,
+							other.raw_.length,
+							other.raw_.copy.exchange(nullptr, std::memory_order_relaxed)
+						};
+					else
+						raw_ = other.raw_;
+					raw_info_ = other.raw_info_;
+					raw_state_.store(impl::raw_state::raw, std::memory_order_relaxed);
+					return;
+				}
+			}
+			::new (static_cast<void*>(&val_)) ValueType(std::move(other.val_));
+		}
+
+		TOML_PURE_INLINE_GETTER
+		decltype(auto) comparable() const noexcept
+		{
+			if constexpr (holds_string)
+				return view();
+			else
+				return val();
+		}
 
 	  public:
 
@@ -4994,7 +5740,7 @@ TOML_NAMESPACE_START
 		TOML_NODISCARD_CTOR
 		value(const value& other) noexcept //
 			: node(other),
-			  val_{ other.val_ },
+			  val_{ other.copy_val() },
 			  flags_{ other.flags_ }
 		{
 #if TOML_LIFETIME_HOOKS
@@ -5005,7 +5751,7 @@ TOML_NAMESPACE_START
 		TOML_NODISCARD_CTOR
 		value(const value& other, value_flags flags) noexcept //
 			: node(other),
-			  val_{ other.val_ },
+			  val_{ other.copy_val() },
 			  flags_{ flags == preserve_source_value_flags ? other.flags_ : flags }
 		{
 #if TOML_LIFETIME_HOOKS
@@ -5016,9 +5762,9 @@ TOML_NAMESPACE_START
 		TOML_NODISCARD_CTOR
 		value(value&& other) noexcept //
 			: node(std::move(other)),
-			  val_{ std::move(other.val_) },
 			  flags_{ std::exchange(other.flags_, value_flags{}) }
 		{
+			take(std::move(other));
 #if TOML_LIFETIME_HOOKS
 			TOML_VALUE_CREATED;
 #endif
@@ -5027,9 +5773,9 @@ TOML_NAMESPACE_START
 		TOML_NODISCARD_CTOR
 		value(value&& other, value_flags flags) noexcept //
 			: node(std::move(other)),
-			  val_{ std::move(other.val_) },
 			  flags_{ flags == preserve_source_value_flags ? other.flags_ : flags }
 		{
+			take(std::move(other));
 #if TOML_LIFETIME_HOOKS
 			TOML_VALUE_CREATED;
 #endif
@@ -5039,7 +5785,10 @@ TOML_NAMESPACE_START
 		value& operator=(const value& rhs) noexcept
 		{
 			node::operator=(rhs);
-			val_   = rhs.val_;
+			if constexpr (holds_string)
+				val().assign(rhs.view());
+			else
+				val(false) = rhs.val();
 			flags_ = rhs.flags_;
 			return *this;
 		}
@@ -5049,18 +5798,21 @@ TOML_NAMESPACE_START
 			if (&rhs != this)
 			{
 				node::operator=(std::move(rhs));
-				val_   = std::move(rhs.val_);
+				destroy();
+				raw_state_.store(impl::raw_state::none, std::memory_order_relaxed);
+				take(std::move(rhs));
 				flags_ = std::exchange(rhs.flags_, value_flags{});
 			}
 			return *this;
 		}
 
-#if TOML_LIFETIME_HOOKS
 		~value() noexcept
 		{
+#if TOML_LIFETIME_HOOKS
 			TOML_VALUE_DESTROYED;
-		}
 #endif
+			destroy();
+		}
 
 		TOML_CONST_INLINE_GETTER
 		node_type type() const noexcept final
@@ -5290,90 +6042,90 @@ TOML_NAMESPACE_START
 			return as_value<date_time>(this);
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		value_type& get() & noexcept
 		{
-			return val_;
+			return val();
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		value_type&& get() && noexcept
 		{
-			return static_cast<value_type&&>(val_);
+			return static_cast<value_type&&>(val());
 		}
 
 		TOML_PURE_INLINE_GETTER
 		const value_type& get() const& noexcept
 		{
-			return val_;
+			return val();
 		}
 
 		TOML_PURE_INLINE_GETTER
 		const value_type&& get() const&& noexcept
 		{
-			return static_cast<const value_type&&>(val_);
+			return static_cast<const value_type&&>(val());
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		value_type& operator*() & noexcept
 		{
-			return val_;
+			return val();
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		value_type&& operator*() && noexcept
 		{
-			return static_cast<value_type&&>(val_);
+			return static_cast<value_type&&>(val());
 		}
 
 		TOML_PURE_INLINE_GETTER
 		const value_type& operator*() const& noexcept
 		{
-			return val_;
+			return val();
 		}
 
 		TOML_PURE_INLINE_GETTER
 		const value_type&& operator*() const&& noexcept
 		{
-			return static_cast<const value_type&&>(val_);
+			return static_cast<const value_type&&>(val());
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		explicit operator value_type&() & noexcept
 		{
-			return val_;
+			return val();
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		explicit operator value_type&&() && noexcept
 		{
-			return static_cast<value_type&&>(val_);
+			return static_cast<value_type&&>(val());
 		}
 
 		TOML_PURE_INLINE_GETTER
 		explicit operator const value_type&() const& noexcept
 		{
-			return val_;
+			return val();
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		explicit operator const value_type&&() && noexcept
 		{
-			return static_cast<const value_type&&>(val_);
+			return static_cast<const value_type&&>(val());
 		}
 
 		TOML_HIDDEN_CONSTRAINT(std::is_class_v<T>, typename T = value_type)
-		TOML_PURE_INLINE_GETTER
+		TOML_INLINE_GETTER
 		value_type* operator->() noexcept
 		{
-			return &val_;
+			return &val();
 		}
 
 		TOML_HIDDEN_CONSTRAINT(std::is_class_v<T>, typename T = value_type)
 		TOML_PURE_INLINE_GETTER
 		const value_type* operator->() const noexcept
 		{
-			return &val_;
+			return &val();
 		}
 
 		TOML_NODISCARD
@@ -5388,19 +6140,32 @@ TOML_NAMESPACE_START
 			return *this;
 		}
 
+		// the characters of a string value, without making a std::string of a string that still refers to its
+		// document (see parse_flags::string_views)
+		TOML_CONSTRAINED_TEMPLATE((std::is_same_v<T, std::string>), typename T = value_type)
+		TOML_PURE_INLINE_GETTER
+		std::string_view view() const noexcept
+		{
+			if (!is_raw())
+				return val_;
+			if (raw_info_)
+				return raw_.str(raw_info_);
+			return { raw_.data, raw_.length };
+		}
+
 		value& operator=(value_arg rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, std::string>)
-				val_.assign(rhs);
+				val(false).assign(rhs);
 			else
-				val_ = rhs;
+				val(false) = rhs;
 			return *this;
 		}
 
 		TOML_CONSTRAINED_TEMPLATE((std::is_same_v<T, std::string>), typename T = value_type)
 		value& operator=(std::string&& rhs) noexcept
 		{
-			val_ = std::move(rhs);
+			val(false) = std::move(rhs);
 			return *this;
 		}
 
@@ -5409,63 +6174,63 @@ TOML_NAMESPACE_START
 		{
 			if constexpr (std::is_same_v<value_type, double>)
 			{
-				const auto lhs_nan = impl::fpclassify(lhs.val_) == impl::fp_class::nan;
+				const auto lhs_nan = impl::fpclassify(lhs.comparable()) == impl::fp_class::nan;
 				const auto rhs_nan = impl::fpclassify(rhs) == impl::fp_class::nan;
 				if (lhs_nan != rhs_nan)
 					return false;
 				if (lhs_nan)
 					return true;
 			}
-			return lhs.val_ == rhs;
+			return lhs.comparable() == rhs;
 		}
 		TOML_ASYMMETRICAL_EQUALITY_OPS(const value&, value_arg, );
 
 		TOML_PURE_GETTER
 		friend bool operator<(const value& lhs, value_arg rhs) noexcept
 		{
-			return lhs.val_ < rhs;
+			return lhs.comparable() < rhs;
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator<(value_arg lhs, const value& rhs) noexcept
 		{
-			return lhs < rhs.val_;
+			return lhs < rhs.comparable();
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator<=(const value& lhs, value_arg rhs) noexcept
 		{
-			return lhs.val_ <= rhs;
+			return lhs.comparable() <= rhs;
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator<=(value_arg lhs, const value& rhs) noexcept
 		{
-			return lhs <= rhs.val_;
+			return lhs <= rhs.comparable();
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator>(const value& lhs, value_arg rhs) noexcept
 		{
-			return lhs.val_ > rhs;
+			return lhs.comparable() > rhs;
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator>(value_arg lhs, const value& rhs) noexcept
 		{
-			return lhs > rhs.val_;
+			return lhs > rhs.comparable();
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator>=(const value& lhs, value_arg rhs) noexcept
 		{
-			return lhs.val_ >= rhs;
+			return lhs.comparable() >= rhs;
 		}
 
 		TOML_PURE_GETTER
 		friend bool operator>=(value_arg lhs, const value& rhs) noexcept
 		{
-			return lhs >= rhs.val_;
+			return lhs >= rhs.comparable();
 		}
 
 		template <typename T>
@@ -5473,7 +6238,7 @@ TOML_NAMESPACE_START
 		friend bool operator==(const value& lhs, const value<T>& rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, T>)
-				return lhs == rhs.val_; // calls asymmetrical value-equality operator defined above
+				return lhs == rhs.comparable(); // calls asymmetrical value-equality operator defined above
 			else
 				return false;
 		}
@@ -5490,7 +6255,7 @@ TOML_NAMESPACE_START
 		friend bool operator<(const value& lhs, const value<T>& rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, T>)
-				return lhs.val_ < rhs.val_;
+				return lhs.comparable() < rhs.comparable();
 			else
 				return impl::node_type_of<value_type> < impl::node_type_of<T>;
 		}
@@ -5500,7 +6265,7 @@ TOML_NAMESPACE_START
 		friend bool operator<=(const value& lhs, const value<T>& rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, T>)
-				return lhs.val_ <= rhs.val_;
+				return lhs.comparable() <= rhs.comparable();
 			else
 				return impl::node_type_of<value_type> <= impl::node_type_of<T>;
 		}
@@ -5510,7 +6275,7 @@ TOML_NAMESPACE_START
 		friend bool operator>(const value& lhs, const value<T>& rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, T>)
-				return lhs.val_ > rhs.val_;
+				return lhs.comparable() > rhs.comparable();
 			else
 				return impl::node_type_of<value_type> > impl::node_type_of<T>;
 		}
@@ -5520,7 +6285,7 @@ TOML_NAMESPACE_START
 		friend bool operator>=(const value& lhs, const value<T>& rhs) noexcept
 		{
 			if constexpr (std::is_same_v<value_type, T>)
-				return lhs.val_ >= rhs.val_;
+				return lhs.comparable() >= rhs.comparable();
 			else
 				return impl::node_type_of<value_type> >= impl::node_type_of<T>;
 		}
@@ -6012,7 +6777,7 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-//********  impl/array.hpp  ********************************************************************************************
+//********  impl/key.hpp  **********************************************************************************************
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -6025,1665 +6790,1459 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-#ifndef TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN
-#if TOML_GCC && TOML_GCC <= 7
-#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN 1
-#else
-#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN 0
-#endif
-#endif
-
-#if TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN && !defined(TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED)
-#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_MESSAGE                                                                  \
-	"If you're seeing this error it's because you're using one of toml++'s for_each() functions on a compiler with "   \
-	"known bugs in that area (e.g. GCC 7). On these compilers returning a bool (or bool-convertible) value from the "  \
-	"for_each() callable causes spurious compilation failures, while returning nothing (void) works fine. "            \
-	"If you believe this message is incorrect for your compiler, you can try your luck by #defining "                  \
-	"TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN as 0 and recompiling - if it works, great! Let me know at "                 \
-	"https://github.com/marzer/tomlplusplus/issues. Alternatively, if you don't have any need for early-exiting from " \
-	"for_each(), you can suppress this error by #defining TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED "         \
-	"and moving on with your life."
-#endif
-
 TOML_IMPL_NAMESPACE_START
 {
-	template <bool IsConst>
-	class TOML_TRIVIAL_ABI array_iterator
+	TOML_PURE_GETTER
+	inline size_t key_hash(std::string_view key) noexcept
 	{
-	  private:
-		template <bool>
-		friend class array_iterator;
-
-		using mutable_vector_iterator = std::vector<node_ptr>::iterator;
-		using const_vector_iterator	  = std::vector<node_ptr>::const_iterator;
-		using vector_iterator		  = std::conditional_t<IsConst, const_vector_iterator, mutable_vector_iterator>;
-
-		mutable vector_iterator iter_;
-
-	  public:
-		using value_type		= std::conditional_t<IsConst, const node, node>;
-		using reference			= value_type&;
-		using pointer			= value_type*;
-		using difference_type	= ptrdiff_t;
-		using iterator_category = typename std::iterator_traits<vector_iterator>::iterator_category;
-
-		TOML_NODISCARD_CTOR
-		array_iterator() noexcept = default;
-
-		TOML_NODISCARD_CTOR
-		explicit array_iterator(mutable_vector_iterator iter) noexcept //
-			: iter_{ iter }
-		{}
-
-		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
-		TOML_NODISCARD_CTOR
-		explicit array_iterator(const_vector_iterator iter) noexcept //
-			: iter_{ iter }
-		{}
+		const auto h = std::hash<std::string_view>{}(key);
+		return h ? h : size_t{ 1u }; // 0 is free to mean 'no key' in hash tables
+	}
 
-		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
-		TOML_NODISCARD_CTOR
-		array_iterator(const array_iterator<false>& other) noexcept //
-			: iter_{ other.iter_ }
-		{}
+	// the characters of a key, along with their hash. immutable and reference-counted, so copies of a key (and keys
+	// the parser interns, see key_interner) share one allocation.
+	class key_string
+	{
+	  private:
+		std::atomic<size_t> refs_;
+		size_t hash_;
+		size_t length_;
+		// followed by length_ + 1 chars
 
 		TOML_NODISCARD_CTOR
-		array_iterator(const array_iterator&) noexcept = default;
-
-		array_iterator& operator=(const array_iterator&) noexcept = default;
-
-		array_iterator& operator++() noexcept // ++pre
+		key_string(std::string_view str) noexcept //
+			: refs_{ 1u },
+			  hash_{ key_hash(str) },
+			  length_{ str.length() }
 		{
-			++iter_;
-			return *this;
+			const auto chars = reinterpret_cast<char*>(this + 1);
+			std::memcpy(chars, str.data(), length_);
+			chars[length_] = '\0';
 		}
 
-		array_iterator operator++(int) noexcept // post++
+	  public:
+		key_string(const key_string&)			 = delete;
+		key_string& operator=(const key_string&) = delete;
+
+		// returns a key_string with one reference.
+		TOML_NODISCARD
+		static key_string* make(std::string_view str)
 		{
-			array_iterator out{ iter_ };
-			++iter_;
-			return out;
+			return ::new (impl::allocate(sizeof(key_string) + str.length() + 1u)) key_string{ str };
 		}
 
-		array_iterator& operator--() noexcept // --pre
+		// returns this with another reference, or a copy if this was allocated from a different resource than
+		// whatever's current (it might be an arena that won't outlive the copy).
+		TOML_NODISCARD
+		key_string* share()
 		{
-			--iter_;
-			return *this;
+			if (allocation_resource(this) != &current_memory_resource())
+				return make(str());
+			refs_.fetch_add(1u, std::memory_order_relaxed);
+			return this;
 		}
 
-		array_iterator operator--(int) noexcept // post--
+		void release() noexcept
 		{
-			array_iterator out{ iter_ };
-			--iter_;
-			return out;
+			if (refs_.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+			{
+				const auto size = sizeof(key_string) + length_ + 1u;
+				this->~key_string();
+				impl::deallocate(this, size);
+			}
 		}
 
 		TOML_PURE_INLINE_GETTER
-		reference operator*() const noexcept
+		const char* data() const noexcept
 		{
-			return *iter_->get();
+			return reinterpret_cast<const char*>(this + 1);
 		}
 
 		TOML_PURE_INLINE_GETTER
-		pointer operator->() const noexcept
+		size_t length() const noexcept
 		{
-			return iter_->get();
+			return length_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		explicit operator const vector_iterator&() const noexcept
+		std::string_view str() const noexcept
 		{
-			return iter_;
+			return { data(), length_ };
 		}
 
-		TOML_CONSTRAINED_TEMPLATE(!C, bool C = IsConst)
 		TOML_PURE_INLINE_GETTER
-		explicit operator const const_vector_iterator() const noexcept
+		size_t hash() const noexcept
 		{
-			return iter_;
+			return hash_;
 		}
+	};
 
-		array_iterator& operator+=(ptrdiff_t rhs) noexcept
+	// hands out one key_string per distinct key for the lifetime of a parse, so keys that are repeated throughout a
+	// document (e.g. in every table of an array) only store their characters once.
+	class key_interner
+	{
+	  private:
+		std::vector<key_string*> slots_; // open addressing, nullptr marks an empty slot
+		size_t count_ = {};
+
+		void grow()
 		{
-			iter_ += rhs;
-			return *this;
+			std::vector<key_string*> old(slots_.empty() ? size_t{ 64u } : slots_.size() * 2u);
+			old.swap(slots_);
+			const size_t mask = slots_.size() - 1u;
+			for (const auto str : old)
+			{
+				if (!str)
+					continue;
+				size_t i = str->hash() & mask;
+				while (slots_[i])
+					i = (i + 1u) & mask;
+				slots_[i] = str;
+			}
 		}
 
-		array_iterator& operator-=(ptrdiff_t rhs) noexcept
+	  public:
+		TOML_NODISCARD_CTOR
+		key_interner() noexcept = default;
+
+		key_interner(const key_interner&)			 = delete;
+		key_interner& operator=(const key_interner&) = delete;
+
+		~key_interner() noexcept
 		{
-			iter_ -= rhs;
-			return *this;
+			for (const auto str : slots_)
+				if (str)
+					str->release();
 		}
 
+		// returns the key_string for str with a reference for the caller.
 		TOML_NODISCARD
-		friend array_iterator operator+(const array_iterator& lhs, ptrdiff_t rhs) noexcept
+		key_string* intern(std::string_view str)
 		{
-			return array_iterator{ lhs.iter_ + rhs };
-		}
-
-		TOML_NODISCARD
-		friend array_iterator operator+(ptrdiff_t lhs, const array_iterator& rhs) noexcept
-		{
-			return array_iterator{ rhs.iter_ + lhs };
-		}
-
-		TOML_NODISCARD
-		friend array_iterator operator-(const array_iterator& lhs, ptrdiff_t rhs) noexcept
-		{
-			return array_iterator{ lhs.iter_ - rhs };
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend ptrdiff_t operator-(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ - rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator==(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ == rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator!=(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ != rhs.iter_;
-		}
+			if ((count_ + 1u) * 2u > slots_.size())
+				grow();
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ < rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<=(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ <= rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ > rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>=(const array_iterator& lhs, const array_iterator& rhs) noexcept
-		{
-			return lhs.iter_ >= rhs.iter_;
-		}
+			const size_t h	  = key_hash(str);
+			const size_t mask = slots_.size() - 1u;
+			size_t i		  = h & mask;
+			for (; slots_[i]; i = (i + 1u) & mask)
+				if (slots_[i]->hash() == h && slots_[i]->str() == str)
+					return slots_[i]->share();
 
-		TOML_PURE_INLINE_GETTER
-		reference operator[](ptrdiff_t idx) const noexcept
-		{
-			return *(iter_ + idx)->get();
+			slots_[i] = key_string::make(str);
+			count_++;
+			return slots_[i]->share();
 		}
 	};
-
-	struct array_init_elem
-	{
-		mutable node_ptr value;
-
-		template <typename T>
-		TOML_NODISCARD_CTOR
-		array_init_elem(T&& val, value_flags flags = preserve_source_value_flags) //
-			: value{ make_node(static_cast<T&&>(val), flags) }
-		{}
-	};
 }
 TOML_IMPL_NAMESPACE_END;
 
 TOML_NAMESPACE_START
 {
-	using array_iterator = POXY_IMPLEMENTATION_DETAIL(impl::array_iterator<false>);
-
-	using const_array_iterator = POXY_IMPLEMENTATION_DETAIL(impl::array_iterator<true>);
-
-	class TOML_EXPORTED_CLASS array : public node
+	class key
 	{
 	  private:
+		impl::key_string* str_ = {}; // nullptr when empty
+		source_region source_;
 
-		using vector_type			= std::vector<impl::node_ptr>;
-		using vector_iterator		= typename vector_type::iterator;
-		using const_vector_iterator = typename vector_type::const_iterator;
-		vector_type elems_;
-
-		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array(const impl::array_init_elem*, const impl::array_init_elem*);
+		friend class TOML_PARSER_TYPENAME;
+		friend class impl::compactor;
+		friend class impl::snapshot;
 
+		// adopts a reference to str.
 		TOML_NODISCARD_CTOR
-		array(std::false_type, std::initializer_list<impl::array_init_elem> elems) //
-			: array{ elems.begin(), elems.end() }
+		key(impl::key_string* str, source_region&& src) noexcept //
+			: str_{ str },
+			  source_{ std::move(src) }
 		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void preinsertion_resize(size_t idx, size_t count);
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void insert_at_back(impl::node_ptr&&);
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		vector_iterator insert_at(const_vector_iterator, impl::node_ptr&&);
-
-		template <typename T>
-		void emplace_back_if_not_empty_view(T&& val, value_flags flags)
+		TOML_NODISCARD
+		static impl::key_string* make_string(std::string_view k)
 		{
-			if constexpr (is_node_view<T>)
-			{
-				if (!val)
-					return;
-			}
-			insert_at_back(impl::make_node(static_cast<T&&>(val), flags));
+			return k.empty() ? nullptr : impl::key_string::make(k);
 		}
 
-		TOML_NODISCARD
-		TOML_EXPORTED_MEMBER_FUNCTION
-		size_t total_leaf_count() const noexcept;
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void flatten_child(array&& child, size_t& dest_index) noexcept;
-
 	  public:
-		using value_type	  = node;
-		using size_type		  = size_t;
-		using difference_type = ptrdiff_t;
-		using reference		  = node&;
-		using const_reference = const node&;
 
 		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array() noexcept;
+		key() noexcept = default;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		~array() noexcept;
+		TOML_NODISCARD_CTOR
+		explicit key(std::string_view k, source_region&& src = {}) //
+			: str_{ make_string(k) },
+			  source_{ std::move(src) }
+		{}
 
 		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array(const array&);
+		explicit key(std::string_view k, const source_region& src) //
+			: str_{ make_string(k) },
+			  source_{ src }
+		{}
 
 		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array(array&& other) noexcept;
+		explicit key(std::string&& k, source_region&& src = {}) //
+			: str_{ make_string(k) },
+			  source_{ std::move(src) }
+		{}
 
-		TOML_CONSTRAINED_TEMPLATE((sizeof...(ElemTypes) > 0 || !std::is_same_v<impl::remove_cvref<ElemType>, array>),
-								  typename ElemType,
-								  typename... ElemTypes)
 		TOML_NODISCARD_CTOR
-		explicit array(ElemType&& val, ElemTypes&&... vals)
-			: array{ std::false_type{},
-					 std::initializer_list<impl::array_init_elem>{ static_cast<ElemType&&>(val),
-																   static_cast<ElemTypes&&>(vals)... } }
+		explicit key(std::string&& k, const source_region& src) //
+			: str_{ make_string(k) },
+			  source_{ src }
 		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array& operator=(const array&);
+		TOML_NODISCARD_CTOR
+		explicit key(const char* k, source_region&& src = {}) //
+			: str_{ make_string(k) },
+			  source_{ std::move(src) }
+		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array& operator=(array&& rhs) noexcept;
+		TOML_NODISCARD_CTOR
+		explicit key(const char* k, const source_region& src) //
+			: str_{ make_string(k) },
+			  source_{ src }
+		{}
 
-		TOML_CONST_INLINE_GETTER
-		node_type type() const noexcept final
-		{
-			return node_type::array;
-		}
+#if TOML_ENABLE_WINDOWS_COMPAT
 
-		TOML_PURE_GETTER
-		TOML_EXPORTED_MEMBER_FUNCTION
-		bool is_homogeneous(node_type ntype) const noexcept final;
+		TOML_NODISCARD_CTOR
+		explicit key(std::wstring_view k, source_region&& src = {}) //
+			: str_{ make_string(impl::narrow(k)) },
+			  source_{ std::move(src) }
+		{}
 
-		TOML_PURE_GETTER
-		TOML_EXPORTED_MEMBER_FUNCTION
-		bool is_homogeneous(node_type ntype, node*& first_nonmatch) noexcept final;
+		TOML_NODISCARD_CTOR
+		explicit key(std::wstring_view k, const source_region& src) //
+			: str_{ make_string(impl::narrow(k)) },
+			  source_{ src }
+		{}
 
-		TOML_PURE_GETTER
-		TOML_EXPORTED_MEMBER_FUNCTION
-		bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept final;
+#endif
 
-		template <typename ElemType = void>
-		TOML_PURE_GETTER
-		bool is_homogeneous() const noexcept
-		{
-			using type = impl::remove_cvref<impl::unwrap_node<ElemType>>;
-			static_assert(std::is_void_v<type> || toml::is_value<type> || toml::is_container<type>,
-						  "The template type argument of array::is_homogeneous() must be void or one "
-						  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+		TOML_NODISCARD_CTOR
+		key(const key& other) //
+			: str_{ other.str_ ? other.str_->share() : nullptr },
+			  source_{ other.source_ }
+		{}
 
-			return is_homogeneous(impl::node_type_of<type>);
-		}
-		TOML_CONST_INLINE_GETTER
-		bool is_table() const noexcept final
+		TOML_NODISCARD_CTOR
+		key(key&& other) noexcept //
+			: str_{ std::exchange(other.str_, nullptr) },
+			  source_{ std::move(other.source_) }
+		{}
+
+		key& operator=(const key& rhs)
 		{
-			return false;
+			if (&rhs != this)
+				*this = key{ rhs };
+			return *this;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_array() const noexcept final
+		key& operator=(key&& rhs) noexcept
 		{
-			return true;
+			if (&rhs != this)
+			{
+				if (str_)
+					str_->release();
+				str_	= std::exchange(rhs.str_, nullptr);
+				source_ = std::move(rhs.source_);
+			}
+			return *this;
 		}
 
-		TOML_PURE_GETTER
-		bool is_array_of_tables() const noexcept final
+		~key() noexcept
 		{
-			return is_homogeneous(node_type::table);
+			if (str_)
+				str_->release();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_value() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		std::string_view str() const noexcept
 		{
-			return false;
+			return str_ ? str_->str() : std::string_view{};
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_string() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		/*implicit*/ operator std::string_view() const noexcept
 		{
-			return false;
+			return str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_integer() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		bool empty() const noexcept
 		{
-			return false;
+			return !str_;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_floating_point() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		const char* data() const noexcept
 		{
-			return false;
+			return str_ ? str_->data() : "";
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_number() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		size_t length() const noexcept
 		{
-			return false;
+			return str_ ? str_->length() : 0u;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_boolean() const noexcept final
+		// the same as std::hash<std::string_view> (except that it's never zero), computed once up front.
+		TOML_PURE_INLINE_GETTER
+		size_t hash() const noexcept
 		{
-			return false;
+			return str_ ? str_->hash() : impl::key_hash({});
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_date() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		const source_region& source() const noexcept
 		{
-			return false;
+			return source_;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_time() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator==(const key& lhs, const key& rhs) noexcept
 		{
-			return false;
+			return lhs.str_ == rhs.str_ || lhs.str() == rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		bool is_date_time() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator!=(const key& lhs, const key& rhs) noexcept
 		{
-			return false;
+			return !(lhs == rhs);
 		}
 
-		TOML_CONST_INLINE_GETTER
-		table* as_table() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<(const key& lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() < rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		array* as_array() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<=(const key& lhs, const key& rhs) noexcept
 		{
-			return this;
+			return lhs.str() <= rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<std::string>* as_string() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>(const key& lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() > rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<int64_t>* as_integer() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>=(const key& lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() >= rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<double>* as_floating_point() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator==(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() == rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<bool>* as_boolean() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator!=(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() != rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<date>* as_date() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() < rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<time>* as_time() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<=(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() <= rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		toml::value<date_time>* as_date_time() noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() > rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const table* as_table() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>=(const key& lhs, std::string_view rhs) noexcept
 		{
-			return nullptr;
+			return lhs.str() >= rhs;
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const array* as_array() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator==(std::string_view lhs, const key& rhs) noexcept
 		{
-			return this;
+			return lhs == rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<std::string>* as_string() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator!=(std::string_view lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs != rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<int64_t>* as_integer() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<(std::string_view lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs < rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<double>* as_floating_point() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator<=(std::string_view lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs <= rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<bool>* as_boolean() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>(std::string_view lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs > rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<date>* as_date() const noexcept final
+		TOML_PURE_INLINE_GETTER
+		friend bool operator>=(std::string_view lhs, const key& rhs) noexcept
 		{
-			return nullptr;
+			return lhs >= rhs.str();
 		}
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<time>* as_time() const noexcept final
-		{
-			return nullptr;
-		}
+		using const_iterator = const char*;
 
-		TOML_CONST_INLINE_GETTER
-		const toml::value<date_time>* as_date_time() const noexcept final
+		using iterator = const_iterator;
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator begin() const noexcept
 		{
-			return nullptr;
+			return data();
 		}
 
 		TOML_PURE_INLINE_GETTER
-		node* get(size_t index) noexcept
+		const_iterator end() const noexcept
 		{
-			return index < elems_.size() ? elems_[index].get() : nullptr;
+			return data() + length();
 		}
 
-		TOML_PURE_INLINE_GETTER
-		const node* get(size_t index) const noexcept
+		friend std::ostream& operator<<(std::ostream& lhs, const key& rhs)
 		{
-			return const_cast<array&>(*this).get(index);
+			impl::print_to_stream(lhs, rhs.str());
+			return lhs;
 		}
+	};
+
+	template <typename T>
+	inline constexpr bool is_key = std::is_same_v<impl::remove_cvref<T>, toml::key>;
+
+	template <typename T>
+	inline constexpr bool is_key_or_convertible = is_key<T> //
+											   || impl::is_constructible_or_convertible<toml::key, T>;
+}
+TOML_NAMESPACE_END;
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
+//********  impl/array.hpp  ********************************************************************************************
+
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+#ifndef TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN
+#if TOML_GCC && TOML_GCC <= 7
+#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN 1
+#else
+#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN 0
+#endif
+#endif
+
+#if TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN && !defined(TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED)
+#define TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_MESSAGE                                                                  \
+	"If you're seeing this error it's because you're using one of toml++'s for_each() functions on a compiler with "   \
+	"known bugs in that area (e.g. GCC 7). On these compilers returning a bool (or bool-convertible) value from the "  \
+	"for_each() callable causes spurious compilation failures, while returning nothing (void) works fine. "            \
+	"If you believe this message is incorrect for your compiler, you can try your luck by #defining "                  \
+	"TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN as 0 and recompiling - if it works, great! Let me know at "                 \
+	"https://github.com/marzer/tomlplusplus/issues. Alternatively, if you don't have any need for early-exiting from " \
+	"for_each(), you can suppress this error by #defining TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED "         \
+	"and moving on with your life."
+#endif
+
+TOML_IMPL_NAMESPACE_START
+{
+	using node_vector = std::vector<node_ptr, allocator<node_ptr>>;
+
+	// the contents of a frozen table or array (see table::freeze()), shared by the container and all of its copies.
+	// a container only gets contents of its own again when it's modified, and copying them just shares the frozen
+	// tables and arrays in them in turn, so a change copies only the containers on the way to it.
+	template <typename T>
+	struct frozen
+	{
+		std::atomic<size_t> refs{ 1u };
+		std::atomic<uint64_t> hash{}; // computed by impl::hasher the first time it's asked for (zero until then)
+		T contents;
 
-		template <typename ElemType>
 		TOML_NODISCARD
-		impl::wrap_node<ElemType>* get_as(size_t index) noexcept
+		static void* operator new(size_t size)
 		{
-			if (auto val = get(index))
-				return val->template as<ElemType>();
-			return nullptr;
+			return impl::allocate(size);
 		}
 
-		template <typename ElemType>
-		TOML_NODISCARD
-		const impl::wrap_node<ElemType>* get_as(size_t index) const noexcept
+		static void operator delete(void* ptr, size_t size) noexcept
 		{
-			return const_cast<array&>(*this).template get_as<ElemType>(index);
+			impl::deallocate(ptr, size);
 		}
 
-		using node::operator[]; // inherit operator[toml::path]
 		TOML_NODISCARD
-		node& operator[](size_t index) noexcept
+		frozen* share() noexcept
 		{
-			return *elems_[index];
+			refs.fetch_add(1u, std::memory_order_relaxed);
+			return this;
 		}
 
-		TOML_NODISCARD
-		const node& operator[](size_t index) const noexcept
+		// whether anything else refers to these contents.
+		TOML_PURE_INLINE_GETTER
+		bool shared() const noexcept
 		{
-			return *elems_[index];
+			return refs.load(std::memory_order_acquire) > 1u;
 		}
 
-		TOML_NODISCARD
-		TOML_EXPORTED_MEMBER_FUNCTION
-		node& at(size_t index);
+		void release() noexcept
+		{
+			if (refs.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+				delete this;
+		}
+	};
 
-		TOML_NODISCARD
-		const node& at(size_t index) const
+	// homogeneous arrays of integers, floats, booleans, dates, times or date-times are stored as a contiguous buffer
+	// of their values instead of one heap-allocated node per element, and arrays of tables that all have the same keys
+	// are stored as one such buffer per key, with each key stored once. nodes are only created when something asks
+	// for an element as a node: const access creates just the elements it's asked for and publishes them atomically
+	// (so concurrent readers are still fine), and mutable access turns the array back into an ordinary one.
+	// elements of a packed array don't keep their individual source regions.
+	class packed_array
+	{
+	  private:
+		// one of the keys shared by a packed array of tables, and that key's value in each table
+		struct column
+		{
+			toml::key key;
+			std::unique_ptr<packed_array> values;
+		};
+
+		node_type type_;
+		bool inline_tables_	  = false; // tables only
+		bool borrowed_strings_ = false; // strings only: the values are std::string_views of the document
+		value_flags flags_;
+		size_t size_;
+		size_t capacity_; // for tables, the number of columns
+		void* values_;	  // for tables, the columns
+
+		// the elements handed out by node_at(), owned by their slots until nodes() publishes them all as a vector.
+		// the slots are allocated a page at a time, as elements in it are asked for.
+		using slot_page = std::atomic<node*>*;
+		static constexpr size_t slots_per_page = 64;
+		mutable std::atomic<std::atomic<slot_page>*> pages_ = {};
+		mutable std::atomic<node_vector*> nodes_			= {};
+
+		template <typename Func>
+		decltype(auto) visit_values(Func&& func) const
 		{
-			return const_cast<array&>(*this).at(index);
+			switch (type_)
+			{
+				case node_type::string:
+					if (borrowed_strings_)
+						return static_cast<Func&&>(func)(static_cast<std::string_view*>(values_));
+					return static_cast<Func&&>(func)(static_cast<std::string*>(values_));
+				case node_type::integer: return static_cast<Func&&>(func)(static_cast<int64_t*>(values_));
+				case node_type::floating_point: return static_cast<Func&&>(func)(static_cast<double*>(values_));
+				case node_type::boolean: return static_cast<Func&&>(func)(static_cast<bool*>(values_));
+				case node_type::date: return static_cast<Func&&>(func)(static_cast<date*>(values_));
+				case node_type::time: return static_cast<Func&&>(func)(static_cast<time*>(values_));
+				case node_type::date_time: return static_cast<Func&&>(func)(static_cast<date_time*>(values_));
+				default: TOML_UNREACHABLE;
+			}
 		}
 
-		TOML_NODISCARD
-		node& front() noexcept
+		template <typename T>
+		TOML_NODISCARD_CTOR
+		packed_array(T*, value_flags flags, size_t size) //
+			: type_{ node_type_of<T> },
+			  borrowed_strings_{ std::is_same_v<T, std::string_view> },
+			  flags_{ flags },
+			  size_{},
+			  capacity_{ size },
+			  values_{ impl::allocate(size * sizeof(T)) }
+		{}
+
+		TOML_NODISCARD_CTOR
+		packed_array(bool inline_tables, size_t rows, size_t columns) //
+			: type_{ node_type::table },
+			  inline_tables_{ inline_tables },
+			  flags_{},
+			  size_{ rows },
+			  capacity_{ columns },
+			  values_{ impl::allocate(columns * sizeof(column)) }
+		{
+			std::uninitialized_value_construct_n(static_cast<column*>(values_), columns);
+		}
+
+		TOML_PURE_INLINE_GETTER
+		column* columns() const noexcept
 		{
-			return *elems_.front();
+			return static_cast<column*>(values_);
 		}
 
 		TOML_NODISCARD
-		const node& front() const noexcept
+		static node_vector* new_node_vector(node_vector&& nodes)
+		{
+			return ::new (impl::allocate(sizeof(node_vector))) node_vector{ std::move(nodes) };
+		}
+
+		static void delete_node_vector(node_vector* nodes) noexcept
+		{
+			nodes->~node_vector();
+			impl::deallocate(nodes, sizeof(node_vector));
+		}
+
+		TOML_PURE_INLINE_GETTER
+		size_t page_count() const noexcept
 		{
-			return *elems_.front();
+			return (size_ + slots_per_page - 1u) / slots_per_page;
 		}
 
+		// allocates count atomics set to nullptr and installs them in dest, unless another thread gets there first.
+		template <typename T>
 		TOML_NODISCARD
-		node& back() noexcept
+		static T* install_zeroed(std::atomic<T*>& dest, size_t count)
 		{
-			return *elems_.back();
+			if (auto existing = dest.load(std::memory_order_acquire))
+				return existing;
+
+			auto fresh = static_cast<T*>(impl::allocate(count * sizeof(T)));
+			for (size_t i = 0; i < count; i++)
+				::new (static_cast<void*>(fresh + i)) T{ nullptr };
+
+			T* expected = nullptr;
+			if (!dest.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				impl::deallocate(fresh, count * sizeof(T));
+				return expected;
+			}
+			return fresh;
 		}
 
+		// the slot for the element at index, allocating its page if need be.
 		TOML_NODISCARD
-		const node& back() const noexcept
+		std::atomic<node*>& slot(size_t index) const
 		{
-			return *elems_.back();
+			const auto pages = install_zeroed(pages_, page_count());
+			return install_zeroed(pages[index / slots_per_page], slots_per_page)[index % slots_per_page];
 		}
 
-		using iterator = array_iterator;
+		// the slot for the element at index, or nullptr if its page hasn't been allocated.
+		TOML_PURE_GETTER
+		std::atomic<node*>* find_slot(size_t index) const noexcept
+		{
+			if (const auto pages = pages_.load(std::memory_order_acquire))
+				if (const auto page = pages[index / slots_per_page].load(std::memory_order_acquire))
+					return page + index % slots_per_page;
+			return nullptr;
+		}
 
-		using const_iterator = const_array_iterator;
+		// the node handed out for the element at index, or nullptr if there isn't one yet.
+		TOML_PURE_GETTER
+		node* handed_out(size_t index) const noexcept
+		{
+			const auto dest = find_slot(index);
+			return dest ? dest->load(std::memory_order_acquire) : nullptr;
+		}
+
+		// frees the slots, and the nodes still in them if they own them.
+		void release_slots(bool owning) noexcept
+		{
+			const auto pages = pages_.exchange(nullptr, std::memory_order_acq_rel);
+			if (!pages)
+				return;
+
+			for (size_t p = 0, e = page_count(); p < e; p++)
+			{
+				const auto page = pages[p].load(std::memory_order_relaxed);
+				if (!page)
+					continue;
+				if (owning)
+					for (size_t i = 0; i < slots_per_page; i++)
+						delete page[i].load(std::memory_order_relaxed);
+				impl::deallocate(page, slots_per_page * sizeof(std::atomic<node*>));
+			}
+			impl::deallocate(pages, page_count() * sizeof(std::atomic<slot_page>));
+		}
 
+		// creates a new node for the element at index (defined below toml::table).
 		TOML_NODISCARD
-		iterator begin() noexcept
+		node_ptr make_node(size_t index) const;
+
+		template <typename T, typename Elem>
+		TOML_NODISCARD
+		static std::unique_ptr<packed_array> pack_as(const Elem* elems, size_t count)
 		{
-			return iterator{ elems_.begin() };
+			const auto flags = reinterpret_cast<const value<T>&>(*elems[0]).flags();
+			for (size_t i = 0; i < count; i++)
+				if (elems[i]->type() != node_type_of<T> || reinterpret_cast<const value<T>&>(*elems[i]).flags() != flags)
+					return {};
+
+			// strings that all still refer to the document they were parsed from, exactly as it spells them (see
+			// parse_flags::string_views), are packed as views of it
+			if constexpr (std::is_same_v<T, std::string>)
+			{
+				bool borrowed = true;
+				for (size_t i = 0; i < count && borrowed; i++)
+				{
+					const auto& val = reinterpret_cast<const value<T>&>(*elems[i]);
+					borrowed		= val.is_raw() && !val.raw_info_;
+				}
+				if (borrowed)
+					return pack_values<std::string_view>(elems, count, flags);
+			}
+			return pack_values<T>(elems, count, flags);
 		}
 
+		template <typename T, typename Elem>
 		TOML_NODISCARD
-		const_iterator begin() const noexcept
+		static std::unique_ptr<packed_array> pack_values(const Elem* elems, size_t count, value_flags flags)
 		{
-			return const_iterator{ elems_.cbegin() };
+			std::unique_ptr<packed_array> packed{ new packed_array{ static_cast<T*>(nullptr), flags, count } };
+			auto values = static_cast<T*>(packed->values_);
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto& val = reinterpret_cast<const value<native_type_of<T>>&>(*elems[i]);
+				if constexpr (std::is_same_v<native_type_of<T>, std::string>)
+					::new (static_cast<void*>(values + i)) T{ val.view() };
+				else
+					::new (static_cast<void*>(values + i)) T{ val.get() };
+				packed->size_++;
+			}
+			return packed;
 		}
 
+		// the element a packed value stands for (strings packed as views still refer to the document)
+		template <typename T>
 		TOML_NODISCARD
-		const_iterator cbegin() const noexcept
+		static auto element_value(const T& val)
 		{
-			return const_iterator{ elems_.cbegin() };
+			if constexpr (std::is_same_v<T, std::string_view>)
+				return value<std::string>{ impl::raw_value_tag{}, val };
+			else
+				return value<T>{ val };
 		}
 
+		// strings are only packed as columns of a packed array of tables, where the alternative is a node and a key
+		// per table. a packed array of strings would have to copy every element it visits.
 		TOML_NODISCARD
-		iterator end() noexcept
+		static std::unique_ptr<packed_array> pack_column(const node* const* elems, size_t count)
 		{
-			return iterator{ elems_.end() };
+			switch (elems[0]->type())
+			{
+				case node_type::string: return pack_as<std::string>(elems, count);
+				case node_type::integer: return pack_as<int64_t>(elems, count);
+				case node_type::floating_point: return pack_as<double>(elems, count);
+				case node_type::boolean: return pack_as<bool>(elems, count);
+				case node_type::date: return pack_as<date>(elems, count);
+				case node_type::time: return pack_as<time>(elems, count);
+				case node_type::date_time: return pack_as<date_time>(elems, count);
+				default: return {};
+			}
 		}
 
+		// (defined below toml::table)
+		template <typename Elem>
 		TOML_NODISCARD
-		const_iterator end() const noexcept
+		static std::unique_ptr<packed_array> pack_tables(const Elem* elems, size_t count);
+
+		template <typename Elem>
+		TOML_NODISCARD
+		static std::unique_ptr<packed_array> pack_elems(const Elem* elems, size_t count)
 		{
-			return const_iterator{ elems_.cend() };
+			switch (elems[0]->type())
+			{
+				case node_type::table: return pack_tables(elems, count);
+				case node_type::integer: return pack_as<int64_t>(elems, count);
+				case node_type::floating_point: return pack_as<double>(elems, count);
+				case node_type::boolean: return pack_as<bool>(elems, count);
+				case node_type::date: return pack_as<date>(elems, count);
+				case node_type::time: return pack_as<time>(elems, count);
+				case node_type::date_time: return pack_as<date_time>(elems, count);
+				default: return {};
+			}
 		}
 
+	  public:
 		TOML_NODISCARD
-		const_iterator cend() const noexcept
+		static void* operator new(size_t size)
 		{
-			return const_iterator{ elems_.cend() };
+			return impl::allocate(size);
 		}
 
-	  private:
+		static void operator delete(void* ptr, size_t size) noexcept
+		{
+			impl::deallocate(ptr, size);
+		}
 
-		template <typename T, typename Array>
-		using for_each_elem_ref = impl::copy_cvref<impl::wrap_node<impl::remove_cvref<impl::unwrap_node<T>>>, Array>;
+		packed_array(const packed_array&)			 = delete;
+		packed_array& operator=(const packed_array&) = delete;
 
-		template <typename Func, typename Array, typename T>
-		using can_for_each = std::disjunction<std::is_invocable<Func, for_each_elem_ref<T, Array>, size_t>,
-											  std::is_invocable<Func, size_t, for_each_elem_ref<T, Array>>,
-											  std::is_invocable<Func, for_each_elem_ref<T, Array>>>;
-
-		template <typename Func, typename Array, typename T>
-		using can_for_each_nothrow = std::conditional_t<
-			// first form
-			std::is_invocable_v<Func, for_each_elem_ref<T, Array>, size_t>,
-			std::is_nothrow_invocable<Func, for_each_elem_ref<T, Array>, size_t>,
-			std::conditional_t<
-				// second form
-				std::is_invocable_v<Func, size_t, for_each_elem_ref<T, Array>>,
-				std::is_nothrow_invocable<Func, size_t, for_each_elem_ref<T, Array>>,
-				std::conditional_t<
-					// third form
-					std::is_invocable_v<Func, for_each_elem_ref<T, Array>>,
-					std::is_nothrow_invocable<Func, for_each_elem_ref<T, Array>>,
-					std::false_type>>>;
-
-		template <typename Func, typename Array>
-		using can_for_each_any = std::disjunction<can_for_each<Func, Array, table>,
-												  can_for_each<Func, Array, array>,
-												  can_for_each<Func, Array, std::string>,
-												  can_for_each<Func, Array, int64_t>,
-												  can_for_each<Func, Array, double>,
-												  can_for_each<Func, Array, bool>,
-												  can_for_each<Func, Array, date>,
-												  can_for_each<Func, Array, time>,
-												  can_for_each<Func, Array, date_time>>;
-
-		template <typename Func, typename Array, typename T>
-		using for_each_is_nothrow_one = std::disjunction<std::negation<can_for_each<Func, Array, T>>, //
-														 can_for_each_nothrow<Func, Array, T>>;
-
-		template <typename Func, typename Array>
-		using for_each_is_nothrow = std::conjunction<for_each_is_nothrow_one<Func, Array, table>,
-													 for_each_is_nothrow_one<Func, Array, array>,
-													 for_each_is_nothrow_one<Func, Array, std::string>,
-													 for_each_is_nothrow_one<Func, Array, int64_t>,
-													 for_each_is_nothrow_one<Func, Array, double>,
-													 for_each_is_nothrow_one<Func, Array, bool>,
-													 for_each_is_nothrow_one<Func, Array, date>,
-													 for_each_is_nothrow_one<Func, Array, time>,
-													 for_each_is_nothrow_one<Func, Array, date_time>>;
-
-		template <typename Func, typename Array>
-		static void do_for_each(Func&& visitor, Array&& arr) //
-			noexcept(for_each_is_nothrow<Func&&, Array&&>::value)
+		~packed_array() noexcept
 		{
-			static_assert(can_for_each_any<Func&&, Array&&>::value,
-						  "TOML array for_each visitors must be invocable for at least one of the toml::node "
-						  "specializations:" TOML_SA_NODE_TYPE_LIST);
+			const auto nodes = nodes_.load(std::memory_order_relaxed);
+			release_slots(!nodes);
+			if (nodes)
+				delete_node_vector(nodes);
 
-			for (size_t i = 0; i < arr.size(); i++)
+			if (type_ == node_type::table)
 			{
-				using node_ref = impl::copy_cvref<toml::node, Array&&>;
-				static_assert(std::is_reference_v<node_ref>);
-
-#if TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN
-
-#ifndef TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED
-				static_assert(impl::always_false<Func, Array, node_ref>, //
-							  TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_MESSAGE);
-#endif
-
-				static_cast<node_ref>(static_cast<Array&&>(arr)[i])
-					.visit(
-						[&]([[maybe_unused]] auto&& elem) //
-						noexcept(for_each_is_nothrow_one<Func&&, Array&&, decltype(elem)>::value)
-						{
-							using elem_ref = for_each_elem_ref<decltype(elem), Array&&>;
-							static_assert(std::is_reference_v<elem_ref>);
-
-							// func(elem, i)
-							if constexpr (std::is_invocable_v<Func&&, elem_ref, size_t>)
-							{
-								static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i);
-							}
-
-							// func(i, elem)
-							else if constexpr (std::is_invocable_v<Func&&, size_t, elem_ref>)
-							{
-								static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem));
-							}
-
-							// func(elem)
-							else if constexpr (std::is_invocable_v<Func&&, elem_ref>)
-							{
-								static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem));
-							}
-						});
-
-#else
-				const auto keep_going =
-					static_cast<node_ref>(static_cast<Array&&>(arr)[i])
-						.visit(
-							[&]([[maybe_unused]] auto&& elem) //
-							noexcept(for_each_is_nothrow_one<Func&&, Array&&, decltype(elem)>::value)
-							{
-								using elem_ref = for_each_elem_ref<decltype(elem), Array&&>;
-								static_assert(std::is_reference_v<elem_ref>);
-
-								// func(elem, i)
-								if constexpr (std::is_invocable_v<Func&&, elem_ref, size_t>)
-								{
-									using return_type =
-										decltype(static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i));
-
-									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
-									{
-										return static_cast<bool>(
-											static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i));
-									}
-									else
-									{
-										static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i);
-										return true;
-									}
-								}
+				std::destroy_n(columns(), capacity_);
+				impl::deallocate(values_, capacity_ * sizeof(column));
+				return;
+			}
+			visit_values(
+				[&](auto values) noexcept
+				{
+					using value_type = std::remove_pointer_t<decltype(values)>;
+					std::destroy_n(values, size_);
+					impl::deallocate(values_, capacity_ * sizeof(value_type));
+				});
+		}
 
-								// func(i, elem)
-								else if constexpr (std::is_invocable_v<Func&&, size_t, elem_ref>)
-								{
-									using return_type =
-										decltype(static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem)));
+		// returns nullptr if the elements aren't all the same packable type with the same flags (or tables with the
+		// same keys, whose values are), or there aren't enough of them to be worth it.
+		TOML_NODISCARD
+		static std::unique_ptr<packed_array> pack(const node_vector& elems)
+		{
+			if (!TOML_ARRAY_PACK_THRESHOLD || elems.size() < TOML_ARRAY_PACK_THRESHOLD)
+				return {};
 
-									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
-									{
-										return static_cast<bool>(
-											static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem)));
-									}
-									else
-									{
-										static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem));
-										return true;
-									}
-								}
+			return pack_elems(elems.data(), elems.size());
+		}
 
-								// func(elem)
-								else if constexpr (std::is_invocable_v<Func&&, elem_ref>)
-								{
-									using return_type =
-										decltype(static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem)));
+		// copies own their strings, like value's copy constructor
+		void own_strings()
+		{
+			if (type_ == node_type::table)
+			{
+				for (size_t i = 0; i < capacity_; i++)
+					columns()[i].values->own_strings();
+				return;
+			}
+			if (!borrowed_strings_)
+				return;
 
-									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
-									{
-										return static_cast<bool>(
-											static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem)));
-									}
-									else
-									{
-										static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem));
-										return true;
-									}
-								}
+			const auto views   = static_cast<std::string_view*>(values_);
+			const auto strings = static_cast<std::string*>(impl::allocate(capacity_ * sizeof(std::string)));
+			std::uninitialized_copy_n(views, size_, strings);
+			impl::deallocate(values_, capacity_ * sizeof(std::string_view));
+			values_			  = strings;
+			borrowed_strings_ = false;
+		}
 
-								// visitor not compatible with this particular type
-								else
-									return true;
-							});
+		TOML_NODISCARD
+		std::unique_ptr<packed_array> copy_packed() const
+		{
+			// the elements that have been handed out as nodes could have been changed through them (the C API hands
+			// out mutable pointers), so the copy has to be packed from those nodes instead
+			if (has_nodes())
+			{
+				node_vector unpublished;
+				std::vector<const node*, allocator<const node*>> elems(size_);
+				for (size_t i = 0; i < size_; i++)
+				{
+					if (!(elems[i] = handed_out(i)))
+					{
+						unpublished.push_back(make_node(i));
+						elems[i] = unpublished.back().get();
+					}
+				}
+				return pack_elems(elems.data(), size_);
+			}
 
-				if (!keep_going)
-					return;
-#endif
+			if (type_ == node_type::table)
+			{
+				std::unique_ptr<packed_array> packed{ new packed_array{ inline_tables_, size_, capacity_ } };
+				for (size_t i = 0; i < capacity_; i++)
+				{
+					packed->columns()[i].key	= columns()[i].key;
+					packed->columns()[i].values = columns()[i].values->copy_packed();
+				}
+				return packed;
 			}
-		}
 
-	  public:
+			return visit_values(
+				[&](auto values)
+				{
+					std::unique_ptr<packed_array> packed{ new packed_array{ values, flags_, size_ } };
+					std::uninitialized_copy_n(values, size_, static_cast<decltype(values)>(packed->values_));
+					packed->size_ = size_;
+					return packed;
+				});
+		}
 
-		template <typename Func>
-		array& for_each(Func&& visitor) & //
-			noexcept(for_each_is_nothrow<Func&&, array&>::value)
+		// returns nullptr if the elements can no longer be packed.
+		TOML_NODISCARD
+		std::unique_ptr<packed_array> clone() const
 		{
-			do_for_each(static_cast<Func&&>(visitor), *this);
-			return *this;
+			auto packed = copy_packed();
+			if (packed)
+				packed->own_strings();
+			return packed;
 		}
 
-		template <typename Func>
-		array&& for_each(Func&& visitor) && //
-			noexcept(for_each_is_nothrow<Func&&, array&&>::value)
+		TOML_PURE_INLINE_GETTER
+		node_type type() const noexcept
 		{
-			do_for_each(static_cast<Func&&>(visitor), static_cast<array&&>(*this));
-			return static_cast<array&&>(*this);
+			return type_;
 		}
 
-		template <typename Func>
-		const array& for_each(Func&& visitor) const& //
-			noexcept(for_each_is_nothrow<Func&&, const array&>::value)
+		TOML_PURE_INLINE_GETTER
+		value_flags flags() const noexcept
 		{
-			do_for_each(static_cast<Func&&>(visitor), *this);
-			return *this;
+			return flags_;
 		}
 
-		template <typename Func>
-		const array&& for_each(Func&& visitor) const&& //
-			noexcept(for_each_is_nothrow<Func&&, const array&&>::value)
+		TOML_PURE_INLINE_GETTER
+		size_t size() const noexcept
 		{
-			do_for_each(static_cast<Func&&>(visitor), static_cast<const array&&>(*this));
-			return static_cast<const array&&>(*this);
+			return size_;
 		}
 
-		TOML_NODISCARD
-		bool empty() const noexcept
+		// calls func with the element at index as a const node&: the one handed out by node_at() if there is one,
+		// otherwise a temporary.
+		template <typename Func>
+		decltype(auto) visit(size_t index, Func&& func) const
 		{
-			return elems_.empty();
+			TOML_ASSERT(index < size_);
+			if (auto nde = handed_out(index))
+				return static_cast<Func&&>(func)(std::as_const(*nde));
+
+			if (type_ == node_type::table)
+			{
+				const auto row = make_node(index);
+				return static_cast<Func&&>(func)(std::as_const(*row));
+			}
+
+			return visit_values(
+				[&](auto values) -> decltype(auto)
+				{
+					auto val = element_value(values[index]);
+					val.flags(flags_);
+					return static_cast<Func&&>(func)(std::as_const(val));
+				});
 		}
 
-		TOML_NODISCARD
-		size_t size() const noexcept
+		// whether any of the elements have been handed out as nodes.
+		TOML_PURE_INLINE_GETTER
+		bool has_nodes() const noexcept
 		{
-			return elems_.size();
+			return pages_.load(std::memory_order_acquire) != nullptr;
 		}
 
+		// the element at index as a node, created on the first call. safe to call from multiple threads at once.
 		TOML_NODISCARD
-		size_t max_size() const noexcept
+		const node& node_at(size_t index) const
 		{
-			return elems_.max_size();
+			TOML_ASSERT(index < size_);
+			auto& dest = slot(index);
+			if (auto nde = dest.load(std::memory_order_acquire))
+				return *nde;
+
+			node* expected = nullptr;
+			node_ptr nde   = make_node(index);
+			if (!dest.compare_exchange_strong(expected, nde.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+				return *expected;
+			return *nde.release();
 		}
 
+		// all the elements as nodes, created on the first call. safe to call from multiple threads at once.
 		TOML_NODISCARD
-		size_t capacity() const noexcept
+		const node_vector& nodes() const
 		{
-			return elems_.capacity();
-		}
+			if (auto nodes = nodes_.load(std::memory_order_acquire))
+				return *nodes;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void reserve(size_t new_capacity);
+			for (size_t i = 0; i < size_; i++)
+				static_cast<void>(node_at(i));
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void shrink_to_fit();
+			// the vector only borrows the nodes from the slots until it's published, so it has to be allocated up front
+			// (filling it can't throw once it is)
+			node_vector borrowed;
+			borrowed.reserve(size_);
+			const auto nodes = new_node_vector(std::move(borrowed));
+			for (size_t i = 0; i < size_; i++)
+				nodes->emplace_back(handed_out(i));
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void truncate(size_t new_size);
+			node_vector* expected = nullptr;
+			if (!nodes_.compare_exchange_strong(expected, nodes, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				for (auto& nde : *nodes)
+					static_cast<void>(nde.release());
+				delete_node_vector(nodes);
+				return *expected;
+			}
+			return *nodes;
+		}
 
-		template <typename ElemType>
-		void resize(size_t new_size,
-					ElemType&& default_init_val,
-					value_flags default_init_flags = preserve_source_value_flags)
+		// moves the elements out as nodes (reusing the ones that have already been handed out, if any).
+		TOML_NODISCARD
+		node_vector take_nodes()
 		{
-			static_assert(!is_node_view<ElemType>,
-						  "The default element type argument to toml::array::resize may not be toml::node_view.");
-
-			if (!new_size)
-				clear();
-			else if (new_size > elems_.size())
-				insert(cend(), new_size - elems_.size(), static_cast<ElemType&&>(default_init_val), default_init_flags);
+			node_vector out;
+			if (auto nodes = nodes_.exchange(nullptr, std::memory_order_acq_rel))
+			{
+				out = std::move(*nodes);
+				delete_node_vector(nodes);
+			}
 			else
-				truncate(new_size);
-		}
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		iterator erase(const_iterator pos) noexcept;
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		iterator erase(const_iterator first, const_iterator last) noexcept;
+			{
+				out.reserve(size_);
+				for (size_t i = 0; i < size_; i++)
+				{
+					const auto dest = find_slot(i);
+					if (auto nde = dest ? dest->exchange(nullptr, std::memory_order_relaxed) : nullptr)
+						out.emplace_back(nde);
+					else
+						out.push_back(make_node(i));
+				}
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array& flatten() &;
+			release_slots(false);
+			return out;
+		}
 
-		array&& flatten() &&
+		void pop_back() noexcept
 		{
-			return static_cast<toml::array&&>(this->flatten());
+			TOML_ASSERT(size_ && !has_nodes());
+			size_--;
+			if (type_ == node_type::table)
+			{
+				for (size_t i = 0; i < capacity_; i++)
+					columns()[i].values->pop_back();
+				return;
+			}
+			visit_values([&](auto values) noexcept { std::destroy_at(values + size_); });
 		}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		array& prune(bool recursive = true) & noexcept;
-
-		array&& prune(bool recursive = true) && noexcept
+		// appends val's value if it has the same type and flags as the others, returning whether it did. (the parser
+		// uses this to add to arrays it has packed part of the way through, instead of creating all their nodes first.)
+		TOML_NODISCARD
+		bool push_back(const node& val)
 		{
-			return static_cast<toml::array&&>(this->prune(recursive));
+			TOML_ASSERT(!has_nodes());
+			if (type_ == node_type::table || type_ == node_type::string || val.type() != type_)
+				return false;
+
+			return visit_values(
+				[&](auto values)
+				{
+					using value_type = std::remove_pointer_t<decltype(values)>;
+					if constexpr (is_one_of<value_type, std::string, std::string_view>)
+						return false;
+					else
+					{
+						const auto& elem = reinterpret_cast<const value<value_type>&>(val);
+						if (elem.flags() != flags_)
+							return false;
+
+						static_assert(std::is_trivially_copyable_v<value_type>);
+						if (size_ == capacity_)
+						{
+							const auto grown = static_cast<value_type*>(impl::allocate(capacity_ * 2u * sizeof(value_type)));
+							std::memcpy(static_cast<void*>(grown), values, size_ * sizeof(value_type));
+							impl::deallocate(values_, capacity_ * sizeof(value_type));
+							values_ = values = grown;
+							capacity_ *= 2u;
+						}
+						::new (static_cast<void*>(values + size_)) value_type{ elem.get() };
+						size_++;
+						return true;
+					}
+				});
 		}
+	};
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void pop_back() noexcept;
+	template <bool IsConst>
+	class TOML_TRIVIAL_ABI array_iterator
+	{
+	  private:
+		template <bool>
+		friend class array_iterator;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void clear() noexcept;
+		using mutable_vector_iterator = std::vector<node_ptr, allocator<node_ptr>>::iterator;
+		using const_vector_iterator	  = std::vector<node_ptr, allocator<node_ptr>>::const_iterator;
+		using vector_iterator		  = std::conditional_t<IsConst, const_vector_iterator, mutable_vector_iterator>;
 
-		template <typename ElemType>
-		iterator insert(const_iterator pos, ElemType&& val, value_flags flags = preserve_source_value_flags)
+		mutable vector_iterator iter_;
+
+	  public:
+		using value_type		= std::conditional_t<IsConst, const node, node>;
+		using reference			= value_type&;
+		using pointer			= value_type*;
+		using difference_type	= ptrdiff_t;
+		using iterator_category = typename std::iterator_traits<vector_iterator>::iterator_category;
+
+		TOML_NODISCARD_CTOR
+		array_iterator() noexcept = default;
+
+		TOML_NODISCARD_CTOR
+		explicit array_iterator(mutable_vector_iterator iter) noexcept //
+			: iter_{ iter }
+		{}
+
+		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
+		TOML_NODISCARD_CTOR
+		explicit array_iterator(const_vector_iterator iter) noexcept //
+			: iter_{ iter }
+		{}
+
+		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
+		TOML_NODISCARD_CTOR
+		array_iterator(const array_iterator<false>& other) noexcept //
+			: iter_{ other.iter_ }
+		{}
+
+		TOML_NODISCARD_CTOR
+		array_iterator(const array_iterator&) noexcept = default;
+
+		array_iterator& operator=(const array_iterator&) noexcept = default;
+
+		array_iterator& operator++() noexcept // ++pre
 		{
-			if constexpr (is_node_view<ElemType>)
-			{
-				if (!val)
-					return end();
-			}
-			return iterator{ insert_at(const_vector_iterator{ pos },
-									   impl::make_node(static_cast<ElemType&&>(val), flags)) };
+			++iter_;
+			return *this;
 		}
 
-		template <typename ElemType>
-		iterator insert(const_iterator pos,
-						size_t count,
-						ElemType&& val,
-						value_flags flags = preserve_source_value_flags)
+		array_iterator operator++(int) noexcept // post++
 		{
-			if constexpr (is_node_view<ElemType>)
-			{
-				if (!val)
-					return end();
-			}
-			switch (count)
-			{
-				case 0: return iterator{ elems_.begin() + (const_vector_iterator{ pos } - elems_.cbegin()) };
-				case 1: return insert(pos, static_cast<ElemType&&>(val), flags);
-				default:
-				{
-					const auto start_idx = static_cast<size_t>(const_vector_iterator{ pos } - elems_.cbegin());
-					preinsertion_resize(start_idx, count);
-					size_t i = start_idx;
-					for (size_t e = start_idx + count - 1u; i < e; i++)
-						elems_[i] = impl::make_node(val, flags);
-
-					elems_[i] = impl::make_node(static_cast<ElemType&&>(val), flags);
-					return iterator{ elems_.begin() + static_cast<ptrdiff_t>(start_idx) };
-				}
-			}
+			array_iterator out{ iter_ };
+			++iter_;
+			return out;
 		}
 
-		template <typename Iter>
-		iterator insert(const_iterator pos, Iter first, Iter last, value_flags flags = preserve_source_value_flags)
+		array_iterator& operator--() noexcept // --pre
 		{
-			const auto distance = std::distance(first, last);
-			if (distance <= 0)
-				return iterator{ elems_.begin() + (const_vector_iterator{ pos } - elems_.cbegin()) };
-			else
-			{
-				auto count		 = distance;
-				using deref_type = decltype(*first);
-				if constexpr (is_node_view<deref_type>)
-				{
-					for (auto it = first; it != last; it++)
-						if (!(*it))
-							count--;
-					if (!count)
-						return iterator{ elems_.begin() + (const_vector_iterator{ pos } - elems_.cbegin()) };
-				}
-				const auto start_idx = static_cast<size_t>(const_vector_iterator{ pos } - elems_.cbegin());
-				preinsertion_resize(start_idx, static_cast<size_t>(count));
-				size_t i = start_idx;
-				for (auto it = first; it != last; it++)
-				{
-					if constexpr (is_node_view<deref_type>)
-					{
-						if (!(*it))
-							continue;
-					}
-					if constexpr (std::is_rvalue_reference_v<deref_type>)
-						elems_[i++] = impl::make_node(std::move(*it), flags);
-					else
-						elems_[i++] = impl::make_node(*it, flags);
-				}
-				return iterator{ elems_.begin() + static_cast<ptrdiff_t>(start_idx) };
-			}
+			--iter_;
+			return *this;
 		}
 
-		template <typename ElemType>
-		iterator insert(const_iterator pos,
-						std::initializer_list<ElemType> ilist,
-						value_flags flags = preserve_source_value_flags)
+		array_iterator operator--(int) noexcept // post--
 		{
-			return insert(pos, ilist.begin(), ilist.end(), flags);
+			array_iterator out{ iter_ };
+			--iter_;
+			return out;
 		}
 
-		template <typename ElemType = void, typename... Args>
-		iterator emplace(const_iterator pos, Args&&... args)
+		TOML_PURE_INLINE_GETTER
+		reference operator*() const noexcept
 		{
-			using raw_elem_type = impl::remove_cvref<ElemType>;
-			using elem_type		= std::conditional_t<std::is_void_v<raw_elem_type>, //
-												 impl::emplaced_type_of<Args&&...>,
-												 raw_elem_type>;
-
-			using type = impl::remove_cvref<impl::unwrap_node<elem_type>>;
-			static_assert(impl::is_native<type> || impl::is_one_of<type, table, array>,
-						  "Emplacement type parameter must be one of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
-
-			return iterator{ insert_at(const_vector_iterator{ pos },
-									   impl::node_ptr{ new impl::wrap_node<type>{ static_cast<Args&&>(args)... } }) };
+			return *iter_->get();
 		}
 
-		template <typename ElemType>
-		iterator replace(const_iterator pos, ElemType&& val, value_flags flags = preserve_source_value_flags)
+		TOML_PURE_INLINE_GETTER
+		pointer operator->() const noexcept
 		{
-			TOML_ASSERT(pos >= cbegin() && pos < cend());
-
-			if constexpr (is_node_view<ElemType>)
-			{
-				if (!val)
-					return end();
-			}
-
-			const auto it = elems_.begin() + (const_vector_iterator{ pos } - elems_.cbegin());
-			*it			  = impl::make_node(static_cast<ElemType&&>(val), flags);
-			return iterator{ it };
+			return iter_->get();
 		}
 
-		template <typename ElemType>
-		void push_back(ElemType&& val, value_flags flags = preserve_source_value_flags)
+		TOML_PURE_INLINE_GETTER
+		explicit operator const vector_iterator&() const noexcept
 		{
-			emplace_back_if_not_empty_view(static_cast<ElemType&&>(val), flags);
+			return iter_;
 		}
 
-		template <typename ElemType = void, typename... Args>
-		decltype(auto) emplace_back(Args&&... args)
+		TOML_CONSTRAINED_TEMPLATE(!C, bool C = IsConst)
+		TOML_PURE_INLINE_GETTER
+		explicit operator const const_vector_iterator() const noexcept
 		{
-			using raw_elem_type = impl::remove_cvref<ElemType>;
-			using elem_type		= std::conditional_t<std::is_void_v<raw_elem_type>, //
-												 impl::emplaced_type_of<Args&&...>,
-												 raw_elem_type>;
-
-			static constexpr auto moving_node_ptr = std::is_same_v<elem_type, impl::node_ptr> //
-												 && sizeof...(Args) == 1u					  //
-												 && impl::first_is_same<impl::node_ptr&&, Args&&...>;
-
-			using unwrapped_type = impl::remove_cvref<impl::unwrap_node<elem_type>>;
-
-			static_assert(
-				moving_node_ptr										  //
-					|| impl::is_native<unwrapped_type>				  //
-					|| impl::is_one_of<unwrapped_type, table, array>, //
-				"ElemType argument of array::emplace_back() must be one of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
-
-			if constexpr (moving_node_ptr)
-			{
-				insert_at_back(static_cast<Args&&>(args)...);
-				return *elems_.back();
-			}
-			else
-			{
-				auto ptr = new impl::wrap_node<unwrapped_type>{ static_cast<Args&&>(args)... };
-				insert_at_back(impl::node_ptr{ ptr });
-				return *ptr;
-			}
+			return iter_;
 		}
 
-	  private:
-
-		TOML_NODISCARD
-		TOML_EXPORTED_STATIC_FUNCTION
-		static bool TOML_CALLCONV equal(const array&, const array&) noexcept;
-
-		template <typename T>
-		TOML_NODISCARD
-		static bool equal_to_container(const array& lhs, const T& rhs) noexcept
+		array_iterator& operator+=(ptrdiff_t rhs) noexcept
 		{
-			using element_type = std::remove_const_t<typename T::value_type>;
-			static_assert(impl::is_losslessly_convertible_to_native<element_type>,
-						  "Container element type must be losslessly convertible one of the native TOML value types");
-
-			if (lhs.size() != rhs.size())
-				return false;
-			if (rhs.size() == 0u)
-				return true;
-
-			size_t i{};
-			for (auto& list_elem : rhs)
-			{
-				const auto elem = lhs.get_as<impl::native_type_of<element_type>>(i++);
-				if (!elem || *elem != list_elem)
-					return false;
-			}
-
-			return true;
+			iter_ += rhs;
+			return *this;
 		}
 
-	  public:
-
-		TOML_NODISCARD
-		friend bool operator==(const array& lhs, const array& rhs) noexcept
+		array_iterator& operator-=(ptrdiff_t rhs) noexcept
 		{
-			return equal(lhs, rhs);
+			iter_ -= rhs;
+			return *this;
 		}
 
 		TOML_NODISCARD
-		friend bool operator!=(const array& lhs, const array& rhs) noexcept
+		friend array_iterator operator+(const array_iterator& lhs, ptrdiff_t rhs) noexcept
 		{
-			return !equal(lhs, rhs);
+			return array_iterator{ lhs.iter_ + rhs };
 		}
 
-		template <typename T>
 		TOML_NODISCARD
-		friend bool operator==(const array& lhs, const std::initializer_list<T>& rhs) noexcept
+		friend array_iterator operator+(ptrdiff_t lhs, const array_iterator& rhs) noexcept
 		{
-			return equal_to_container(lhs, rhs);
+			return array_iterator{ rhs.iter_ + lhs };
 		}
-		TOML_ASYMMETRICAL_EQUALITY_OPS(const array&, const std::initializer_list<T>&, template <typename T>);
 
-		template <typename T>
 		TOML_NODISCARD
-		friend bool operator==(const array& lhs, const std::vector<T>& rhs) noexcept
+		friend array_iterator operator-(const array_iterator& lhs, ptrdiff_t rhs) noexcept
 		{
-			return equal_to_container(lhs, rhs);
+			return array_iterator{ lhs.iter_ - rhs };
 		}
-		TOML_ASYMMETRICAL_EQUALITY_OPS(const array&, const std::vector<T>&, template <typename T>);
-
-#if TOML_ENABLE_FORMATTERS
-
-		friend std::ostream& operator<<(std::ostream& lhs, const array& rhs)
-		{
-			impl::print_to_stream(lhs, rhs);
-			return lhs;
-		}
-
-#endif
-	};
-}
-TOML_NAMESPACE_END;
-
-#ifdef _MSC_VER
-#pragma pop_macro("min")
-#pragma pop_macro("max")
-#ifndef __clang__
-#pragma inline_recursion(off)
-#endif
-#endif
-TOML_POP_WARNINGS;
-
-//********  impl/key.hpp  **********************************************************************************************
-
-TOML_PUSH_WARNINGS;
-#ifdef _MSC_VER
-#ifndef __clang__
-#pragma inline_recursion(on)
-#endif
-#pragma push_macro("min")
-#pragma push_macro("max")
-#undef min
-#undef max
-#endif
-
-TOML_NAMESPACE_START
-{
-	class key
-	{
-	  private:
-		std::string key_;
-		source_region source_;
-
-	  public:
-
-		TOML_NODISCARD_CTOR
-		key() noexcept = default;
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::string_view k, source_region&& src = {}) //
-			: key_{ k },
-			  source_{ std::move(src) }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::string_view k, const source_region& src) //
-			: key_{ k },
-			  source_{ src }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::string&& k, source_region&& src = {}) noexcept //
-			: key_{ std::move(k) },
-			  source_{ std::move(src) }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::string&& k, const source_region& src) noexcept //
-			: key_{ std::move(k) },
-			  source_{ src }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(const char* k, source_region&& src = {}) //
-			: key_{ k },
-			  source_{ std::move(src) }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(const char* k, const source_region& src) //
-			: key_{ k },
-			  source_{ src }
-		{}
-
-#if TOML_ENABLE_WINDOWS_COMPAT
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::wstring_view k, source_region&& src = {}) //
-			: key_{ impl::narrow(k) },
-			  source_{ std::move(src) }
-		{}
-
-		TOML_NODISCARD_CTOR
-		explicit key(std::wstring_view k, const source_region& src) //
-			: key_{ impl::narrow(k) },
-			  source_{ src }
-		{}
-
-#endif
 
 		TOML_PURE_INLINE_GETTER
-		std::string_view str() const noexcept
+		friend ptrdiff_t operator-(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return std::string_view{ key_ };
+			return lhs.iter_ - rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		/*implicit*/ operator std::string_view() const noexcept
+		friend bool operator==(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return str();
+			return lhs.iter_ == rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		bool empty() const noexcept
+		friend bool operator!=(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return key_.empty();
+			return lhs.iter_ != rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		const char* data() const noexcept
+		friend bool operator<(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return key_.data();
+			return lhs.iter_ < rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		size_t length() const noexcept
+		friend bool operator<=(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return key_.length();
+			return lhs.iter_ <= rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		const source_region& source() const noexcept
+		friend bool operator>(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return source_;
+			return lhs.iter_ > rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		friend bool operator==(const key& lhs, const key& rhs) noexcept
+		friend bool operator>=(const array_iterator& lhs, const array_iterator& rhs) noexcept
 		{
-			return lhs.key_ == rhs.key_;
+			return lhs.iter_ >= rhs.iter_;
 		}
 
 		TOML_PURE_INLINE_GETTER
-		friend bool operator!=(const key& lhs, const key& rhs) noexcept
+		reference operator[](ptrdiff_t idx) const noexcept
 		{
-			return lhs.key_ != rhs.key_;
+			return *(iter_ + idx)->get();
 		}
+	};
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<(const key& lhs, const key& rhs) noexcept
-		{
-			return lhs.key_ < rhs.key_;
-		}
+	struct array_init_elem
+	{
+		mutable node_ptr value;
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<=(const key& lhs, const key& rhs) noexcept
-		{
-			return lhs.key_ <= rhs.key_;
-		}
+		template <typename T>
+		TOML_NODISCARD_CTOR
+		array_init_elem(T&& val, value_flags flags = preserve_source_value_flags) //
+			: value{ make_node(static_cast<T&&>(val), flags) }
+		{}
+	};
+}
+TOML_IMPL_NAMESPACE_END;
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>(const key& lhs, const key& rhs) noexcept
-		{
-			return lhs.key_ > rhs.key_;
-		}
+TOML_NAMESPACE_START
+{
+	using array_iterator = POXY_IMPLEMENTATION_DETAIL(impl::array_iterator<false>);
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>=(const key& lhs, const key& rhs) noexcept
-		{
-			return lhs.key_ >= rhs.key_;
-		}
+	using const_array_iterator = POXY_IMPLEMENTATION_DETAIL(impl::array_iterator<true>);
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator==(const key& lhs, std::string_view rhs) noexcept
-		{
-			return lhs.key_ == rhs;
-		}
+	class TOML_EXPORTED_CLASS array : public node
+	{
+	  private:
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator!=(const key& lhs, std::string_view rhs) noexcept
-		{
-			return lhs.key_ != rhs;
-		}
+		using vector_type			= impl::node_vector;
+		using vector_iterator		= typename vector_type::iterator;
+		using const_vector_iterator = typename vector_type::const_iterator;
+		vector_type elems_;
+		std::unique_ptr<impl::packed_array> packed_; // when set, elems_ is empty
+		impl::frozen<array>* frozen_ = {};			 // when set, elems_ is empty and packed_ isn't set
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<(const key& lhs, std::string_view rhs) noexcept
-		{
-			return lhs.key_ < rhs;
-		}
+		friend class TOML_PARSER_TYPENAME;
+		friend class impl::compactor;
+		friend class impl::reclaimer;
+		friend class impl::snapshot;
+		friend class impl::hasher;
+		friend class impl::merger;
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<=(const key& lhs, std::string_view rhs) noexcept
-		{
-			return lhs.key_ <= rhs;
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void unpack();
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>(const key& lhs, std::string_view rhs) noexcept
-		{
-			return lhs.key_ > rhs;
-		}
+		// gives the array elements of its own again (see freeze()).
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void thaw();
 
+		// the array holding the elements: the frozen one while there is one, otherwise this one.
 		TOML_PURE_INLINE_GETTER
-		friend bool operator>=(const key& lhs, std::string_view rhs) noexcept
+		const array& contents() const noexcept
 		{
-			return lhs.key_ >= rhs;
+			return frozen_ ? frozen_->contents : *this;
 		}
 
+		// where impl::hasher caches the hash of the frozen elements, or nullptr if they aren't frozen.
 		TOML_PURE_INLINE_GETTER
-		friend bool operator==(std::string_view lhs, const key& rhs) noexcept
+		std::atomic<uint64_t>* cached_hash() const noexcept
 		{
-			return lhs == rhs.key_;
+			return frozen_ ? &frozen_->hash : nullptr;
 		}
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator!=(std::string_view lhs, const key& rhs) noexcept
+		TOML_NODISCARD
+		vector_type& elems()
 		{
-			return lhs != rhs.key_;
+			if (frozen_)
+				thaw();
+			if (packed_)
+				unpack();
+			return elems_;
 		}
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<(std::string_view lhs, const key& rhs) noexcept
+		TOML_NODISCARD
+		const vector_type& elems() const
 		{
-			return lhs < rhs.key_;
+			const auto& c = contents();
+			return c.packed_ ? c.packed_->nodes() : c.elems_;
 		}
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator<=(std::string_view lhs, const key& rhs) noexcept
+		TOML_NODISCARD
+		const node& elem(size_t index) const
 		{
-			return lhs <= rhs.key_;
+			const auto& c = contents();
+			return c.packed_ ? c.packed_->node_at(index) : *c.elems_[index];
 		}
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>(std::string_view lhs, const key& rhs) noexcept
+		// the index of `pos`, an iterator into the elements as they are (which may be frozen or packed).
+		TOML_NODISCARD
+		size_t index_of(const_vector_iterator pos) const
 		{
-			return lhs > rhs.key_;
+			return static_cast<size_t>(pos - elems().cbegin());
 		}
 
-		TOML_PURE_INLINE_GETTER
-		friend bool operator>=(std::string_view lhs, const key& rhs) noexcept
+		// thaws and unpacks the elements, returning where `pos` (an iterator into them as they were) ends up.
+		TOML_NODISCARD
+		vector_iterator thaw(const_vector_iterator pos)
 		{
-			return lhs >= rhs.key_;
+			const auto index = index_of(pos);
+			return elems().begin() + static_cast<ptrdiff_t>(index);
 		}
 
-		using const_iterator = const char*;
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		array(const impl::array_init_elem*, const impl::array_init_elem*);
 
-		using iterator = const_iterator;
+		TOML_NODISCARD_CTOR
+		array(std::false_type, std::initializer_list<impl::array_init_elem> elems) //
+			: array{ elems.begin(), elems.end() }
+		{}
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator begin() const noexcept
-		{
-			return key_.data();
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void preinsertion_resize(size_t idx, size_t count);
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator end() const noexcept
-		{
-			return key_.data() + key_.length();
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void insert_at_back(impl::node_ptr&&);
 
-		friend std::ostream& operator<<(std::ostream& lhs, const key& rhs)
+		TOML_EXPORTED_MEMBER_FUNCTION
+		vector_iterator insert_at(const_vector_iterator, impl::node_ptr&&);
+
+		template <typename T>
+		void emplace_back_if_not_empty_view(T&& val, value_flags flags)
 		{
-			impl::print_to_stream(lhs, rhs.key_);
-			return lhs;
+			if constexpr (is_node_view<T>)
+			{
+				if (!val)
+					return;
+			}
+			insert_at_back(impl::make_node(static_cast<T&&>(val), flags));
 		}
-	};
 
-	template <typename T>
-	inline constexpr bool is_key = std::is_same_v<impl::remove_cvref<T>, toml::key>;
+		TOML_NODISCARD
+		TOML_EXPORTED_MEMBER_FUNCTION
+		size_t total_leaf_count() const noexcept;
 
-	template <typename T>
-	inline constexpr bool is_key_or_convertible = is_key<T> //
-											   || impl::is_constructible_or_convertible<toml::key, T>;
-}
-TOML_NAMESPACE_END;
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void flatten_child(array&& child, size_t& dest_index);
 
-#ifdef _MSC_VER
-#pragma pop_macro("min")
-#pragma pop_macro("max")
-#ifndef __clang__
-#pragma inline_recursion(off)
-#endif
-#endif
-TOML_POP_WARNINGS;
+	  public:
+		using value_type	  = node;
+		using size_type		  = size_t;
+		using difference_type = ptrdiff_t;
+		using reference		  = node&;
+		using const_reference = const node&;
 
-//********  impl/std_map.hpp  ******************************************************************************************
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		array() noexcept;
 
-TOML_DISABLE_WARNINGS;
-#include <map>
-#include <iterator>
-TOML_ENABLE_WARNINGS;
-
-//********  impl/table.hpp  ********************************************************************************************
-
-TOML_PUSH_WARNINGS;
-#ifdef _MSC_VER
-#ifndef __clang__
-#pragma inline_recursion(on)
-#endif
-#pragma push_macro("min")
-#pragma push_macro("max")
-#undef min
-#undef max
-#endif
-
-TOML_IMPL_NAMESPACE_START
-{
-	template <bool IsConst>
-	struct table_proxy_pair
-	{
-		using value_type = std::conditional_t<IsConst, const node, node>;
-
-		const toml::key& first;
-		value_type& second;
-	};
-
-	template <bool IsConst>
-	class table_iterator
-	{
-	  private:
-		template <bool>
-		friend class table_iterator;
-
-		using proxy_type		   = table_proxy_pair<IsConst>;
-		using mutable_map_iterator = std::map<toml::key, node_ptr, std::less<>>::iterator;
-		using const_map_iterator   = std::map<toml::key, node_ptr, std::less<>>::const_iterator;
-		using map_iterator		   = std::conditional_t<IsConst, const_map_iterator, mutable_map_iterator>;
-
-		mutable map_iterator iter_;
-		alignas(proxy_type) mutable unsigned char proxy_[sizeof(proxy_type)];
-		mutable bool proxy_instantiated_ = false;
-
-		TOML_NODISCARD
-		proxy_type* get_proxy() const noexcept
-		{
-			if (!proxy_instantiated_)
-			{
-				auto p = ::new (static_cast<void*>(proxy_)) proxy_type{ iter_->first, *iter_->second.get() };
-				proxy_instantiated_ = true;
-				return p;
-			}
-			else
-				return TOML_LAUNDER(reinterpret_cast<proxy_type*>(proxy_));
-		}
-
-	  public:
-		TOML_NODISCARD_CTOR
-		table_iterator() noexcept = default;
-
-		TOML_NODISCARD_CTOR
-		explicit table_iterator(mutable_map_iterator iter) noexcept //
-			: iter_{ iter }
-		{}
-
-		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
-		TOML_NODISCARD_CTOR
-		explicit table_iterator(const_map_iterator iter) noexcept //
-			: iter_{ iter }
-		{}
-
-		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
-		TOML_NODISCARD_CTOR
-		table_iterator(const table_iterator<false>& other) noexcept //
-			: iter_{ other.iter_ }
-		{}
-
-		TOML_NODISCARD_CTOR
-		table_iterator(const table_iterator& other) noexcept //
-			: iter_{ other.iter_ }
-		{}
-
-		table_iterator& operator=(const table_iterator& rhs) noexcept
-		{
-			iter_				= rhs.iter_;
-			proxy_instantiated_ = false;
-			return *this;
-		}
-
-		using value_type		= table_proxy_pair<IsConst>;
-		using reference			= value_type&;
-		using pointer			= value_type*;
-		using difference_type	= typename std::iterator_traits<map_iterator>::difference_type;
-		using iterator_category = typename std::iterator_traits<map_iterator>::iterator_category;
-
-		table_iterator& operator++() noexcept // ++pre
-		{
-			++iter_;
-			proxy_instantiated_ = false;
-			return *this;
-		}
-
-		table_iterator operator++(int) noexcept // post++
-		{
-			table_iterator out{ iter_ };
-			++iter_;
-			proxy_instantiated_ = false;
-			return out;
-		}
-
-		table_iterator& operator--() noexcept // --pre
-		{
-			--iter_;
-			proxy_instantiated_ = false;
-			return *this;
-		}
-
-		table_iterator operator--(int) noexcept // post--
-		{
-			table_iterator out{ iter_ };
-			--iter_;
-			proxy_instantiated_ = false;
-			return out;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		reference operator*() const noexcept
-		{
-			return *get_proxy();
-		}
-
-		TOML_PURE_INLINE_GETTER
-		pointer operator->() const noexcept
-		{
-			return get_proxy();
-		}
-
-		TOML_PURE_INLINE_GETTER
-		explicit operator const map_iterator&() const noexcept
-		{
-			return iter_;
-		}
-
-		TOML_CONSTRAINED_TEMPLATE(!C, bool C = IsConst)
-		TOML_PURE_INLINE_GETTER
-		explicit operator const const_map_iterator() const noexcept
-		{
-			return iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator==(const table_iterator& lhs, const table_iterator& rhs) noexcept
-		{
-			return lhs.iter_ == rhs.iter_;
-		}
-
-		TOML_PURE_INLINE_GETTER
-		friend bool operator!=(const table_iterator& lhs, const table_iterator& rhs) noexcept
-		{
-			return lhs.iter_ != rhs.iter_;
-		}
-	};
-
-	struct table_init_pair
-	{
-		mutable toml::key key;
-		mutable node_ptr value;
-
-		template <typename K, typename V>
-		TOML_NODISCARD_CTOR
-		table_init_pair(K&& k, V&& v, value_flags flags = preserve_source_value_flags) //
-			: key{ static_cast<K&&>(k) },
-			  value{ make_node(static_cast<V&&>(v), flags) }
-		{}
-	};
-}
-TOML_IMPL_NAMESPACE_END;
-
-TOML_NAMESPACE_START
-{
-	using table_iterator = POXY_IMPLEMENTATION_DETAIL(impl::table_iterator<false>);
-
-	using const_table_iterator = POXY_IMPLEMENTATION_DETAIL(impl::table_iterator<true>);
-
-	class TOML_EXPORTED_CLASS table : public node
-	{
-	  private:
-
-		using map_type			 = std::map<toml::key, impl::node_ptr, std::less<>>;
-		using map_pair			 = std::pair<const toml::key, impl::node_ptr>;
-		using map_iterator		 = typename map_type::iterator;
-		using const_map_iterator = typename map_type::const_iterator;
-		map_type map_;
-
-		bool inline_ = false;
-
-		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		table(const impl::table_init_pair*, const impl::table_init_pair*);
-
-	  public:
-
-		TOML_NODISCARD_CTOR
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table() noexcept;
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		~table() noexcept;
+		~array() noexcept;
 
 		TOML_NODISCARD_CTOR
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table(const table&);
+		array(const array&);
 
 		TOML_NODISCARD_CTOR
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table(table&& other) noexcept;
+		array(array&& other) noexcept;
 
+		TOML_CONSTRAINED_TEMPLATE((sizeof...(ElemTypes) > 0 || !std::is_same_v<impl::remove_cvref<ElemType>, array>),
+								  typename ElemType,
+								  typename... ElemTypes)
 		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		explicit table(std::initializer_list<impl::table_init_pair> kvps) //
-			: table(kvps.begin(), kvps.end())
+		explicit array(ElemType&& val, ElemTypes&&... vals)
+			: array{ std::false_type{},
+					 std::initializer_list<impl::array_init_elem>{ static_cast<ElemType&&>(val),
+																   static_cast<ElemTypes&&>(vals)... } }
 		{}
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table& operator=(const table&);
+		array& operator=(const array&);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table& operator=(table&& rhs) noexcept;
+		array& operator=(array&& rhs) noexcept;
 
 		TOML_CONST_INLINE_GETTER
 		node_type type() const noexcept final
 		{
-			return node_type::table;
+			return node_type::array;
 		}
 
 		TOML_PURE_GETTER
 		TOML_EXPORTED_MEMBER_FUNCTION
 		bool is_homogeneous(node_type ntype) const noexcept final;
 
-		TOML_PURE_GETTER
+		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		bool is_homogeneous(node_type ntype, node*& first_nonmatch) noexcept final;
+		bool is_homogeneous(node_type ntype, node*& first_nonmatch) final;
 
-		TOML_PURE_GETTER
+		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept final;
+		bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const final;
 
 		template <typename ElemType = void>
 		TOML_PURE_GETTER
@@ -7691,7 +8250,7 @@ TOML_NAMESPACE_START
 		{
 			using type = impl::remove_cvref<impl::unwrap_node<ElemType>>;
 			static_assert(std::is_void_v<type> || toml::is_value<type> || toml::is_container<type>,
-						  "The template type argument of table::is_homogeneous() must be void or one "
+						  "The template type argument of array::is_homogeneous() must be void or one "
 						  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
 
 			return is_homogeneous(impl::node_type_of<type>);
@@ -7699,19 +8258,19 @@ TOML_NAMESPACE_START
 		TOML_CONST_INLINE_GETTER
 		bool is_table() const noexcept final
 		{
-			return true;
+			return false;
 		}
 
 		TOML_CONST_INLINE_GETTER
 		bool is_array() const noexcept final
 		{
-			return false;
+			return true;
 		}
 
 		TOML_PURE_GETTER
 		bool is_array_of_tables() const noexcept final
 		{
-			return false;
+			return is_homogeneous(node_type::table);
 		}
 
 		TOML_CONST_INLINE_GETTER
@@ -7771,13 +8330,13 @@ TOML_NAMESPACE_START
 		TOML_CONST_INLINE_GETTER
 		table* as_table() noexcept final
 		{
-			return this;
+			return nullptr;
 		}
 
 		TOML_CONST_INLINE_GETTER
 		array* as_array() noexcept final
 		{
-			return nullptr;
+			return this;
 		}
 
 		TOML_CONST_INLINE_GETTER
@@ -7825,13 +8384,13 @@ TOML_NAMESPACE_START
 		TOML_CONST_INLINE_GETTER
 		const table* as_table() const noexcept final
 		{
-			return this;
+			return nullptr;
 		}
 
 		TOML_CONST_INLINE_GETTER
 		const array* as_array() const noexcept final
 		{
-			return nullptr;
+			return this;
 		}
 
 		TOML_CONST_INLINE_GETTER
@@ -7876,281 +8435,270 @@ TOML_NAMESPACE_START
 			return nullptr;
 		}
 
-		TOML_PURE_INLINE_GETTER
-		bool is_inline() const noexcept
+		// (these can allocate: packed elements are only created as nodes when they're asked for, and mutable access
+		// gives a frozen or packed array elements of its own)
+		TOML_NODISCARD
+		node* get(size_t index)
 		{
-			return inline_;
+			return index < size() ? elems()[index].get() : nullptr;
 		}
 
-		void is_inline(bool val) noexcept
+		TOML_NODISCARD
+		const node* get(size_t index) const
 		{
-			inline_ = val;
+			return index < size() ? &elem(index) : nullptr;
 		}
 
-		TOML_PURE_GETTER
-		TOML_EXPORTED_MEMBER_FUNCTION
-		node* get(std::string_view key) noexcept;
-
-		TOML_PURE_INLINE_GETTER
-		const node* get(std::string_view key) const noexcept
-		{
-			return const_cast<table&>(*this).get(key);
-		}
-
-#if TOML_ENABLE_WINDOWS_COMPAT
-
+		template <typename ElemType>
 		TOML_NODISCARD
-		node* get(std::wstring_view key)
+		impl::wrap_node<ElemType>* get_as(size_t index)
 		{
-			if (empty())
-				return nullptr;
-
-			return get(impl::narrow(key));
+			if (auto val = get(index))
+				return val->template as<ElemType>();
+			return nullptr;
 		}
 
+		template <typename ElemType>
 		TOML_NODISCARD
-		const node* get(std::wstring_view key) const
-		{
-			return const_cast<table&>(*this).get(key);
-		}
-
-#endif // TOML_ENABLE_WINDOWS_COMPAT
-
-		template <typename T>
-		TOML_PURE_GETTER
-		impl::wrap_node<T>* get_as(std::string_view key) noexcept
-		{
-			const auto n = this->get(key);
-			return n ? n->template as<T>() : nullptr;
-		}
-
-		template <typename T>
-		TOML_PURE_GETTER
-		const impl::wrap_node<T>* get_as(std::string_view key) const noexcept
+		const impl::wrap_node<ElemType>* get_as(size_t index) const
 		{
-			return const_cast<table&>(*this).template get_as<T>(key);
+			if (auto val = get(index))
+				return val->template as<ElemType>();
+			return nullptr;
 		}
 
-#if TOML_ENABLE_WINDOWS_COMPAT
-
-		template <typename T>
+		using node::operator[]; // inherit operator[toml::path]
 		TOML_NODISCARD
-		impl::wrap_node<T>* get_as(std::wstring_view key)
+		node& operator[](size_t index)
 		{
-			if (empty())
-				return nullptr;
-
-			return get_as<T>(impl::narrow(key));
+			return *elems()[index];
 		}
 
-		template <typename T>
 		TOML_NODISCARD
-		const impl::wrap_node<T>* get_as(std::wstring_view key) const
+		const node& operator[](size_t index) const
 		{
-			return const_cast<table&>(*this).template get_as<T>(key);
+			return elem(index);
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
+		TOML_NODISCARD
+		TOML_EXPORTED_MEMBER_FUNCTION
+		node& at(size_t index);
 
 		TOML_NODISCARD
 		TOML_EXPORTED_MEMBER_FUNCTION
-		node& at(std::string_view key);
+		const node& at(size_t index) const;
 
 		TOML_NODISCARD
-		const node& at(std::string_view key) const
+		node& front()
 		{
-			return const_cast<table&>(*this).at(key);
+			return *elems().front();
 		}
 
-#if TOML_ENABLE_WINDOWS_COMPAT
-
 		TOML_NODISCARD
-		node& at(std::wstring_view key)
+		const node& front() const
 		{
-			return at(impl::narrow(key));
+			return elem(0);
 		}
 
 		TOML_NODISCARD
-		const node& at(std::wstring_view key) const
+		node& back()
 		{
-			return const_cast<table&>(*this).at(key);
+			return *elems().back();
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
+		TOML_NODISCARD
+		const node& back() const
+		{
+			return elem(size() - 1u);
+		}
 
-		using iterator = toml::table_iterator;
+		using iterator = array_iterator;
 
-		using const_iterator = toml::const_table_iterator;
+		using const_iterator = const_array_iterator;
 
-		TOML_PURE_INLINE_GETTER
-		iterator begin() noexcept
+		TOML_NODISCARD
+		iterator begin()
 		{
-			return iterator{ map_.begin() };
+			return iterator{ elems().begin() };
 		}
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator begin() const noexcept
+		TOML_NODISCARD
+		const_iterator begin() const
 		{
-			return const_iterator{ map_.cbegin() };
+			return const_iterator{ elems().cbegin() };
 		}
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator cbegin() const noexcept
+		TOML_NODISCARD
+		const_iterator cbegin() const
 		{
-			return const_iterator{ map_.cbegin() };
+			return const_iterator{ elems().cbegin() };
 		}
 
-		TOML_PURE_INLINE_GETTER
-		iterator end() noexcept
+		TOML_NODISCARD
+		iterator end()
 		{
-			return iterator{ map_.end() };
+			return iterator{ elems().end() };
 		}
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator end() const noexcept
+		TOML_NODISCARD
+		const_iterator end() const
 		{
-			return const_iterator{ map_.cend() };
+			return const_iterator{ elems().cend() };
 		}
 
-		TOML_PURE_INLINE_GETTER
-		const_iterator cend() const noexcept
+		TOML_NODISCARD
+		const_iterator cend() const
 		{
-			return const_iterator{ map_.cend() };
+			return const_iterator{ elems().cend() };
 		}
 
 	  private:
 
-		template <typename T, typename Table>
-		using for_each_value_ref = impl::copy_cvref<impl::wrap_node<impl::remove_cvref<impl::unwrap_node<T>>>, Table>;
+		template <typename T, typename Array>
+		using for_each_elem_ref = impl::copy_cvref<impl::wrap_node<impl::remove_cvref<impl::unwrap_node<T>>>, Array>;
 
-		template <typename Func, typename Table, typename T>
-		using can_for_each = std::disjunction<std::is_invocable<Func, const key&, for_each_value_ref<T, Table>>, //
-											  std::is_invocable<Func, for_each_value_ref<T, Table>>>;
+		template <typename Func, typename Array, typename T>
+		using can_for_each = std::disjunction<std::is_invocable<Func, for_each_elem_ref<T, Array>, size_t>,
+											  std::is_invocable<Func, size_t, for_each_elem_ref<T, Array>>,
+											  std::is_invocable<Func, for_each_elem_ref<T, Array>>>;
 
-		template <typename Func, typename Table, typename T>
+		template <typename Func, typename Array, typename T>
 		using can_for_each_nothrow = std::conditional_t<
 			// first form
-			std::is_invocable_v<Func, const key&, for_each_value_ref<T, Table>>,
-			std::is_nothrow_invocable<Func, const key&, for_each_value_ref<T, Table>>,
+			std::is_invocable_v<Func, for_each_elem_ref<T, Array>, size_t>,
+			std::is_nothrow_invocable<Func, for_each_elem_ref<T, Array>, size_t>,
 			std::conditional_t<
 				// second form
-				std::is_invocable_v<Func, for_each_value_ref<T, Table>>,
-				std::is_nothrow_invocable<Func, for_each_value_ref<T, Table>>,
-				std::false_type>>;
-
-		template <typename Func, typename Table>
-		using can_for_each_any = std::disjunction<can_for_each<Func, Table, table>,
-												  can_for_each<Func, Table, array>,
-												  can_for_each<Func, Table, std::string>,
-												  can_for_each<Func, Table, int64_t>,
-												  can_for_each<Func, Table, double>,
-												  can_for_each<Func, Table, bool>,
-												  can_for_each<Func, Table, date>,
-												  can_for_each<Func, Table, time>,
-												  can_for_each<Func, Table, date_time>>;
+				std::is_invocable_v<Func, size_t, for_each_elem_ref<T, Array>>,
+				std::is_nothrow_invocable<Func, size_t, for_each_elem_ref<T, Array>>,
+				std::conditional_t<
+					// third form
+					std::is_invocable_v<Func, for_each_elem_ref<T, Array>>,
+					std::is_nothrow_invocable<Func, for_each_elem_ref<T, Array>>,
+					std::false_type>>>;
 
-		template <typename Func, typename Table, typename T>
-		using for_each_is_nothrow_one = std::disjunction<std::negation<can_for_each<Func, Table, T>>, //
-														 can_for_each_nothrow<Func, Table, T>>;
+		template <typename Func, typename Array>
+		using can_for_each_any = std::disjunction<can_for_each<Func, Array, table>,
+												  can_for_each<Func, Array, array>,
+												  can_for_each<Func, Array, std::string>,
+												  can_for_each<Func, Array, int64_t>,
+												  can_for_each<Func, Array, double>,
+												  can_for_each<Func, Array, bool>,
+												  can_for_each<Func, Array, date>,
+												  can_for_each<Func, Array, time>,
+												  can_for_each<Func, Array, date_time>>;
 
-		template <typename Func, typename Table>
-		using for_each_is_nothrow = std::conjunction<for_each_is_nothrow_one<Func, Table, table>,
-													 for_each_is_nothrow_one<Func, Table, array>,
-													 for_each_is_nothrow_one<Func, Table, std::string>,
-													 for_each_is_nothrow_one<Func, Table, int64_t>,
-													 for_each_is_nothrow_one<Func, Table, double>,
-													 for_each_is_nothrow_one<Func, Table, bool>,
-													 for_each_is_nothrow_one<Func, Table, date>,
-													 for_each_is_nothrow_one<Func, Table, time>,
-													 for_each_is_nothrow_one<Func, Table, date_time>>;
+		template <typename Func, typename Array, typename T>
+		using for_each_is_nothrow_one = std::disjunction<std::negation<can_for_each<Func, Array, T>>, //
+														 can_for_each_nothrow<Func, Array, T>>;
 
-		template <typename Func, typename Table>
-		static void do_for_each(Func&& visitor, Table&& tbl) //
-			noexcept(for_each_is_nothrow<Func&&, Table&&>::value)
+		// (never noexcept: getting the elements of a packed array as nodes allocates)
+		template <typename Func, typename Array>
+		static void do_for_each(Func&& visitor, Array&& arr)
 		{
-			static_assert(can_for_each_any<Func&&, Table&&>::value,
-						  "TOML table for_each visitors must be invocable for at least one of the toml::node "
+			static_assert(can_for_each_any<Func&&, Array&&>::value,
+						  "TOML array for_each visitors must be invocable for at least one of the toml::node "
 						  "specializations:" TOML_SA_NODE_TYPE_LIST);
 
-			using kvp_type = impl::copy_cv<map_pair, std::remove_reference_t<Table>>;
-
-			for (kvp_type& kvp : tbl.map_)
+			for (size_t i = 0; i < arr.size(); i++)
 			{
-				using node_ref = impl::copy_cvref<toml::node, Table&&>;
+				using node_ref = impl::copy_cvref<toml::node, Array&&>;
 				static_assert(std::is_reference_v<node_ref>);
 
 #if TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN
 
 #ifndef TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED
-				static_assert(impl::always_false<Func, Table, kvp_type, node_ref>, //
+				static_assert(impl::always_false<Func, Array, node_ref>, //
 							  TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_MESSAGE);
 #endif
 
-				static_cast<node_ref>(*kvp.second)
+				static_cast<node_ref>(static_cast<Array&&>(arr)[i])
 					.visit(
-						[&]([[maybe_unused]] auto&& v) //
-						noexcept(for_each_is_nothrow_one<Func&&, Table&&, decltype(v)>::value)
+						[&]([[maybe_unused]] auto&& elem) //
+						noexcept(for_each_is_nothrow_one<Func&&, Array&&, decltype(elem)>::value)
 						{
-							using value_ref = for_each_value_ref<decltype(v), Table&&>;
-							static_assert(std::is_reference_v<value_ref>);
+							using elem_ref = for_each_elem_ref<decltype(elem), Array&&>;
+							static_assert(std::is_reference_v<elem_ref>);
 
-							// func(key, val)
-							if constexpr (std::is_invocable_v<Func&&, const key&, value_ref>)
+							// func(elem, i)
+							if constexpr (std::is_invocable_v<Func&&, elem_ref, size_t>)
 							{
-								static_cast<Func&&>(visitor)(static_cast<const key&>(kvp.first),
-															 static_cast<value_ref>(v));
+								static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i);
 							}
 
-							// func(val)
-							else if constexpr (std::is_invocable_v<Func&&, value_ref>)
+							// func(i, elem)
+							else if constexpr (std::is_invocable_v<Func&&, size_t, elem_ref>)
 							{
-								static_cast<Func&&>(visitor)(static_cast<value_ref>(v));
+								static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem));
+							}
+
+							// func(elem)
+							else if constexpr (std::is_invocable_v<Func&&, elem_ref>)
+							{
+								static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem));
 							}
 						});
 
 #else
 				const auto keep_going =
-					static_cast<node_ref>(*kvp.second)
+					static_cast<node_ref>(static_cast<Array&&>(arr)[i])
 						.visit(
-							[&]([[maybe_unused]] auto&& v) //
-							noexcept(for_each_is_nothrow_one<Func&&, Table&&, decltype(v)>::value)
+							[&]([[maybe_unused]] auto&& elem) //
+							noexcept(for_each_is_nothrow_one<Func&&, Array&&, decltype(elem)>::value)
 							{
-								using value_ref = for_each_value_ref<decltype(v), Table&&>;
-								static_assert(std::is_reference_v<value_ref>);
+								using elem_ref = for_each_elem_ref<decltype(elem), Array&&>;
+								static_assert(std::is_reference_v<elem_ref>);
 
-								// func(key, val)
-								if constexpr (std::is_invocable_v<Func&&, const key&, value_ref>)
+								// func(elem, i)
+								if constexpr (std::is_invocable_v<Func&&, elem_ref, size_t>)
 								{
-									using return_type = decltype(static_cast<Func&&>(
-										visitor)(static_cast<const key&>(kvp.first), static_cast<value_ref>(v)));
+									using return_type =
+										decltype(static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i));
 
 									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
 									{
-										return static_cast<bool>(static_cast<Func&&>(
-											visitor)(static_cast<const key&>(kvp.first), static_cast<value_ref>(v)));
+										return static_cast<bool>(
+											static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i));
 									}
 									else
 									{
-										static_cast<Func&&>(visitor)(static_cast<const key&>(kvp.first),
-																	 static_cast<value_ref>(v));
+										static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem), i);
 										return true;
 									}
 								}
 
-								// func(val)
-								else if constexpr (std::is_invocable_v<Func&&, value_ref>)
+								// func(i, elem)
+								else if constexpr (std::is_invocable_v<Func&&, size_t, elem_ref>)
 								{
 									using return_type =
-										decltype(static_cast<Func&&>(visitor)(static_cast<value_ref>(v)));
+										decltype(static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem)));
 
 									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
 									{
 										return static_cast<bool>(
-											static_cast<Func&&>(visitor)(static_cast<value_ref>(v)));
+											static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem)));
 									}
 									else
 									{
-										static_cast<Func&&>(visitor)(static_cast<value_ref>(v));
+										static_cast<Func&&>(visitor)(i, static_cast<elem_ref>(elem));
+										return true;
+									}
+								}
+
+								// func(elem)
+								else if constexpr (std::is_invocable_v<Func&&, elem_ref>)
+								{
+									using return_type =
+										decltype(static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem)));
+
+									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
+									{
+										return static_cast<bool>(
+											static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem)));
+									}
+									else
+									{
+										static_cast<Func&&>(visitor)(static_cast<elem_ref>(elem));
 										return true;
 									}
 								}
@@ -8169,452 +8717,355 @@ TOML_NAMESPACE_START
 	  public:
 
 		template <typename Func>
-		table& for_each(Func&& visitor) & //
-			noexcept(for_each_is_nothrow<Func&&, table&>::value)
+		array& for_each(Func&& visitor) &
 		{
 			do_for_each(static_cast<Func&&>(visitor), *this);
 			return *this;
 		}
 
 		template <typename Func>
-		table&& for_each(Func&& visitor) && //
-			noexcept(for_each_is_nothrow<Func&&, table&&>::value)
+		array&& for_each(Func&& visitor) &&
 		{
-			do_for_each(static_cast<Func&&>(visitor), static_cast<table&&>(*this));
-			return static_cast<table&&>(*this);
+			do_for_each(static_cast<Func&&>(visitor), static_cast<array&&>(*this));
+			return static_cast<array&&>(*this);
 		}
 
 		template <typename Func>
-		const table& for_each(Func&& visitor) const& //
-			noexcept(for_each_is_nothrow<Func&&, const table&>::value)
+		const array& for_each(Func&& visitor) const&
 		{
 			do_for_each(static_cast<Func&&>(visitor), *this);
 			return *this;
 		}
 
 		template <typename Func>
-		const table&& for_each(Func&& visitor) const&& //
-			noexcept(for_each_is_nothrow<Func&&, const table&&>::value)
+		const array&& for_each(Func&& visitor) const&&
 		{
-			do_for_each(static_cast<Func&&>(visitor), static_cast<const table&&>(*this));
-			return static_cast<const table&&>(*this);
+			do_for_each(static_cast<Func&&>(visitor), static_cast<const array&&>(*this));
+			return static_cast<const array&&>(*this);
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_NODISCARD
 		bool empty() const noexcept
 		{
-			return map_.empty();
+			const auto& c = contents();
+			return !c.packed_ && c.elems_.empty();
 		}
 
-		TOML_PURE_INLINE_GETTER
+		TOML_NODISCARD
 		size_t size() const noexcept
 		{
-			return map_.size();
-		}
-
-	  private:
-
-		TOML_PURE_GETTER
-		TOML_EXPORTED_MEMBER_FUNCTION
-		map_iterator get_lower_bound(std::string_view) noexcept;
-
-	  public:
-
-		TOML_PURE_GETTER
-		iterator lower_bound(std::string_view key) noexcept
-		{
-			return iterator{ get_lower_bound(key) };
+			const auto& c = contents();
+			return c.packed_ ? c.packed_->size() : c.elems_.size();
 		}
 
-		TOML_PURE_GETTER
-		const_iterator lower_bound(std::string_view key) const noexcept
+		TOML_NODISCARD
+		size_t max_size() const noexcept
 		{
-			return const_iterator{ const_cast<table&>(*this).get_lower_bound(key) };
+			return elems_.max_size();
 		}
 
-#if TOML_ENABLE_WINDOWS_COMPAT
-
 		TOML_NODISCARD
-		iterator lower_bound(std::wstring_view key)
+		size_t capacity() const noexcept
 		{
-			if (empty())
-				return end();
-
-			return lower_bound(impl::narrow(key));
+			const auto& c = contents();
+			return c.packed_ ? c.packed_->size() : c.elems_.capacity();
 		}
 
 		TOML_NODISCARD
-		const_iterator lower_bound(std::wstring_view key) const
+		const impl::packed_array* packed() const noexcept
 		{
-			if (empty())
-				return end();
-
-			return lower_bound(impl::narrow(key));
+			return contents().packed_.get();
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
-
-		TOML_PURE_GETTER
+		// stores the elements packed if they allow it (the parser does this for every array), returning whether they
+		// are.
 		TOML_EXPORTED_MEMBER_FUNCTION
-		iterator find(std::string_view key) noexcept;
+		bool pack();
 
-		TOML_PURE_GETTER
+		// makes copies of the array share its elements until one of them is modified (see table::freeze()).
 		TOML_EXPORTED_MEMBER_FUNCTION
-		const_iterator find(std::string_view key) const noexcept;
-
-		TOML_PURE_GETTER
-		bool contains(std::string_view key) const noexcept
-		{
-			return get(key) != nullptr;
-		}
-
-#if TOML_ENABLE_WINDOWS_COMPAT
-
-		TOML_NODISCARD
-		iterator find(std::wstring_view key)
-		{
-			if (empty())
-				return end();
-
-			return find(impl::narrow(key));
-		}
-
-		TOML_NODISCARD
-		const_iterator find(std::wstring_view key) const
-		{
-			return find(impl::narrow(key));
-		}
+		void freeze();
 
-		TOML_NODISCARD
-		bool contains(std::wstring_view key) const
+		// whether the array's elements are frozen, and shared with its copies rather than its own.
+		TOML_PURE_INLINE_GETTER
+		bool frozen() const noexcept
 		{
-			return contains(impl::narrow(key));
+			return frozen_ != nullptr;
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
-
-	  private:
-
 		TOML_EXPORTED_MEMBER_FUNCTION
-		map_iterator erase(const_map_iterator) noexcept;
+		void reserve(size_t new_capacity);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		map_iterator erase(const_map_iterator, const_map_iterator) noexcept;
+		void shrink_to_fit();
 
-	  public:
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void truncate(size_t new_size);
 
-		iterator erase(iterator pos) noexcept
+		template <typename ElemType>
+		void resize(size_t new_size,
+					ElemType&& default_init_val,
+					value_flags default_init_flags = preserve_source_value_flags)
 		{
-			return iterator{ erase(const_map_iterator{ pos }) };
-		}
+			static_assert(!is_node_view<ElemType>,
+						  "The default element type argument to toml::array::resize may not be toml::node_view.");
 
-		iterator erase(const_iterator pos) noexcept
-		{
-			return iterator{ erase(const_map_iterator{ pos }) };
+			if (!new_size)
+				clear();
+			else if (new_size > size())
+				insert(cend(), new_size - size(), static_cast<ElemType&&>(default_init_val), default_init_flags);
+			else
+				truncate(new_size);
 		}
 
-		iterator erase(const_iterator begin, const_iterator end) noexcept
-		{
-			return iterator{ erase(const_map_iterator{ begin }, const_map_iterator{ end }) };
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		iterator erase(const_iterator pos);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		size_t erase(std::string_view key) noexcept;
+		iterator erase(const_iterator first, const_iterator last);
 
-#if TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		array& flatten() &;
 
-		size_t erase(std::wstring_view key)
+		array&& flatten() &&
 		{
-			if (empty())
-				return false;
-
-			return erase(impl::narrow(key));
+			return static_cast<toml::array&&>(this->flatten());
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
-
 		TOML_EXPORTED_MEMBER_FUNCTION
-		table& prune(bool recursive = true) & noexcept;
+		array& prune(bool recursive = true) &;
 
-		table&& prune(bool recursive = true) && noexcept
+		array&& prune(bool recursive = true) &&
 		{
-			return static_cast<toml::table&&>(this->prune(recursive));
+			return static_cast<toml::array&&>(this->prune(recursive));
 		}
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		void clear() noexcept;
-
-	  private:
+		void pop_back();
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		map_iterator insert_with_hint(const_iterator, key&&, impl::node_ptr&&);
-
-	  public:
+		void clear() noexcept;
 
-		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
-								  typename ValueType = void,
-								  typename KeyType,
-								  typename... ValueArgs)
-		iterator emplace_hint(const_iterator hint, KeyType&& key, ValueArgs&&... args)
+		template <typename ElemType>
+		iterator insert(const_iterator pos, ElemType&& val, value_flags flags = preserve_source_value_flags)
 		{
-			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
-						  "Emplacement using wide-character keys is only supported on Windows with "
-						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
-
-			using raw_value_type = impl::remove_cvref<ValueType>;
-			using value_type	 = std::
-				conditional_t<std::is_void_v<raw_value_type>, impl::emplaced_type_of<ValueArgs&&...>, raw_value_type>;
-
-			if constexpr (impl::is_wide_string<KeyType>)
-			{
-#if TOML_ENABLE_WINDOWS_COMPAT
-				return emplace_hint<value_type>(hint,
-												impl::narrow(static_cast<KeyType&&>(key)),
-												static_cast<ValueArgs&&>(args)...);
-#else
-				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
-#endif
-			}
-			else
+			if constexpr (is_node_view<ElemType>)
 			{
-				static constexpr auto moving_node_ptr = std::is_same_v<value_type, impl::node_ptr> //
-													 && sizeof...(ValueArgs) == 1u				   //
-													 && impl::first_is_same<impl::node_ptr&&, ValueArgs&&...>;
-				using unwrapped_type = impl::remove_cvref<impl::unwrap_node<value_type>>;
-
-				static_assert(moving_node_ptr										//
-								  || impl::is_native<unwrapped_type>				//
-								  || impl::is_one_of<unwrapped_type, table, array>, //
-							  "ValueType argument of table::emplace_hint() must be one "
-							  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
-
-				map_iterator ipos = insert_with_hint(hint, toml::key{ static_cast<KeyType&&>(key) }, nullptr);
-
-				// if second is nullptr then we successully claimed the key and inserted the empty sentinel,
-				// so now we have to construct the actual value
-				if (!ipos->second)
-				{
-					if constexpr (moving_node_ptr)
-						ipos->second = std::move(static_cast<ValueArgs&&>(args)...);
-					else
-					{
-#if TOML_COMPILER_HAS_EXCEPTIONS
-						try
-						{
-#endif
-							ipos->second.reset(
-								new impl::wrap_node<unwrapped_type>{ static_cast<ValueArgs&&>(args)... });
-#if TOML_COMPILER_HAS_EXCEPTIONS
-						}
-						catch (...)
-						{
-							erase(const_map_iterator{ ipos }); // strong exception guarantee
-							throw;
-						}
-#endif
-					}
-				}
-				return iterator{ ipos };
+				if (!val)
+					return end();
 			}
+			return iterator{ insert_at(const_vector_iterator{ pos },
+									   impl::make_node(static_cast<ElemType&&>(val), flags)) };
 		}
 
-		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
-								  typename KeyType,
-								  typename ValueType)
-		std::pair<iterator, bool> insert(KeyType&& key,
-										 ValueType&& val,
-										 value_flags flags = preserve_source_value_flags)
+		template <typename ElemType>
+		iterator insert(const_iterator pos,
+						size_t count,
+						ElemType&& val,
+						value_flags flags = preserve_source_value_flags)
 		{
-			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
-						  "Insertion using wide-character keys is only supported on Windows with "
-						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
-
-			if constexpr (is_node_view<ValueType>)
+			if constexpr (is_node_view<ElemType>)
 			{
 				if (!val)
-					return { end(), false };
-			}
-
-			if constexpr (impl::is_wide_string<KeyType>)
-			{
-#if TOML_ENABLE_WINDOWS_COMPAT
-				return insert(impl::narrow(static_cast<KeyType&&>(key)), static_cast<ValueType&&>(val), flags);
-#else
-				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
-#endif
+					return end();
 			}
-			else
+			switch (count)
 			{
-				const auto key_view = std::string_view{ key };
-				map_iterator ipos	= get_lower_bound(key_view);
-				if (ipos == map_.end() || ipos->first != key_view)
+				case 0: return iterator{ thaw(const_vector_iterator{ pos }) };
+				case 1: return insert(pos, static_cast<ElemType&&>(val), flags);
+				default:
 				{
-					ipos = insert_with_hint(const_iterator{ ipos },
-											toml::key{ static_cast<KeyType&&>(key) },
-											impl::make_node(static_cast<ValueType&&>(val), flags));
-					return { iterator{ ipos }, true };
+					const auto start_idx = index_of(const_vector_iterator{ pos });
+					preinsertion_resize(start_idx, count);
+					size_t i = start_idx;
+					for (size_t e = start_idx + count - 1u; i < e; i++)
+						elems()[i] = impl::make_node(val, flags);
+
+					elems()[i] = impl::make_node(static_cast<ElemType&&>(val), flags);
+					return iterator{ elems().begin() + static_cast<ptrdiff_t>(start_idx) };
 				}
-				return { iterator{ ipos }, false };
 			}
 		}
 
-		TOML_CONSTRAINED_TEMPLATE((!is_key_or_convertible<Iter> && !impl::is_wide_string<Iter>), typename Iter)
-		void insert(Iter begin, Iter end, value_flags flags = preserve_source_value_flags)
+		template <typename Iter>
+		iterator insert(const_iterator pos, Iter first, Iter last, value_flags flags = preserve_source_value_flags)
 		{
-			if (begin == end)
-				return;
-			for (auto it = begin; it != end; it++)
+			const auto distance = std::distance(first, last);
+			if (distance <= 0)
+				return iterator{ thaw(const_vector_iterator{ pos }) };
+			else
 			{
-				if constexpr (std::is_rvalue_reference_v<decltype(*it)>)
-					insert(std::move((*it).first), std::move((*it).second), flags);
-				else
-					insert((*it).first, (*it).second, flags);
+				auto count		 = distance;
+				using deref_type = decltype(*first);
+				if constexpr (is_node_view<deref_type>)
+				{
+					for (auto it = first; it != last; it++)
+						if (!(*it))
+							count--;
+					if (!count)
+						return iterator{ thaw(const_vector_iterator{ pos }) };
+				}
+				const auto start_idx = index_of(const_vector_iterator{ pos });
+				preinsertion_resize(start_idx, static_cast<size_t>(count));
+				size_t i = start_idx;
+				for (auto it = first; it != last; it++)
+				{
+					if constexpr (is_node_view<deref_type>)
+					{
+						if (!(*it))
+							continue;
+					}
+					if constexpr (std::is_rvalue_reference_v<deref_type>)
+						elems()[i++] = impl::make_node(std::move(*it), flags);
+					else
+						elems()[i++] = impl::make_node(*it, flags);
+				}
+				return iterator{ elems().begin() + static_cast<ptrdiff_t>(start_idx) };
 			}
 		}
 
-		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
-								  typename KeyType,
-								  typename ValueType)
-		std::pair<iterator, bool> insert_or_assign(KeyType&& key,
-												   ValueType&& val,
-												   value_flags flags = preserve_source_value_flags)
+		template <typename ElemType>
+		iterator insert(const_iterator pos,
+						std::initializer_list<ElemType> ilist,
+						value_flags flags = preserve_source_value_flags)
 		{
-			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
-						  "Insertion using wide-character keys is only supported on Windows with "
-						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+			return insert(pos, ilist.begin(), ilist.end(), flags);
+		}
 
-			if constexpr (is_node_view<ValueType>)
+		template <typename ElemType = void, typename... Args>
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			using raw_elem_type = impl::remove_cvref<ElemType>;
+			using elem_type		= std::conditional_t<std::is_void_v<raw_elem_type>, //
+												 impl::emplaced_type_of<Args&&...>,
+												 raw_elem_type>;
+
+			using type = impl::remove_cvref<impl::unwrap_node<elem_type>>;
+			static_assert(impl::is_native<type> || impl::is_one_of<type, table, array>,
+						  "Emplacement type parameter must be one of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+
+			return iterator{ insert_at(const_vector_iterator{ pos },
+									   impl::node_ptr{ new impl::wrap_node<type>{ static_cast<Args&&>(args)... } }) };
+		}
+
+		template <typename ElemType>
+		iterator replace(const_iterator pos, ElemType&& val, value_flags flags = preserve_source_value_flags)
+		{
+			TOML_ASSERT(pos >= cbegin() && pos < cend());
+
+			if constexpr (is_node_view<ElemType>)
 			{
 				if (!val)
-					return { end(), false };
+					return end();
 			}
 
-			if constexpr (impl::is_wide_string<KeyType>)
-			{
-#if TOML_ENABLE_WINDOWS_COMPAT
-				return insert_or_assign(impl::narrow(static_cast<KeyType&&>(key)),
-										static_cast<ValueType&&>(val),
-										flags);
-#else
-				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
-#endif
-			}
-			else
-			{
-				const auto key_view = std::string_view{ key };
-				map_iterator ipos	= get_lower_bound(key_view);
-				if (ipos == map_.end() || ipos->first != key_view)
-				{
-					ipos = insert_with_hint(const_iterator{ ipos },
-											toml::key{ static_cast<KeyType&&>(key) },
-											impl::make_node(static_cast<ValueType&&>(val), flags));
-					return { iterator{ ipos }, true };
-				}
-				else
-				{
-					(*ipos).second = impl::make_node(static_cast<ValueType&&>(val), flags);
-					return { iterator{ ipos }, false };
-				}
-			}
+			const auto it = thaw(const_vector_iterator{ pos });
+			*it			  = impl::make_node(static_cast<ElemType&&>(val), flags);
+			return iterator{ it };
 		}
 
-		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
-								  typename ValueType = void,
-								  typename KeyType,
-								  typename... ValueArgs)
-		std::pair<iterator, bool> emplace(KeyType&& key, ValueArgs&&... args)
+		template <typename ElemType>
+		void push_back(ElemType&& val, value_flags flags = preserve_source_value_flags)
 		{
-			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
-						  "Emplacement using wide-character keys is only supported on Windows with "
-						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+			emplace_back_if_not_empty_view(static_cast<ElemType&&>(val), flags);
+		}
 
-			using raw_value_type = impl::remove_cvref<ValueType>;
-			using value_type	 = std::
-				conditional_t<std::is_void_v<raw_value_type>, impl::emplaced_type_of<ValueArgs&&...>, raw_value_type>;
+		template <typename ElemType = void, typename... Args>
+		decltype(auto) emplace_back(Args&&... args)
+		{
+			using raw_elem_type = impl::remove_cvref<ElemType>;
+			using elem_type		= std::conditional_t<std::is_void_v<raw_elem_type>, //
+												 impl::emplaced_type_of<Args&&...>,
+												 raw_elem_type>;
 
-			if constexpr (impl::is_wide_string<KeyType>)
+			static constexpr auto moving_node_ptr = std::is_same_v<elem_type, impl::node_ptr> //
+												 && sizeof...(Args) == 1u					  //
+												 && impl::first_is_same<impl::node_ptr&&, Args&&...>;
+
+			using unwrapped_type = impl::remove_cvref<impl::unwrap_node<elem_type>>;
+
+			static_assert(
+				moving_node_ptr										  //
+					|| impl::is_native<unwrapped_type>				  //
+					|| impl::is_one_of<unwrapped_type, table, array>, //
+				"ElemType argument of array::emplace_back() must be one of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+
+			if constexpr (moving_node_ptr)
 			{
-#if TOML_ENABLE_WINDOWS_COMPAT
-				return emplace<value_type>(impl::narrow(static_cast<KeyType&&>(key)),
-										   static_cast<ValueArgs&&>(args)...);
-#else
-				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
-#endif
+				insert_at_back(static_cast<Args&&>(args)...);
+				return *elems().back();
 			}
 			else
 			{
-				using unwrapped_type = impl::remove_cvref<impl::unwrap_node<value_type>>;
-				static_assert((impl::is_native<unwrapped_type> || impl::is_one_of<unwrapped_type, table, array>),
-							  "ValueType argument of table::emplace() must be one "
-							  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
-
-				const auto key_view = std::string_view{ key };
-				auto ipos			= get_lower_bound(key_view);
-				if (ipos == map_.end() || ipos->first != key_view)
-				{
-					ipos = insert_with_hint(
-						const_iterator{ ipos },
-						toml::key{ static_cast<KeyType&&>(key) },
-						impl::node_ptr{ new impl::wrap_node<unwrapped_type>{ static_cast<ValueArgs&&>(args)... } });
-					return { iterator{ ipos }, true };
-				}
-				return { iterator{ ipos }, false };
+				auto ptr = new impl::wrap_node<unwrapped_type>{ static_cast<Args&&>(args)... };
+				insert_at_back(impl::node_ptr{ ptr });
+				return *ptr;
 			}
 		}
 
-		using node::operator[]; // inherit operator[toml::path]
+	  private:
 
 		TOML_NODISCARD
-		node_view<node> operator[](std::string_view key) noexcept
-		{
-			return node_view<node>{ get(key) };
-		}
+		TOML_EXPORTED_STATIC_FUNCTION
+		static bool TOML_CALLCONV equal(const array&, const array&);
 
+		template <typename T>
 		TOML_NODISCARD
-		node_view<const node> operator[](std::string_view key) const noexcept
+		static bool equal_to_container(const array& lhs, const T& rhs)
 		{
-			return node_view<const node>{ get(key) };
+			using element_type = std::remove_const_t<typename T::value_type>;
+			static_assert(impl::is_losslessly_convertible_to_native<element_type>,
+						  "Container element type must be losslessly convertible one of the native TOML value types");
+
+			if (lhs.size() != rhs.size())
+				return false;
+			if (rhs.size() == 0u)
+				return true;
+
+			size_t i{};
+			for (auto& list_elem : rhs)
+			{
+				const auto elem = lhs.get_as<impl::native_type_of<element_type>>(i++);
+				if (!elem || *elem != list_elem)
+					return false;
+			}
+
+			return true;
 		}
 
-#if TOML_ENABLE_WINDOWS_COMPAT
+	  public:
 
 		TOML_NODISCARD
-		node_view<node> operator[](std::wstring_view key)
+		friend bool operator==(const array& lhs, const array& rhs)
 		{
-			return node_view<node>{ get(key) };
+			return equal(lhs, rhs);
 		}
 
 		TOML_NODISCARD
-		node_view<const node> operator[](std::wstring_view key) const
+		friend bool operator!=(const array& lhs, const array& rhs)
 		{
-			return node_view<const node>{ get(key) };
+			return !equal(lhs, rhs);
 		}
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
-
-	  private:
-
-		TOML_PURE_GETTER
-		TOML_EXPORTED_STATIC_FUNCTION
-		static bool TOML_CALLCONV equal(const table&, const table&) noexcept;
-
-	  public:
-
+		template <typename T>
 		TOML_NODISCARD
-		friend bool operator==(const table& lhs, const table& rhs) noexcept
+		friend bool operator==(const array& lhs, const std::initializer_list<T>& rhs)
 		{
-			return equal(lhs, rhs);
+			return equal_to_container(lhs, rhs);
 		}
+		TOML_ASYMMETRICAL_EQUALITY_OPS(const array&, const std::initializer_list<T>&, template <typename T>);
 
+		template <typename T>
 		TOML_NODISCARD
-		friend bool operator!=(const table& lhs, const table& rhs) noexcept
+		friend bool operator==(const array& lhs, const std::vector<T>& rhs)
 		{
-			return !equal(lhs, rhs);
+			return equal_to_container(lhs, rhs);
 		}
+		TOML_ASYMMETRICAL_EQUALITY_OPS(const array&, const std::vector<T>&, template <typename T>);
 
 #if TOML_ENABLE_FORMATTERS
 
-		friend std::ostream& operator<<(std::ostream& lhs, const table& rhs)
+		friend std::ostream& operator<<(std::ostream& lhs, const array& rhs)
 		{
 			impl::print_to_stream(lhs, rhs);
 			return lhs;
@@ -8625,6 +9076,19 @@ TOML_NAMESPACE_START
 }
 TOML_NAMESPACE_END;
 
+TOML_IMPL_NAMESPACE_START
+{
+	// calls func with the element at index as a const node&, without creating nodes for packed arrays.
+	template <typename Func>
+	decltype(auto) visit_array_element(const array& arr, size_t index, Func&& func)
+	{
+		if (auto packed = arr.packed())
+			return packed->visit(index, static_cast<Func&&>(func));
+		return static_cast<Func&&>(func)(arr[index]);
+	}
+}
+TOML_IMPL_NAMESPACE_END;
+
 #ifdef _MSC_VER
 #pragma pop_macro("min")
 #pragma pop_macro("max")
@@ -8634,7 +9098,14 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-//********  impl/unicode_autogenerated.hpp  ****************************************************************************
+//********  impl/std_map.hpp  ******************************************************************************************
+
+TOML_DISABLE_WARNINGS;
+#include <map>
+#include <iterator>
+TOML_ENABLE_WARNINGS;
+
+//********  impl/table.hpp  ********************************************************************************************
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -8647,27 +9118,2084 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-#if TOML_GCC && TOML_GCC < 9
-#pragma GCC push_options
-#pragma GCC optimize("O1") // codegen bugs
-#endif
-
-// the functions in this namespace block are automatically generated by a tool - they are not meant to be hand-edited
-
 TOML_IMPL_NAMESPACE_START
 {
-	TOML_CONST_GETTER
-	constexpr bool is_ascii_horizontal_whitespace(char32_t c) noexcept
-	{
-		return c == U'\t' || c == U' ';
-	}
-
-	TOML_CONST_GETTER
-	constexpr bool is_non_ascii_horizontal_whitespace(char32_t c) noexcept
+	template <bool IsConst>
+	struct table_proxy_pair
 	{
-		// 20 code units from 8 ranges (spanning a search area of 65120)
+		using value_type = std::conditional_t<IsConst, const node, node>;
 
-		if (c < U'\xA0' || c > U'\uFEFF')
+		const toml::key& first;
+		value_type& second;
+	};
+
+	using map_storage = std::map<toml::key, node_ptr, std::less<>, allocator<std::pair<const toml::key, node_ptr>>>;
+
+	// an open-addressing (linear probing) hash index over a table's map, so lookups in wide tables don't have to
+	// walk the tree comparing strings. map iterators stay valid while other elements are inserted and erased, so
+	// the index can hold them directly; the map remains the storage, which keeps iteration (and therefore
+	// serialization) in key order.
+	class table_index
+	{
+	  private:
+		struct slot
+		{
+			size_t hash; // 0 marks an empty slot
+			map_storage::iterator it;
+		};
+		std::vector<slot, allocator<slot>> slots_;
+		size_t count_ = {};
+
+		void grow()
+		{
+			std::vector<slot, allocator<slot>> old(slots_.empty() ? size_t{ 32u } : slots_.size() * 2u);
+			old.swap(slots_);
+			const size_t mask = slots_.size() - 1u;
+			for (const auto& s : old)
+			{
+				if (!s.hash)
+					continue;
+				size_t i = s.hash & mask;
+				while (slots_[i].hash)
+					i = (i + 1u) & mask;
+				slots_[i] = s;
+			}
+		}
+
+	  public:
+		TOML_NODISCARD
+		static void* operator new(size_t size)
+		{
+			return impl::allocate(size);
+		}
+
+		static void operator delete(void* ptr, size_t size) noexcept
+		{
+			impl::deallocate(ptr, size);
+		}
+
+		TOML_PURE_INLINE_GETTER
+		static size_t hash(std::string_view key) noexcept
+		{
+			return key_hash(key);
+		}
+
+		TOML_PURE_INLINE_GETTER
+		static size_t hash(const toml::key& key) noexcept
+		{
+			return key.hash();
+		}
+
+		TOML_NODISCARD_CTOR
+		explicit table_index(map_storage& map)
+		{
+			for (auto it = map.begin(), e = map.end(); it != e; it++)
+				insert(it);
+		}
+
+		TOML_PURE_GETTER
+		const map_storage::iterator* find(std::string_view key) const noexcept
+		{
+			const size_t h	  = hash(key);
+			const size_t mask = slots_.size() - 1u;
+			for (size_t i = h & mask; slots_[i].hash; i = (i + 1u) & mask)
+				if (slots_[i].hash == h && std::string_view{ slots_[i].it->first } == key)
+					return &slots_[i].it;
+			return nullptr;
+		}
+
+		void insert(map_storage::iterator it)
+		{
+			if ((count_ + 1u) * 2u > slots_.size())
+				grow();
+
+			const size_t h	  = hash(it->first);
+			const size_t mask = slots_.size() - 1u;
+			size_t i		  = h & mask;
+			while (slots_[i].hash)
+				i = (i + 1u) & mask;
+			slots_[i] = { h, it };
+			count_++;
+		}
+
+		void erase(map_storage::const_iterator it) noexcept
+		{
+			const size_t mask = slots_.size() - 1u;
+			size_t i		  = hash(it->first) & mask;
+			while (slots_[i].it != it || !slots_[i].hash)
+				i = (i + 1u) & mask;
+
+			// backward-shift deletion; no tombstones, so probe sequences never get longer than they need to be
+			for (size_t j = (i + 1u) & mask; slots_[j].hash; j = (j + 1u) & mask)
+			{
+				const size_t home = slots_[j].hash & mask;
+				const bool stays  = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+				if (!stays)
+				{
+					slots_[i] = slots_[j];
+					i		  = j;
+				}
+			}
+			slots_[i].hash = 0;
+			count_--;
+		}
+	};
+
+	using table_storage_pair = std::pair<const toml::key, node_ptr>;
+
+	template <bool IsConst>
+	class table_storage_iterator
+	{
+	  private:
+		template <bool>
+		friend class table_storage_iterator;
+		friend class table_storage;
+
+		using pair_type		= std::conditional_t<IsConst, const table_storage_pair, table_storage_pair>;
+		using tree_iterator = std::conditional_t<IsConst, map_storage::const_iterator, map_storage::iterator>;
+
+		pair_type* flat_ = {};
+		tree_iterator tree_{};
+		bool is_tree_ = false;
+
+	  public:
+		using value_type		= table_storage_pair;
+		using reference			= pair_type&;
+		using pointer			= pair_type*;
+		using difference_type	= ptrdiff_t;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		TOML_NODISCARD_CTOR
+		table_storage_iterator() noexcept = default;
+
+		TOML_NODISCARD_CTOR
+		explicit table_storage_iterator(pair_type* flat) noexcept //
+			: flat_{ flat }
+		{}
+
+		TOML_NODISCARD_CTOR
+		explicit table_storage_iterator(tree_iterator tree) noexcept //
+			: tree_{ tree },
+			  is_tree_{ true }
+		{}
+
+		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
+		TOML_NODISCARD_CTOR
+		table_storage_iterator(const table_storage_iterator<false>& other) noexcept //
+			: flat_{ other.flat_ },
+			  tree_{ other.tree_ },
+			  is_tree_{ other.is_tree_ }
+		{}
+
+		table_storage_iterator& operator++() noexcept // ++pre
+		{
+			if (is_tree_)
+				++tree_;
+			else
+				++flat_;
+			return *this;
+		}
+
+		table_storage_iterator operator++(int) noexcept // post++
+		{
+			table_storage_iterator out{ *this };
+			++(*this);
+			return out;
+		}
+
+		table_storage_iterator& operator--() noexcept // --pre
+		{
+			if (is_tree_)
+				--tree_;
+			else
+				--flat_;
+			return *this;
+		}
+
+		table_storage_iterator operator--(int) noexcept // post--
+		{
+			table_storage_iterator out{ *this };
+			--(*this);
+			return out;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		reference operator*() const noexcept
+		{
+			return is_tree_ ? *tree_ : *flat_;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		pointer operator->() const noexcept
+		{
+			return &(**this);
+		}
+
+		TOML_PURE_INLINE_GETTER
+		friend bool operator==(const table_storage_iterator& lhs, const table_storage_iterator& rhs) noexcept
+		{
+			return lhs.is_tree_ ? lhs.tree_ == rhs.tree_ : lhs.flat_ == rhs.flat_;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		friend bool operator!=(const table_storage_iterator& lhs, const table_storage_iterator& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+	};
+
+	// a table's key-value storage. small tables (the overwhelming majority: [server], [tls], inline tables in
+	// arrays...) keep their entries sorted in a single flat allocation that is searched linearly; once a table
+	// grows past TOML_TABLE_SMALL_SIZE entries it's promoted to a map (plus a hash index once it gets really wide).
+	// either way iteration is in key order. unlike the map, inserting into or erasing from a small table
+	// invalidates iterators to its other entries.
+	class table_storage
+	{
+	  public:
+		using value_type	 = table_storage_pair;
+		using iterator		 = table_storage_iterator<false>;
+		using const_iterator = table_storage_iterator<true>;
+
+	  private:
+		struct tree
+		{
+			map_storage map;
+			std::unique_ptr<table_index> index;
+
+			TOML_NODISCARD
+			static void* operator new(size_t size)
+			{
+				return impl::allocate(size);
+			}
+
+			static void operator delete(void* ptr, size_t size) noexcept
+			{
+				impl::deallocate(ptr, size);
+			}
+		};
+
+		value_type* flat_ = {};
+		size_t size_	  = {}; // flat entries only
+		size_t capacity_  = {};
+		std::unique_ptr<tree> tree_;
+		impl::frozen<table_storage>* frozen_ = {}; // when set, the entries are in there instead (see freeze())
+
+		// the storage holding the entries: the frozen one while there is one, otherwise this one.
+		TOML_PURE_INLINE_GETTER
+		const table_storage& contents() const noexcept
+		{
+			return frozen_ ? frozen_->contents : *this;
+		}
+
+		// gives the storage entries of its own again: the frozen ones if nothing else refers to them, otherwise a
+		// copy of them. (defined below toml::table)
+		void thaw();
+
+		// thaws the entries, returning where `pos` (an iterator into the frozen ones) ends up.
+		iterator thaw(const_iterator pos)
+		{
+			const auto index = std::distance(cbegin(), pos);
+			thaw();
+			return std::next(begin(), index);
+		}
+
+		// moves an entry to uninitialized storage, leaving the source destroyed. the key has to be cast away from
+		// const to be moved rather than copied (the same thing std::map's node handles do).
+		static void relocate(value_type* dest, value_type* src) noexcept
+		{
+			::new (static_cast<void*>(dest))
+				value_type{ std::move(const_cast<toml::key&>(src->first)), std::move(src->second) };
+			src->~value_type();
+		}
+
+		void destroy_flat() noexcept
+		{
+			for (size_t i = size_; i-- > 0u;)
+				flat_[i].~value_type();
+			size_ = {};
+		}
+
+		void release_flat() noexcept
+		{
+			destroy_flat();
+			if (flat_)
+				impl::deallocate(flat_, capacity_ * sizeof(value_type));
+			flat_	  = {};
+			capacity_ = {};
+		}
+
+		TOML_PURE_GETTER
+		iterator lookup(std::string_view key) noexcept
+		{
+			if (!tree_)
+			{
+				for (size_t i = 0; i < size_; i++)
+					if (std::string_view{ flat_[i].first } == key)
+						return iterator{ flat_ + i };
+				return iterator{ flat_ + size_ };
+			}
+
+			if (tree_->index)
+			{
+				const auto it = tree_->index->find(key);
+				return iterator{ it ? *it : tree_->map.end() };
+			}
+			return iterator{ tree_->map.find(key) };
+		}
+
+		TOML_NODISCARD
+		iterator mutable_iterator(const_iterator it) noexcept
+		{
+			if (tree_)
+				return iterator{ tree_->map.erase(it.tree_, it.tree_) };
+			return iterator{ const_cast<value_type*>(it.flat_) };
+		}
+
+		void index_inserted(map_storage::iterator it)
+		{
+			if (tree_->index)
+				tree_->index->insert(it);
+			else if (TOML_TABLE_HASH_INDEX_THRESHOLD && tree_->map.size() >= TOML_TABLE_HASH_INDEX_THRESHOLD)
+				tree_->index.reset(new table_index{ tree_->map });
+		}
+
+		iterator emplace_tree(map_storage::const_iterator hint, toml::key&& key, node_ptr&& value)
+		{
+			const auto size = tree_->map.size();
+			const auto it	= tree_->map.emplace_hint(hint, std::move(key), std::move(value));
+			if (tree_->map.size() != size)
+				index_inserted(it);
+			return iterator{ it };
+		}
+
+		iterator promote(toml::key&& key, node_ptr&& value)
+		{
+			// the keys are copied rather than moved so the flat entries are still intact if this throws
+			auto t = std::unique_ptr<tree>{ new tree };
+			for (size_t i = 0; i < size_; i++)
+				t->map.emplace_hint(t->map.end(), flat_[i].first, nullptr);
+			auto it = t->map.begin();
+			for (size_t i = 0; i < size_; i++, it++)
+				it->second = std::move(flat_[i].second);
+
+			release_flat();
+			tree_ = std::move(t);
+			if (TOML_TABLE_HASH_INDEX_THRESHOLD && tree_->map.size() >= TOML_TABLE_HASH_INDEX_THRESHOLD)
+				tree_->index.reset(new table_index{ tree_->map });
+			return emplace_tree(tree_->map.end(), std::move(key), std::move(value));
+		}
+
+		iterator emplace_flat(size_t pos, toml::key&& key, node_ptr&& value)
+		{
+			if (size_ == TOML_TABLE_SMALL_SIZE)
+				return promote(std::move(key), std::move(value));
+
+			if (size_ == capacity_)
+			{
+				// grows by half rather than doubling; entries are large (keys carry their source region) and the
+				// slack adds up across many small tables
+				const size_t capacity =
+					(std::min)((std::max)(capacity_ + capacity_ / 2u, size_t{ 2u }), size_t{ TOML_TABLE_SMALL_SIZE });
+				auto buf = static_cast<value_type*>(impl::allocate(capacity * sizeof(value_type)));
+				for (size_t i = 0; i < pos; i++)
+					relocate(buf + i, flat_ + i);
+				for (size_t i = pos; i < size_; i++)
+					relocate(buf + i + 1u, flat_ + i);
+				if (flat_)
+					impl::deallocate(flat_, capacity_ * sizeof(value_type));
+				flat_	  = buf;
+				capacity_ = capacity;
+			}
+			else
+			{
+				for (size_t i = size_; i > pos; i--)
+					relocate(flat_ + i, flat_ + i - 1u);
+			}
+
+			::new (static_cast<void*>(flat_ + pos)) value_type{ std::move(key), std::move(value) };
+			size_++;
+			return iterator{ flat_ + pos };
+		}
+
+	  public:
+		TOML_NODISCARD_CTOR
+		table_storage() noexcept = default;
+
+		TOML_NODISCARD_CTOR
+		table_storage(table_storage&& other) noexcept //
+			: flat_{ std::exchange(other.flat_, nullptr) },
+			  size_{ std::exchange(other.size_, size_t{}) },
+			  capacity_{ std::exchange(other.capacity_, size_t{}) },
+			  tree_{ std::move(other.tree_) },
+			  frozen_{ std::exchange(other.frozen_, nullptr) }
+		{}
+
+		table_storage& operator=(table_storage&& rhs) noexcept
+		{
+			if (&rhs != this)
+			{
+				release_flat();
+				if (frozen_)
+					frozen_->release();
+				flat_	  = std::exchange(rhs.flat_, nullptr);
+				size_	  = std::exchange(rhs.size_, size_t{});
+				capacity_ = std::exchange(rhs.capacity_, size_t{});
+				tree_	  = std::move(rhs.tree_);
+				frozen_	  = std::exchange(rhs.frozen_, nullptr);
+			}
+			return *this;
+		}
+
+		table_storage(const table_storage&)			   = delete;
+		table_storage& operator=(const table_storage&) = delete;
+
+		~table_storage() noexcept
+		{
+			release_flat();
+			if (frozen_)
+				frozen_->release();
+		}
+
+		// moves the entries into frozen contents, which copies made with share() refer to as well. modifying the
+		// storage (or anything in it, which has to be reached through a non-const iterator) thaws it again.
+		void freeze()
+		{
+			if (frozen_)
+				return;
+			const auto f = new impl::frozen<table_storage>{};
+			f->contents	 = std::move(*this);
+			frozen_		 = f;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		bool frozen() const noexcept
+		{
+			return frozen_ != nullptr;
+		}
+
+		// where impl::hasher caches the hash of the frozen entries, or nullptr if they aren't frozen. storages that
+		// refer to the same frozen entries have the same one.
+		TOML_PURE_INLINE_GETTER
+		std::atomic<uint64_t>* cached_hash() const noexcept
+		{
+			return frozen_ ? &frozen_->hash : nullptr;
+		}
+
+		// whether the entries are frozen and another storage refers to them too.
+		TOML_PURE_INLINE_GETTER
+		bool shared() const noexcept
+		{
+			return frozen_ && frozen_->shared();
+		}
+
+		// a storage referring to the same frozen entries as this one.
+		TOML_NODISCARD
+		table_storage share() const noexcept
+		{
+			TOML_ASSERT(frozen_);
+			table_storage out;
+			out.frozen_ = frozen_->share();
+			return out;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return !size();
+		}
+
+		TOML_PURE_INLINE_GETTER
+		size_t size() const noexcept
+		{
+			const auto& c = contents();
+			return c.tree_ ? c.tree_->map.size() : c.size_;
+		}
+
+		TOML_NODISCARD
+		iterator begin()
+		{
+			if (frozen_)
+				thaw();
+			return tree_ ? iterator{ tree_->map.begin() } : iterator{ flat_ };
+		}
+
+		TOML_NODISCARD
+		iterator end()
+		{
+			if (frozen_)
+				thaw();
+			return tree_ ? iterator{ tree_->map.end() } : iterator{ flat_ + size_ };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator begin() const noexcept
+		{
+			const auto& c = contents();
+			return c.tree_ ? const_iterator{ c.tree_->map.cbegin() } : const_iterator{ c.flat_ };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator end() const noexcept
+		{
+			const auto& c = contents();
+			return c.tree_ ? const_iterator{ c.tree_->map.cend() } : const_iterator{ c.flat_ + c.size_ };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator cbegin() const noexcept
+		{
+			return begin();
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator cend() const noexcept
+		{
+			return end();
+		}
+
+		TOML_NODISCARD
+		iterator find(std::string_view key)
+		{
+			if (frozen_)
+				thaw();
+			return lookup(key);
+		}
+
+		TOML_PURE_GETTER
+		const_iterator find(std::string_view key) const noexcept
+		{
+			return const_cast<table_storage&>(contents()).lookup(key);
+		}
+
+		TOML_PURE_GETTER
+		const_iterator lower_bound(std::string_view key) const noexcept
+		{
+			return const_cast<table_storage&>(contents()).lower_bound(key);
+		}
+
+		TOML_NODISCARD
+		iterator lower_bound(std::string_view key)
+		{
+			if (frozen_)
+				thaw();
+			if (tree_)
+				return iterator{ tree_->map.lower_bound(key) };
+
+			size_t i = 0;
+			while (i < size_ && std::string_view{ flat_[i].first } < key)
+				i++;
+			return iterator{ flat_ + i };
+		}
+
+		// inserts {key, value} unless the key is already present, in which case the existing entry is returned.
+		// the hint only saves a search when it's the right position.
+		template <typename Key>
+		iterator emplace_hint(const_iterator hint, Key&& key, node_ptr&& value)
+		{
+			if (frozen_)
+				hint = thaw(hint);
+			if (tree_)
+				return emplace_tree(hint.tree_, toml::key{ static_cast<Key&&>(key) }, std::move(value));
+
+			toml::key k{ static_cast<Key&&>(key) };
+			const std::string_view kv{ k };
+
+			size_t pos = static_cast<size_t>(hint.flat_ - flat_);
+			if (!(pos == 0u || std::string_view{ flat_[pos - 1u].first } < kv)
+				|| !(pos == size_ || !(std::string_view{ flat_[pos].first } < kv)))
+				pos = static_cast<size_t>(lower_bound(kv).flat_ - flat_);
+
+			if (pos < size_ && std::string_view{ flat_[pos].first } == kv)
+				return iterator{ flat_ + pos };
+			return emplace_flat(pos, std::move(k), std::move(value));
+		}
+
+		// makes room for `count` entries up front (an empty table that will hold more than TOML_TABLE_SMALL_SIZE
+		// entries goes straight to a map).
+		void reserve(size_t count)
+		{
+			if (frozen_)
+				thaw();
+			if (tree_ || count <= capacity_)
+				return;
+
+			if (count > TOML_TABLE_SMALL_SIZE)
+			{
+				if (!size_)
+					tree_.reset(new tree);
+				return;
+			}
+
+			auto buf = static_cast<value_type*>(impl::allocate(count * sizeof(value_type)));
+			for (size_t i = 0; i < size_; i++)
+				relocate(buf + i, flat_ + i);
+			if (flat_)
+				impl::deallocate(flat_, capacity_ * sizeof(value_type));
+			flat_	  = buf;
+			capacity_ = count;
+		}
+
+		void insert_or_assign(toml::key&& key, node_ptr&& value)
+		{
+			auto it = lower_bound(key);
+			if (it != end() && it->first == key)
+				it->second = std::move(value);
+			else
+				emplace_hint(it, std::move(key), std::move(value));
+		}
+
+		iterator erase(const_iterator pos) noexcept
+		{
+			if (frozen_)
+				pos = thaw(pos);
+			if (tree_)
+			{
+				if (tree_->index)
+					tree_->index->erase(pos.tree_);
+				return iterator{ tree_->map.erase(pos.tree_) };
+			}
+
+			return erase(pos, std::next(pos));
+		}
+
+		iterator erase(const_iterator begin, const_iterator end) noexcept
+		{
+			if (frozen_)
+			{
+				const auto count = std::distance(begin, end);
+				begin			 = thaw(begin);
+				end				 = std::next(begin, count);
+			}
+			if (tree_)
+			{
+				if (tree_->index)
+					for (auto it = begin.tree_; it != end.tree_; it++)
+						tree_->index->erase(it);
+				return iterator{ tree_->map.erase(begin.tree_, end.tree_) };
+			}
+
+			const auto first = static_cast<size_t>(begin.flat_ - flat_);
+			const auto last	 = static_cast<size_t>(end.flat_ - flat_);
+			if (first == last)
+				return mutable_iterator(begin);
+
+			for (size_t i = first; i < last; i++)
+				flat_[i].~value_type();
+			for (size_t i = last; i < size_; i++)
+				relocate(flat_ + first + (i - last), flat_ + i);
+			size_ -= last - first;
+			return iterator{ flat_ + first };
+		}
+
+		void clear() noexcept
+		{
+			if (frozen_)
+				std::exchange(frozen_, nullptr)->release();
+			tree_.reset();
+			destroy_flat();
+		}
+	};
+
+	template <bool IsConst>
+	class table_iterator
+	{
+	  private:
+		template <bool>
+		friend class table_iterator;
+
+		using proxy_type		   = table_proxy_pair<IsConst>;
+		using mutable_map_iterator = table_storage::iterator;
+		using const_map_iterator   = table_storage::const_iterator;
+		using map_iterator		   = std::conditional_t<IsConst, const_map_iterator, mutable_map_iterator>;
+
+		mutable map_iterator iter_;
+		alignas(proxy_type) mutable unsigned char proxy_[sizeof(proxy_type)];
+		mutable bool proxy_instantiated_ = false;
+
+		TOML_NODISCARD
+		proxy_type* get_proxy() const noexcept
+		{
+			if (!proxy_instantiated_)
+			{
+				auto p = ::new (static_cast<void*>(proxy_)) proxy_type{ iter_->first, *iter_->second.get() };
+				proxy_instantiated_ = true;
+				return p;
+			}
+			else
+				return TOML_LAUNDER(reinterpret_cast<proxy_type*>(proxy_));
+		}
+
+	  public:
+		TOML_NODISCARD_CTOR
+		table_iterator() noexcept = default;
+
+		TOML_NODISCARD_CTOR
+		explicit table_iterator(mutable_map_iterator iter) noexcept //
+			: iter_{ iter }
+		{}
+
+		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
+		TOML_NODISCARD_CTOR
+		explicit table_iterator(const_map_iterator iter) noexcept //
+			: iter_{ iter }
+		{}
+
+		TOML_CONSTRAINED_TEMPLATE(C, bool C = IsConst)
+		TOML_NODISCARD_CTOR
+		table_iterator(const table_iterator<false>& other) noexcept //
+			: iter_{ other.iter_ }
+		{}
+
+		TOML_NODISCARD_CTOR
+		table_iterator(const table_iterator& other) noexcept //
+			: iter_{ other.iter_ }
+		{}
+
+		table_iterator& operator=(const table_iterator& rhs) noexcept
+		{
+			iter_				= rhs.iter_;
+			proxy_instantiated_ = false;
+			return *this;
+		}
+
+		using value_type		= table_proxy_pair<IsConst>;
+		using reference			= value_type&;
+		using pointer			= value_type*;
+		using difference_type	= typename std::iterator_traits<map_iterator>::difference_type;
+		using iterator_category = typename std::iterator_traits<map_iterator>::iterator_category;
+
+		table_iterator& operator++() noexcept // ++pre
+		{
+			++iter_;
+			proxy_instantiated_ = false;
+			return *this;
+		}
+
+		table_iterator operator++(int) noexcept // post++
+		{
+			table_iterator out{ iter_ };
+			++iter_;
+			proxy_instantiated_ = false;
+			return out;
+		}
+
+		table_iterator& operator--() noexcept // --pre
+		{
+			--iter_;
+			proxy_instantiated_ = false;
+			return *this;
+		}
+
+		table_iterator operator--(int) noexcept // post--
+		{
+			table_iterator out{ iter_ };
+			--iter_;
+			proxy_instantiated_ = false;
+			return out;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		reference operator*() const noexcept
+		{
+			return *get_proxy();
+		}
+
+		TOML_PURE_INLINE_GETTER
+		pointer operator->() const noexcept
+		{
+			return get_proxy();
+		}
+
+		TOML_PURE_INLINE_GETTER
+		explicit operator const map_iterator&() const noexcept
+		{
+			return iter_;
+		}
+
+		TOML_CONSTRAINED_TEMPLATE(!C, bool C = IsConst)
+		TOML_PURE_INLINE_GETTER
+		explicit operator const const_map_iterator() const noexcept
+		{
+			return iter_;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		friend bool operator==(const table_iterator& lhs, const table_iterator& rhs) noexcept
+		{
+			return lhs.iter_ == rhs.iter_;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		friend bool operator!=(const table_iterator& lhs, const table_iterator& rhs) noexcept
+		{
+			return lhs.iter_ != rhs.iter_;
+		}
+	};
+
+	struct table_init_pair
+	{
+		mutable toml::key key;
+		mutable node_ptr value;
+
+		template <typename K, typename V>
+		TOML_NODISCARD_CTOR
+		table_init_pair(K&& k, V&& v, value_flags flags = preserve_source_value_flags) //
+			: key{ static_cast<K&&>(k) },
+			  value{ make_node(static_cast<V&&>(v), flags) }
+		{}
+	};
+}
+TOML_IMPL_NAMESPACE_END;
+
+TOML_NAMESPACE_START
+{
+	using table_iterator = POXY_IMPLEMENTATION_DETAIL(impl::table_iterator<false>);
+
+	using const_table_iterator = POXY_IMPLEMENTATION_DETAIL(impl::table_iterator<true>);
+
+	class TOML_EXPORTED_CLASS table : public node
+	{
+	  private:
+
+		using map_type			 = impl::table_storage;
+		using map_pair			 = std::pair<const toml::key, impl::node_ptr>;
+		using map_iterator		 = typename map_type::iterator;
+		using const_map_iterator = typename map_type::const_iterator;
+		map_type map_;
+
+		bool inline_ = false;
+
+		friend class impl::compactor;
+		friend class impl::reclaimer;
+		friend class impl::snapshot;
+		friend class impl::hasher;
+		friend class impl::merger;
+
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table(const impl::table_init_pair*, const impl::table_init_pair*);
+
+	  public:
+
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table() noexcept;
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		~table() noexcept;
+
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table(const table&);
+
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table(table&& other) noexcept;
+
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		explicit table(std::initializer_list<impl::table_init_pair> kvps) //
+			: table(kvps.begin(), kvps.end())
+		{}
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table& operator=(const table&);
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table& operator=(table&& rhs) noexcept;
+
+		TOML_CONST_INLINE_GETTER
+		node_type type() const noexcept final
+		{
+			return node_type::table;
+		}
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		bool is_homogeneous(node_type ntype) const noexcept final;
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		bool is_homogeneous(node_type ntype, node*& first_nonmatch) noexcept final;
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		bool is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept final;
+
+		template <typename ElemType = void>
+		TOML_PURE_GETTER
+		bool is_homogeneous() const noexcept
+		{
+			using type = impl::remove_cvref<impl::unwrap_node<ElemType>>;
+			static_assert(std::is_void_v<type> || toml::is_value<type> || toml::is_container<type>,
+						  "The template type argument of table::is_homogeneous() must be void or one "
+						  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+
+			return is_homogeneous(impl::node_type_of<type>);
+		}
+		TOML_CONST_INLINE_GETTER
+		bool is_table() const noexcept final
+		{
+			return true;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_array() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_PURE_GETTER
+		bool is_array_of_tables() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_value() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_string() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_integer() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_floating_point() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_number() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_boolean() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_date() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_time() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		bool is_date_time() const noexcept final
+		{
+			return false;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		table* as_table() noexcept final
+		{
+			return this;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		array* as_array() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<std::string>* as_string() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<int64_t>* as_integer() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<double>* as_floating_point() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<bool>* as_boolean() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<date>* as_date() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<time>* as_time() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		toml::value<date_time>* as_date_time() noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const table* as_table() const noexcept final
+		{
+			return this;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const array* as_array() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<std::string>* as_string() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<int64_t>* as_integer() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<double>* as_floating_point() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<bool>* as_boolean() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<date>* as_date() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<time>* as_time() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_CONST_INLINE_GETTER
+		const toml::value<date_time>* as_date_time() const noexcept final
+		{
+			return nullptr;
+		}
+
+		TOML_PURE_INLINE_GETTER
+		bool is_inline() const noexcept
+		{
+			return inline_;
+		}
+
+		void is_inline(bool val) noexcept
+		{
+			inline_ = val;
+		}
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		node* get(std::string_view key) noexcept;
+
+		TOML_PURE_GETTER
+		const node* get(std::string_view key) const noexcept
+		{
+			const auto it = map_.find(key);
+			return it != map_.end() ? it->second.get() : nullptr;
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		node* get(std::wstring_view key)
+		{
+			if (empty())
+				return nullptr;
+
+			return get(impl::narrow(key));
+		}
+
+		TOML_NODISCARD
+		const node* get(std::wstring_view key) const
+		{
+			return get(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+		template <typename T>
+		TOML_PURE_GETTER
+		impl::wrap_node<T>* get_as(std::string_view key) noexcept
+		{
+			const auto n = this->get(key);
+			return n ? n->template as<T>() : nullptr;
+		}
+
+		template <typename T>
+		TOML_PURE_GETTER
+		const impl::wrap_node<T>* get_as(std::string_view key) const noexcept
+		{
+			const auto n = this->get(key);
+			return n ? n->template as<T>() : nullptr;
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		template <typename T>
+		TOML_NODISCARD
+		impl::wrap_node<T>* get_as(std::wstring_view key)
+		{
+			if (empty())
+				return nullptr;
+
+			return get_as<T>(impl::narrow(key));
+		}
+
+		template <typename T>
+		TOML_NODISCARD
+		const impl::wrap_node<T>* get_as(std::wstring_view key) const
+		{
+			return get_as<T>(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		TOML_EXPORTED_MEMBER_FUNCTION
+		node& at(std::string_view key);
+
+		TOML_NODISCARD
+		const node& at(std::string_view key) const
+		{
+			if (const auto n = get(key))
+				return *n;
+			return const_cast<table&>(*this).at(key); // reports it missing
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		node& at(std::wstring_view key)
+		{
+			return at(impl::narrow(key));
+		}
+
+		TOML_NODISCARD
+		const node& at(std::wstring_view key) const
+		{
+			return at(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+		using iterator = toml::table_iterator;
+
+		using const_iterator = toml::const_table_iterator;
+
+		TOML_PURE_INLINE_GETTER
+		iterator begin() noexcept
+		{
+			return iterator{ map_.begin() };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator begin() const noexcept
+		{
+			return const_iterator{ map_.cbegin() };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator cbegin() const noexcept
+		{
+			return const_iterator{ map_.cbegin() };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		iterator end() noexcept
+		{
+			return iterator{ map_.end() };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator end() const noexcept
+		{
+			return const_iterator{ map_.cend() };
+		}
+
+		TOML_PURE_INLINE_GETTER
+		const_iterator cend() const noexcept
+		{
+			return const_iterator{ map_.cend() };
+		}
+
+	  private:
+
+		template <typename T, typename Table>
+		using for_each_value_ref = impl::copy_cvref<impl::wrap_node<impl::remove_cvref<impl::unwrap_node<T>>>, Table>;
+
+		template <typename Func, typename Table, typename T>
+		using can_for_each = std::disjunction<std::is_invocable<Func, const key&, for_each_value_ref<T, Table>>, //
+											  std::is_invocable<Func, for_each_value_ref<T, Table>>>;
+
+		template <typename Func, typename Table, typename T>
+		using can_for_each_nothrow = std::conditional_t<
+			// first form
+			std::is_invocable_v<Func, const key&, for_each_value_ref<T, Table>>,
+			std::is_nothrow_invocable<Func, const key&, for_each_value_ref<T, Table>>,
+			std::conditional_t<
+				// second form
+				std::is_invocable_v<Func, for_each_value_ref<T, Table>>,
+				std::is_nothrow_invocable<Func, for_each_value_ref<T, Table>>,
+				std::false_type>>;
+
+		template <typename Func, typename Table>
+		using can_for_each_any = std::disjunction<can_for_each<Func, Table, table>,
+												  can_for_each<Func, Table, array>,
+												  can_for_each<Func, Table, std::string>,
+												  can_for_each<Func, Table, int64_t>,
+												  can_for_each<Func, Table, double>,
+												  can_for_each<Func, Table, bool>,
+												  can_for_each<Func, Table, date>,
+												  can_for_each<Func, Table, time>,
+												  can_for_each<Func, Table, date_time>>;
+
+		template <typename Func, typename Table, typename T>
+		using for_each_is_nothrow_one = std::disjunction<std::negation<can_for_each<Func, Table, T>>, //
+														 can_for_each_nothrow<Func, Table, T>>;
+
+		template <typename Func, typename Table>
+		using for_each_is_nothrow = std::conjunction<for_each_is_nothrow_one<Func, Table, table>,
+													 for_each_is_nothrow_one<Func, Table, array>,
+													 for_each_is_nothrow_one<Func, Table, std::string>,
+													 for_each_is_nothrow_one<Func, Table, int64_t>,
+													 for_each_is_nothrow_one<Func, Table, double>,
+													 for_each_is_nothrow_one<Func, Table, bool>,
+													 for_each_is_nothrow_one<Func, Table, date>,
+													 for_each_is_nothrow_one<Func, Table, time>,
+													 for_each_is_nothrow_one<Func, Table, date_time>>;
+
+		template <typename Func, typename Table>
+		static void do_for_each(Func&& visitor, Table&& tbl) //
+			noexcept(for_each_is_nothrow<Func&&, Table&&>::value)
+		{
+			static_assert(can_for_each_any<Func&&, Table&&>::value,
+						  "TOML table for_each visitors must be invocable for at least one of the toml::node "
+						  "specializations:" TOML_SA_NODE_TYPE_LIST);
+
+			using kvp_type = impl::copy_cv<map_pair, std::remove_reference_t<Table>>;
+
+			for (kvp_type& kvp : tbl.map_)
+			{
+				using node_ref = impl::copy_cvref<toml::node, Table&&>;
+				static_assert(std::is_reference_v<node_ref>);
+
+#if TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN
+
+#ifndef TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_ACKNOWLEDGED
+				static_assert(impl::always_false<Func, Table, kvp_type, node_ref>, //
+							  TOML_RETURN_BOOL_FROM_FOR_EACH_BROKEN_MESSAGE);
+#endif
+
+				static_cast<node_ref>(*kvp.second)
+					.visit(
+						[&]([[maybe_unused]] auto&& v) //
+						noexcept(for_each_is_nothrow_one<Func&&, Table&&, decltype(v)>::value)
+						{
+							using value_ref = for_each_value_ref<decltype(v), Table&&>;
+							static_assert(std::is_reference_v<value_ref>);
+
+							// func(key, val)
+							if constexpr (std::is_invocable_v<Func&&, const key&, value_ref>)
+							{
+								static_cast<Func&&>(visitor)(static_cast<const key&>(kvp.first),
+															 static_cast<value_ref>(v));
+							}
+
+							// func(val)
+							else if constexpr (std::is_invocable_v<Func&&, value_ref>)
+							{
+								static_cast<Func&&>(visitor)(static_cast<value_ref>(v));
+							}
+						});
+
+#else
+				const auto keep_going =
+					static_cast<node_ref>(*kvp.second)
+						.visit(
+							[&]([[maybe_unused]] auto&& v) //
+							noexcept(for_each_is_nothrow_one<Func&&, Table&&, decltype(v)>::value)
+							{
+								using value_ref = for_each_value_ref<decltype(v), Table&&>;
+								static_assert(std::is_reference_v<value_ref>);
+
+								// func(key, val)
+								if constexpr (std::is_invocable_v<Func&&, const key&, value_ref>)
+								{
+									using return_type = decltype(static_cast<Func&&>(
+										visitor)(static_cast<const key&>(kvp.first), static_cast<value_ref>(v)));
+
+									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
+									{
+										return static_cast<bool>(static_cast<Func&&>(
+											visitor)(static_cast<const key&>(kvp.first), static_cast<value_ref>(v)));
+									}
+									else
+									{
+										static_cast<Func&&>(visitor)(static_cast<const key&>(kvp.first),
+																	 static_cast<value_ref>(v));
+										return true;
+									}
+								}
+
+								// func(val)
+								else if constexpr (std::is_invocable_v<Func&&, value_ref>)
+								{
+									using return_type =
+										decltype(static_cast<Func&&>(visitor)(static_cast<value_ref>(v)));
+
+									if constexpr (impl::is_constructible_or_convertible<bool, return_type>)
+									{
+										return static_cast<bool>(
+											static_cast<Func&&>(visitor)(static_cast<value_ref>(v)));
+									}
+									else
+									{
+										static_cast<Func&&>(visitor)(static_cast<value_ref>(v));
+										return true;
+									}
+								}
+
+								// visitor not compatible with this particular type
+								else
+									return true;
+							});
+
+				if (!keep_going)
+					return;
+#endif
+			}
+		}
+
+	  public:
+
+		template <typename Func>
+		table& for_each(Func&& visitor) & //
+			noexcept(for_each_is_nothrow<Func&&, table&>::value)
+		{
+			do_for_each(static_cast<Func&&>(visitor), *this);
+			return *this;
+		}
+
+		template <typename Func>
+		table&& for_each(Func&& visitor) && //
+			noexcept(for_each_is_nothrow<Func&&, table&&>::value)
+		{
+			do_for_each(static_cast<Func&&>(visitor), static_cast<table&&>(*this));
+			return static_cast<table&&>(*this);
+		}
+
+		template <typename Func>
+		const table& for_each(Func&& visitor) const& //
+			noexcept(for_each_is_nothrow<Func&&, const table&>::value)
+		{
+			do_for_each(static_cast<Func&&>(visitor), *this);
+			return *this;
+		}
+
+		template <typename Func>
+		const table&& for_each(Func&& visitor) const&& //
+			noexcept(for_each_is_nothrow<Func&&, const table&&>::value)
+		{
+			do_for_each(static_cast<Func&&>(visitor), static_cast<const table&&>(*this));
+			return static_cast<const table&&>(*this);
+		}
+
+		TOML_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return map_.empty();
+		}
+
+		TOML_PURE_INLINE_GETTER
+		size_t size() const noexcept
+		{
+			return map_.size();
+		}
+
+	  private:
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		map_iterator get_lower_bound(std::string_view) noexcept;
+
+	  public:
+
+		TOML_PURE_GETTER
+		iterator lower_bound(std::string_view key) noexcept
+		{
+			return iterator{ get_lower_bound(key) };
+		}
+
+		TOML_PURE_GETTER
+		const_iterator lower_bound(std::string_view key) const noexcept
+		{
+			return const_iterator{ map_.lower_bound(key) };
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		iterator lower_bound(std::wstring_view key)
+		{
+			if (empty())
+				return end();
+
+			return lower_bound(impl::narrow(key));
+		}
+
+		TOML_NODISCARD
+		const_iterator lower_bound(std::wstring_view key) const
+		{
+			if (empty())
+				return end();
+
+			return lower_bound(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		iterator find(std::string_view key) noexcept;
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_MEMBER_FUNCTION
+		const_iterator find(std::string_view key) const noexcept;
+
+		TOML_PURE_GETTER
+		bool contains(std::string_view key) const noexcept
+		{
+			return get(key) != nullptr;
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		iterator find(std::wstring_view key)
+		{
+			if (empty())
+				return end();
+
+			return find(impl::narrow(key));
+		}
+
+		TOML_NODISCARD
+		const_iterator find(std::wstring_view key) const
+		{
+			return find(impl::narrow(key));
+		}
+
+		TOML_NODISCARD
+		bool contains(std::wstring_view key) const
+		{
+			return contains(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+	  private:
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		map_iterator erase(const_map_iterator) noexcept;
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		map_iterator erase(const_map_iterator, const_map_iterator) noexcept;
+
+	  public:
+
+		iterator erase(iterator pos) noexcept
+		{
+			return iterator{ erase(const_map_iterator{ pos }) };
+		}
+
+		iterator erase(const_iterator pos) noexcept
+		{
+			return iterator{ erase(const_map_iterator{ pos }) };
+		}
+
+		iterator erase(const_iterator begin, const_iterator end) noexcept
+		{
+			return iterator{ erase(const_map_iterator{ begin }, const_map_iterator{ end }) };
+		}
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		size_t erase(std::string_view key) noexcept;
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		size_t erase(std::wstring_view key)
+		{
+			if (empty())
+				return false;
+
+			return erase(impl::narrow(key));
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		table& prune(bool recursive = true) & noexcept;
+
+		table&& prune(bool recursive = true) && noexcept
+		{
+			return static_cast<toml::table&&>(this->prune(recursive));
+		}
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void clear() noexcept;
+
+		// moves everything in the table into freshly allocated, contiguous memory in depth-first order, so that
+		// walking it (serializing, comparing, looking things up) touches memory in order. worth it for documents
+		// that have been edited a lot, or that are kept around and read many times.
+		// references and iterators to anything in the table are invalidated. if an allocation fails the table is
+		// left as it was.
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void compact();
+
+		// moves everything in the table into immutable, reference-counted storage, so that copying it (or anything
+		// in it) takes constant time and shares that storage with the original. modifying a copy - or anything
+		// reached through non-const access, which is assumed to be about to - copies just the tables and arrays on
+		// the path to it, and the rest stays shared. worth it for a document that's copied and then changed a
+		// little, many times over.
+		// pointers and references to anything in the table that were taken before freezing it mustn't be used to
+		// modify it afterwards.
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void freeze();
+
+		// whether the table is frozen (and not since modified).
+		TOML_PURE_INLINE_GETTER
+		bool frozen() const noexcept
+		{
+			return map_.frozen();
+		}
+
+		// whether the two tables are frozen and share their entries (one is a copy of the other, and neither has
+		// been modified since), which makes them equal without comparing anything.
+		TOML_PURE_INLINE_GETTER
+		bool shares_entries(const table& other) const noexcept
+		{
+			return map_.frozen() && map_.cached_hash() == other.map_.cached_hash();
+		}
+
+	  private:
+
+		TOML_EXPORTED_MEMBER_FUNCTION
+		map_iterator insert_with_hint(const_iterator, key&&, impl::node_ptr&&);
+
+	  public:
+
+		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
+								  typename ValueType = void,
+								  typename KeyType,
+								  typename... ValueArgs)
+		iterator emplace_hint(const_iterator hint, KeyType&& key, ValueArgs&&... args)
+		{
+			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
+						  "Emplacement using wide-character keys is only supported on Windows with "
+						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+
+			using raw_value_type = impl::remove_cvref<ValueType>;
+			using value_type	 = std::
+				conditional_t<std::is_void_v<raw_value_type>, impl::emplaced_type_of<ValueArgs&&...>, raw_value_type>;
+
+			if constexpr (impl::is_wide_string<KeyType>)
+			{
+#if TOML_ENABLE_WINDOWS_COMPAT
+				return emplace_hint<value_type>(hint,
+												impl::narrow(static_cast<KeyType&&>(key)),
+												static_cast<ValueArgs&&>(args)...);
+#else
+				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
+#endif
+			}
+			else
+			{
+				static constexpr auto moving_node_ptr = std::is_same_v<value_type, impl::node_ptr> //
+													 && sizeof...(ValueArgs) == 1u				   //
+													 && impl::first_is_same<impl::node_ptr&&, ValueArgs&&...>;
+				using unwrapped_type = impl::remove_cvref<impl::unwrap_node<value_type>>;
+
+				static_assert(moving_node_ptr										//
+								  || impl::is_native<unwrapped_type>				//
+								  || impl::is_one_of<unwrapped_type, table, array>, //
+							  "ValueType argument of table::emplace_hint() must be one "
+							  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+
+				map_iterator ipos = insert_with_hint(hint, toml::key{ static_cast<KeyType&&>(key) }, nullptr);
+
+				// if second is nullptr then we successully claimed the key and inserted the empty sentinel,
+				// so now we have to construct the actual value
+				if (!ipos->second)
+				{
+					if constexpr (moving_node_ptr)
+						ipos->second = std::move(static_cast<ValueArgs&&>(args)...);
+					else
+					{
+#if TOML_COMPILER_HAS_EXCEPTIONS
+						try
+						{
+#endif
+							ipos->second.reset(
+								new impl::wrap_node<unwrapped_type>{ static_cast<ValueArgs&&>(args)... });
+#if TOML_COMPILER_HAS_EXCEPTIONS
+						}
+						catch (...)
+						{
+							erase(const_map_iterator{ ipos }); // strong exception guarantee
+							throw;
+						}
+#endif
+					}
+				}
+				return iterator{ ipos };
+			}
+		}
+
+		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
+								  typename KeyType,
+								  typename ValueType)
+		std::pair<iterator, bool> insert(KeyType&& key,
+										 ValueType&& val,
+										 value_flags flags = preserve_source_value_flags)
+		{
+			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
+						  "Insertion using wide-character keys is only supported on Windows with "
+						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+
+			if constexpr (is_node_view<ValueType>)
+			{
+				if (!val)
+					return { end(), false };
+			}
+
+			if constexpr (impl::is_wide_string<KeyType>)
+			{
+#if TOML_ENABLE_WINDOWS_COMPAT
+				return insert(impl::narrow(static_cast<KeyType&&>(key)), static_cast<ValueType&&>(val), flags);
+#else
+				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
+#endif
+			}
+			else
+			{
+				const auto key_view = std::string_view{ key };
+				map_iterator ipos	= get_lower_bound(key_view);
+				if (ipos == map_.end() || ipos->first != key_view)
+				{
+					ipos = insert_with_hint(const_iterator{ ipos },
+											toml::key{ static_cast<KeyType&&>(key) },
+											impl::make_node(static_cast<ValueType&&>(val), flags));
+					return { iterator{ ipos }, true };
+				}
+				return { iterator{ ipos }, false };
+			}
+		}
+
+		TOML_CONSTRAINED_TEMPLATE((!is_key_or_convertible<Iter> && !impl::is_wide_string<Iter>), typename Iter)
+		void insert(Iter begin, Iter end, value_flags flags = preserve_source_value_flags)
+		{
+			if (begin == end)
+				return;
+			for (auto it = begin; it != end; it++)
+			{
+				if constexpr (std::is_rvalue_reference_v<decltype(*it)>)
+					insert(std::move((*it).first), std::move((*it).second), flags);
+				else
+					insert((*it).first, (*it).second, flags);
+			}
+		}
+
+		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
+								  typename KeyType,
+								  typename ValueType)
+		std::pair<iterator, bool> insert_or_assign(KeyType&& key,
+												   ValueType&& val,
+												   value_flags flags = preserve_source_value_flags)
+		{
+			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
+						  "Insertion using wide-character keys is only supported on Windows with "
+						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+
+			if constexpr (is_node_view<ValueType>)
+			{
+				if (!val)
+					return { end(), false };
+			}
+
+			if constexpr (impl::is_wide_string<KeyType>)
+			{
+#if TOML_ENABLE_WINDOWS_COMPAT
+				return insert_or_assign(impl::narrow(static_cast<KeyType&&>(key)),
+										static_cast<ValueType&&>(val),
+										flags);
+#else
+				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
+#endif
+			}
+			else
+			{
+				const auto key_view = std::string_view{ key };
+				map_iterator ipos	= get_lower_bound(key_view);
+				if (ipos == map_.end() || ipos->first != key_view)
+				{
+					ipos = insert_with_hint(const_iterator{ ipos },
+											toml::key{ static_cast<KeyType&&>(key) },
+											impl::make_node(static_cast<ValueType&&>(val), flags));
+					return { iterator{ ipos }, true };
+				}
+				else
+				{
+					(*ipos).second = impl::make_node(static_cast<ValueType&&>(val), flags);
+					return { iterator{ ipos }, false };
+				}
+			}
+		}
+
+		TOML_CONSTRAINED_TEMPLATE((is_key_or_convertible<KeyType&&> || impl::is_wide_string<KeyType>),
+								  typename ValueType = void,
+								  typename KeyType,
+								  typename... ValueArgs)
+		std::pair<iterator, bool> emplace(KeyType&& key, ValueArgs&&... args)
+		{
+			static_assert(!impl::is_wide_string<KeyType> || TOML_ENABLE_WINDOWS_COMPAT,
+						  "Emplacement using wide-character keys is only supported on Windows with "
+						  "TOML_ENABLE_WINDOWS_COMPAT enabled.");
+
+			using raw_value_type = impl::remove_cvref<ValueType>;
+			using value_type	 = std::
+				conditional_t<std::is_void_v<raw_value_type>, impl::emplaced_type_of<ValueArgs&&...>, raw_value_type>;
+
+			if constexpr (impl::is_wide_string<KeyType>)
+			{
+#if TOML_ENABLE_WINDOWS_COMPAT
+				return emplace<value_type>(impl::narrow(static_cast<KeyType&&>(key)),
+										   static_cast<ValueArgs&&>(args)...);
+#else
+				static_assert(impl::always_false<KeyType>, "Evaluated unreachable branch!");
+#endif
+			}
+			else
+			{
+				using unwrapped_type = impl::remove_cvref<impl::unwrap_node<value_type>>;
+				static_assert((impl::is_native<unwrapped_type> || impl::is_one_of<unwrapped_type, table, array>),
+							  "ValueType argument of table::emplace() must be one "
+							  "of:" TOML_SA_UNWRAPPED_NODE_TYPE_LIST);
+
+				const auto key_view = std::string_view{ key };
+				auto ipos			= get_lower_bound(key_view);
+				if (ipos == map_.end() || ipos->first != key_view)
+				{
+					ipos = insert_with_hint(
+						const_iterator{ ipos },
+						toml::key{ static_cast<KeyType&&>(key) },
+						impl::node_ptr{ new impl::wrap_node<unwrapped_type>{ static_cast<ValueArgs&&>(args)... } });
+					return { iterator{ ipos }, true };
+				}
+				return { iterator{ ipos }, false };
+			}
+		}
+
+		using node::operator[]; // inherit operator[toml::path]
+
+		TOML_NODISCARD
+		node_view<node> operator[](std::string_view key) noexcept
+		{
+			return node_view<node>{ get(key) };
+		}
+
+		TOML_NODISCARD
+		node_view<const node> operator[](std::string_view key) const noexcept
+		{
+			return node_view<const node>{ get(key) };
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
+
+		TOML_NODISCARD
+		node_view<node> operator[](std::wstring_view key)
+		{
+			return node_view<node>{ get(key) };
+		}
+
+		TOML_NODISCARD
+		node_view<const node> operator[](std::wstring_view key) const
+		{
+			return node_view<const node>{ get(key) };
+		}
+
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+	  private:
+
+		TOML_PURE_GETTER
+		TOML_EXPORTED_STATIC_FUNCTION
+		static bool TOML_CALLCONV equal(const table&, const table&);
+
+	  public:
+
+		TOML_NODISCARD
+		friend bool operator==(const table& lhs, const table& rhs)
+		{
+			return equal(lhs, rhs);
+		}
+
+		TOML_NODISCARD
+		friend bool operator!=(const table& lhs, const table& rhs)
+		{
+			return !equal(lhs, rhs);
+		}
+
+#if TOML_ENABLE_FORMATTERS
+
+		friend std::ostream& operator<<(std::ostream& lhs, const table& rhs)
+		{
+			impl::print_to_stream(lhs, rhs);
+			return lhs;
+		}
+
+#endif
+	};
+}
+TOML_NAMESPACE_END;
+
+TOML_IMPL_NAMESPACE_START
+{
+	inline node_ptr packed_array::make_node(size_t index) const
+	{
+		if (type_ == node_type::table)
+		{
+			const auto tbl = new table{};
+			node_ptr row{ tbl };
+			tbl->is_inline(inline_tables_);
+			for (size_t i = 0; i < capacity_; i++)
+				tbl->emplace_hint<node_ptr>(tbl->cend(), columns()[i].key, columns()[i].values->make_node(index));
+			return row;
+		}
+
+		return visit_values(
+			[&](auto values)
+			{
+				const auto val = new auto{ element_value(values[index]) };
+				node_ptr nde{ val };
+				val->flags(flags_);
+				return nde;
+			});
+	}
+
+	inline void table_storage::thaw()
+	{
+		if (!frozen_->shared())
+		{
+			table_storage contents{ std::move(frozen_->contents) };
+			*this = std::move(contents);
+			return;
+		}
+
+		// the copies of any tables and arrays share their frozen contents in turn, so this copies one level
+		const auto& from = frozen_->contents;
+		table_storage copy;
+		copy.reserve(from.size());
+		for (auto it = from.begin(), e = from.end(); it != e; it++)
+			copy.emplace_hint(copy.end(), it->first, make_node(*it->second));
+		*this = std::move(copy);
+	}
+
+	template <typename Elem>
+	inline std::unique_ptr<packed_array> packed_array::pack_tables(const Elem* elems, size_t count)
+	{
+		const auto& first = *reinterpret_cast<const table*>(&*elems[0]);
+		const auto rows	  = count;
+		const auto cols	  = first.size();
+		if (!cols)
+			return {};
+
+		std::vector<const key*, allocator<const key*>> keys;
+		keys.reserve(cols);
+		for (auto&& [k, v] : first)
+		{
+			TOML_UNUSED(v);
+			keys.push_back(&k);
+		}
+
+		// tables are ordered, so tables with the same keys have them in the same order.
+		// cells[col * rows + row] is the value of the row'th table's col'th key.
+		std::vector<const node*, allocator<const node*>> cells(rows * cols);
+		for (size_t row = 0; row < rows; row++)
+		{
+			if (elems[row]->type() != node_type::table)
+				return {};
+
+			const auto& tbl = *reinterpret_cast<const table*>(&*elems[row]);
+			if (tbl.size() != cols || tbl.is_inline() != first.is_inline())
+				return {};
+
+			size_t col = 0;
+			for (auto&& [k, v] : tbl)
+			{
+				if (k != *keys[col])
+					return {};
+				cells[col++ * rows + row] = &v;
+			}
+		}
+
+		std::unique_ptr<packed_array> packed{ new packed_array{ first.is_inline(), rows, cols } };
+		for (size_t col = 0; col < cols; col++)
+		{
+			auto& column  = packed->columns()[col];
+			column.values = pack_column(cells.data() + col * rows, rows);
+			if (!column.values)
+				return {};
+			column.key = toml::key{ keys[col]->str() }; // (without its source region)
+		}
+		return packed;
+	}
+
+	// frees documents a slice at a time instead of all at once: containers are taken apart one at a time and their
+	// children queued, so freeing never recurses (however deeply the document nests) and the work can be spread
+	// out, or handed to another thread.
+	class reclaimer
+	{
+	  private:
+		node_vector pending_;
+
+	  public:
+		TOML_NODISCARD_CTOR
+		reclaimer() noexcept = default;
+
+		reclaimer(const reclaimer&)			   = delete;
+		reclaimer& operator=(const reclaimer&) = delete;
+
+		TOML_PURE_INLINE_GETTER
+		bool empty() const noexcept
+		{
+			return pending_.empty();
+		}
+
+		void add(node_ptr&& n)
+		{
+			if (n)
+				pending_.push_back(std::move(n));
+		}
+
+		// frees up to `budget` tables and arrays (along with the values directly in them), returning whether there
+		// are any left.
+		bool collect(size_t budget = static_cast<size_t>(-1))
+		{
+			for (; budget && !pending_.empty(); budget--)
+			{
+				node_ptr n = std::move(pending_.back());
+				pending_.pop_back();
+
+				// whatever can't be queued (if that throws) is just freed along with its parent. frozen contents that
+				// something else still refers to are left to that (and those that nothing does are moved, not copied,
+				// by thawing them).
+				if (const auto tbl = n->as_table())
+				{
+					if (tbl->map_.shared())
+						continue;
+					for (auto&& [k, v] : tbl->map_)
+						if (v && (v->is_table() || v->is_array()))
+							pending_.push_back(std::move(v));
+				}
+				else if (const auto arr = n->as_array())
+				{
+					if (arr->frozen_ && arr->frozen_->shared())
+						continue;
+					for (auto&& elem : arr->elems())
+						if (elem->is_table() || elem->is_array())
+							pending_.push_back(std::move(elem));
+				}
+			}
+			return !pending_.empty();
+		}
+	};
+}
+TOML_IMPL_NAMESPACE_END;
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
+//********  impl/unicode_autogenerated.hpp  ****************************************************************************
+
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+#if TOML_GCC && TOML_GCC < 9
+#pragma GCC push_options
+#pragma GCC optimize("O1") // codegen bugs
+#endif
+
+// the functions in this namespace block are automatically generated by a tool - they are not meant to be hand-edited
+
+TOML_IMPL_NAMESPACE_START
+{
+	TOML_CONST_GETTER
+	constexpr bool is_ascii_horizontal_whitespace(char32_t c) noexcept
+	{
+		return c == U'\t' || c == U' ';
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_non_ascii_horizontal_whitespace(char32_t c) noexcept
+	{
+		// 20 code units from 8 ranges (spanning a search area of 65120)
+
+		if (c < U'\xA0' || c > U'\uFEFF')
 			return false;
 
 		const auto child_index_0 = (static_cast<uint_least64_t>(c) - 0xA0ull) / 0x3FAull;
@@ -8687,135 +11215,479 @@ TOML_IMPL_NAMESPACE_START
 	}
 
 	TOML_CONST_GETTER
-	constexpr bool is_ascii_vertical_whitespace(char32_t c) noexcept
+	constexpr bool is_ascii_vertical_whitespace(char32_t c) noexcept
+	{
+		return c >= U'\n' && c <= U'\r';
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_non_ascii_vertical_whitespace(char32_t c) noexcept
+	{
+		return (U'\u2028' <= c && c <= U'\u2029') || c == U'\x85';
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_ascii_bare_key_character(char32_t c) noexcept
+	{
+#if TOML_LANG_UNRELEASED // toml/issues/644 ('+' in bare keys)
+		if TOML_UNLIKELY(c == U'+')
+			return true;
+#endif
+		// 64 code units from 5 ranges (spanning a search area of 78)
+
+		if (c < U'-' || c > U'z')
+			return false;
+
+		return (((static_cast<uint_least64_t>(c) - 0x2Dull) / 0x40ull) != 0ull)
+			|| ((1ull << (static_cast<uint_least64_t>(c) - 0x2Dull)) & 0xFFF43FFFFFF01FF9ull);
+	}
+
+#if TOML_LANG_UNRELEASED // toml/pull/891 (unicode bare keys)
+
+	TOML_CONST_GETTER
+	constexpr bool is_non_ascii_bare_key_character(char32_t c) noexcept
+	{
+		// 971732 code units from 16 ranges (spanning a search area of 982862)
+
+		if (c < U'\xB2' || c > U'\U000EFFFF')
+			return false;
+
+		const auto child_index_0 = (static_cast<uint_least64_t>(c) - 0xB2ull) / 0x3BFEull;
+		if ((1ull << child_index_0) & 0xFFFFFFFFFFFFFFE6ull)
+			return true;
+		switch (child_index_0)
+		{
+			case 0x00: // [0] 00B2 - 3CAF
+			{
+				// 12710 code units from 13 ranges (spanning a search area of 15358)
+
+				TOML_ASSUME(c >= U'\xB2' && c <= U'\u3CAF');
+
+				constexpr uint_least64_t bitmask_table_1[] = {
+					0xFFFFFFDFFFFFDC83u, 0xFFFFFFFFFFFFFFDFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFEFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0x000000000C003FFFu, 0xC000000000006000u, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0x000000003FFFFFFFu,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0xFFFFC00000000000u, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0x0000000000003FFFu, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
+					0x0000000000000000u, 0xFFFFFFFFFFFFC000u, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0x3FFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFF8000u, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
+					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0x3FFFFFFFFFFFFFFFu,
+				};
+				return bitmask_table_1[(static_cast<uint_least64_t>(c) - 0xB2ull) / 0x40ull]
+					 & (0x1ull << ((static_cast<uint_least64_t>(c) - 0xB2ull) % 0x40ull));
+			}
+			case 0x03: return c <= U'\uD7FF';
+			case 0x04:
+				return (U'\uF900' <= c && c <= U'\uFDCF') || (U'\uFDF0' <= c && c <= U'\uFFFD') || U'\U00010000' <= c;
+			default: TOML_UNREACHABLE;
+		}
+
+		TOML_UNREACHABLE;
+	}
+
+#endif // TOML_LANG_UNRELEASED
+}
+TOML_IMPL_NAMESPACE_END;
+
+#if TOML_GCC && TOML_GCC < 9
+#pragma GCC pop_options
+#endif
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
+//********  impl/unicode.hpp  ******************************************************************************************
+
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+TOML_IMPL_NAMESPACE_START
+{
+	TOML_CONST_GETTER
+	constexpr bool is_string_delimiter(char32_t c) noexcept
+	{
+		return c == U'"' || c == U'\'';
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_ascii_letter(char32_t c) noexcept
+	{
+		return (c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z');
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_binary_digit(char32_t c) noexcept
+	{
+		return c == U'0' || c == U'1';
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_octal_digit(char32_t c) noexcept
+	{
+		return (c >= U'0' && c <= U'7');
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_decimal_digit(char32_t c) noexcept
+	{
+		return (c >= U'0' && c <= U'9');
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_hexadecimal_digit(char32_t c) noexcept
+	{
+		return U'0' <= c && c <= U'f' && (1ull << (static_cast<uint_least64_t>(c) - 0x30u)) & 0x7E0000007E03FFull;
+	}
+
+	template <typename T>
+	TOML_CONST_GETTER
+	constexpr uint_least32_t hex_to_dec(const T c) noexcept
+	{
+		if constexpr (std::is_same_v<remove_cvref<T>, uint_least32_t>)
+			return c >= 0x41u					 // >= 'A'
+					 ? 10u + (c | 0x20u) - 0x61u // - 'a'
+					 : c - 0x30u				 // - '0'
+				;
+		else
+			return hex_to_dec(static_cast<uint_least32_t>(c));
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_horizontal_whitespace(char32_t c) noexcept
+	{
+		return is_ascii_horizontal_whitespace(c) || is_non_ascii_horizontal_whitespace(c);
+	}
+
+	TOML_CONST_GETTER
+	constexpr bool is_vertical_whitespace(char32_t c) noexcept
 	{
-		return c >= U'\n' && c <= U'\r';
+		return is_ascii_vertical_whitespace(c) || is_non_ascii_vertical_whitespace(c);
 	}
 
 	TOML_CONST_GETTER
-	constexpr bool is_non_ascii_vertical_whitespace(char32_t c) noexcept
+	constexpr bool is_whitespace(char32_t c) noexcept
 	{
-		return (U'\u2028' <= c && c <= U'\u2029') || c == U'\x85';
+		return is_horizontal_whitespace(c) || is_vertical_whitespace(c);
 	}
 
 	TOML_CONST_GETTER
-	constexpr bool is_ascii_bare_key_character(char32_t c) noexcept
+	constexpr bool is_bare_key_character(char32_t c) noexcept
 	{
-#if TOML_LANG_UNRELEASED // toml/issues/644 ('+' in bare keys)
-		if TOML_UNLIKELY(c == U'+')
-			return true;
+		return is_ascii_bare_key_character(c)
+#if TOML_LANG_UNRELEASED // toml/pull/891 (unicode bare keys)
+			|| is_non_ascii_bare_key_character(c)
 #endif
-		// 64 code units from 5 ranges (spanning a search area of 78)
+			;
+	}
 
-		if (c < U'-' || c > U'z')
-			return false;
+	TOML_CONST_GETTER
+	constexpr bool is_value_terminator(char32_t c) noexcept
+	{
+		return is_whitespace(c) || c == U']' || c == U'}' || c == U',' || c == U'#';
+	}
 
-		return (((static_cast<uint_least64_t>(c) - 0x2Dull) / 0x40ull) != 0ull)
-			|| ((1ull << (static_cast<uint_least64_t>(c) - 0x2Dull)) & 0xFFF43FFFFFF01FF9ull);
+	TOML_CONST_GETTER
+	constexpr bool is_control_character(char c) noexcept
+	{
+		return c <= '\u001F' || c == '\u007F';
 	}
 
-#if TOML_LANG_UNRELEASED // toml/pull/891 (unicode bare keys)
+	TOML_CONST_GETTER
+	constexpr bool is_control_character(char32_t c) noexcept
+	{
+		return c <= U'\u001F' || c == U'\u007F';
+	}
 
 	TOML_CONST_GETTER
-	constexpr bool is_non_ascii_bare_key_character(char32_t c) noexcept
+	constexpr bool is_nontab_control_character(char32_t c) noexcept
 	{
-		// 971732 code units from 16 ranges (spanning a search area of 982862)
+		return c <= U'\u0008' || (c >= U'\u000A' && c <= U'\u001F') || c == U'\u007F';
+	}
 
-		if (c < U'\xB2' || c > U'\U000EFFFF')
-			return false;
+	TOML_CONST_GETTER
+	constexpr bool is_unicode_surrogate(char32_t c) noexcept
+	{
+		return c >= 0xD800u && c <= 0xDFFF;
+	}
 
-		const auto child_index_0 = (static_cast<uint_least64_t>(c) - 0xB2ull) / 0x3BFEull;
-		if ((1ull << child_index_0) & 0xFFFFFFFFFFFFFFE6ull)
-			return true;
-		switch (child_index_0)
+	struct utf8_decoder
+	{
+		// utf8_decoder based on this: https://bjoern.hoehrmann.de/utf-8/decoder/dfa/
+		// Copyright (c) 2008-2009 Bjoern Hoehrmann <bjoern@hoehrmann.de>
+
+		uint_least32_t state{};
+		char32_t codepoint{};
+
+		static constexpr uint8_t state_table[]{
+			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
+			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
+			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
+			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
+			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	1,	1,	1,	1,	1,	1,	1,
+			1,	1,	1,	1,	1,	1,	1,	1,	1,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	7,	7,
+			7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,
+			7,	7,	7,	8,	8,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,
+			2,	2,	2,	2,	2,	2,	2,	2,	10, 3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	4,	3,	3,	11, 6,	6,
+			6,	5,	8,	8,	8,	8,	8,	8,	8,	8,	8,	8,	8,
+			0,	12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 0,	12,
+			12, 12, 12, 12, 0,	12, 0,	12, 12, 12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12, 12, 12, 12, 12, 12, 12,
+			12, 24, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 12, 12, 12, 12, 36, 12,
+			36, 12, 12, 12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12, 12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12
+		};
+
+		TOML_PURE_INLINE_GETTER
+		constexpr bool error() const noexcept
 		{
-			case 0x00: // [0] 00B2 - 3CAF
-			{
-				// 12710 code units from 13 ranges (spanning a search area of 15358)
+			return state == uint_least32_t{ 12u };
+		}
 
-				TOML_ASSUME(c >= U'\xB2' && c <= U'\u3CAF');
+		TOML_PURE_INLINE_GETTER
+		constexpr bool has_code_point() const noexcept
+		{
+			return state == uint_least32_t{};
+		}
 
-				constexpr uint_least64_t bitmask_table_1[] = {
-					0xFFFFFFDFFFFFDC83u, 0xFFFFFFFFFFFFFFDFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFEFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0x000000000C003FFFu, 0xC000000000006000u, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0x000000003FFFFFFFu,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0xFFFFC00000000000u, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0x0000000000003FFFu, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u, 0x0000000000000000u,
-					0x0000000000000000u, 0xFFFFFFFFFFFFC000u, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0x3FFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFF8000u, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu,
-					0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu, 0x3FFFFFFFFFFFFFFFu,
-				};
-				return bitmask_table_1[(static_cast<uint_least64_t>(c) - 0xB2ull) / 0x40ull]
-					 & (0x1ull << ((static_cast<uint_least64_t>(c) - 0xB2ull) % 0x40ull));
-			}
-			case 0x03: return c <= U'\uD7FF';
-			case 0x04:
-				return (U'\uF900' <= c && c <= U'\uFDCF') || (U'\uFDF0' <= c && c <= U'\uFFFD') || U'\U00010000' <= c;
-			default: TOML_UNREACHABLE;
+		TOML_PURE_INLINE_GETTER
+		constexpr bool needs_more_input() const noexcept
+		{
+			return !has_code_point() && !error();
+		}
+
+		constexpr void operator()(uint8_t byte) noexcept
+		{
+			TOML_ASSERT_ASSUME(!error());
+
+			const auto type = state_table[byte];
+
+			codepoint = static_cast<char32_t>(has_code_point() ? (uint_least32_t{ 255u } >> type) & byte
+															   : (byte & uint_least32_t{ 63u })
+																	 | (static_cast<uint_least32_t>(codepoint) << 6));
+
+			state = state_table[state + uint_least32_t{ 256u } + type];
+		}
+
+		TOML_ALWAYS_INLINE
+		constexpr void operator()(char c) noexcept
+		{
+			operator()(static_cast<uint8_t>(c));
+		}
+
+		TOML_ALWAYS_INLINE
+		constexpr void reset() noexcept
+		{
+			state = {};
+		}
+	};
+
+	TOML_PURE_GETTER
+	TOML_ATTR(nonnull)
+	bool is_ascii(const char* str, size_t len) noexcept;
+
+	// returns the first character in [str, end) which affects how a string is formatted
+	// (control characters, DEL, single-quotes and non-ASCII bytes), or end if there are none.
+	TOML_PURE_GETTER
+	TOML_ATTR(nonnull)
+	const char* find_string_trait_char(const char* str, const char* end) noexcept;
+
+	// returns the first character in [str, end) which can't be copied verbatim into a basic string
+	// (control characters, DEL, double-quotes, backslashes and non-ASCII bytes), or end if there are none.
+	TOML_PURE_GETTER
+	TOML_ATTR(nonnull)
+	const char* find_string_escape_char(const char* str, const char* end) noexcept;
+}
+TOML_IMPL_NAMESPACE_END;
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
+//********  impl/parse_error.hpp  **************************************************************************************
+
+#if TOML_ENABLE_PARSER
+
+//********  impl/std_except.hpp  ***************************************************************************************
+
+TOML_DISABLE_WARNINGS;
+#if TOML_EXCEPTIONS
+#include <stdexcept>
+#endif
+TOML_ENABLE_WARNINGS;
+
+//********  impl/parse_error.hpp  **************************************************************************************
+
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+#if TOML_DOXYGEN || !TOML_EXCEPTIONS
+#define TOML_PARSE_ERROR_BASE
+#else
+#define TOML_PARSE_ERROR_BASE	 : public std::runtime_error
+#endif
+
+TOML_NAMESPACE_START
+{
+	TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, ex, noex);
+
+	class parse_error TOML_PARSE_ERROR_BASE
+	{
+	  private:
+#if !TOML_EXCEPTIONS
+		std::string description_;
+#endif
+		source_region source_;
+
+	  public:
+#if TOML_EXCEPTIONS
+
+		TOML_NODISCARD_CTOR
+		TOML_ATTR(nonnull)
+		parse_error(const char* desc, source_region&& src) noexcept //
+			: std::runtime_error{ desc },
+			  source_{ std::move(src) }
+		{}
+
+		TOML_NODISCARD_CTOR
+		TOML_ATTR(nonnull)
+		parse_error(const char* desc, const source_region& src) noexcept //
+			: parse_error{ desc, source_region{ src } }
+		{}
+
+		TOML_NODISCARD_CTOR
+		TOML_ATTR(nonnull)
+		parse_error(const char* desc, const source_position& position, const source_path_ptr& path = {}) noexcept
+			: parse_error{ desc, source_region{ position, position, path } }
+		{}
+
+#else
+
+		TOML_NODISCARD_CTOR
+		parse_error(std::string&& desc, source_region&& src) noexcept //
+			: description_{ std::move(desc) },
+			  source_{ std::move(src) }
+		{}
+
+		TOML_NODISCARD_CTOR
+		parse_error(std::string&& desc, const source_region& src) noexcept //
+			: parse_error{ std::move(desc), source_region{ src } }
+		{}
+
+		TOML_NODISCARD_CTOR
+		parse_error(std::string&& desc, const source_position& position, const source_path_ptr& path = {}) noexcept
+			: parse_error{ std::move(desc), source_region{ position, position, path } }
+		{}
+
+#endif
+
+		TOML_NODISCARD
+		std::string_view description() const noexcept
+		{
+#if TOML_EXCEPTIONS
+			return std::string_view{ what() };
+#else
+			return description_;
+#endif
 		}
 
-		TOML_UNREACHABLE;
-	}
+		TOML_NODISCARD
+		const source_region& source() const noexcept
+		{
+			return source_;
+		}
 
-#endif // TOML_LANG_UNRELEASED
+		friend std::ostream& operator<<(std::ostream& lhs, const parse_error& rhs)
+		{
+			impl::print_to_stream(lhs, rhs.description());
+			impl::print_to_stream(lhs, "\n\t(error occurred at "sv);
+			impl::print_to_stream(lhs, rhs.source());
+			impl::print_to_stream(lhs, ")"sv);
+			return lhs;
+		}
+	};
+
+	TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
 }
-TOML_IMPL_NAMESPACE_END;
+TOML_NAMESPACE_END;
 
-#if TOML_GCC && TOML_GCC < 9
-#pragma GCC pop_options
-#endif
+#undef TOML_PARSE_ERROR_BASE
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -8826,7 +11698,11 @@ TOML_IMPL_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-//********  impl/unicode.hpp  ******************************************************************************************
+#endif // TOML_ENABLE_PARSER
+
+//********  impl/parse_result.hpp  *************************************************************************************
+
+#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -8839,316 +11715,331 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-TOML_IMPL_NAMESPACE_START
+TOML_NAMESPACE_START
 {
-	TOML_CONST_GETTER
-	constexpr bool is_string_delimiter(char32_t c) noexcept
-	{
-		return c == U'"' || c == U'\'';
-	}
+	TOML_ABI_NAMESPACE_START(noex);
 
-	TOML_CONST_GETTER
-	constexpr bool is_ascii_letter(char32_t c) noexcept
+	class parse_result
 	{
-		return (c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z');
-	}
+	  private:
+		struct storage_t
+		{
+			static constexpr size_t size =
+				(sizeof(toml::table) < sizeof(parse_error) ? sizeof(parse_error) : sizeof(toml::table));
+			static constexpr size_t align =
+				(alignof(toml::table) < alignof(parse_error) ? alignof(parse_error) : alignof(toml::table));
 
-	TOML_CONST_GETTER
-	constexpr bool is_binary_digit(char32_t c) noexcept
-	{
-		return c == U'0' || c == U'1';
-	}
+			alignas(align) unsigned char bytes[size];
+		};
 
-	TOML_CONST_GETTER
-	constexpr bool is_octal_digit(char32_t c) noexcept
-	{
-		return (c >= U'0' && c <= U'7');
-	}
+		alignas(storage_t::align) mutable storage_t storage_;
+		bool err_;
 
-	TOML_CONST_GETTER
-	constexpr bool is_decimal_digit(char32_t c) noexcept
-	{
-		return (c >= U'0' && c <= U'9');
-	}
+		template <typename Type>
+		TOML_NODISCARD
+		TOML_ALWAYS_INLINE
+		static Type* get_as(storage_t& s) noexcept
+		{
+			return TOML_LAUNDER(reinterpret_cast<Type*>(s.bytes));
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_hexadecimal_digit(char32_t c) noexcept
-	{
-		return U'0' <= c && c <= U'f' && (1ull << (static_cast<uint_least64_t>(c) - 0x30u)) & 0x7E0000007E03FFull;
-	}
+		void destroy() noexcept
+		{
+			if (err_)
+				get_as<parse_error>(storage_)->~parse_error();
+			else
+				get_as<toml::table>(storage_)->~table();
+		}
 
-	template <typename T>
-	TOML_CONST_GETTER
-	constexpr uint_least32_t hex_to_dec(const T c) noexcept
-	{
-		if constexpr (std::is_same_v<remove_cvref<T>, uint_least32_t>)
-			return c >= 0x41u					 // >= 'A'
-					 ? 10u + (c | 0x20u) - 0x61u // - 'a'
-					 : c - 0x30u				 // - '0'
-				;
-		else
-			return hex_to_dec(static_cast<uint_least32_t>(c));
-	}
+	  public:
 
-	TOML_CONST_GETTER
-	constexpr bool is_horizontal_whitespace(char32_t c) noexcept
-	{
-		return is_ascii_horizontal_whitespace(c) || is_non_ascii_horizontal_whitespace(c);
-	}
+		TOML_NODISCARD_CTOR
+		parse_result() noexcept //
+			: err_{ true }
+		{
+			::new (static_cast<void*>(storage_.bytes)) parse_error{ std::string{}, source_region{} };
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_vertical_whitespace(char32_t c) noexcept
-	{
-		return is_ascii_vertical_whitespace(c) || is_non_ascii_vertical_whitespace(c);
-	}
+		TOML_NODISCARD_CTOR
+		explicit parse_result(toml::table&& tbl) noexcept //
+			: err_{ false }
+		{
+			::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(tbl) };
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_whitespace(char32_t c) noexcept
-	{
-		return is_horizontal_whitespace(c) || is_vertical_whitespace(c);
-	}
+		TOML_NODISCARD_CTOR
+		explicit parse_result(parse_error&& err) noexcept //
+			: err_{ true }
+		{
+			::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(err) };
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_bare_key_character(char32_t c) noexcept
-	{
-		return is_ascii_bare_key_character(c)
-#if TOML_LANG_UNRELEASED // toml/pull/891 (unicode bare keys)
-			|| is_non_ascii_bare_key_character(c)
-#endif
-			;
-	}
+		TOML_NODISCARD_CTOR
+		parse_result(parse_result&& res) noexcept //
+			: err_{ res.err_ }
+		{
+			if (err_)
+				::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(res).error() };
+			else
+				::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(res).table() };
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_value_terminator(char32_t c) noexcept
-	{
-		return is_whitespace(c) || c == U']' || c == U'}' || c == U',' || c == U'#';
-	}
+		parse_result& operator=(parse_result&& rhs) noexcept
+		{
+			if (err_ != rhs.err_)
+			{
+				destroy();
+				err_ = rhs.err_;
+				if (err_)
+					::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(rhs).error() };
+				else
+					::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(rhs).table() };
+			}
+			else
+			{
+				if (err_)
+					error() = std::move(rhs).error();
+				else
+					table() = std::move(rhs).table();
+			}
+			return *this;
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_control_character(char c) noexcept
-	{
-		return c <= '\u001F' || c == '\u007F';
-	}
+		~parse_result() noexcept
+		{
+			destroy();
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_control_character(char32_t c) noexcept
-	{
-		return c <= U'\u001F' || c == U'\u007F';
-	}
+		TOML_NODISCARD
+		bool succeeded() const noexcept
+		{
+			return !err_;
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_nontab_control_character(char32_t c) noexcept
-	{
-		return c <= U'\u0008' || (c >= U'\u000A' && c <= U'\u001F') || c == U'\u007F';
-	}
+		TOML_NODISCARD
+		bool failed() const noexcept
+		{
+			return err_;
+		}
 
-	TOML_CONST_GETTER
-	constexpr bool is_unicode_surrogate(char32_t c) noexcept
-	{
-		return c >= 0xD800u && c <= 0xDFFF;
-	}
+		TOML_NODISCARD
+		explicit operator bool() const noexcept
+		{
+			return !err_;
+		}
 
-	struct utf8_decoder
-	{
-		// utf8_decoder based on this: https://bjoern.hoehrmann.de/utf-8/decoder/dfa/
-		// Copyright (c) 2008-2009 Bjoern Hoehrmann <bjoern@hoehrmann.de>
+		TOML_NODISCARD
+		toml::table& table() & noexcept
+		{
+			TOML_ASSERT_ASSUME(!err_);
+			return *get_as<toml::table>(storage_);
+		}
 
-		uint_least32_t state{};
-		char32_t codepoint{};
+		TOML_NODISCARD
+		toml::table&& table() && noexcept
+		{
+			TOML_ASSERT_ASSUME(!err_);
+			return static_cast<toml::table&&>(*get_as<toml::table>(storage_));
+		}
 
-		static constexpr uint8_t state_table[]{
-			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
-			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
-			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
-			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,
-			0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	0,	1,	1,	1,	1,	1,	1,	1,
-			1,	1,	1,	1,	1,	1,	1,	1,	1,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	9,	7,	7,
-			7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,	7,
-			7,	7,	7,	8,	8,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,	2,
-			2,	2,	2,	2,	2,	2,	2,	2,	10, 3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	3,	4,	3,	3,	11, 6,	6,
-			6,	5,	8,	8,	8,	8,	8,	8,	8,	8,	8,	8,	8,
-			0,	12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 0,	12,
-			12, 12, 12, 12, 0,	12, 0,	12, 12, 12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12, 12, 12, 12, 12, 12, 12,
-			12, 24, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 12, 12, 12, 12, 36, 12,
-			36, 12, 12, 12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12, 12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12
-		};
+		TOML_NODISCARD
+		const toml::table& table() const& noexcept
+		{
+			TOML_ASSERT_ASSUME(!err_);
+			return *get_as<const toml::table>(storage_);
+		}
 
-		TOML_PURE_INLINE_GETTER
-		constexpr bool error() const noexcept
+		TOML_NODISCARD
+		/* implicit */ operator toml::table&() noexcept
 		{
-			return state == uint_least32_t{ 12u };
+			return table();
 		}
 
-		TOML_PURE_INLINE_GETTER
-		constexpr bool has_code_point() const noexcept
+		TOML_NODISCARD
+		/* implicit */ operator toml::table&&() noexcept
 		{
-			return state == uint_least32_t{};
+			return std::move(table());
 		}
 
-		TOML_PURE_INLINE_GETTER
-		constexpr bool needs_more_input() const noexcept
+		TOML_NODISCARD
+		/* implicit */ operator const toml::table&() const noexcept
 		{
-			return !has_code_point() && !error();
+			return table();
 		}
 
-		constexpr void operator()(uint8_t byte) noexcept
+		TOML_NODISCARD
+		parse_error& error() & noexcept
 		{
-			TOML_ASSERT_ASSUME(!error());
+			TOML_ASSERT_ASSUME(err_);
+			return *get_as<parse_error>(storage_);
+		}
 
-			const auto type = state_table[byte];
+		TOML_NODISCARD
+		parse_error&& error() && noexcept
+		{
+			TOML_ASSERT_ASSUME(err_);
+			return static_cast<parse_error&&>(*get_as<parse_error>(storage_));
+		}
 
-			codepoint = static_cast<char32_t>(has_code_point() ? (uint_least32_t{ 255u } >> type) & byte
-															   : (byte & uint_least32_t{ 63u })
-																	 | (static_cast<uint_least32_t>(codepoint) << 6));
+		TOML_NODISCARD
+		const parse_error& error() const& noexcept
+		{
+			TOML_ASSERT_ASSUME(err_);
+			return *get_as<const parse_error>(storage_);
+		}
 
-			state = state_table[state + uint_least32_t{ 256u } + type];
+		TOML_NODISCARD
+		explicit operator parse_error&() noexcept
+		{
+			return error();
 		}
 
-		TOML_ALWAYS_INLINE
-		constexpr void operator()(char c) noexcept
+		TOML_NODISCARD
+		explicit operator parse_error&&() noexcept
 		{
-			operator()(static_cast<uint8_t>(c));
+			return std::move(error());
 		}
 
-		TOML_ALWAYS_INLINE
-		constexpr void reset() noexcept
+		TOML_NODISCARD
+		explicit operator const parse_error&() const noexcept
 		{
-			state = {};
+			return error();
 		}
-	};
 
-	TOML_PURE_GETTER
-	TOML_ATTR(nonnull)
-	bool is_ascii(const char* str, size_t len) noexcept;
-}
-TOML_IMPL_NAMESPACE_END;
+		using iterator = table_iterator;
 
-#ifdef _MSC_VER
-#pragma pop_macro("min")
-#pragma pop_macro("max")
-#ifndef __clang__
-#pragma inline_recursion(off)
-#endif
-#endif
-TOML_POP_WARNINGS;
+		using const_iterator = const_table_iterator;
 
-//********  impl/parse_error.hpp  **************************************************************************************
+		TOML_NODISCARD
+		table_iterator begin() noexcept
+		{
+			return err_ ? table_iterator{} : table().begin();
+		}
 
-#if TOML_ENABLE_PARSER
+		TOML_NODISCARD
+		const_table_iterator begin() const noexcept
+		{
+			return err_ ? const_table_iterator{} : table().begin();
+		}
 
-//********  impl/std_except.hpp  ***************************************************************************************
+		TOML_NODISCARD
+		const_table_iterator cbegin() const noexcept
+		{
+			return err_ ? const_table_iterator{} : table().cbegin();
+		}
 
-TOML_DISABLE_WARNINGS;
-#if TOML_EXCEPTIONS
-#include <stdexcept>
-#endif
-TOML_ENABLE_WARNINGS;
+		TOML_NODISCARD
+		table_iterator end() noexcept
+		{
+			return err_ ? table_iterator{} : table().end();
+		}
 
-//********  impl/parse_error.hpp  **************************************************************************************
+		TOML_NODISCARD
+		const_table_iterator end() const noexcept
+		{
+			return err_ ? const_table_iterator{} : table().end();
+		}
 
-TOML_PUSH_WARNINGS;
-#ifdef _MSC_VER
-#ifndef __clang__
-#pragma inline_recursion(on)
-#endif
-#pragma push_macro("min")
-#pragma push_macro("max")
-#undef min
-#undef max
-#endif
+		TOML_NODISCARD
+		const_table_iterator cend() const noexcept
+		{
+			return err_ ? const_table_iterator{} : table().cend();
+		}
 
-#if TOML_DOXYGEN || !TOML_EXCEPTIONS
-#define TOML_PARSE_ERROR_BASE
-#else
-#define TOML_PARSE_ERROR_BASE	 : public std::runtime_error
-#endif
+		TOML_NODISCARD
+		node_view<node> at_path(std::string_view path)
+		{
+			return err_ ? node_view<node>{} : table().at_path(path);
+		}
 
-TOML_NAMESPACE_START
-{
-	TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, ex, noex);
+		TOML_NODISCARD
+		node_view<const node> at_path(std::string_view path) const
+		{
+			return err_ ? node_view<const node>{} : table().at_path(path);
+		}
 
-	class parse_error TOML_PARSE_ERROR_BASE
-	{
-	  private:
-#if !TOML_EXCEPTIONS
-		std::string description_;
-#endif
-		source_region source_;
+		TOML_NODISCARD
+		node_view<node> at_path(const toml::path& path)
+		{
+			return err_ ? node_view<node>{} : table().at_path(path);
+		}
 
-	  public:
-#if TOML_EXCEPTIONS
+		TOML_NODISCARD
+		node_view<const node> at_path(const toml::path& path) const
+		{
+			return err_ ? node_view<const node>{} : table().at_path(path);
+		}
 
-		TOML_NODISCARD_CTOR
-		TOML_ATTR(nonnull)
-		parse_error(const char* desc, source_region&& src) noexcept //
-			: std::runtime_error{ desc },
-			  source_{ std::move(src) }
-		{}
+#if TOML_ENABLE_WINDOWS_COMPAT
 
-		TOML_NODISCARD_CTOR
-		TOML_ATTR(nonnull)
-		parse_error(const char* desc, const source_region& src) noexcept //
-			: parse_error{ desc, source_region{ src } }
-		{}
+		TOML_NODISCARD
+		node_view<node> at_path(std::wstring_view path)
+		{
+			return err_ ? node_view<node>{} : table().at_path(path);
+		}
 
-		TOML_NODISCARD_CTOR
-		TOML_ATTR(nonnull)
-		parse_error(const char* desc, const source_position& position, const source_path_ptr& path = {}) noexcept
-			: parse_error{ desc, source_region{ position, position, path } }
-		{}
+		TOML_NODISCARD
+		node_view<const node> at_path(std::wstring_view path) const
+		{
+			return err_ ? node_view<const node>{} : table().at_path(path);
+		}
 
-#else
+#endif
 
-		TOML_NODISCARD_CTOR
-		parse_error(std::string&& desc, source_region&& src) noexcept //
-			: description_{ std::move(desc) },
-			  source_{ std::move(src) }
-		{}
+		TOML_NODISCARD
+		node_view<node> operator[](const toml::path& path)
+		{
+			return err_ ? node_view<node>{} : table()[path];
+		}
 
-		TOML_NODISCARD_CTOR
-		parse_error(std::string&& desc, const source_region& src) noexcept //
-			: parse_error{ std::move(desc), source_region{ src } }
-		{}
+		TOML_NODISCARD
+		node_view<const node> operator[](const toml::path& path) const
+		{
+			return err_ ? node_view<const node>{} : table()[path];
+		}
 
-		TOML_NODISCARD_CTOR
-		parse_error(std::string&& desc, const source_position& position, const source_path_ptr& path = {}) noexcept
-			: parse_error{ std::move(desc), source_region{ position, position, path } }
-		{}
+		TOML_NODISCARD
+		node_view<node> operator[](std::string_view key) noexcept
+		{
+			return err_ ? node_view<node>{} : table()[key];
+		}
 
-#endif
+		TOML_NODISCARD
+		node_view<const node> operator[](std::string_view key) const noexcept
+		{
+			return err_ ? node_view<const node>{} : table()[key];
+		}
+
+#if TOML_ENABLE_WINDOWS_COMPAT
 
 		TOML_NODISCARD
-		std::string_view description() const noexcept
+		node_view<node> operator[](std::wstring_view key)
 		{
-#if TOML_EXCEPTIONS
-			return std::string_view{ what() };
-#else
-			return description_;
-#endif
+			return err_ ? node_view<node>{} : table()[key];
 		}
 
 		TOML_NODISCARD
-		const source_region& source() const noexcept
+		node_view<const node> operator[](std::wstring_view key) const
 		{
-			return source_;
+			return err_ ? node_view<const node>{} : table()[key];
 		}
 
-		friend std::ostream& operator<<(std::ostream& lhs, const parse_error& rhs)
+#endif // TOML_ENABLE_WINDOWS_COMPAT
+
+#if TOML_ENABLE_FORMATTERS
+
+		friend std::ostream& operator<<(std::ostream& os, const parse_result& result)
 		{
-			impl::print_to_stream(lhs, rhs.description());
-			impl::print_to_stream(lhs, "\n\t(error occurred at "sv);
-			impl::print_to_stream(lhs, rhs.source());
-			impl::print_to_stream(lhs, ")"sv);
-			return lhs;
+			return result.err_ ? (os << result.error()) : (os << result.table());
 		}
+
+#endif
 	};
 
-	TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
+	TOML_ABI_NAMESPACE_END;
 }
 TOML_NAMESPACE_END;
 
-#undef TOML_PARSE_ERROR_BASE
-
 #ifdef _MSC_VER
 #pragma pop_macro("min")
 #pragma pop_macro("max")
@@ -9158,11 +12049,11 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_PARSER
+#endif // TOML_ENABLE_PARSER && !TOML_EXCEPTIONS
 
-//********  impl/parse_result.hpp  *************************************************************************************
+//********  impl/parser.hpp  *******************************************************************************************
 
-#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
+#if TOML_ENABLE_PARSER
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -9177,328 +12068,307 @@ TOML_PUSH_WARNINGS;
 
 TOML_NAMESPACE_START
 {
-	TOML_ABI_NAMESPACE_START(noex);
+	TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, ex, noex);
 
-	class parse_result
-	{
-	  private:
-		struct storage_t
-		{
-			static constexpr size_t size =
-				(sizeof(toml::table) < sizeof(parse_error) ? sizeof(parse_error) : sizeof(toml::table));
-			static constexpr size_t align =
-				(alignof(toml::table) < alignof(parse_error) ? alignof(parse_error) : alignof(toml::table));
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::string_view doc,
+										std::string_view source_path = {},
+										parse_flags flags			 = parse_flags::none);
 
-			alignas(align) unsigned char bytes[size];
-		};
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::string_view doc,
+										std::string && source_path,
+										parse_flags flags = parse_flags::none);
 
-		alignas(storage_t::align) mutable storage_t storage_;
-		bool err_;
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse_file(std::string_view file_path, parse_flags flags = parse_flags::none);
 
-		template <typename Type>
-		TOML_NODISCARD
-		TOML_ALWAYS_INLINE
-		static Type* get_as(storage_t& s) noexcept
-		{
-			return TOML_LAUNDER(reinterpret_cast<Type*>(s.bytes));
-		}
+#if TOML_HAS_CHAR8
 
-		void destroy() noexcept
-		{
-			if (err_)
-				get_as<parse_error>(storage_)->~parse_error();
-			else
-				get_as<toml::table>(storage_)->~table();
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::string_view source_path = {});
 
-	  public:
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::string && source_path);
 
-		TOML_NODISCARD_CTOR
-		parse_result() noexcept //
-			: err_{ true }
-		{
-			::new (static_cast<void*>(storage_.bytes)) parse_error{ std::string{}, source_region{} };
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse_file(std::u8string_view file_path);
 
-		TOML_NODISCARD_CTOR
-		explicit parse_result(toml::table&& tbl) noexcept //
-			: err_{ false }
-		{
-			::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(tbl) };
-		}
+#endif // TOML_HAS_CHAR8
 
-		TOML_NODISCARD_CTOR
-		explicit parse_result(parse_error&& err) noexcept //
-			: err_{ true }
-		{
-			::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(err) };
-		}
+#if TOML_ENABLE_WINDOWS_COMPAT
 
-		TOML_NODISCARD_CTOR
-		parse_result(parse_result&& res) noexcept //
-			: err_{ res.err_ }
-		{
-			if (err_)
-				::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(res).error() };
-			else
-				::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(res).table() };
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::string_view doc, std::wstring_view source_path);
 
-		parse_result& operator=(parse_result&& rhs) noexcept
-		{
-			if (err_ != rhs.err_)
-			{
-				destroy();
-				err_ = rhs.err_;
-				if (err_)
-					::new (static_cast<void*>(storage_.bytes)) parse_error{ std::move(rhs).error() };
-				else
-					::new (static_cast<void*>(storage_.bytes)) toml::table{ std::move(rhs).table() };
-			}
-			else
-			{
-				if (err_)
-					error() = std::move(rhs).error();
-				else
-					table() = std::move(rhs).table();
-			}
-			return *this;
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::istream & doc, std::wstring_view source_path);
 
-		~parse_result() noexcept
-		{
-			destroy();
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse_file(std::wstring_view file_path);
 
-		TOML_NODISCARD
-		bool succeeded() const noexcept
-		{
-			return !err_;
-		}
+#endif // TOML_ENABLE_WINDOWS_COMPAT
 
-		TOML_NODISCARD
-		bool failed() const noexcept
-		{
-			return err_;
-		}
+#if TOML_HAS_CHAR8 && TOML_ENABLE_WINDOWS_COMPAT
 
-		TOML_NODISCARD
-		explicit operator bool() const noexcept
-		{
-			return !err_;
-		}
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::wstring_view source_path);
 
-		TOML_NODISCARD
-		toml::table& table() & noexcept
-		{
-			TOML_ASSERT_ASSUME(!err_);
-			return *get_as<toml::table>(storage_);
-		}
+#endif // TOML_HAS_CHAR8 && TOML_ENABLE_WINDOWS_COMPAT
+
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::istream & doc,
+										std::string_view source_path = {},
+										parse_flags flags			 = parse_flags::none);
+
+	TOML_NODISCARD
+	TOML_EXPORTED_FREE_FUNCTION
+	parse_result TOML_CALLCONV parse(std::istream & doc,
+										std::string && source_path,
+										parse_flags flags = parse_flags::none);
+
+	TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
+
+	inline namespace literals
+	{
+		TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, lit_ex, lit_noex);
 
 		TOML_NODISCARD
-		toml::table&& table() && noexcept
+		TOML_ALWAYS_INLINE
+		parse_result operator"" _toml(const char* str, size_t len)
 		{
-			TOML_ASSERT_ASSUME(!err_);
-			return static_cast<toml::table&&>(*get_as<toml::table>(storage_));
+			return parse(std::string_view{ str, len });
 		}
 
+#if TOML_HAS_CHAR8
+
 		TOML_NODISCARD
-		const toml::table& table() const& noexcept
+		TOML_ALWAYS_INLINE
+		parse_result operator"" _toml(const char8_t* str, size_t len)
 		{
-			TOML_ASSERT_ASSUME(!err_);
-			return *get_as<const toml::table>(storage_);
+			return parse(std::u8string_view{ str, len });
 		}
 
-		TOML_NODISCARD
-		/* implicit */ operator toml::table&() noexcept
-		{
-			return table();
-		}
+#endif // TOML_HAS_CHAR8
+
+		TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
+	}
+}
+TOML_NAMESPACE_END;
+
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
+
+#endif // TOML_ENABLE_PARSER
+
+//********  impl/formatter.hpp  ****************************************************************************************
+
+#if TOML_ENABLE_FORMATTERS
+
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
+
+TOML_IMPL_NAMESPACE_START
+{
+	struct formatter_constants
+	{
+		format_flags mandatory_flags;
+		format_flags ignored_flags;
+
+		std::string_view float_pos_inf;
+		std::string_view float_neg_inf;
+		std::string_view float_nan;
+
+		std::string_view bool_true;
+		std::string_view bool_false;
+	};
 
-		TOML_NODISCARD
-		/* implicit */ operator toml::table&&() noexcept
-		{
-			return std::move(table());
-		}
+	struct formatter_config
+	{
+		format_flags flags;
+		std::string_view indent;
+	};
 
-		TOML_NODISCARD
-		/* implicit */ operator const toml::table&() const noexcept
-		{
-			return table();
-		}
+	class TOML_EXPORTED_CLASS formatter
+	{
+	  private:
+		const node* source_;
+#if TOML_ENABLE_PARSER && !TOML_EXCEPTIONS
+		const parse_result* result_;
+#endif
+		const formatter_constants* constants_;
+		formatter_config config_;
+		size_t indent_columns_;
+		format_flags int_format_mask_;
+		std::ostream* stream_; //
+		int indent_;		   // these are set in attach()
+		bool naked_newline_;   //
 
-		TOML_NODISCARD
-		parse_error& error() & noexcept
+	  protected:
+		TOML_PURE_INLINE_GETTER
+		const node& source() const noexcept
 		{
-			TOML_ASSERT_ASSUME(err_);
-			return *get_as<parse_error>(storage_);
+			return *source_;
 		}
 
-		TOML_NODISCARD
-		parse_error&& error() && noexcept
+		TOML_PURE_INLINE_GETTER
+		std::ostream& stream() const noexcept
 		{
-			TOML_ASSERT_ASSUME(err_);
-			return static_cast<parse_error&&>(*get_as<parse_error>(storage_));
+			return *stream_;
 		}
 
-		TOML_NODISCARD
-		const parse_error& error() const& noexcept
+		TOML_PURE_INLINE_GETTER
+		int indent() const noexcept
 		{
-			TOML_ASSERT_ASSUME(err_);
-			return *get_as<const parse_error>(storage_);
+			return indent_;
 		}
 
-		TOML_NODISCARD
-		explicit operator parse_error&() noexcept
+		void indent(int level) noexcept
 		{
-			return error();
+			indent_ = level;
 		}
 
-		TOML_NODISCARD
-		explicit operator parse_error&&() noexcept
+		void increase_indent() noexcept
 		{
-			return std::move(error());
+			indent_++;
 		}
 
-		TOML_NODISCARD
-		explicit operator const parse_error&() const noexcept
+		void decrease_indent() noexcept
 		{
-			return error();
+			indent_--;
 		}
 
-		using iterator = table_iterator;
-
-		using const_iterator = const_table_iterator;
-
-		TOML_NODISCARD
-		table_iterator begin() noexcept
+		TOML_PURE_INLINE_GETTER
+		size_t indent_columns() const noexcept
 		{
-			return err_ ? table_iterator{} : table().begin();
+			return indent_columns_;
 		}
 
-		TOML_NODISCARD
-		const_table_iterator begin() const noexcept
+		TOML_PURE_INLINE_GETTER
+		bool indent_array_elements() const noexcept
 		{
-			return err_ ? const_table_iterator{} : table().begin();
+			return !!(config_.flags & format_flags::indent_array_elements);
 		}
 
-		TOML_NODISCARD
-		const_table_iterator cbegin() const noexcept
+		TOML_PURE_INLINE_GETTER
+		bool indent_sub_tables() const noexcept
 		{
-			return err_ ? const_table_iterator{} : table().cbegin();
+			return !!(config_.flags & format_flags::indent_sub_tables);
 		}
 
-		TOML_NODISCARD
-		table_iterator end() noexcept
+		TOML_PURE_INLINE_GETTER
+		bool literal_strings_allowed() const noexcept
 		{
-			return err_ ? table_iterator{} : table().end();
+			return !!(config_.flags & format_flags::allow_literal_strings);
 		}
 
-		TOML_NODISCARD
-		const_table_iterator end() const noexcept
+		TOML_PURE_INLINE_GETTER
+		bool multi_line_strings_allowed() const noexcept
 		{
-			return err_ ? const_table_iterator{} : table().end();
+			return !!(config_.flags & format_flags::allow_multi_line_strings);
 		}
 
-		TOML_NODISCARD
-		const_table_iterator cend() const noexcept
+		TOML_PURE_INLINE_GETTER
+		bool real_tabs_in_strings_allowed() const noexcept
 		{
-			return err_ ? const_table_iterator{} : table().cend();
+			return !!(config_.flags & format_flags::allow_real_tabs_in_strings);
 		}
 
-		TOML_NODISCARD
-		node_view<node> at_path(std::string_view path) noexcept
+		TOML_PURE_INLINE_GETTER
+		bool unicode_strings_allowed() const noexcept
 		{
-			return err_ ? node_view<node>{} : table().at_path(path);
+			return !!(config_.flags & format_flags::allow_unicode_strings);
 		}
 
-		TOML_NODISCARD
-		node_view<const node> at_path(std::string_view path) const noexcept
+		TOML_PURE_INLINE_GETTER
+		bool terse_kvps() const noexcept
 		{
-			return err_ ? node_view<const node>{} : table().at_path(path);
+			return !!(config_.flags & format_flags::terse_key_value_pairs);
 		}
 
-		TOML_NODISCARD
-		node_view<node> at_path(const toml::path& path) noexcept
-		{
-			return err_ ? node_view<node>{} : table().at_path(path);
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void attach(std::ostream& stream) noexcept;
 
-		TOML_NODISCARD
-		node_view<const node> at_path(const toml::path& path) const noexcept
-		{
-			return err_ ? node_view<const node>{} : table().at_path(path);
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void detach() noexcept;
 
-#if TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_newline(bool force = false);
 
-		TOML_NODISCARD
-		node_view<node> at_path(std::wstring_view path)
-		{
-			return err_ ? node_view<node>{} : table().at_path(path);
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_indent();
 
-		TOML_NODISCARD
-		node_view<const node> at_path(std::wstring_view path) const
-		{
-			return err_ ? node_view<const node>{} : table().at_path(path);
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_unformatted(char);
 
-#endif
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_unformatted(std::string_view);
 
-		TOML_NODISCARD
-		node_view<node> operator[](const toml::path& path) noexcept
-		{
-			return err_ ? node_view<node>{} : table()[path];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_string(std::string_view str,
+						  bool allow_multi_line			= true,
+						  bool allow_bare				= false,
+						  bool allow_literal_whitespace = true);
 
-		TOML_NODISCARD
-		node_view<const node> operator[](const toml::path& path) const noexcept
-		{
-			return err_ ? node_view<const node>{} : table()[path];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<std::string>&);
 
-		TOML_NODISCARD
-		node_view<node> operator[](std::string_view key) noexcept
-		{
-			return err_ ? node_view<node>{} : table()[key];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<int64_t>&);
 
-		TOML_NODISCARD
-		node_view<const node> operator[](std::string_view key) const noexcept
-		{
-			return err_ ? node_view<const node>{} : table()[key];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<double>&);
 
-#if TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<bool>&);
 
-		TOML_NODISCARD
-		node_view<node> operator[](std::wstring_view key)
-		{
-			return err_ ? node_view<node>{} : table()[key];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<date>&);
 
-		TOML_NODISCARD
-		node_view<const node> operator[](std::wstring_view key) const
-		{
-			return err_ ? node_view<const node>{} : table()[key];
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<time>&);
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const value<date_time>&);
 
-#if TOML_ENABLE_FORMATTERS
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_value(const node&, node_type);
 
-		friend std::ostream& operator<<(std::ostream& os, const parse_result& result)
-		{
-			return result.err_ ? (os << result.error()) : (os << result.table());
-		}
+		TOML_NODISCARD
+		TOML_EXPORTED_MEMBER_FUNCTION
+		bool dump_failed_parse_result();
 
-#endif
+		TOML_NODISCARD_CTOR
+		TOML_EXPORTED_MEMBER_FUNCTION
+		formatter(const node*, const parse_result*, const formatter_constants&, const formatter_config&) noexcept;
 	};
-
-	TOML_ABI_NAMESPACE_END;
 }
-TOML_NAMESPACE_END;
+TOML_IMPL_NAMESPACE_END;
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -9509,113 +12379,99 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_PARSER && !TOML_EXCEPTIONS
-
-//********  impl/parser.hpp  *******************************************************************************************
-
-#if TOML_ENABLE_PARSER
-
-TOML_PUSH_WARNINGS;
-#ifdef _MSC_VER
-#ifndef __clang__
-#pragma inline_recursion(on)
-#endif
-#pragma push_macro("min")
-#pragma push_macro("max")
-#undef min
-#undef max
-#endif
-
-TOML_NAMESPACE_START
-{
-	TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, ex, noex);
-
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::string_view doc, std::string_view source_path = {});
-
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::string_view doc, std::string && source_path);
+#endif // TOML_ENABLE_FORMATTERS
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse_file(std::string_view file_path);
+//********  impl/toml_formatter.hpp  ***********************************************************************************
 
-#if TOML_HAS_CHAR8
+#if TOML_ENABLE_FORMATTERS
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::string_view source_path = {});
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::string && source_path);
+TOML_NAMESPACE_START
+{
+	class TOML_EXPORTED_CLASS toml_formatter : impl::formatter
+	{
+	  private:
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse_file(std::u8string_view file_path);
+		using base = impl::formatter;
+		std::vector<const key*> key_path_;
+		bool pending_table_separator_ = false;
 
-#endif // TOML_HAS_CHAR8
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_pending_table_separator();
 
-#if TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const key&);
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::string_view doc, std::wstring_view source_path);
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print_inline(const toml::table&);
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::istream & doc, std::wstring_view source_path);
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const toml::array&);
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse_file(std::wstring_view file_path);
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const toml::table&);
 
-#endif // TOML_ENABLE_WINDOWS_COMPAT
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print();
 
-#if TOML_HAS_CHAR8 && TOML_ENABLE_WINDOWS_COMPAT
+		static constexpr impl::formatter_constants constants = { format_flags::none, // mandatory
+																 format_flags::none, // ignored
+																 "inf"sv,
+																 "-inf"sv,
+																 "nan"sv,
+																 "true"sv,
+																 "false"sv };
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::u8string_view doc, std::wstring_view source_path);
+	  public:
 
-#endif // TOML_HAS_CHAR8 && TOML_ENABLE_WINDOWS_COMPAT
+		static constexpr format_flags default_flags = constants.mandatory_flags				   //
+													| format_flags::allow_literal_strings	   //
+													| format_flags::allow_multi_line_strings   //
+													| format_flags::allow_unicode_strings	   //
+													| format_flags::allow_real_tabs_in_strings //
+													| format_flags::allow_binary_integers	   //
+													| format_flags::allow_octal_integers	   //
+													| format_flags::allow_hexadecimal_integers //
+													| format_flags::indentation;
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::istream & doc, std::string_view source_path = {});
+		TOML_NODISCARD_CTOR
+		explicit toml_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
+			: base{ &source, nullptr, constants, { flags, "    "sv } }
+		{}
 
-	TOML_NODISCARD
-	TOML_EXPORTED_FREE_FUNCTION
-	parse_result TOML_CALLCONV parse(std::istream & doc, std::string && source_path);
+#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
 
-	TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
+		TOML_NODISCARD_CTOR
+		explicit toml_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
+			: base{ nullptr, &result, constants, { flags, "    "sv } }
+		{}
 
-	inline namespace literals
-	{
-		TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, lit_ex, lit_noex);
+#endif
 
-		TOML_NODISCARD
-		TOML_ALWAYS_INLINE
-		parse_result operator"" _toml(const char* str, size_t len)
+		friend std::ostream& operator<<(std::ostream& lhs, toml_formatter& rhs)
 		{
-			return parse(std::string_view{ str, len });
+			rhs.attach(lhs);
+			rhs.key_path_.clear();
+			rhs.print();
+			rhs.detach();
+			return lhs;
 		}
 
-#if TOML_HAS_CHAR8
-
-		TOML_NODISCARD
-		TOML_ALWAYS_INLINE
-		parse_result operator"" _toml(const char8_t* str, size_t len)
+		friend std::ostream& operator<<(std::ostream& lhs, toml_formatter&& rhs)
 		{
-			return parse(std::u8string_view{ str, len });
+			return lhs << rhs; // as lvalue
 		}
-
-#endif // TOML_HAS_CHAR8
-
-		TOML_ABI_NAMESPACE_END; // TOML_EXCEPTIONS
-	}
+	};
 }
 TOML_NAMESPACE_END;
 
@@ -9628,9 +12484,9 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_PARSER
+#endif // TOML_ENABLE_FORMATTERS
 
-//********  impl/formatter.hpp  ****************************************************************************************
+//********  impl/json_formatter.hpp  ***********************************************************************************
 
 #if TOML_ENABLE_FORMATTERS
 
@@ -9645,182 +12501,164 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-TOML_IMPL_NAMESPACE_START
+TOML_NAMESPACE_START
 {
-	struct formatter_constants
+	class TOML_EXPORTED_CLASS json_formatter : impl::formatter
 	{
-		format_flags mandatory_flags;
-		format_flags ignored_flags;
-
-		std::string_view float_pos_inf;
-		std::string_view float_neg_inf;
-		std::string_view float_nan;
-
-		std::string_view bool_true;
-		std::string_view bool_false;
-	};
+	  private:
 
-	struct formatter_config
-	{
-		format_flags flags;
-		std::string_view indent;
-	};
+		using base = impl::formatter;
 
-	class TOML_EXPORTED_CLASS formatter
-	{
-	  private:
-		const node* source_;
-#if TOML_ENABLE_PARSER && !TOML_EXCEPTIONS
-		const parse_result* result_;
-#endif
-		const formatter_constants* constants_;
-		formatter_config config_;
-		size_t indent_columns_;
-		format_flags int_format_mask_;
-		std::ostream* stream_; //
-		int indent_;		   // these are set in attach()
-		bool naked_newline_;   //
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const toml::table&);
 
-	  protected:
-		TOML_PURE_INLINE_GETTER
-		const node& source() const noexcept
-		{
-			return *source_;
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print(const toml::array&);
 
-		TOML_PURE_INLINE_GETTER
-		std::ostream& stream() const noexcept
-		{
-			return *stream_;
-		}
+		TOML_EXPORTED_MEMBER_FUNCTION
+		void print();
 
-		TOML_PURE_INLINE_GETTER
-		int indent() const noexcept
-		{
-			return indent_;
-		}
+		static constexpr impl::formatter_constants constants = {
+			format_flags::quote_dates_and_times,										  // mandatory
+			format_flags::allow_literal_strings | format_flags::allow_multi_line_strings, // ignored
+			"Infinity"sv,
+			"-Infinity"sv,
+			"NaN"sv,
+			"true"sv,
+			"false"sv
+		};
 
-		void indent(int level) noexcept
-		{
-			indent_ = level;
-		}
+	  public:
 
-		void increase_indent() noexcept
-		{
-			indent_++;
-		}
+		static constexpr format_flags default_flags = constants.mandatory_flags				  //
+													| format_flags::quote_infinities_and_nans //
+													| format_flags::allow_unicode_strings	  //
+													| format_flags::indentation;
 
-		void decrease_indent() noexcept
-		{
-			indent_--;
-		}
+		TOML_NODISCARD_CTOR
+		explicit json_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
+			: base{ &source, nullptr, constants, { flags, "    "sv } }
+		{}
 
-		TOML_PURE_INLINE_GETTER
-		size_t indent_columns() const noexcept
-		{
-			return indent_columns_;
-		}
+#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
 
-		TOML_PURE_INLINE_GETTER
-		bool indent_array_elements() const noexcept
-		{
-			return !!(config_.flags & format_flags::indent_array_elements);
-		}
+		TOML_NODISCARD_CTOR
+		explicit json_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
+			: base{ nullptr, &result, constants, { flags, "    "sv } }
+		{}
 
-		TOML_PURE_INLINE_GETTER
-		bool indent_sub_tables() const noexcept
-		{
-			return !!(config_.flags & format_flags::indent_sub_tables);
-		}
+#endif
 
-		TOML_PURE_INLINE_GETTER
-		bool literal_strings_allowed() const noexcept
+		friend std::ostream& operator<<(std::ostream& lhs, json_formatter& rhs)
 		{
-			return !!(config_.flags & format_flags::allow_literal_strings);
+			rhs.attach(lhs);
+			rhs.print();
+			rhs.detach();
+			return lhs;
 		}
 
-		TOML_PURE_INLINE_GETTER
-		bool multi_line_strings_allowed() const noexcept
+		friend std::ostream& operator<<(std::ostream& lhs, json_formatter&& rhs)
 		{
-			return !!(config_.flags & format_flags::allow_multi_line_strings);
+			return lhs << rhs; // as lvalue
 		}
+	};
+}
+TOML_NAMESPACE_END;
 
-		TOML_PURE_INLINE_GETTER
-		bool real_tabs_in_strings_allowed() const noexcept
-		{
-			return !!(config_.flags & format_flags::allow_real_tabs_in_strings);
-		}
+#ifdef _MSC_VER
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+#ifndef __clang__
+#pragma inline_recursion(off)
+#endif
+#endif
+TOML_POP_WARNINGS;
 
-		TOML_PURE_INLINE_GETTER
-		bool unicode_strings_allowed() const noexcept
-		{
-			return !!(config_.flags & format_flags::allow_unicode_strings);
-		}
+#endif // TOML_ENABLE_FORMATTERS
 
-		TOML_PURE_INLINE_GETTER
-		bool terse_kvps() const noexcept
-		{
-			return !!(config_.flags & format_flags::terse_key_value_pairs);
-		}
+//********  impl/yaml_formatter.hpp  ***********************************************************************************
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void attach(std::ostream& stream) noexcept;
+#if TOML_ENABLE_FORMATTERS
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void detach() noexcept;
+TOML_PUSH_WARNINGS;
+#ifdef _MSC_VER
+#ifndef __clang__
+#pragma inline_recursion(on)
+#endif
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#endif
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_newline(bool force = false);
+TOML_NAMESPACE_START
+{
+	class TOML_EXPORTED_CLASS yaml_formatter : impl::formatter
+	{
+	  private:
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_indent();
+		using base = impl::formatter;
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_unformatted(char);
+		void print_yaml_string(const value<std::string>&);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_unformatted(std::string_view);
+		void print(const toml::table&, bool = false);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_string(std::string_view str,
-						  bool allow_multi_line			= true,
-						  bool allow_bare				= false,
-						  bool allow_literal_whitespace = true);
+		void print(const toml::array&, bool = false);
 
 		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<std::string>&);
+		void print();
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<int64_t>&);
+		static constexpr impl::formatter_constants constants = {
+			//
+			format_flags::quote_dates_and_times | format_flags::indentation, // mandatory
+			format_flags::allow_multi_line_strings,							 // ignored
+			".inf"sv,
+			"-.inf"sv,
+			".NAN"sv,
+			"true"sv,
+			"false"sv
+		};
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<double>&);
+	  public:
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<bool>&);
+		static constexpr format_flags default_flags = constants.mandatory_flags			  //
+													| format_flags::allow_literal_strings //
+													| format_flags::allow_unicode_strings //
+													| format_flags::allow_octal_integers  //
+													| format_flags::allow_hexadecimal_integers;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<date>&);
+		TOML_NODISCARD_CTOR
+		explicit yaml_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
+			: base{ &source, nullptr, constants, { flags, "  "sv } }
+		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<time>&);
+#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const value<date_time>&);
+		TOML_NODISCARD_CTOR
+		explicit yaml_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
+			: base{ nullptr, &result, constants, { flags, "  "sv } }
+		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_value(const node&, node_type);
+#endif
 
-		TOML_NODISCARD
-		TOML_EXPORTED_MEMBER_FUNCTION
-		bool dump_failed_parse_result();
+		friend std::ostream& TOML_CALLCONV operator<<(std::ostream& lhs, yaml_formatter& rhs)
+		{
+			rhs.attach(lhs);
+			rhs.print();
+			rhs.detach();
+			return lhs;
+		}
 
-		TOML_NODISCARD_CTOR
-		TOML_EXPORTED_MEMBER_FUNCTION
-		formatter(const node*, const parse_result*, const formatter_constants&, const formatter_config&) noexcept;
+		friend std::ostream& TOML_CALLCONV operator<<(std::ostream& lhs, yaml_formatter&& rhs)
+		{
+			return lhs << rhs; // as lvalue
+		}
 	};
 }
-TOML_IMPL_NAMESPACE_END;
+TOML_NAMESPACE_END;
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -9833,9 +12671,7 @@ TOML_POP_WARNINGS;
 
 #endif // TOML_ENABLE_FORMATTERS
 
-//********  impl/toml_formatter.hpp  ***********************************************************************************
-
-#if TOML_ENABLE_FORMATTERS
+//********  impl/snapshot.hpp  *****************************************************************************************
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -9848,84 +12684,381 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-TOML_NAMESPACE_START
+TOML_IMPL_NAMESPACE_START
 {
-	class TOML_EXPORTED_CLASS toml_formatter : impl::formatter
+	// a pointer-free binary image of a table, so a document can be loaded again without being parsed. a snapshot is
+	// a header (magic, version, byte order, total size and a checksum of the rest) followed by the nodes in
+	// depth-first order:
+	//
+	//   table:      type, inline (u8), entry count (u32), then each key (u32 length, chars) and its value
+	//   array:      type, element count (u32), then each element
+	//   string:     type, flags (u16), length (u32), chars
+	//   integer:    type, flags, int64        floating_point: type, flags, double     boolean: type, flags, u8
+	//   date:       type, flags, year (u16), month, day
+	//   time:       type, flags, hour, minute, second, nanosecond (u32)
+	//   date_time:  type, flags, date, time, whether there's an offset (u8), offset minutes (i16)
+	//
+	// numbers are in the byte order of the machine that wrote the snapshot, and snapshots written with another byte
+	// order or format version are rejected rather than converted. source regions aren't stored.
+	class snapshot
 	{
 	  private:
+		static constexpr char magic[8]		  = { 'T', 'O', 'M', 'L', 'S', 'N', 'A', 'P' };
+		static constexpr uint32_t version	  = 2u;
+		static constexpr uint32_t byte_order  = 0x01020304u;
+		static constexpr size_t header_size	  = sizeof(magic) + sizeof(uint32_t) * 2u + sizeof(uint64_t) * 2u;
+		static constexpr size_t max_depth	  = TOML_MAX_NESTED_VALUES;
 
-		using base = impl::formatter;
-		std::vector<const key*> key_path_;
-		bool pending_table_separator_ = false;
+		class writer
+		{
+		  private:
+			std::string& out_;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_pending_table_separator();
+			template <typename T>
+			void put(const T& val)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				out_.append(reinterpret_cast<const char*>(&val), sizeof(T));
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const key&);
+			void put(std::string_view str)
+			{
+				put(static_cast<uint32_t>(str.length()));
+				out_.append(str.data(), str.length());
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_inline(const toml::table&);
+			void put(const toml::date& d)
+			{
+				put(d.year);
+				put(d.month);
+				put(d.day);
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::array&);
+			void put(const toml::time& t)
+			{
+				put(t.hour);
+				put(t.minute);
+				put(t.second);
+				put(t.nanosecond);
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::table&);
+			template <typename T>
+			void write_value(const value<T>& val)
+			{
+				put(static_cast<uint8_t>(val.type()));
+				put(static_cast<std::underlying_type_t<value_flags>>(val.flags()));
+				if constexpr (std::is_same_v<T, std::string>)
+					put(val.view());
+				else if constexpr (std::is_same_v<T, bool>)
+					put(static_cast<uint8_t>(val.get()));
+				else if constexpr (std::is_same_v<T, date_time>)
+				{
+					put(val.get().date);
+					put(val.get().time);
+					put(static_cast<uint8_t>(!!val.get().offset));
+					put(val.get().offset ? val.get().offset->minutes : int16_t{});
+				}
+				else
+					put(val.get());
+			}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print();
+		  public:
+			TOML_NODISCARD_CTOR
+			explicit writer(std::string& out) noexcept //
+				: out_{ out }
+			{}
 
-		static constexpr impl::formatter_constants constants = { format_flags::none, // mandatory
-																 format_flags::none, // ignored
-																 "inf"sv,
-																 "-inf"sv,
-																 "nan"sv,
-																 "true"sv,
-																 "false"sv };
+			void write(const node& n)
+			{
+				if (auto tbl = n.as_table())
+				{
+					put(static_cast<uint8_t>(node_type::table));
+					put(static_cast<uint8_t>(tbl->is_inline()));
+					put(static_cast<uint32_t>(tbl->size()));
+					for (auto&& [k, v] : *tbl)
+					{
+						put(k.str());
+						write(v);
+					}
+				}
+				else if (auto arr = n.as_array())
+				{
+					put(static_cast<uint8_t>(node_type::array));
+					put(static_cast<uint32_t>(arr->size()));
+					if (auto packed = arr->packed(); packed && !packed->has_nodes())
+					{
+						// without making nodes for the elements just to write them out
+						for (size_t i = 0; i < packed->size(); i++)
+							packed->visit(i, [&](const auto& elem) { write(elem); });
+					}
+					else
+					{
+						for (auto&& elem : *arr)
+							write(elem);
+					}
+				}
+				else
+					n.visit(
+						[&](const auto& val)
+						{
+							if constexpr (is_value<decltype(val)>)
+								this->write_value(val);
+						});
+			}
+		};
 
-	  public:
+		class reader
+		{
+		  private:
+			const char* pos_;
+			const char* end_;
+			bool pack_;
+			key_interner keys_;
 
-		static constexpr format_flags default_flags = constants.mandatory_flags				   //
-													| format_flags::allow_literal_strings	   //
-													| format_flags::allow_multi_line_strings   //
-													| format_flags::allow_unicode_strings	   //
-													| format_flags::allow_real_tabs_in_strings //
-													| format_flags::allow_binary_integers	   //
-													| format_flags::allow_octal_integers	   //
-													| format_flags::allow_hexadecimal_integers //
-													| format_flags::indentation;
+			template <typename T>
+			TOML_NODISCARD
+			bool get(T& val) noexcept
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				if (static_cast<size_t>(end_ - pos_) < sizeof(T))
+					return false;
+				std::memcpy(&val, pos_, sizeof(T));
+				pos_ += sizeof(T);
+				return true;
+			}
 
-		TOML_NODISCARD_CTOR
-		explicit toml_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
-			: base{ &source, nullptr, constants, { flags, "    "sv } }
-		{}
+			TOML_NODISCARD
+			bool get(std::string_view& str) noexcept
+			{
+				uint32_t length;
+				if (!get(length) || static_cast<size_t>(end_ - pos_) < length)
+					return false;
+				str = { pos_, length };
+				pos_ += length;
+				return true;
+			}
 
-#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
+			TOML_NODISCARD
+			bool get(toml::date& d) noexcept
+			{
+				return get(d.year) && get(d.month) && get(d.day);
+			}
 
-		TOML_NODISCARD_CTOR
-		explicit toml_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
-			: base{ nullptr, &result, constants, { flags, "    "sv } }
-		{}
+			TOML_NODISCARD
+			bool get(toml::time& t) noexcept
+			{
+				return get(t.hour) && get(t.minute) && get(t.second) && get(t.nanosecond);
+			}
 
-#endif
+			template <typename T>
+			TOML_NODISCARD
+			node_ptr read_value(value_flags flags)
+			{
+				std::unique_ptr<value<T>> val;
+				if constexpr (std::is_same_v<T, std::string>)
+				{
+					std::string_view str;
+					if (!get(str))
+						return {};
+
+					// long strings refer to the snapshot, like parse_flags::string_views does for documents
+					if (str.length() > std::string{}.capacity())
+						val.reset(new value<std::string>{ raw_value_tag{}, str });
+					else
+						val.reset(new value<std::string>{ str });
+				}
+				else if constexpr (std::is_same_v<T, bool>)
+				{
+					uint8_t b;
+					if (!get(b) || b > 1u)
+						return {};
+					val.reset(new value<bool>{ !!b });
+				}
+				else if constexpr (std::is_same_v<T, date_time>)
+				{
+					toml::date_time dt;
+					uint8_t has_offset;
+					int16_t minutes;
+					if (!get(dt.date) || !get(dt.time) || !get(has_offset) || !get(minutes) || has_offset > 1u)
+						return {};
+					if (has_offset)
+						dt.offset = time_offset{ 0, minutes };
+					val.reset(new value<date_time>{ dt });
+				}
+				else
+				{
+					T v;
+					if (!get(v))
+						return {};
+					val.reset(new value<T>{ v });
+				}
+				val->flags(flags);
+				return val;
+			}
+
+			TOML_NODISCARD
+			node_ptr read_table(size_t depth)
+			{
+				uint8_t is_inline;
+				uint32_t count;
+				if (!get(is_inline) || !get(count) || is_inline > 1u)
+					return {};
+
+				std::unique_ptr<table> tbl{ new table{} };
+				tbl->is_inline(!!is_inline);
+				tbl->map_.reserve((std::min)(size_t{ count }, static_cast<size_t>(end_ - pos_)));
+				std::string_view prev;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					// (the keys were written in order, and are appended in order)
+					std::string_view k;
+					if (!get(k) || (i && k <= prev))
+						return {};
+					prev = k;
+					auto v = read(depth + 1u);
+					if (!v)
+						return {};
+
+					toml::key key = k.empty() ? toml::key{} : toml::key{ keys_.intern(k), source_region{} };
+					tbl->map_.emplace_hint(tbl->map_.end(), std::move(key), std::move(v));
+				}
+				return tbl;
+			}
+
+			TOML_NODISCARD
+			node_ptr read_array(size_t depth)
+			{
+				uint32_t count;
+				if (!get(count))
+					return {};
+
+				std::unique_ptr<array> arr{ new array{} };
+				arr->elems_.reserve((std::min)(size_t{ count }, static_cast<size_t>(end_ - pos_)));
+				for (uint32_t i = 0; i < count; i++)
+				{
+					auto elem = read(depth + 1u);
+					if (!elem)
+						return {};
+					arr->elems_.push_back(std::move(elem));
+				}
+				if (pack_)
+					arr->pack();
+				return arr;
+			}
+
+		  public:
+			TOML_NODISCARD_CTOR
+			reader(std::string_view bytes, bool pack) noexcept //
+				: pos_{ bytes.data() },
+				  end_{ bytes.data() + bytes.length() },
+				  pack_{ pack }
+			{}
+
+			TOML_PURE_INLINE_GETTER
+			bool at_end() const noexcept
+			{
+				return pos_ == end_;
+			}
+
+			// returns nullptr if the snapshot is malformed.
+			TOML_NODISCARD
+			node_ptr read(size_t depth = 0)
+			{
+				uint8_t type;
+				if (depth > max_depth || !get(type))
+					return {};
+				if (type == static_cast<uint8_t>(node_type::table))
+					return read_table(depth);
+				if (type == static_cast<uint8_t>(node_type::array))
+					return read_array(depth);
+
+				std::underlying_type_t<value_flags> flags;
+				if (!get(flags))
+					return {};
+				switch (static_cast<node_type>(type))
+				{
+					case node_type::string: return read_value<std::string>(value_flags{ flags });
+					case node_type::integer: return read_value<int64_t>(value_flags{ flags });
+					case node_type::floating_point: return read_value<double>(value_flags{ flags });
+					case node_type::boolean: return read_value<bool>(value_flags{ flags });
+					case node_type::date: return read_value<toml::date>(value_flags{ flags });
+					case node_type::time: return read_value<toml::time>(value_flags{ flags });
+					case node_type::date_time: return read_value<toml::date_time>(value_flags{ flags });
+					default: return {};
+				}
+			}
+		};
+
+	  public:
+		// a 64-bit hash of `bytes` that's the same in every process (unlike std::hash). the header stores the
+		// checksum of everything after it, so that a damaged snapshot is rejected instead of read as another table.
+		TOML_PURE_GETTER
+		static uint64_t checksum(std::string_view bytes) noexcept
+		{
+			uint64_t hash = 0x9E3779B97F4A7C15ull ^ bytes.size();
+			size_t i	  = 0;
+			for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, bytes.data() + i, sizeof(word));
+				hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+				hash ^= hash >> 32;
+			}
+
+			uint64_t tail = 0;
+			if (i < bytes.size())
+				std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+			hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull;
+			return hash ^ (hash >> 29);
+		}
 
-		friend std::ostream& operator<<(std::ostream& lhs, toml_formatter& rhs)
+		// appends a snapshot of `tbl` to `out`.
+		static void write(const table& tbl, std::string& out)
 		{
-			rhs.attach(lhs);
-			rhs.key_path_.clear();
-			rhs.print();
-			rhs.detach();
-			return lhs;
+			const auto start = out.size();
+			out.append(magic, sizeof(magic));
+			out.append(reinterpret_cast<const char*>(&version), sizeof(version));
+			out.append(reinterpret_cast<const char*>(&byte_order), sizeof(byte_order));
+			out.append(sizeof(uint64_t) * 2u, '\0');
+
+			writer{ out }.write(tbl);
+
+			const uint64_t size		= out.size() - start;
+			const uint64_t sum		= checksum(std::string_view{ out }.substr(start + header_size));
+			std::memcpy(&out[start + header_size - sizeof(uint64_t) * 2u], &size, sizeof(size));
+			std::memcpy(&out[start + header_size - sizeof(uint64_t)], &sum, sizeof(sum));
 		}
 
-		friend std::ostream& operator<<(std::ostream& lhs, toml_formatter&& rhs)
+		// reads a snapshot written by write() into `tbl`, returning false (and leaving `tbl` alone) if it isn't one.
+		// long strings refer to their characters in `bytes`, which must outlive the table. arrays are packed where they
+		// can be unless `pack` is false (packed arrays create nodes for their elements as they're accessed).
+		TOML_NODISCARD
+		static bool read(std::string_view bytes, table& tbl, bool pack = true)
 		{
-			return lhs << rhs; // as lvalue
+			if (bytes.length() < header_size || std::memcmp(bytes.data(), magic, sizeof(magic)) != 0)
+				return false;
+
+			uint32_t ver, order;
+			uint64_t size, sum;
+			std::memcpy(&ver, bytes.data() + sizeof(magic), sizeof(ver));
+			std::memcpy(&order, bytes.data() + sizeof(magic) + sizeof(ver), sizeof(order));
+			std::memcpy(&size, bytes.data() + sizeof(magic) + sizeof(ver) + sizeof(order), sizeof(size));
+			std::memcpy(&sum, bytes.data() + header_size - sizeof(sum), sizeof(sum));
+			if (ver != version || order != byte_order || size != bytes.length()
+				|| sum != checksum(bytes.substr(header_size)))
+				return false;
+
+			reader r{ bytes.substr(header_size), pack };
+			auto root = r.read();
+			if (!root || !root->is_table() || !r.at_end())
+				return false;
+
+			tbl = std::move(*root->as_table());
+			return true;
 		}
 	};
 }
-TOML_NAMESPACE_END;
+TOML_IMPL_NAMESPACE_END;
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -9936,11 +13069,7 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_FORMATTERS
-
-//********  impl/json_formatter.hpp  ***********************************************************************************
-
-#if TOML_ENABLE_FORMATTERS
+//********  impl/hasher.hpp  *******************************************************************************************
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -9953,69 +13082,144 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-TOML_NAMESPACE_START
+TOML_IMPL_NAMESPACE_START
 {
-	class TOML_EXPORTED_CLASS json_formatter : impl::formatter
+	// a 64-bit hash of a node's structure and values, such that nodes that compare equal hash the same (so value
+	// flags, source regions, whether tables are inline and how arrays are stored don't count). it doesn't depend on
+	// where anything is in memory, so it's the same in every process on machines with the same byte order. frozen
+	// tables and arrays (see table::freeze()) can't change, so their hashes are cached the first time they're
+	// computed, and hashing a document again after changing part of it only visits what was thawed to change it.
+	class hasher
 	{
 	  private:
+		uint64_t state_;
 
-		using base = impl::formatter;
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::table&);
+		TOML_NODISCARD_CTOR
+		explicit hasher(node_type type, size_t size) noexcept //
+			: state_{ 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(type) << 56) ^ size }
+		{}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::array&);
+		void mix(uint64_t word) noexcept
+		{
+			state_ = (state_ ^ word) * 0xFF51AFD7ED558CCDull;
+			state_ ^= state_ >> 32;
+		}
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print();
+		void mix(std::string_view str) noexcept
+		{
+			mix(static_cast<uint64_t>(str.length()));
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= str.length(); i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, str.data() + i, sizeof(word));
+				mix(word);
+			}
+			uint64_t tail = 0;
+			std::memcpy(&tail, str.data() + i, str.length() - i);
+			mix(tail);
+		}
 
-		static constexpr impl::formatter_constants constants = {
-			format_flags::quote_dates_and_times,										  // mandatory
-			format_flags::allow_literal_strings | format_flags::allow_multi_line_strings, // ignored
-			"Infinity"sv,
-			"-Infinity"sv,
-			"NaN"sv,
-			"true"sv,
-			"false"sv
-		};
+		void mix(const date& d) noexcept
+		{
+			mix(uint64_t{ d.year } | uint64_t{ d.month } << 16 | uint64_t{ d.day } << 24);
+		}
 
-	  public:
+		void mix(const time& t) noexcept
+		{
+			mix(uint64_t{ t.hour } | uint64_t{ t.minute } << 8 | uint64_t{ t.second } << 16
+				| uint64_t{ t.nanosecond } << 32);
+		}
 
-		static constexpr format_flags default_flags = constants.mandatory_flags				  //
-													| format_flags::quote_infinities_and_nans //
-													| format_flags::allow_unicode_strings	  //
-													| format_flags::indentation;
+		// as doubles compare: every nan is the same, and so are the zeros
+		void mix(double d) noexcept
+		{
+			if (impl::fpclassify(d) == impl::fp_class::nan)
+				d = std::numeric_limits<double>::quiet_NaN();
+			else if (d == 0.0)
+				d = 0.0;
+			uint64_t bits;
+			std::memcpy(&bits, &d, sizeof(bits));
+			mix(bits);
+		}
 
-		TOML_NODISCARD_CTOR
-		explicit json_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
-			: base{ &source, nullptr, constants, { flags, "    "sv } }
-		{}
+		void mix(const date_time& dt) noexcept
+		{
+			mix(dt.date);
+			mix(dt.time);
+			mix(dt.offset ? uint64_t{ 1u } << 16 | static_cast<uint16_t>(dt.offset->minutes) : uint64_t{});
+		}
 
-#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
+		// never zero, which is how frozen contents say they haven't been hashed yet
+		TOML_NODISCARD
+		uint64_t finish() const noexcept
+		{
+			auto h = state_ * 0xC4CEB9FE1A85EC53ull;
+			h ^= h >> 29;
+			return h ? h : 1u;
+		}
 
-		TOML_NODISCARD_CTOR
-		explicit json_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
-			: base{ nullptr, &result, constants, { flags, "    "sv } }
-		{}
+		TOML_NODISCARD
+		static uint64_t cached(std::atomic<uint64_t>* cache, uint64_t (*compute)(const void*), const void* n)
+		{
+			if (!cache)
+				return compute(n);
+			if (const auto h = cache->load(std::memory_order_relaxed))
+				return h;
+			const auto h = compute(n);
+			cache->store(h, std::memory_order_relaxed);
+			return h;
+		}
 
-#endif
+		TOML_NODISCARD
+		static uint64_t hash_entries(const void* n)
+		{
+			const auto& tbl = *static_cast<const table*>(n);
+			hasher h{ node_type::table, tbl.size() };
+			for (auto&& [k, v] : tbl)
+			{
+				h.mix(k.str());
+				h.mix(of(v));
+			}
+			return h.finish();
+		}
 
-		friend std::ostream& operator<<(std::ostream& lhs, json_formatter& rhs)
+		TOML_NODISCARD
+		static uint64_t hash_elements(const void* n)
 		{
-			rhs.attach(lhs);
-			rhs.print();
-			rhs.detach();
-			return lhs;
+			const auto& arr = *static_cast<const array*>(n);
+			hasher h{ node_type::array, arr.size() };
+			for (size_t i = 0, e = arr.size(); i < e; i++)
+				h.mix(visit_array_element(arr, i, [](const node& elem) { return of(elem); }));
+			return h.finish();
 		}
 
-		friend std::ostream& operator<<(std::ostream& lhs, json_formatter&& rhs)
+	  public:
+		TOML_NODISCARD
+		static uint64_t of(const node& n)
 		{
-			return lhs << rhs; // as lvalue
+			if (const auto tbl = n.as_table())
+				return cached(tbl->map_.cached_hash(), hash_entries, tbl);
+			if (const auto arr = n.as_array())
+				return cached(arr->cached_hash(), hash_elements, arr);
+
+			hasher h{ n.type(), 0u };
+			switch (n.type())
+			{
+				case node_type::string: h.mix(n.as_string()->view()); break;
+				case node_type::integer: h.mix(static_cast<uint64_t>(n.as_integer()->get())); break;
+				case node_type::floating_point: h.mix(n.as_floating_point()->get()); break;
+				case node_type::boolean: h.mix(uint64_t{ n.as_boolean()->get() }); break;
+				case node_type::date: h.mix(n.as_date()->get()); break;
+				case node_type::time: h.mix(n.as_time()->get()); break;
+				case node_type::date_time: h.mix(n.as_date_time()->get()); break;
+				default: TOML_UNREACHABLE;
+			}
+			return h.finish();
 		}
 	};
 }
-TOML_NAMESPACE_END;
+TOML_IMPL_NAMESPACE_END;
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -10026,11 +13230,7 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_FORMATTERS
-
-//********  impl/yaml_formatter.hpp  ***********************************************************************************
-
-#if TOML_ENABLE_FORMATTERS
+//********  impl/merger.hpp  *******************************************************************************************
 
 TOML_PUSH_WARNINGS;
 #ifdef _MSC_VER
@@ -10043,74 +13243,83 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
-TOML_NAMESPACE_START
+TOML_IMPL_NAMESPACE_START
 {
-	class TOML_EXPORTED_CLASS yaml_formatter : impl::formatter
+	// merges one table into another, recursing into tables that are in both. the source's entries are moved across
+	// (node pointers and all) in a single walk over both tables' keys in order, so nothing is copied or looked up.
+	// the nodes have to be in memory that outlives the source table (not an arena of its own).
+	class merger
 	{
-	  private:
-
-		using base = impl::formatter;
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print_yaml_string(const value<std::string>&);
-
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::table&, bool = false);
+	  public:
+		// what's done with a key that's in both tables, unless it's a table in both
+		enum class policy : uint8_t
+		{
+			replace,
+			keep,
+			append_arrays // joins arrays in both, and replaces anything else
+		};
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print(const toml::array&, bool = false);
+	  private:
+		policy policy_;
 
-		TOML_EXPORTED_MEMBER_FUNCTION
-		void print();
+		static void append(array& into, array& from)
+		{
+			auto& elems = into.elems();
+			auto& added = from.elems();
+			elems.reserve(elems.size() + added.size());
+			for (auto& elem : added)
+				elems.push_back(std::move(elem));
+		}
 
-		static constexpr impl::formatter_constants constants = {
-			//
-			format_flags::quote_dates_and_times | format_flags::indentation, // mandatory
-			format_flags::allow_multi_line_strings,							 // ignored
-			".inf"sv,
-			"-.inf"sv,
-			".NAN"sv,
-			"true"sv,
-			"false"sv
-		};
+		void merge(table& into, table& from) const
+		{
+			auto& entries = into.map_;
+			auto pos	  = entries.begin();
+			for (auto&& [k, v] : from.map_)
+			{
+				while (pos != entries.end() && pos->first < k)
+					pos++;
+
+				if (pos == entries.end() || k < pos->first)
+					pos = entries.emplace_hint(pos, k, std::move(v));
+				else if (pos->second->is_table() && v->is_table())
+					merge(*pos->second->as_table(), *v->as_table());
+				else if (policy_ == policy::append_arrays && pos->second->is_array() && v->is_array())
+					append(*pos->second->as_array(), *v->as_array());
+				else if (policy_ != policy::keep)
+					pos->second = std::move(v);
+				pos++;
+			}
+		}
 
 	  public:
-
-		static constexpr format_flags default_flags = constants.mandatory_flags			  //
-													| format_flags::allow_literal_strings //
-													| format_flags::allow_unicode_strings //
-													| format_flags::allow_octal_integers  //
-													| format_flags::allow_hexadecimal_integers;
-
 		TOML_NODISCARD_CTOR
-		explicit yaml_formatter(const toml::node& source, format_flags flags = default_flags) noexcept
-			: base{ &source, nullptr, constants, { flags, "  "sv } }
+		explicit merger(policy p) noexcept //
+			: policy_{ p }
 		{}
 
-#if TOML_DOXYGEN || (TOML_ENABLE_PARSER && !TOML_EXCEPTIONS)
-
-		TOML_NODISCARD_CTOR
-		explicit yaml_formatter(const toml::parse_result& result, format_flags flags = default_flags) noexcept
-			: base{ nullptr, &result, constants, { flags, "  "sv } }
-		{}
+		// merges `from` into `into`, leaving `from` empty (even if an allocation fails part way, since some of its
+		// values will have been moved by then).
+		void operator()(table& into, table& from) const
+		{
+			if (&into == &from)
+				return;
 
-#endif
+			struct clear_on_exit
+			{
+				table& tbl;
 
-		friend std::ostream& TOML_CALLCONV operator<<(std::ostream& lhs, yaml_formatter& rhs)
-		{
-			rhs.attach(lhs);
-			rhs.print();
-			rhs.detach();
-			return lhs;
-		}
+				~clear_on_exit() noexcept
+				{
+					tbl.clear();
+				}
+			} guard{ from };
 
-		friend std::ostream& TOML_CALLCONV operator<<(std::ostream& lhs, yaml_formatter&& rhs)
-		{
-			return lhs << rhs; // as lvalue
+			merge(into, from);
 		}
 	};
 }
-TOML_NAMESPACE_END;
+TOML_IMPL_NAMESPACE_END;
 
 #ifdef _MSC_VER
 #pragma pop_macro("min")
@@ -10121,8 +13330,6 @@ TOML_NAMESPACE_END;
 #endif
 TOML_POP_WARNINGS;
 
-#endif // TOML_ENABLE_FORMATTERS
-
 #if TOML_IMPLEMENTATION
 
 //********  impl/std_string.inl  ***************************************************************************************
@@ -10775,25 +13982,25 @@ TOML_NAMESPACE_START
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<node> node::at_path(std::string_view path) noexcept
+	node_view<node> node::at_path(std::string_view path)
 	{
 		return toml::at_path(*this, path);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<const node> node::at_path(std::string_view path) const noexcept
+	node_view<const node> node::at_path(std::string_view path) const
 	{
 		return toml::at_path(*this, path);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<node> node::at_path(const path& p) noexcept
+	node_view<node> node::at_path(const path& p)
 	{
 		return toml::at_path(*this, p);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<const node> node::at_path(const path& p) const noexcept
+	node_view<const node> node::at_path(const path& p) const
 	{
 		return toml::at_path(*this, p);
 	}
@@ -10815,13 +14022,13 @@ TOML_NAMESPACE_START
 #endif // TOML_ENABLE_WINDOWS_COMPAT
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<node> node::operator[](const path& p) noexcept
+	node_view<node> node::operator[](const path& p)
 	{
 		return toml::at_path(*this, p);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<const node> node::operator[](const path& p) const noexcept
+	node_view<const node> node::operator[](const path& p) const
 	{
 		return toml::at_path(*this, p);
 	}
@@ -10832,7 +14039,7 @@ TOML_IMPL_NAMESPACE_START
 {
 	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
-	bool TOML_CALLCONV node_deep_equality(const node* lhs, const node* rhs) noexcept
+	bool TOML_CALLCONV node_deep_equality(const node* lhs, const node* rhs)
 	{
 		// both same or both null
 		if (lhs == rhs)
@@ -10843,7 +14050,7 @@ TOML_IMPL_NAMESPACE_START
 			return false;
 
 		return lhs->visit(
-			[=](auto& l) noexcept
+			[=](auto& l)
 			{
 				using concrete_type = remove_cvref<decltype(l)>;
 
@@ -11062,13 +14269,13 @@ TOML_IMPL_NAMESPACE_START
 
 		return true;
 	}
-}
-TOML_IMPL_NAMESPACE_END;
 
-TOML_NAMESPACE_START
-{
-	TOML_EXTERNAL_LINKAGE
-	node_view<node> TOML_CALLCONV at_path(node & root, std::string_view path) noexcept
+	// Node is node or const node: looking a path up from a const node only reads the tables and arrays on the way,
+	// rather than giving frozen or packed ones contents of their own. (getting an element of a packed array can
+	// still allocate its node.)
+	template <typename Node>
+	TOML_NODISCARD
+	Node* find_at_path(Node& root, std::string_view path)
 	{
 		// early-exit sanity-checks
 		if (root.is_value())
@@ -11078,14 +14285,14 @@ TOML_NAMESPACE_START
 		if (auto arr = root.as_array(); arr && arr->empty())
 			return {};
 
-		node* current = &root;
+		Node* current = &root;
 
-		static constexpr auto on_key = [](void* data, std::string_view key) noexcept -> bool
+		static constexpr auto on_key = [](void* data, std::string_view key) -> bool
 		{
-			auto& curr = *static_cast<node**>(data);
+			auto& curr = *static_cast<Node**>(data);
 			TOML_ASSERT_ASSUME(curr);
 
-			const auto current_table = curr->as<table>();
+			const auto current_table = curr->as_table();
 			if (!current_table)
 				return false;
 
@@ -11093,12 +14300,12 @@ TOML_NAMESPACE_START
 			return curr != nullptr;
 		};
 
-		static constexpr auto on_index = [](void* data, size_t index) noexcept -> bool
+		static constexpr auto on_index = [](void* data, size_t index) -> bool
 		{
-			auto& curr = *static_cast<node**>(data);
+			auto& curr = *static_cast<Node**>(data);
 			TOML_ASSERT_ASSUME(curr);
 
-			const auto current_array = curr->as<array>();
+			const auto current_array = curr->as_array();
 			if (!current_array)
 				return false;
 
@@ -11106,16 +14313,25 @@ TOML_NAMESPACE_START
 			return curr != nullptr;
 		};
 
-		if (!impl::parse_path(path, &current, on_key, on_index))
-			current = nullptr;
+		if (!parse_path(path, &current, on_key, on_index))
+			return nullptr;
+		return current;
+	}
+}
+TOML_IMPL_NAMESPACE_END;
 
-		return node_view{ current };
+TOML_NAMESPACE_START
+{
+	TOML_EXTERNAL_LINKAGE
+	node_view<node> TOML_CALLCONV at_path(node & root, std::string_view path)
+	{
+		return node_view{ impl::find_at_path(root, path) };
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<const node> TOML_CALLCONV at_path(const node& root, std::string_view path) noexcept
+	node_view<const node> TOML_CALLCONV at_path(const node& root, std::string_view path)
 	{
-		return node_view<const node>{ at_path(const_cast<node&>(root), path).node() };
+		return node_view{ impl::find_at_path(root, path) };
 	}
 
 #if TOML_ENABLE_WINDOWS_COMPAT
@@ -11139,7 +14355,14 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	node_view<const node> TOML_CALLCONV at_path(const node& root, std::wstring_view path)
 	{
-		return node_view<const node>{ at_path(const_cast<node&>(root), path).node() };
+		if (root.is_value())
+			return {};
+		if (auto tbl = root.as_table(); tbl && tbl->empty())
+			return {};
+		if (auto arr = root.as_array(); arr && arr->empty())
+			return {};
+
+		return at_path(root, impl::narrow(path));
 	}
 
 #endif // TOML_ENABLE_WINDOWS_COMPAT
@@ -11593,10 +14816,12 @@ TOML_NAMESPACE_START
 }
 TOML_NAMESPACE_END;
 
-TOML_NAMESPACE_START
+TOML_IMPL_NAMESPACE_START
 {
-	TOML_EXTERNAL_LINKAGE
-	node_view<node> TOML_CALLCONV at_path(node & root, const toml::path& path) noexcept
+	// (see the std::string_view overload)
+	template <typename Node>
+	TOML_NODISCARD
+	Node* find_at_path(Node& root, const toml::path& path)
 	{
 		// early-exit sanity-checks
 		if (root.is_value())
@@ -11606,14 +14831,14 @@ TOML_NAMESPACE_START
 		if (auto arr = root.as_array(); arr && arr->empty())
 			return {};
 
-		node* current = &root;
+		Node* current = &root;
 
 		for (const auto& component : path)
 		{
 			auto type = component.type();
 			if (type == path_component_type::array_index)
 			{
-				const auto current_array = current->as<array>();
+				const auto current_array = current->as_array();
 				if (!current_array)
 					return {}; // not an array, using array index doesn't work
 
@@ -11621,7 +14846,7 @@ TOML_NAMESPACE_START
 			}
 			else if (type == path_component_type::key)
 			{
-				const auto current_table = current->as<table>();
+				const auto current_table = current->as_table();
 				if (!current_table)
 					return {};
 
@@ -11637,13 +14862,23 @@ TOML_NAMESPACE_START
 				return {}; // not found
 		}
 
-		return node_view{ current };
+		return current;
+	}
+}
+TOML_IMPL_NAMESPACE_END;
+
+TOML_NAMESPACE_START
+{
+	TOML_EXTERNAL_LINKAGE
+	node_view<node> TOML_CALLCONV at_path(node & root, const toml::path& path)
+	{
+		return node_view{ impl::find_at_path(root, path) };
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	node_view<const node> TOML_CALLCONV at_path(const node& root, const toml::path& path) noexcept
+	node_view<const node> TOML_CALLCONV at_path(const node& root, const toml::path& path)
 	{
-		return node_view<const node>{ at_path(const_cast<node&>(root), path).node() };
+		return node_view{ impl::find_at_path(root, path) };
 	}
 }
 TOML_NAMESPACE_END;
@@ -11683,6 +14918,9 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	array::~array() noexcept
 	{
+		if (frozen_)
+			frozen_->release();
+
 #if TOML_LIFETIME_HOOKS
 		TOML_ARRAY_DESTROYED;
 #endif
@@ -11723,9 +14961,16 @@ TOML_NAMESPACE_START
 	array::array(const array& other) //
 		: node(other)
 	{
-		elems_.reserve(other.elems_.size());
-		for (const auto& elem : other)
-			elems_.emplace_back(impl::make_node(elem));
+		if (other.frozen_)
+			frozen_ = other.frozen_->share();
+		else if (other.packed_)
+			packed_ = other.packed_->clone();
+		if (!packed_ && !frozen_)
+		{
+			elems_.reserve(other.size());
+			for (const auto& elem : other)
+				elems_.emplace_back(impl::make_node(elem));
+		}
 
 #if TOML_LIFETIME_HOOKS
 		TOML_ARRAY_CREATED;
@@ -11735,7 +14980,9 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	array::array(array && other) noexcept //
 		: node(std::move(other)),
-		  elems_(std::move(other.elems_))
+		  elems_(std::move(other.elems_)),
+		  packed_(std::move(other.packed_)),
+		  frozen_(std::exchange(other.frozen_, nullptr))
 	{
 #if TOML_LIFETIME_HOOKS
 		TOML_ARRAY_CREATED;
@@ -11748,10 +14995,17 @@ TOML_NAMESPACE_START
 		if (&rhs != this)
 		{
 			node::operator=(rhs);
-			elems_.clear();
-			elems_.reserve(rhs.elems_.size());
-			for (const auto& elem : rhs)
-				elems_.emplace_back(impl::make_node(elem));
+			clear();
+			if (rhs.frozen_)
+				frozen_ = rhs.frozen_->share();
+			else if (rhs.packed_)
+				packed_ = rhs.packed_->clone();
+			if (!packed_ && !frozen_)
+			{
+				elems_.reserve(rhs.size());
+				for (const auto& elem : rhs)
+					elems_.emplace_back(impl::make_node(elem));
+			}
 		}
 		return *this;
 	}
@@ -11762,14 +15016,86 @@ TOML_NAMESPACE_START
 		if (&rhs != this)
 		{
 			node::operator=(std::move(rhs));
-			elems_ = std::move(rhs.elems_);
+			if (frozen_)
+				frozen_->release();
+			elems_	= std::move(rhs.elems_);
+			packed_ = std::move(rhs.packed_);
+			frozen_ = std::exchange(rhs.frozen_, nullptr);
 		}
 		return *this;
 	}
 
+	TOML_EXTERNAL_LINKAGE
+	bool array::pack()
+	{
+		if (frozen_)
+			thaw();
+		if (packed_)
+			return true;
+		if (elems_.empty())
+			return false;
+
+		if (auto packed = impl::packed_array::pack(elems_))
+		{
+			packed_ = std::move(packed);
+			elems_	= vector_type{};
+		}
+		return packed_ != nullptr;
+	}
+
+	TOML_EXTERNAL_LINKAGE
+	void array::unpack()
+	{
+		elems_ = packed_->take_nodes();
+		packed_.reset();
+	}
+
+	TOML_EXTERNAL_LINKAGE
+	void array::freeze()
+	{
+		if (frozen_)
+			return;
+
+		for (auto&& elem : elems_)
+		{
+			if (auto tbl = elem->as_table())
+				tbl->freeze();
+			else if (auto arr = elem->as_array())
+				arr->freeze();
+		}
+
+		const auto f = new impl::frozen<array>{};
+		f->contents.elems_.swap(elems_);
+		f->contents.packed_.swap(packed_);
+		frozen_ = f;
+	}
+
+	TOML_EXTERNAL_LINKAGE
+	void array::thaw()
+	{
+		if (frozen_->shared())
+		{
+			// (the copy's tables and arrays share the frozen ones' contents)
+			array copy{ frozen_->contents };
+			elems_	= std::move(copy.elems_);
+			packed_ = std::move(copy.packed_);
+		}
+		else
+		{
+			elems_	= std::move(frozen_->contents.elems_);
+			packed_ = std::move(frozen_->contents.packed_);
+		}
+		std::exchange(frozen_, nullptr)->release();
+	}
+
 	TOML_EXTERNAL_LINKAGE
 	void array::preinsertion_resize(size_t idx, size_t count)
 	{
+		if (frozen_)
+			thaw();
+		if (packed_)
+			unpack();
+
 		TOML_ASSERT(idx <= elems_.size());
 		TOML_ASSERT_ASSUME(count >= 1u);
 		const auto old_size			= elems_.size();
@@ -11787,19 +15113,24 @@ TOML_NAMESPACE_START
 	void array::insert_at_back(impl::node_ptr && elem)
 	{
 		TOML_ASSERT(elem);
-		elems_.push_back(std::move(elem));
+		elems().push_back(std::move(elem));
 	}
 
 	TOML_EXTERNAL_LINKAGE
 	array::vector_iterator array::insert_at(const_vector_iterator pos, impl::node_ptr && elem)
 	{
-		return elems_.insert(pos, std::move(elem));
+		return elems_.insert(thaw(pos), std::move(elem));
 	}
 
 	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
 	bool array::is_homogeneous(node_type ntype) const noexcept
 	{
+		if (frozen_)
+			return frozen_->contents.is_homogeneous(ntype);
+		if (packed_)
+			return ntype == node_type::none || ntype == packed_->type();
+
 		if (elems_.empty())
 			return false;
 
@@ -11813,10 +15144,16 @@ TOML_NAMESPACE_START
 		return true;
 	}
 
-	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
-	bool array::is_homogeneous(node_type ntype, node * &first_nonmatch) noexcept
+	bool array::is_homogeneous(node_type ntype, node * &first_nonmatch)
 	{
+		if (packed() && (ntype == node_type::none || ntype == packed()->type()))
+			return true;
+		if (frozen_)
+			thaw();
+		if (packed_)
+			unpack();
+
 		if (elems_.empty())
 		{
 			first_nonmatch = {};
@@ -11835,14 +15172,29 @@ TOML_NAMESPACE_START
 		return true;
 	}
 
-	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
-	bool array::is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept
+	bool array::is_homogeneous(node_type ntype, const node*& first_nonmatch) const
 	{
-		node* fnm		  = nullptr;
-		const auto result = const_cast<array&>(*this).is_homogeneous(ntype, fnm);
-		first_nonmatch	  = fnm;
-		return result;
+		if (packed() && (ntype == node_type::none || ntype == packed()->type()))
+			return true;
+
+		const auto& nodes = elems();
+		if (nodes.empty())
+		{
+			first_nonmatch = {};
+			return false;
+		}
+		if (ntype == node_type::none)
+			ntype = nodes[0]->type();
+		for (const auto& val : nodes)
+		{
+			if (val->type() != ntype)
+			{
+				first_nonmatch = val.get();
+				return false;
+			}
+		}
+		return true;
 	}
 
 	TOML_EXTERNAL_LINKAGE
@@ -11850,7 +15202,26 @@ TOML_NAMESPACE_START
 	{
 #if TOML_COMPILER_HAS_EXCEPTIONS
 
-		return *elems_.at(index);
+		return *elems().at(index);
+
+#else
+
+		auto n = get(index);
+		TOML_ASSERT_ASSUME(n && "element index not found in array!");
+		return *n;
+
+#endif
+	}
+
+	TOML_EXTERNAL_LINKAGE
+	const node& array::at(size_t index) const
+	{
+#if TOML_COMPILER_HAS_EXCEPTIONS
+
+		const auto& c = contents();
+		if (c.packed_ && index < c.packed_->size())
+			return c.packed_->node_at(index);
+		return *c.elems_.at(index); // (empty when packed, so it throws)
 
 #else
 
@@ -11864,37 +15235,44 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	void array::reserve(size_t new_capacity)
 	{
-		elems_.reserve(new_capacity);
+		elems().reserve(new_capacity);
 	}
 
 	TOML_EXTERNAL_LINKAGE
 	void array::shrink_to_fit()
 	{
-		elems_.shrink_to_fit();
+		elems().shrink_to_fit();
 	}
 
 	TOML_EXTERNAL_LINKAGE
 	void array::truncate(size_t new_size)
 	{
-		if (new_size < elems_.size())
-			elems_.resize(new_size);
+		if (new_size < size())
+			elems().resize(new_size);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	array::iterator array::erase(const_iterator pos) noexcept
+	array::iterator array::erase(const_iterator pos)
 	{
-		return iterator{ elems_.erase(const_vector_iterator{ pos }) };
+		return iterator{ elems_.erase(thaw(const_vector_iterator{ pos })) };
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	array::iterator array::erase(const_iterator first, const_iterator last) noexcept
+	array::iterator array::erase(const_iterator first, const_iterator last)
 	{
-		return iterator{ elems_.erase(const_vector_iterator{ first }, const_vector_iterator{ last }) };
+		const auto count = const_vector_iterator{ last } - const_vector_iterator{ first };
+		const auto begin = thaw(const_vector_iterator{ first });
+		return iterator{ elems_.erase(begin, begin + count) };
 	}
 
 	TOML_EXTERNAL_LINKAGE
 	size_t array::total_leaf_count() const noexcept
 	{
+		if (frozen_)
+			return frozen_->contents.total_leaf_count();
+		if (packed_)
+			return packed_->size();
+
 		size_t leaves{};
 		for (size_t i = 0, e = elems_.size(); i < e; i++)
 		{
@@ -11905,8 +15283,13 @@ TOML_NAMESPACE_START
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	void array::flatten_child(array && child, size_t & dest_index) noexcept
+	void array::flatten_child(array && child, size_t & dest_index)
 	{
+		if (child.frozen_)
+			child.thaw();
+		if (child.packed_)
+			child.unpack();
+
 		for (size_t i = 0, e = child.size(); i < e; i++)
 		{
 			auto type = child.elems_[i]->type();
@@ -11924,8 +15307,10 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	array& array::flatten()&
 	{
-		if (elems_.empty())
+		if (packed() || empty()) // packed arrays don't hold arrays
 			return *this;
+		if (frozen_)
+			thaw();
 
 		bool requires_flattening	 = false;
 		size_t size_after_flattening = elems_.size();
@@ -11971,10 +15356,12 @@ TOML_NAMESPACE_START
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	array& array::prune(bool recursive)& noexcept
+	array& array::prune(bool recursive)&
 	{
-		if (elems_.empty())
+		if (packed() || empty()) // packed arrays don't hold arrays, and their tables hold scalars
 			return *this;
+		if (frozen_)
+			thaw();
 
 		for (size_t i = elems_.size(); i-- > 0u;)
 		{
@@ -11998,35 +15385,71 @@ TOML_NAMESPACE_START
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	void array::pop_back() noexcept
+	void array::pop_back()
 	{
-		elems_.pop_back();
+		if (frozen_)
+			thaw();
+
+		// no new nodes are needed either way: either nodes() has already been called, or the value can just be dropped
+		if (packed_ && !packed_->has_nodes())
+		{
+			packed_->pop_back();
+			if (!packed_->size())
+				packed_.reset();
+			return;
+		}
+		elems().pop_back();
 	}
 
 	TOML_EXTERNAL_LINKAGE
 	void array::clear() noexcept
 	{
+		if (frozen_)
+			std::exchange(frozen_, nullptr)->release();
+		packed_.reset();
 		elems_.clear();
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	bool TOML_CALLCONV array::equal(const array& lhs, const array& rhs) noexcept
+	bool TOML_CALLCONV array::equal(const array& lhs, const array& rhs)
 	{
 		if (&lhs == &rhs)
 			return true;
-		if (lhs.elems_.size() != rhs.elems_.size())
-			return false;
-		for (size_t i = 0, e = lhs.elems_.size(); i < e; i++)
+		if (const auto lhs_hash = lhs.cached_hash(), rhs_hash = rhs.cached_hash(); lhs_hash && rhs_hash)
 		{
-			const auto lhs_type = lhs.elems_[i]->type();
-			const node& rhs_	= *rhs.elems_[i];
-			const auto rhs_type = rhs_.type();
-			if (lhs_type != rhs_type)
+			// copies of a frozen array share its elements (and their hash), and ones that have been hashed can be
+			// told apart by their hashes
+			if (lhs_hash == rhs_hash)
+				return true;
+			const auto l = lhs_hash->load(std::memory_order_relaxed);
+			const auto r = rhs_hash->load(std::memory_order_relaxed);
+			if (l && r && l != r)
 				return false;
+		}
+		if (lhs.size() != rhs.size())
+			return false;
+		if (lhs.packed() && rhs.packed() && lhs.packed()->type() != rhs.packed()->type())
+			return false;
+		for (size_t i = 0, e = lhs.size(); i < e; i++)
+		{
+			const bool equal = impl::visit_array_element(
+				lhs,
+				i,
+				[&](const node& lhs_elem)
+				{
+					return impl::visit_array_element(
+						rhs,
+						i,
+						[&](const node& rhs_)
+						{
+							if (lhs_elem.type() != rhs_.type())
+								return false;
 
-			const bool equal = lhs.elems_[i]->visit(
-				[&](const auto& lhs_) noexcept
-				{ return lhs_ == *reinterpret_cast<std::remove_reference_t<decltype(lhs_)>*>(&rhs_); });
+							return lhs_elem.visit(
+								[&](const auto& lhs_)
+								{ return lhs_ == *reinterpret_cast<std::remove_reference_t<decltype(lhs_)>*>(&rhs_); });
+						});
+				});
 			if (!equal)
 				return false;
 		}
@@ -12057,6 +15480,213 @@ TOML_PUSH_WARNINGS;
 #undef max
 #endif
 
+TOML_IMPL_NAMESPACE_START
+{
+	// relocates a table's contents into regions in depth-first order for table::compact(). keys are interned again
+	// as they're copied, so repeated keys still share their characters. values are moved, but only once their new
+	// node has been allocated, so if an allocation fails everything moved so far can be moved back.
+	class compactor
+	{
+	  private:
+		static constexpr size_t min_region_size = size_t{ 4u } * 1024u;
+		static constexpr size_t max_region_size = size_t{ 4u } * 1024u * 1024u;
+		static constexpr size_t min_available	= 512u; // below this a new region is started rather than spilling
+
+		memory_resource& upstream_;
+		memory_resource* previous_;
+		size_t region_size_;
+		region* region_ = nullptr;
+		key_interner keys_;
+
+		// puts back whatever has been relocated from `from` to `to` if a relocation is abandoned part way through.
+		template <typename Container>
+		struct rollback
+		{
+			Container& from;
+			Container& to;
+			bool done = false;
+
+			~rollback() noexcept
+			{
+				if (!done)
+					restore_contents(from, to);
+			}
+		};
+
+		// a rough upper bound on the bytes a node will need once relocated (not counting std::string buffers,
+		// which stay where they are).
+		TOML_PURE_GETTER
+		static size_t estimate(const node& n) noexcept
+		{
+			constexpr size_t overhead = allocation_header_size + sizeof(void*) * 4u; // map nodes, slack
+			if (auto tbl = n.as_table())
+			{
+				size_t bytes = sizeof(table) + allocation_header_size;
+				for (auto&& [k, v] : tbl->map_)
+					bytes += sizeof(table_storage_pair) + overhead + k.str().length() + estimate(*v);
+				return bytes;
+			}
+			if (auto arr = n.as_array())
+			{
+				size_t bytes = sizeof(array) + allocation_header_size;
+				if (const auto packed = arr->packed())
+					return bytes + sizeof(packed_array) + overhead + packed->size() * sizeof(std::string);
+				for (auto&& elem : arr->contents().elems_)
+					bytes += sizeof(node_ptr) + estimate(*elem);
+				return bytes;
+			}
+			return sizeof(value<std::string>) + allocation_header_size;
+		}
+
+		void reserve()
+		{
+			if (region_ && region_->available() >= min_available)
+				return;
+
+			const auto r = region::create(region_size_, upstream_);
+			if (region_)
+				region_->release();
+			region_						  = r;
+			current_memory_resource_ref() = r;
+		}
+
+		TOML_NODISCARD
+		toml::key copy_key(const toml::key& k)
+		{
+			if (k.str().empty())
+				return k;
+			return toml::key{ keys_.intern(k.str()), source_region{ k.source() } };
+		}
+
+		template <typename T>
+		TOML_NODISCARD
+		static node_ptr relocate(value<T>& from)
+		{
+			return node_ptr{ new value<T>{ std::move(from) } };
+		}
+
+		TOML_NODISCARD
+		node_ptr relocate(table& from)
+		{
+			std::unique_ptr<table> to{ new table{} };
+			relocate_entries(from, *to);
+			to->inline_ = from.inline_;
+			to->source_ = std::move(from.source_);
+			return to;
+		}
+
+		TOML_NODISCARD
+		node_ptr relocate(array& from)
+		{
+			std::unique_ptr<array> to{ new array{} };
+			if (from.frozen_)
+				from.thaw();
+			if (from.packed_)
+			{
+				to->packed_ = from.packed_->copy_packed();
+				if (!to->packed_)
+					from.unpack();
+			}
+			if (!to->packed_)
+			{
+				to->elems_.reserve(from.elems_.size());
+				rollback<array> guard{ from, *to };
+				for (auto&& elem : from.elems_)
+					to->elems_.push_back(relocate(*elem));
+				guard.done = true;
+			}
+			to->source_ = std::move(from.source_);
+			return to;
+		}
+
+		TOML_NODISCARD
+		node_ptr relocate(node& from)
+		{
+			reserve();
+			switch (from.type())
+			{
+				case node_type::table: return relocate(*from.as_table());
+				case node_type::array: return relocate(*from.as_array());
+				case node_type::string: return relocate(*from.as_string());
+				case node_type::integer: return relocate(*from.as_integer());
+				case node_type::floating_point: return relocate(*from.as_floating_point());
+				case node_type::boolean: return relocate(*from.as_boolean());
+				case node_type::date: return relocate(*from.as_date());
+				case node_type::time: return relocate(*from.as_time());
+				case node_type::date_time: return relocate(*from.as_date_time());
+				default: TOML_UNREACHABLE;
+			}
+		}
+
+		// moves a node relocated by relocate() back into the one it came from.
+		static void restore(node& from, node& to) noexcept
+		{
+			switch (from.type())
+			{
+				case node_type::table: restore_contents(*from.as_table(), *to.as_table()); break;
+				case node_type::array: restore_contents(*from.as_array(), *to.as_array()); break;
+				case node_type::string: *from.as_string() = std::move(*to.as_string()); return;
+				case node_type::integer: *from.as_integer() = std::move(*to.as_integer()); return;
+				case node_type::floating_point: *from.as_floating_point() = std::move(*to.as_floating_point()); return;
+				case node_type::boolean: *from.as_boolean() = std::move(*to.as_boolean()); return;
+				case node_type::date: *from.as_date() = std::move(*to.as_date()); return;
+				case node_type::time: *from.as_time() = std::move(*to.as_time()); return;
+				case node_type::date_time: *from.as_date_time() = std::move(*to.as_date_time()); return;
+				default: TOML_UNREACHABLE;
+			}
+			from.source_ = std::move(to.source_);
+		}
+
+		// entries of `to` are a prefix of those of `from` (and may still be waiting for their value).
+		static void restore_contents(table& from, table& to) noexcept
+		{
+			auto f = from.map_.begin();
+			for (auto t = to.map_.begin(), e = to.map_.end(); t != e; t++, f++)
+				if (t->second)
+					restore(*f->second, *t->second);
+		}
+
+		static void restore_contents(array& from, array& to) noexcept
+		{
+			for (size_t i = 0; i < to.elems_.size(); i++)
+				restore(*from.elems_[i], *to.elems_[i]);
+		}
+
+	  public:
+		TOML_NODISCARD_CTOR
+		explicit compactor(const table& tbl) noexcept //
+			: upstream_{ current_memory_resource() },
+			  previous_{ current_memory_resource_ref() },
+			  region_size_{ (std::min)((std::max)(estimate(tbl), min_region_size), max_region_size) }
+		{}
+
+		compactor(const compactor&)			   = delete;
+		compactor& operator=(const compactor&) = delete;
+
+		~compactor() noexcept
+		{
+			current_memory_resource_ref() = previous_;
+			if (region_)
+				region_->release();
+		}
+
+		void relocate_entries(table& from, table& to)
+		{
+			reserve();
+			to.map_.reserve(from.map_.size());
+			rollback<table> guard{ from, to };
+			for (auto&& [k, v] : from.map_)
+			{
+				// the entry goes in first so nothing has been moved out of `from` if that fails
+				auto it = to.map_.emplace_hint(to.map_.end(), copy_key(k), nullptr);
+				it->second = relocate(*v);
+			}
+			guard.done = true;
+		}
+	};
+}
+TOML_IMPL_NAMESPACE_END;
+
 TOML_NAMESPACE_START
 {
 	TOML_EXTERNAL_LINKAGE
@@ -12103,8 +15733,11 @@ TOML_NAMESPACE_START
 		: node(other),
 		  inline_{ other.inline_ }
 	{
-		for (auto&& [k, v] : other.map_)
-			map_.emplace_hint(map_.end(), k, impl::make_node(*v));
+		if (other.map_.frozen())
+			map_ = other.map_.share();
+		else
+			for (auto&& [k, v] : other.map_)
+				map_.emplace_hint(map_.end(), k, impl::make_node(*v));
 
 #if TOML_LIFETIME_HOOKS
 		TOML_TABLE_CREATED;
@@ -12129,8 +15762,11 @@ TOML_NAMESPACE_START
 		{
 			node::operator=(rhs);
 			map_.clear();
-			for (auto&& [k, v] : rhs.map_)
-				map_.emplace_hint(map_.end(), k, impl::make_node(*v));
+			if (rhs.map_.frozen())
+				map_ = rhs.map_.share();
+			else
+				for (auto&& [k, v] : rhs.map_)
+					map_.emplace_hint(map_.end(), k, impl::make_node(*v));
 			inline_ = rhs.inline_;
 		}
 		return *this;
@@ -12148,6 +15784,34 @@ TOML_NAMESPACE_START
 		return *this;
 	}
 
+	TOML_EXTERNAL_LINKAGE
+	void table::compact()
+	{
+		table relocated;
+		{
+			impl::compactor compactor{ *this };
+			compactor.relocate_entries(*this, relocated);
+		}
+		map_ = std::move(relocated.map_);
+	}
+
+	TOML_EXTERNAL_LINKAGE
+	void table::freeze()
+	{
+		if (map_.frozen())
+			return;
+
+		for (auto&& [k, v] : map_)
+		{
+			TOML_UNUSED(k);
+			if (const auto tbl = v->as_table())
+				tbl->freeze();
+			else if (const auto arr = v->as_array())
+				arr->freeze();
+		}
+		map_.freeze();
+	}
+
 	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
 	bool table::is_homogeneous(node_type ntype) const noexcept
@@ -12195,10 +15859,23 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	bool table::is_homogeneous(node_type ntype, const node*& first_nonmatch) const noexcept
 	{
-		node* fnm		  = nullptr;
-		const auto result = const_cast<table&>(*this).is_homogeneous(ntype, fnm);
-		first_nonmatch	  = fnm;
-		return result;
+		if (map_.empty())
+		{
+			first_nonmatch = {};
+			return false;
+		}
+		if (ntype == node_type::none)
+			ntype = map_.cbegin()->second->type();
+		for (const auto& [k, v] : map_)
+		{
+			TOML_UNUSED(k);
+			if (v->type() != ntype)
+			{
+				first_nonmatch = v.get();
+				return false;
+			}
+		}
+		return true;
 	}
 
 	TOML_PURE_GETTER
@@ -12328,10 +16005,21 @@ TOML_NAMESPACE_START
 
 	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
-	bool TOML_CALLCONV table::equal(const table& lhs, const table& rhs) noexcept
+	bool TOML_CALLCONV table::equal(const table& lhs, const table& rhs)
 	{
 		if (&lhs == &rhs)
 			return true;
+		if (const auto lhs_hash = lhs.map_.cached_hash(), rhs_hash = rhs.map_.cached_hash(); lhs_hash && rhs_hash)
+		{
+			// copies of a frozen table share its entries (and their hash), and ones that have been hashed can be
+			// told apart by their hashes
+			if (lhs_hash == rhs_hash)
+				return true;
+			const auto l = lhs_hash->load(std::memory_order_relaxed);
+			const auto r = rhs_hash->load(std::memory_order_relaxed);
+			if (l && r && l != r)
+				return false;
+		}
 		if (lhs.map_.size() != rhs.map_.size())
 			return false;
 
@@ -12347,7 +16035,7 @@ TOML_NAMESPACE_START
 				return false;
 
 			const bool equal = l->second->visit(
-				[&](const auto& lhs_) noexcept
+				[&](const auto& lhs_)
 				{ return lhs_ == *reinterpret_cast<std::remove_reference_t<decltype(lhs_)>*>(&rhs_); });
 			if (!equal)
 				return false;
@@ -12395,6 +16083,11 @@ TOML_DISABLE_WARNINGS;
 #if TOML_HAS_SSE2
 #include <emmintrin.h>
 #endif
+#if TOML_FLOAT_CHARCONV
+#include <charconv>
+#else
+#include <sstream>
+#endif
 TOML_ENABLE_WARNINGS;
 
 //********  impl/unicode.inl  ******************************************************************************************
@@ -12414,40 +16107,248 @@ TOML_IMPL_NAMESPACE_START
 {
 	TOML_PURE_GETTER
 	TOML_EXTERNAL_LINKAGE
-	bool is_ascii(const char* str, size_t len) noexcept
+	bool is_ascii(const char* str, size_t len) noexcept
+	{
+		const char* const end = str + len;
+
+#if TOML_HAS_SSE2 && (128 % CHAR_BIT) == 0
+		{
+			constexpr size_t chars_per_vector = 128u / CHAR_BIT;
+
+			if (const size_t simdable = len - (len % chars_per_vector))
+			{
+				__m128i mask = _mm_setzero_si128();
+				for (const char* const e = str + simdable; str < e; str += chars_per_vector)
+				{
+					const __m128i current_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+					mask						= _mm_or_si128(mask, current_bytes);
+				}
+				const __m128i has_error = _mm_cmpgt_epi8(_mm_setzero_si128(), mask);
+
+#if TOML_HAS_SSE4_1
+				if (!_mm_testz_si128(has_error, has_error))
+					return false;
+#else
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(has_error, _mm_setzero_si128())) != 0xFFFF)
+					return false;
+#endif
+			}
+		}
+#endif
+
+		for (; str < end; str++)
+			if (static_cast<unsigned char>(*str) > 127u)
+				return false;
+
+		return true;
+	}
+
+	template <char Q1, char Q2>
+	TOML_PURE_GETTER
+	TOML_ATTR(nonnull)
+	const char* find_string_special_char(const char* str, const char* const end) noexcept
+	{
+		// 'special' here means < 0x20, >= 0x7F, or one of the quoting characters Q1/Q2.
+		// whole blocks of ordinary characters are skipped at once, and the first block containing
+		// something special is handed off to the scalar loop at the bottom.
+
+#if TOML_HAS_SSE2 && (128 % CHAR_BIT) == 0
+		{
+			constexpr size_t chars_per_vector = 128u / CHAR_BIT;
+
+			// bytes >= 0x80 are negative as signed chars, so the 'less than space' comparison catches them too
+			const __m128i space = _mm_set1_epi8(' ');
+			const __m128i del	= _mm_set1_epi8('\x7F');
+			const __m128i q1	= _mm_set1_epi8(Q1);
+			const __m128i q2	= _mm_set1_epi8(Q2);
+
+			while (static_cast<size_t>(end - str) >= chars_per_vector)
+			{
+				const __m128i current_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+				const __m128i special		= _mm_or_si128(
+					  _mm_or_si128(_mm_cmplt_epi8(current_bytes, space), _mm_cmpeq_epi8(current_bytes, del)),
+					  _mm_or_si128(_mm_cmpeq_epi8(current_bytes, q1), _mm_cmpeq_epi8(current_bytes, q2)));
+				if (_mm_movemask_epi8(special))
+					break;
+				str += chars_per_vector;
+			}
+		}
+#else
+		{
+			// SWAR fallback for targets without SSE2 (e.g. ARM)
+			constexpr uint64_t ones	 = 0x0101010101010101ull;
+			constexpr uint64_t highs = 0x8080808080808080ull;
+			constexpr auto has_zero	 = [](uint64_t v) constexpr noexcept { return (v - ones) & ~v & highs; };
+
+			while (static_cast<size_t>(end - str) >= sizeof(uint64_t))
+			{
+				uint64_t v;
+				std::memcpy(&v, str, sizeof(v));
+				const uint64_t special = (v & highs)						  // >= 0x80
+									   | ((v - ones * 0x20u) & ~v & highs)	  // < 0x20
+									   | has_zero(v ^ (ones * 0x7Fu))		  // DEL
+									   | has_zero(v ^ (ones * static_cast<unsigned char>(Q1)))
+									   | has_zero(v ^ (ones * static_cast<unsigned char>(Q2)));
+				if (special)
+					break;
+				str += sizeof(uint64_t);
+			}
+		}
+#endif
+
+		for (; str < end; str++)
+		{
+			const auto c = static_cast<unsigned char>(*str);
+			if (c < 0x20u || c >= 0x7Fu || *str == Q1 || *str == Q2)
+				return str;
+		}
+		return end;
+	}
+
+	TOML_PURE_GETTER
+	TOML_EXTERNAL_LINKAGE
+	const char* find_string_trait_char(const char* str, const char* end) noexcept
+	{
+		return find_string_special_char<'\'', '\''>(str, end);
+	}
+
+	TOML_PURE_GETTER
+	TOML_EXTERNAL_LINKAGE
+	const char* find_string_escape_char(const char* str, const char* end) noexcept
+	{
+		return find_string_special_char<'"', '\\'>(str, end);
+	}
+
+	// raw strings are only ever made of text the parser accepted, so none of this needs to check for errors
+	TOML_EXTERNAL_LINKAGE
+	std::string decode_string(std::string_view raw, uint8_t decoding)
 	{
-		const char* const end = str + len;
+		std::string str;
+		str.reserve(raw.length());
 
-#if TOML_HAS_SSE2 && (128 % CHAR_BIT) == 0
+		const bool escapes			  = !!(decoding & decode_escapes);
+		const bool line_breaks		  = !!(decoding & decode_line_breaks);
+		bool skipping_whitespace	  = false; // after a line-ending backslash
+		const char* c				  = raw.data();
+		const char* const end		  = c + raw.length();
+		while (c < end)
 		{
-			constexpr size_t chars_per_vector = 128u / CHAR_BIT;
-
-			if (const size_t simdable = len - (len % chars_per_vector))
+			if (escapes && *c == '\\')
 			{
-				__m128i mask = _mm_setzero_si128();
-				for (const char* const e = str + simdable; str < e; str += chars_per_vector)
+				skipping_whitespace = false;
+				switch (*++c)
 				{
-					const __m128i current_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
-					mask						= _mm_or_si128(mask, current_bytes);
+					case 'b': str += '\b'; break;
+					case 'f': str += '\f'; break;
+					case 'n': str += '\n'; break;
+					case 'r': str += '\r'; break;
+					case 't': str += '\t'; break;
+					case '"': str += '"'; break;
+					case '\\': str += '\\'; break;
+					case 'e': str += '\x1B'; break;
+
+					case 'x': [[fallthrough]];
+					case 'u': [[fallthrough]];
+					case 'U':
+					{
+						const size_t digits = *c == 'U' ? 8u : (*c == 'u' ? 4u : 2u);
+						uint32_t sequence_value{};
+						for (size_t i = 0; i < digits; i++)
+							sequence_value = sequence_value * 16u + hex_to_dec(static_cast<char32_t>(*++c));
+
+						if (sequence_value < 0x80)
+						{
+							str += static_cast<char>(sequence_value);
+						}
+						else if (sequence_value < 0x800u)
+						{
+							str += static_cast<char>((sequence_value >> 6) | 0xC0u);
+							str += static_cast<char>((sequence_value & 0x3Fu) | 0x80u);
+						}
+						else if (sequence_value < 0x10000u)
+						{
+							str += static_cast<char>((sequence_value >> 12) | 0xE0u);
+							str += static_cast<char>(((sequence_value >> 6) & 0x3Fu) | 0x80u);
+							str += static_cast<char>((sequence_value & 0x3Fu) | 0x80u);
+						}
+						else
+						{
+							str += static_cast<char>((sequence_value >> 18) | 0xF0u);
+							str += static_cast<char>(((sequence_value >> 12) & 0x3Fu) | 0x80u);
+							str += static_cast<char>(((sequence_value >> 6) & 0x3Fu) | 0x80u);
+							str += static_cast<char>((sequence_value & 0x3Fu) | 0x80u);
+						}
+						break;
+					}
+
+					// a line-ending backslash: spaces and tabs, then the line break
+					default:
+						while (*c == ' ' || *c == '\t')
+							c++;
+						if (*c == '\r')
+							c++;
+						skipping_whitespace = true;
+						break;
 				}
-				const __m128i has_error = _mm_cmpgt_epi8(_mm_setzero_si128(), mask);
+				c++;
+				continue;
+			}
 
-#if TOML_HAS_SSE4_1
-				if (!_mm_testz_si128(has_error, has_error))
-					return false;
-#else
-				if (_mm_movemask_epi8(_mm_cmpeq_epi8(has_error, _mm_setzero_si128())) != 0xFFFF)
-					return false;
-#endif
+			if (line_breaks && *c == '\r') // always followed by a '\n'
+			{
+				c++;
+				continue;
+			}
+
+			if (line_breaks && *c == '\n')
+			{
+				if (!skipping_whitespace)
+					str += '\n';
+				c++;
+				continue;
+			}
+
+			// copy the whole codepoint, since the whitespace being skipped needn't be ascii
+			const char* const begin = c;
+			utf8_decoder decoder;
+			do
+				decoder(*c++);
+			while (decoder.needs_more_input() && c < end);
+
+			if (!skipping_whitespace || !is_horizontal_whitespace(decoder.codepoint))
+			{
+				skipping_whitespace = false;
+				str.append(begin, static_cast<size_t>(c - begin));
 			}
 		}
-#endif
+		return str;
+	}
 
-		for (; str < end; str++)
-			if (static_cast<unsigned char>(*str) > 127u)
-				return false;
+	// raw floats are only deferred by the parser when they're known to convert without over- or underflowing
+	TOML_EXTERNAL_LINKAGE
+	double decode_float(std::string_view raw)
+	{
+		char chars[0xFF];
+		size_t length = {};
+		double sign	  = 1.0;
+		for (const char c : raw)
+		{
+			if (c == '-' && !length)
+				sign = -1.0;
+			else if (c != '_' && (c != '+' || length))
+				chars[length++] = c;
+		}
 
-		return true;
+		double result{};
+#if TOML_FLOAT_CHARCONV
+		std::from_chars(chars, chars + length, result);
+#else
+		std::stringstream ss;
+		ss.imbue(std::locale::classic());
+		ss.write(chars, static_cast<std::streamsize>(length));
+		ss >> result;
+#endif
+		return result * sign;
 	}
 }
 TOML_IMPL_NAMESPACE_END;
@@ -12466,6 +16367,7 @@ TOML_POP_WARNINGS;
 #if TOML_ENABLE_PARSER
 
 TOML_DISABLE_WARNINGS;
+#include <algorithm>
 #include <istream>
 #include <fstream>
 #if TOML_INT_CHARCONV || TOML_FLOAT_CHARCONV
@@ -12504,6 +16406,7 @@ TOML_ANON_NAMESPACE_START
 
 	  private:
 		std::basic_string_view<Char> source_;
+		size_t start_	 = {};
 		size_t position_ = {};
 
 	  public:
@@ -12513,7 +16416,14 @@ TOML_ANON_NAMESPACE_START
 		{
 			// skip bom
 			if (source_.length() >= 3u && memcmp(utf8_byte_order_mark.data(), source_.data(), 3u) == 0)
-				position_ += 3u;
+				start_ = position_ = 3u;
+		}
+
+		// the document after the bom (the reader's offsets index into this)
+		TOML_PURE_INLINE_GETTER
+		std::string_view text() const noexcept
+		{
+			return { reinterpret_cast<const char*>(source_.data()) + start_, source_.length() - start_ };
 		}
 
 		TOML_CONST_INLINE_GETTER
@@ -12617,7 +16527,7 @@ TOML_ANON_NAMESPACE_START
 		char32_t value;
 		char bytes[4];
 		size_t count;
-		source_position position;
+		size_t offset; // in bytes from the start of the document (after any bom); see source_lines
 
 		TOML_PURE_INLINE_GETTER
 		constexpr operator const char32_t&() const noexcept
@@ -12634,11 +16544,70 @@ TOML_ANON_NAMESPACE_START
 	static_assert(std::is_trivial_v<utf8_codepoint>);
 	static_assert(std::is_standard_layout_v<utf8_codepoint>);
 
+	// the line/column position of every codepoint offset a reader has seen. the reader only notes where each line
+	// starts (and where the multi-byte codepoints are) as it goes, so positions are only worked out for the offsets
+	// that need one (source regions and errors).
+	class source_lines
+	{
+	  private:
+		std::vector<size_t> starts_; // offsets of the first codepoint of every line after the first
+
+		// offsets of the multi-byte codepoints, with the bytes past the first of every one up to and including it
+		// (columns count codepoints, not bytes)
+		std::vector<std::pair<size_t, size_t>> wide_;
+
+		TOML_NODISCARD
+		size_t extra_bytes_before(size_t offset) const noexcept
+		{
+			if (wide_.empty() || offset <= wide_.front().first)
+				return 0u;
+			if (offset > wide_.back().first)
+				return wide_.back().second;
+
+			const auto it = std::lower_bound(wide_.begin(),
+											 wide_.end(),
+											 offset,
+											 [](const auto& wide, size_t off) noexcept { return wide.first < off; });
+			return (it - 1)->second;
+		}
+
+	  public:
+		void push_line(size_t start)
+		{
+			starts_.push_back(start);
+		}
+
+		void push_wide(size_t offset, size_t extra_bytes)
+		{
+			wide_.emplace_back(offset, (wide_.empty() ? 0u : wide_.back().second) + extra_bytes);
+		}
+
+		TOML_NODISCARD
+		source_position position(size_t offset) const noexcept
+		{
+			// almost everything asks about the line currently being read, so that's checked before searching
+			size_t line = starts_.size();
+			if (line && offset < starts_.back())
+				line = static_cast<size_t>(std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin());
+
+			const size_t line_start = line ? starts_[line - 1u] : 0u;
+			const size_t column		= offset - line_start - (extra_bytes_before(offset) - extra_bytes_before(line_start));
+			return { static_cast<source_index>(line + 1u), static_cast<source_index>(column + 1u) };
+		}
+	};
+
 	struct TOML_ABSTRACT_INTERFACE utf8_reader_interface
 	{
 		TOML_NODISCARD
 		virtual const source_path_ptr& source_path() const noexcept = 0;
 
+		TOML_NODISCARD
+		virtual source_position position(size_t offset) const noexcept = 0;
+
+		// the whole document when it's read from memory, empty when it's read from a stream
+		TOML_NODISCARD
+		virtual std::string_view source_text() const noexcept = 0;
+
 		TOML_NODISCARD
 		virtual const utf8_codepoint* read_next() noexcept(!TOML_COMPILER_HAS_EXCEPTIONS) = 0;
 
@@ -12684,7 +16653,8 @@ TOML_ANON_NAMESPACE_START
 	  private:
 		static constexpr size_t block_capacity = 32;
 		utf8_byte_stream<T> stream_;
-		source_position next_pos_ = { 1, 1 };
+		size_t next_offset_ = {};
+		source_lines lines_;
 
 		impl::utf8_decoder decoder_;
 		struct currently_decoding_t
@@ -12700,7 +16670,7 @@ TOML_ANON_NAMESPACE_START
 			size_t count;
 		} codepoints_;
 
-		source_path_ptr source_path_;
+		source_path_ptr source_path_ = {};
 
 #if !TOML_EXCEPTIONS
 		optional<parse_error> err_;
@@ -12727,11 +16697,11 @@ TOML_ANON_NAMESPACE_START
 				}
 				catch (const std::exception& exc)
 				{
-					throw parse_error{ exc.what(), next_pos_, source_path_ };
+					throw parse_error{ exc.what(), lines_.position(next_offset_), source_path_ };
 				}
 				catch (...)
 				{
-					throw parse_error{ "An unspecified error occurred", next_pos_, source_path_ };
+					throw parse_error{ "An unspecified error occurred", lines_.position(next_offset_), source_path_ };
 				}
 			}
 #endif // TOML_EXCEPTIONS
@@ -12746,13 +16716,13 @@ TOML_ANON_NAMESPACE_START
 					// the EOF flag, and that's totally fine
 					if (decoder_.needs_more_input())
 						utf8_reader_error("Encountered EOF during incomplete utf-8 code point sequence",
-										  next_pos_,
+										  lines_.position(next_offset_),
 										  source_path_);
 				}
 				else
 				{
 					utf8_reader_error("Reading from the underlying stream failed - zero bytes read",
-									  next_pos_,
+									  lines_.position(next_offset_),
 									  source_path_);
 				}
 				return false;
@@ -12761,21 +16731,19 @@ TOML_ANON_NAMESPACE_START
 			TOML_ASSERT_ASSUME(raw_bytes_read);
 			std::memset(&codepoints_, 0, sizeof(codepoints_));
 
-			// helper for calculating decoded codepoint line+cols
-			const auto calc_positions = [&]() noexcept
+			// helper for numbering the decoded codepoints and noting where new lines start
+			const auto calc_offsets = [&]()
 			{
 				for (size_t i = 0; i < codepoints_.count; i++)
 				{
-					auto& cp	= codepoints_.buffer[i];
-					cp.position = next_pos_;
+					auto& cp  = codepoints_.buffer[i];
+					cp.offset = next_offset_;
+					next_offset_ += cp.count;
 
+					if TOML_UNLIKELY(cp.count > 1u)
+						lines_.push_wide(cp.offset, cp.count - 1u);
 					if (cp == U'\n')
-					{
-						next_pos_.line++;
-						next_pos_.column = source_index{ 1 };
-					}
-					else
-						next_pos_.column++;
+						lines_.push_line(next_offset_);
 				}
 			};
 
@@ -12802,9 +16770,10 @@ TOML_ANON_NAMESPACE_START
 			else
 			{
 				// helper for getting precise error location
-				const auto error_pos = [&]() noexcept -> const source_position&
+				const auto error_pos = [&]() noexcept
 				{ //
-					return codepoints_.count ? codepoints_.buffer[codepoints_.count - 1u].position : next_pos_;
+					return lines_.position(codepoints_.count ? codepoints_.buffer[codepoints_.count - 1u].offset
+															 : next_offset_);
 				};
 
 				for (size_t i = 0; i < raw_bytes_read; i++)
@@ -12812,7 +16781,7 @@ TOML_ANON_NAMESPACE_START
 					decoder_(static_cast<uint8_t>(raw_bytes[i]));
 					if TOML_UNLIKELY(decoder_.error())
 					{
-						calc_positions();
+						calc_offsets();
 						utf8_reader_error("Encountered invalid utf-8 sequence", error_pos(), source_path_);
 						utf8_reader_return_after_error(false);
 					}
@@ -12830,14 +16799,14 @@ TOML_ANON_NAMESPACE_START
 					}
 					else if TOML_UNLIKELY(currently_decoding_.count == 4u)
 					{
-						calc_positions();
+						calc_offsets();
 						utf8_reader_error("Encountered overlong utf-8 sequence", error_pos(), source_path_);
 						utf8_reader_return_after_error(false);
 					}
 				}
 				if TOML_UNLIKELY(decoder_.needs_more_input() && stream_.eof())
 				{
-					calc_positions();
+					calc_offsets();
 					utf8_reader_error("Encountered EOF during incomplete utf-8 code point sequence",
 									  error_pos(),
 									  source_path_);
@@ -12846,14 +16815,14 @@ TOML_ANON_NAMESPACE_START
 			}
 
 			TOML_ASSERT_ASSUME(codepoints_.count);
-			calc_positions();
+			calc_offsets();
 
 			// handle general I/O errors
-			// (down here so the next_pos_ benefits from calc_positions())
+			// (down here so the next_offset_ benefits from calc_offsets())
 			if TOML_UNLIKELY(stream_.error())
 			{
 				utf8_reader_error("An I/O error occurred while reading from the underlying stream",
-								  next_pos_,
+								  lines_.position(next_offset_),
 								  source_path_);
 				utf8_reader_return_after_error(false);
 			}
@@ -12874,7 +16843,7 @@ TOML_ANON_NAMESPACE_START
 			codepoints_.count	= {};
 
 			if (!source_path.empty())
-				source_path_ = std::make_shared<const std::string>(static_cast<String&&>(source_path));
+				source_path_ = impl::intern_source_path(std::string_view{ source_path });
 		}
 
 		TOML_PURE_INLINE_GETTER
@@ -12883,6 +16852,21 @@ TOML_ANON_NAMESPACE_START
 			return source_path_;
 		}
 
+		TOML_NODISCARD
+		source_position position(size_t offset) const noexcept final
+		{
+			return lines_.position(offset);
+		}
+
+		TOML_NODISCARD
+		std::string_view source_text() const noexcept final
+		{
+			if constexpr (std::is_same_v<T, std::istream>)
+				return {};
+			else
+				return stream_.text();
+		}
+
 		TOML_NODISCARD
 		const utf8_codepoint* read_next() noexcept(!TOML_COMPILER_HAS_EXCEPTIONS) final
 		{
@@ -12969,6 +16953,18 @@ TOML_ANON_NAMESPACE_START
 			return reader_.source_path();
 		}
 
+		TOML_NODISCARD
+		source_position position(size_t offset) const noexcept
+		{
+			return reader_.position(offset);
+		}
+
+		TOML_NODISCARD
+		std::string_view source_text() const noexcept
+		{
+			return reader_.source_text();
+		}
+
 		TOML_NODISCARD
 		const utf8_codepoint* read_next() noexcept(!TOML_COMPILER_HAS_EXCEPTIONS)
 		{
@@ -13306,8 +17302,8 @@ TOML_ANON_NAMESPACE_START
 	{
 		std::string buffer;
 		std::vector<std::pair<size_t, size_t>> segments;
-		std::vector<source_position> starts;
-		std::vector<source_position> ends;
+		std::vector<size_t> starts;
+		std::vector<size_t> ends;
 
 		void clear() noexcept
 		{
@@ -13317,7 +17313,7 @@ TOML_ANON_NAMESPACE_START
 			ends.clear();
 		}
 
-		void push_back(std::string_view segment, source_position b, source_position e)
+		void push_back(std::string_view segment, size_t b, size_t e)
 		{
 			segments.push_back({ buffer.length(), segment.length() });
 			buffer.append(segment);
@@ -13512,14 +17508,24 @@ TOML_IMPL_NAMESPACE_START
 
 		utf8_buffered_reader reader;
 		table root;
-		source_position prev_pos = { 1, 1 };
+		size_t prev_offset		 = {};
 		const utf8_codepoint* cp = {};
 		std::vector<table*> implicit_tables;
 		std::vector<table*> dotted_key_tables;
 		std::vector<table*> open_inline_tables;
 		std::vector<array*> table_arrays;
 		parse_key_buffer key_buffer;
+		key_interner interned_keys;
+		bool record_regions = true; // parse errors still get positions from the reader when this is off
+		bool borrow_strings = false; // both only when parsing from memory
+		bool lazy_values	= false;
 		std::string string_buffer;
+		size_t string_begin_offset = {}; // where the last string's characters started
+		uint8_t string_decoding	   = {}; // how to get the last string back from those characters
+		slab scalar_slab;
+		node_ptr spare_value; // the node of the last value added to a packed array, for the next one to reuse
+		size_t nested_arrays = {};
+		bool in_table_array	 = false; // the current [table] is an element of a [[table array]]
 		std::string recording_buffer; // for diagnostics
 		bool recording = false, recording_whitespace = true;
 		std::string_view current_scope;
@@ -13529,17 +17535,36 @@ TOML_IMPL_NAMESPACE_START
 #endif
 
 		TOML_NODISCARD
-		source_position current_position(source_index fallback_offset = 0) const noexcept
+		size_t current_offset(size_t fallback_offset = 0) const noexcept
 		{
 			if (!is_eof())
-				return cp->position;
-			return { prev_pos.line, static_cast<source_index>(prev_pos.column + fallback_offset) };
+				return cp->offset;
+			return prev_offset + fallback_offset;
+		}
+
+		TOML_NODISCARD
+		source_position position_of(size_t offset) const noexcept
+		{
+			// offsets past the last codepoint (from current_offset() at eof) stay on the last codepoint's line
+			if (is_eof() && offset > prev_offset)
+			{
+				auto pos = reader.position(prev_offset);
+				pos.column += static_cast<source_index>(offset - prev_offset);
+				return pos;
+			}
+			return reader.position(offset);
+		}
+
+		TOML_NODISCARD
+		source_region region_of(size_t begin, size_t end) const noexcept
+		{
+			return { position_of(begin), position_of(end), reader.source_path() };
 		}
 
 		template <typename... T>
 		TOML_RETURNS_BY_THROWING
 		TOML_NEVER_INLINE
-		void set_error_at(source_position pos, const T&... reason) const
+		void set_error_at(size_t offset, const T&... reason) const
 		{
 			static_assert(sizeof...(T) > 0);
 			return_if_error();
@@ -13550,9 +17575,9 @@ TOML_IMPL_NAMESPACE_START
 			parse_error_break();
 
 #if TOML_EXCEPTIONS
-			builder.finish(pos, reader.source_path());
+			builder.finish(position_of(offset), reader.source_path());
 #else
-			err.emplace(builder.finish(pos, reader.source_path()));
+			err.emplace(builder.finish(position_of(offset), reader.source_path()));
 #endif
 		}
 
@@ -13560,7 +17585,7 @@ TOML_IMPL_NAMESPACE_START
 		TOML_RETURNS_BY_THROWING
 		void set_error(const T&... reason) const
 		{
-			set_error_at(current_position(1), reason...);
+			set_error_at(current_offset(1), reason...);
 		}
 
 		void go_back(size_t count = 1) noexcept
@@ -13568,8 +17593,8 @@ TOML_IMPL_NAMESPACE_START
 			return_if_error();
 			TOML_ASSERT_ASSUME(count);
 
-			cp		 = reader.step_back(count);
-			prev_pos = cp->position;
+			cp			= reader.step_back(count);
+			prev_offset = cp->offset;
 		}
 
 		void advance()
@@ -13577,8 +17602,8 @@ TOML_IMPL_NAMESPACE_START
 			return_if_error();
 			assert_not_eof();
 
-			prev_pos = cp->position;
-			cp		 = reader.read_next();
+			prev_offset = cp->offset;
+			cp			= reader.read_next();
 
 #if !TOML_EXCEPTIONS
 			if (reader.error())
@@ -13796,7 +17821,9 @@ TOML_IMPL_NAMESPACE_START
 				set_error_and_return_if_eof({});
 			}
 
-			auto& str = string_buffer;
+			string_begin_offset = cp->offset;
+			string_decoding		= impl::decode_escapes | (multi_line ? impl::decode_line_breaks : 0u);
+			auto& str			= string_buffer;
 			str.clear();
 			bool escaped			 = false;
 			bool skipping_whitespace = false;
@@ -14038,7 +18065,9 @@ TOML_IMPL_NAMESPACE_START
 				set_error_and_return_if_eof({});
 			}
 
-			auto& str = string_buffer;
+			string_begin_offset = cp->offset;
+			string_decoding		= multi_line ? impl::decode_line_breaks : uint8_t{};
+			auto& str			= string_buffer;
 			str.clear();
 			do
 			{
@@ -14244,7 +18273,7 @@ TOML_IMPL_NAMESPACE_START
 
 		TOML_NODISCARD
 		TOML_NEVER_INLINE
-		double parse_float()
+		double parse_float(bool* deferred = nullptr)
 		{
 			return_if_error({});
 			assert_not_eof();
@@ -14355,6 +18384,24 @@ TOML_IMPL_NAMESPACE_START
 				}
 			}
 
+			// with parse_flags::lazy_values the conversion is left for later when it can't fail: up to 100 digits with
+			// an exponent of at most 180 either way stays well inside the range of a double
+			if (deferred && length <= 100u)
+			{
+				const auto exponent_begin = std::find_if(chars, chars + length, [](char c) { return c == 'e' || c == 'E'; });
+				unsigned exponent		  = {};
+				for (auto c = exponent_begin + (exponent_begin < chars + length); c < chars + length && exponent <= 180u; c++)
+				{
+					if (*c != '+' && *c != '-')
+						exponent = exponent * 10u + static_cast<unsigned>(*c - '0');
+				}
+				if (exponent <= 180u)
+				{
+					*deferred = true;
+					return {};
+				}
+			}
+
 			// convert to double
 			double result;
 #if TOML_FLOAT_CHARCONV
@@ -14944,6 +18991,74 @@ TOML_IMPL_NAMESPACE_START
 		TOML_NODISCARD
 		node_ptr parse_inline_table();
 
+		// scalars that end up in a table are allocated next to each other from a slab rather than one at a time.
+		// arrays (and [[table arrays]]) might be packed, freeing their elements, so theirs aren't: a chunk is only
+		// returned once all of it has been freed. the elements of an array that's being packed as it's parsed reuse
+		// one node between them.
+		template <typename T, typename... Args>
+		TOML_NODISCARD
+		node_ptr make_value(Args&&... args)
+		{
+			if (nested_arrays || in_table_array)
+			{
+				if constexpr (std::is_nothrow_constructible_v<value<T>, Args&&...>)
+				{
+					if (spare_value && spare_value->type() == node_type_of<T>)
+					{
+						const auto spare = static_cast<value<T>*>(spare_value.release());
+						std::destroy_at(spare);
+						return node_ptr{ ::new (static_cast<void*>(spare)) value<T>{ static_cast<Args&&>(args)... } };
+					}
+				}
+				return node_ptr{ new value<T>{ static_cast<Args&&>(args)... } };
+			}
+			return node_ptr{ ::new (scalar_slab.allocate(sizeof(value<T>))) value<T>{ static_cast<Args&&>(args)... } };
+		}
+
+		// with parse_flags::string_views, strings too long for std::string to keep inline that are spelled out in the
+		// document exactly as they read (no escapes or line ending changes) refer to the document instead of copying
+		// it. with parse_flags::lazy_values the rest of them do too, and are decoded when something asks for them.
+		TOML_NODISCARD
+		node_ptr make_string(parsed_string str)
+		{
+			if (borrow_strings && str.value.length() > std::string{}.capacity())
+			{
+				const auto text = reader.source_text();
+				const auto end	= current_offset(1) - (str.was_multi_line ? 3u : 1u);
+				TOML_ASSERT(string_begin_offset <= end && end <= text.length());
+
+				const auto raw = text.substr(string_begin_offset, end - string_begin_offset);
+				if (raw == str.value)
+					return node_ptr{ new value<std::string>{ impl::raw_value_tag{}, raw } };
+				if (lazy_values)
+				{
+					TOML_ASSERT(impl::decode_string(raw, string_decoding) == str.value);
+					return node_ptr{ new value<std::string>{ impl::raw_value_tag{}, raw, string_decoding } };
+				}
+			}
+			return node_ptr{ new value{ str.value } };
+		}
+
+		TOML_NODISCARD
+		node_ptr parse_float_value()
+		{
+			return_if_error({});
+			const auto begin_offset = cp->offset;
+
+			bool deferred	  = false;
+			const auto result = parse_float(lazy_values ? &deferred : nullptr);
+			return_if_error({});
+
+			if (deferred)
+			{
+				const auto raw = reader.source_text().substr(begin_offset, current_offset(1) - begin_offset);
+				if (raw.length() <= 0xFFu)
+					return make_value<double>(impl::raw_value_tag{}, raw);
+				return make_value<double>(impl::decode_float(raw));
+			}
+			return make_value<double>(result);
+		}
+
 		TOML_NODISCARD
 		node_ptr parse_value_known_prefixes()
 		{
@@ -14961,11 +19076,11 @@ TOML_IMPL_NAMESPACE_START
 				case U'{': return parse_inline_table();
 
 				// floats beginning with '.'
-				case U'.': return node_ptr{ new value{ parse_float() } };
+				case U'.': return parse_float_value();
 
 				// strings
 				case U'"': [[fallthrough]];
-				case U'\'': return node_ptr{ new value{ parse_string().value } };
+				case U'\'': return make_string(parse_string());
 
 				default:
 				{
@@ -14973,11 +19088,11 @@ TOML_IMPL_NAMESPACE_START
 
 					// bools
 					if (cp_upper == 70u || cp_upper == 84u) // F or T
-						return node_ptr{ new value{ parse_boolean() } };
+						return make_value<bool>(parse_boolean());
 
 					// inf/nan
 					else if (cp_upper == 73u || cp_upper == 78u) // I or N
-						return node_ptr{ new value{ parse_inf_or_nan() } };
+						return make_value<double>(parse_inf_or_nan());
 
 					else
 						return nullptr;
@@ -15010,7 +19125,7 @@ TOML_IMPL_NAMESPACE_START
 			else if (*cp == U'_')
 				set_error_and_return_default("values may not begin with underscores"sv);
 
-			const auto begin_pos = cp->position;
+			const auto begin_pos = cp->offset;
 			node_ptr val;
 
 			do
@@ -15197,7 +19312,7 @@ TOML_IMPL_NAMESPACE_START
 				{
 					if (has_any(begins_digit))
 					{
-						val.reset(new value{ static_cast<int64_t>(chars[0] - U'0') });
+						val = make_value<int64_t>(static_cast<int64_t>(chars[0] - U'0'));
 						advance(); // skip the digit
 						break;
 					}
@@ -15216,7 +19331,7 @@ TOML_IMPL_NAMESPACE_START
 				// typed parse functions to take over and show better diagnostics if there's an issue
 				// (as opposed to the fallback "could not determine type" message)
 				if (has_any(has_p))
-					val.reset(new value{ parse_hex_float() });
+					val = make_value<double>(parse_hex_float());
 				else if (has_any(has_x | has_o | has_b))
 				{
 					int64_t i;
@@ -15238,17 +19353,18 @@ TOML_IMPL_NAMESPACE_START
 					}
 					return_if_error({});
 
-					val.reset(new value{ i });
+					val = make_value<int64_t>(i);
 					val->ref_cast<int64_t>().flags(flags);
 				}
 				else if (has_any(has_e) || (has_any(begins_digit) && chars[1] == U'.'))
-					val.reset(new value{ parse_float() });
+					val = parse_float_value();
 				else if (has_any(begins_sign))
 				{
 					// single-digit signed integers
 					if (char_count == 2u && has_any(has_digits))
 					{
-						val.reset(new value{ static_cast<int64_t>(chars[1] - U'0') * (chars[0] == U'-' ? -1LL : 1LL) });
+						val = make_value<int64_t>(static_cast<int64_t>(chars[1] - U'0')
+												  * (chars[0] == U'-' ? -1LL : 1LL));
 						advance(); // skip the sign
 						advance(); // skip the digit
 						break;
@@ -15256,11 +19372,11 @@ TOML_IMPL_NAMESPACE_START
 
 					// simple signed floats (e.g. +1.0)
 					if (is_decimal_digit(chars[1]) && chars[2] == U'.')
-						val.reset(new value{ parse_float() });
+						val = parse_float_value();
 
 					// signed infinity or nan
 					else if (is_match(chars[1], U'i', U'n', U'I', U'N'))
-						val.reset(new value{ parse_inf_or_nan() });
+						val = make_value<double>(parse_inf_or_nan());
 				}
 
 				return_if_error({});
@@ -15276,14 +19392,14 @@ TOML_IMPL_NAMESPACE_START
 					// binary integers
 					// 0b10
 					case bzero_msk | has_b:
-						val.reset(new value{ parse_integer<2>() });
+						val = make_value<int64_t>(parse_integer<2>());
 						val->ref_cast<int64_t>().flags(value_flags::format_as_binary);
 						break;
 
 					// octal integers
 					// 0o10
 					case bzero_msk | has_o:
-						val.reset(new value{ parse_integer<8>() });
+						val = make_value<int64_t>(parse_integer<8>());
 						val->ref_cast<int64_t>().flags(value_flags::format_as_octal);
 						break;
 
@@ -15309,14 +19425,14 @@ TOML_IMPL_NAMESPACE_START
 														 max_numeric_value_length,
 														 " characters"sv);
 
-						val.reset(new value{ parse_integer<10>() });
+						val = make_value<int64_t>(parse_integer<10>());
 						break;
 					}
 
 					// hexadecimal integers
 					// 0x10
 					case bzero_msk | has_x:
-						val.reset(new value{ parse_integer<16>() });
+						val = make_value<int64_t>(parse_integer<16>());
 						val->ref_cast<int64_t>().flags(value_flags::format_as_hexadecimal);
 						break;
 
@@ -15369,7 +19485,7 @@ TOML_IMPL_NAMESPACE_START
 					case begins_sign | has_digits | has_e | signs_msk: [[fallthrough]];
 					case begins_sign | has_digits | has_dot | has_minus: [[fallthrough]];
 					case begins_sign | has_digits | has_dot | has_e | has_minus:
-						val.reset(new value{ parse_float() });
+						val = parse_float_value();
 						break;
 
 					// hexadecimal floats
@@ -15403,7 +19519,7 @@ TOML_IMPL_NAMESPACE_START
 					case begins_sign | has_digits | has_x | has_dot | has_p | has_minus: [[fallthrough]];
 					case begins_sign | has_digits | has_x | has_dot | has_p | has_plus: [[fallthrough]];
 					case begins_sign | has_digits | has_x | has_dot | has_p | signs_msk:
-						val.reset(new value{ parse_hex_float() });
+						val = make_value<double>(parse_hex_float());
 						break;
 
 					// times
@@ -15413,12 +19529,12 @@ TOML_IMPL_NAMESPACE_START
 					case bzero_msk | has_colon: [[fallthrough]];
 					case bzero_msk | has_colon | has_dot: [[fallthrough]];
 					case bdigit_msk | has_colon: [[fallthrough]];
-					case bdigit_msk | has_colon | has_dot: val.reset(new value{ parse_time() }); break;
+					case bdigit_msk | has_colon | has_dot: val = make_value<time>(parse_time()); break;
 
 					// local dates
 					// YYYY-MM-DD
 					case bzero_msk | has_minus: [[fallthrough]];
-					case bdigit_msk | has_minus: val.reset(new value{ parse_date() }); break;
+					case bdigit_msk | has_minus: val = make_value<date>(parse_date()); break;
 
 					// date-times
 					// YYYY-MM-DDTHH:MM
@@ -15457,7 +19573,7 @@ TOML_IMPL_NAMESPACE_START
 					case bzero_msk | has_minus | has_colon | has_dot | has_z | has_t: [[fallthrough]];
 					case bdigit_msk | has_minus | has_colon | has_z | has_t: [[fallthrough]];
 					case bdigit_msk | has_minus | has_colon | has_dot | has_z | has_t:
-						val.reset(new value{ parse_date_time() });
+						val = make_value<date_time>(parse_date_time());
 						break;
 				}
 			}
@@ -15469,7 +19585,8 @@ TOML_IMPL_NAMESPACE_START
 				return_after_error({});
 			}
 
-			val->source_ = { begin_pos, current_position(1), reader.source_path() };
+			if (record_regions)
+				val->source_ = region_of(begin_pos, current_offset(1));
 			return val;
 		}
 
@@ -15487,7 +19604,7 @@ TOML_IMPL_NAMESPACE_START
 			while (!is_error())
 			{
 				std::string_view key_segment;
-				const auto key_begin = current_position();
+				const auto key_begin = current_offset();
 
 				// bare_key_segment
 				if (is_bare_key_character(*cp))
@@ -15496,7 +19613,7 @@ TOML_IMPL_NAMESPACE_START
 				// "quoted key segment"
 				else if (is_string_delimiter(*cp))
 				{
-					const auto begin_pos = cp->position;
+					const auto begin_pos = cp->offset;
 
 					recording_whitespace = true;
 					parsed_string str	 = parse_string();
@@ -15521,7 +19638,7 @@ TOML_IMPL_NAMESPACE_START
 												 to_sv(*cp),
 												 "'"sv);
 
-				const auto key_end = current_position();
+				const auto key_end = current_offset();
 
 				// whitespace following the key segment
 				consume_leading_whitespace();
@@ -15544,14 +19661,15 @@ TOML_IMPL_NAMESPACE_START
 		}
 
 		TOML_NODISCARD
-		key make_key(size_t segment_index) const
+		key make_key(size_t segment_index)
 		{
 			TOML_ASSERT(key_buffer.size() > segment_index);
 
-			return key{
-				key_buffer[segment_index],
-				source_region{ key_buffer.starts[segment_index], key_buffer.ends[segment_index], root.source().path }
-			};
+			source_region region{};
+			if (record_regions)
+				region = region_of(key_buffer.starts[segment_index], key_buffer.ends[segment_index]);
+
+			return key{ interned_keys.intern(key_buffer[segment_index]), std::move(region) };
 		}
 
 		TOML_NODISCARD
@@ -15563,9 +19681,10 @@ TOML_IMPL_NAMESPACE_START
 			TOML_ASSERT_ASSUME(*cp == U'[');
 			push_parse_scope("table header"sv);
 
-			const source_position header_begin_pos = cp->position;
-			source_position header_end_pos;
-			bool is_arr = false;
+			const size_t header_begin_pos = cp->offset;
+			size_t header_end_pos;
+			bool is_arr	   = false;
+			in_table_array = false;
 
 			// parse header
 			{
@@ -15583,7 +19702,8 @@ TOML_IMPL_NAMESPACE_START
 						set_error_and_return_default(
 							"[[array-of-table]] brackets must be contiguous (i.e. [ [ this ] ] is prohibited)"sv);
 
-					is_arr = true;
+					is_arr		   = true;
+					in_table_array = true;
 					advance_and_return_if_error_or_eof({});
 
 					// skip past any whitespace that followed the '['
@@ -15616,7 +19736,7 @@ TOML_IMPL_NAMESPACE_START
 						set_error_and_return_default("expected ']', saw '"sv, to_sv(*cp), "'"sv);
 				}
 				advance_and_return_if_error({});
-				header_end_pos = current_position(1);
+				header_end_pos = current_offset(1);
 
 				// handle the rest of the line after the header
 				consume_leading_whitespace();
@@ -15676,7 +19796,8 @@ TOML_IMPL_NAMESPACE_START
 				{
 					pit		  = parent->emplace_hint<table>(pit, make_key(i));
 					table& p  = pit->second.ref_cast<table>();
-					p.source_ = { header_begin_pos, header_end_pos, reader.source_path() };
+					if (record_regions)
+						p.source_ = region_of(header_begin_pos, header_end_pos);
 
 					implicit_tables.push_back(&p);
 					parent = &p;
@@ -15697,7 +19818,8 @@ TOML_IMPL_NAMESPACE_START
 					is_arr && arr && impl::find(table_arrays.begin(), table_arrays.end(), arr))
 				{
 					table& tbl	= arr->emplace_back<table>();
-					tbl.source_ = { header_begin_pos, header_end_pos, reader.source_path() };
+					if (record_regions)
+						tbl.source_ = region_of(header_begin_pos, header_end_pos);
 					return &tbl;
 				}
 
@@ -15721,8 +19843,11 @@ TOML_IMPL_NAMESPACE_START
 						if (ok)
 						{
 							implicit_tables.erase(implicit_tables.cbegin() + (found - implicit_tables.data()));
-							tbl->source_.begin = header_begin_pos;
-							tbl->source_.end   = header_end_pos;
+							if (record_regions)
+							{
+								tbl->source_.begin = position_of(header_begin_pos);
+								tbl->source_.end   = position_of(header_end_pos);
+							}
 							return tbl;
 						}
 					}
@@ -15762,10 +19887,12 @@ TOML_IMPL_NAMESPACE_START
 					it			   = parent->emplace_hint<array>(it, std::move(last_key));
 					array& tbl_arr = it->second.ref_cast<array>();
 					table_arrays.push_back(&tbl_arr);
-					tbl_arr.source_ = { header_begin_pos, header_end_pos, reader.source_path() };
+					if (record_regions)
+						tbl_arr.source_ = region_of(header_begin_pos, header_end_pos);
 
 					table& tbl	= tbl_arr.emplace_back<table>();
-					tbl.source_ = { header_begin_pos, header_end_pos, reader.source_path() };
+					if (record_regions)
+						tbl.source_ = region_of(header_begin_pos, header_end_pos);
 					return &tbl;
 				}
 
@@ -15774,7 +19901,8 @@ TOML_IMPL_NAMESPACE_START
 				{
 					it			= parent->emplace_hint<table>(it, std::move(last_key));
 					table& tbl	= it->second.ref_cast<table>();
-					tbl.source_ = { header_begin_pos, header_end_pos, reader.source_path() };
+					if (record_regions)
+						tbl.source_ = region_of(header_begin_pos, header_end_pos);
 					return &tbl;
 				}
 			}
@@ -15924,13 +20052,16 @@ TOML_IMPL_NAMESPACE_START
 			}
 			while (!is_eof());
 
-			auto eof_pos	 = current_position(1);
+			if (!record_regions)
+				return;
+
+			auto eof_pos	 = position_of(current_offset(1));
 			root.source_.end = eof_pos;
 			if (current_table && current_table != &root && current_table->source_.end <= current_table->source_.begin)
 				current_table->source_.end = eof_pos;
 		}
 
-		static void update_region_ends(node& nde) noexcept
+		static void update_region_ends(node& nde)
 		{
 			const auto type = nde.type();
 			if (type > node_type::array)
@@ -15955,7 +20086,10 @@ TOML_IMPL_NAMESPACE_START
 			else // arrays
 			{
 				auto& arr = nde.ref_cast<array>();
-				auto end  = nde.source_.end;
+				if (arr.packed()) // scalars or inline tables, so they can't end past the closing bracket
+					return;
+
+				auto end = nde.source_.end;
 				for (auto&& v : arr)
 				{
 					update_region_ends(v);
@@ -15963,14 +20097,23 @@ TOML_IMPL_NAMESPACE_START
 						end = v.source_.end;
 				}
 				nde.source_.end = end;
+
+				// arrays of tables can't be packed any earlier than this, since later headers can still add to them
+				if (arr.is_array_of_tables())
+					arr.pack();
 			}
 		}
 
 	  public:
-		parser(utf8_reader_interface&& reader_) //
-			: reader{ reader_ }
+		parser(utf8_reader_interface&& reader_, parse_flags flags = parse_flags::none) //
+			: reader{ reader_ },
+			  record_regions{ !(flags & parse_flags::no_source_regions) },
+			  borrow_strings{ !!(flags & (parse_flags::string_views | parse_flags::lazy_values))
+							  && !reader.source_text().empty() },
+			  lazy_values{ !!(flags & parse_flags::lazy_values) && borrow_strings }
 		{
-			root.source_ = { prev_pos, prev_pos, reader.source_path() };
+			if (record_regions)
+				root.source_ = region_of(prev_offset, prev_offset);
 
 			if (!reader.peek_eof())
 			{
@@ -15988,7 +20131,14 @@ TOML_IMPL_NAMESPACE_START
 					parse_document();
 			}
 
-			update_region_ends(root);
+			if (record_regions)
+				update_region_ends(root);
+			else
+			{
+				// nothing to extend, so only the packing is left; newer arrays can only be nested inside older ones
+				for (auto it = table_arrays.rbegin(); it != table_arrays.rend(); ++it)
+					(*it)->pack();
+			}
 		}
 
 		TOML_NODISCARD
@@ -16020,8 +20170,10 @@ TOML_IMPL_NAMESPACE_START
 		// skip opening '['
 		advance_and_return_if_error_or_eof({});
 
+		const depth_counter_scope array_depth{ nested_arrays };
 		node_ptr arr_ptr{ new array{} };
-		array& arr = arr_ptr->ref_cast<array>();
+		array& arr	  = arr_ptr->ref_cast<array>();
+		bool packable = true;
 		enum class TOML_CLOSED_ENUM parse_type : int
 		{
 			none,
@@ -16068,13 +20220,31 @@ TOML_IMPL_NAMESPACE_START
 				auto val = parse_value();
 				return_if_error({});
 
+				// arrays of scalars are packed as soon as there are enough elements to tell, and the rest are added
+				// to the packed values as they're parsed (until one doesn't fit), so their nodes never all exist at
+				// once. arrays of tables can't be packed until their tables are complete.
+				if (arr.packed_)
+				{
+					if (arr.packed_->push_back(*val))
+					{
+						spare_value = std::move(val);
+						continue;
+					}
+					arr.unpack();
+					packable = false;
+				}
+
 				if (!arr.capacity())
 					arr.reserve(4u);
 				arr.emplace_back<node_ptr>(std::move(val));
+				if (packable && arr.elems_.size() == TOML_ARRAY_PACK_THRESHOLD && !arr.elems_.front()->is_table())
+					packable = arr.pack();
 			}
 		}
 
 		return_if_error({});
+		if (packable && !arr.packed_)
+			arr.pack();
 		return arr_ptr;
 	}
 
@@ -16194,25 +20364,25 @@ TOML_ANON_NAMESPACE_START
 {
 	TOML_NODISCARD
 	TOML_INTERNAL_LINKAGE
-	parse_result do_parse(utf8_reader_interface && reader)
+	parse_result do_parse(utf8_reader_interface && reader, parse_flags flags = parse_flags::none)
 	{
-		return impl::parser{ std::move(reader) };
+		return impl::parser{ std::move(reader), flags };
 	}
 
 	TOML_NODISCARD
 	TOML_INTERNAL_LINKAGE
-	parse_result do_parse_file(std::string_view file_path)
+	parse_result do_parse_file(std::string_view file_path, parse_flags flags = parse_flags::none)
 	{
 #if TOML_EXCEPTIONS
 #define TOML_PARSE_FILE_ERROR(msg, path)                                                                               \
-	throw parse_error{ msg, source_position{}, std::make_shared<const std::string>(std::move(path)) }
+	throw parse_error{ msg, source_position{}, impl::intern_source_path(path) }
 #else
 #define TOML_PARSE_FILE_ERROR(msg, path)                                                                               \
 	return parse_result                                                                                                \
 	{                                                                                                                  \
 		parse_error                                                                                                    \
 		{                                                                                                              \
-			msg, source_position{}, std::make_shared<const std::string>(std::move(path))                               \
+			msg, source_position{}, impl::intern_source_path(path)                                                     \
 		}                                                                                                              \
 	}
 #endif
@@ -16244,12 +20414,12 @@ TOML_ANON_NAMESPACE_START
 			std::vector<char> file_data;
 			file_data.resize(static_cast<size_t>(file_size));
 			file.read(file_data.data(), static_cast<std::streamsize>(file_size));
-			return parse(std::string_view{ file_data.data(), file_data.size() }, std::move(file_path_str));
+			return parse(std::string_view{ file_data.data(), file_data.size() }, std::move(file_path_str), flags);
 		}
 
 		// otherwise parse it using the streams
 		else
-			return parse(file, std::move(file_path_str));
+			return parse(file, std::move(file_path_str), flags);
 
 #undef TOML_PARSE_FILE_ERROR
 	}
@@ -16261,33 +20431,33 @@ TOML_NAMESPACE_START
 	TOML_ABI_NAMESPACE_BOOL(TOML_EXCEPTIONS, ex, noex);
 
 	TOML_EXTERNAL_LINKAGE
-	parse_result TOML_CALLCONV parse(std::string_view doc, std::string_view source_path)
+	parse_result TOML_CALLCONV parse(std::string_view doc, std::string_view source_path, parse_flags flags)
 	{
-		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, source_path });
+		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, source_path }, flags);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	parse_result TOML_CALLCONV parse(std::string_view doc, std::string && source_path)
+	parse_result TOML_CALLCONV parse(std::string_view doc, std::string && source_path, parse_flags flags)
 	{
-		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, std::move(source_path) });
+		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, std::move(source_path) }, flags);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	parse_result TOML_CALLCONV parse(std::istream & doc, std::string_view source_path)
+	parse_result TOML_CALLCONV parse(std::istream & doc, std::string_view source_path, parse_flags flags)
 	{
-		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, source_path });
+		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, source_path }, flags);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	parse_result TOML_CALLCONV parse(std::istream & doc, std::string && source_path)
+	parse_result TOML_CALLCONV parse(std::istream & doc, std::string && source_path, parse_flags flags)
 	{
-		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, std::move(source_path) });
+		return TOML_ANON_NAMESPACE::do_parse(TOML_ANON_NAMESPACE::utf8_reader{ doc, std::move(source_path) }, flags);
 	}
 
 	TOML_EXTERNAL_LINKAGE
-	parse_result TOML_CALLCONV parse_file(std::string_view file_path)
+	parse_result TOML_CALLCONV parse_file(std::string_view file_path, parse_flags flags)
 	{
-		return TOML_ANON_NAMESPACE::do_parse_file(file_path);
+		return TOML_ANON_NAMESPACE::do_parse_file(file_path, flags);
 	}
 
 #if TOML_HAS_CHAR8
@@ -16492,28 +20662,53 @@ TOML_IMPL_NAMESPACE_START
 		// ascii fast path
 		if (is_ascii(str.data(), str.length()))
 		{
-			for (auto c : str)
+			static constexpr auto all_ascii_traits =
+				formatted_string_traits::all & ~formatted_string_traits::non_ascii;
+
+			// candidate bare keys need every character checked
+			if (allow_bare)
 			{
-				switch (c)
+				for (auto c : str)
 				{
-					case '\n': traits |= formatted_string_traits::line_breaks; break;
-					case '\t': traits |= formatted_string_traits::tabs; break;
-					case '\'': traits |= formatted_string_traits::single_quotes; break;
-					default:
+					switch (c)
 					{
-						if TOML_UNLIKELY(is_control_character(c))
-							traits |= formatted_string_traits::control_chars;
+						case '\n': traits |= formatted_string_traits::line_breaks; break;
+						case '\t': traits |= formatted_string_traits::tabs; break;
+						case '\'': traits |= formatted_string_traits::single_quotes; break;
+						default:
+						{
+							if TOML_UNLIKELY(is_control_character(c))
+								traits |= formatted_string_traits::control_chars;
 
-						if (!is_ascii_bare_key_character(static_cast<char32_t>(c)))
-							traits |= formatted_string_traits::non_bare;
-						break;
+							if (!is_ascii_bare_key_character(static_cast<char32_t>(c)))
+								traits |= formatted_string_traits::non_bare;
+							break;
+						}
 					}
+
+					if (traits == all_ascii_traits)
+						break;
 				}
+			}
 
-				static constexpr auto all_ascii_traits =
-					formatted_string_traits::all & ~formatted_string_traits::non_ascii;
-				if (traits == all_ascii_traits)
-					break;
+			// everything else only cares about the rare characters, so skip straight to them
+			else
+			{
+				const char* const end = str.data() + str.length();
+				for (auto c = find_string_trait_char(str.data(), end); c != end;
+					 c			= find_string_trait_char(c + 1, end))
+				{
+					switch (*c)
+					{
+						case '\n': traits |= formatted_string_traits::line_breaks; break;
+						case '\t': traits |= formatted_string_traits::tabs; break;
+						case '\'': traits |= formatted_string_traits::single_quotes; break;
+						default: traits |= formatted_string_traits::control_chars; break;
+					}
+
+					if (traits == all_ascii_traits)
+						break;
+				}
 			}
 		}
 
@@ -16532,9 +20727,18 @@ TOML_IMPL_NAMESPACE_START
 				unicode_allowed = false;
 			};
 
-			for (auto c : str)
+			const char* const end = str.data() + str.length();
+			for (auto c = str.data(); c != end; c++)
 			{
-				decoder(c);
+				// between codepoints, runs of ordinary ascii can be skipped when bare-ness isn't in question
+				if (!allow_bare && decoder.has_code_point())
+				{
+					c = find_string_trait_char(c, end);
+					if (c == end)
+						break;
+				}
+
+				decoder(*c);
 
 				if TOML_UNLIKELY(decoder.error())
 				{
@@ -16613,8 +20817,18 @@ TOML_IMPL_NAMESPACE_START
 		// ascii fast path
 		if (!(traits & formatted_string_traits::non_ascii))
 		{
-			for (auto c : str)
+			const char* const end = str.data() + str.length();
+			for (auto run = str.data(); run != end;)
 			{
+				// runs of characters that don't need escaping are written in one go
+				const auto c_ptr = find_string_escape_char(run, end);
+				if (c_ptr != run)
+					print_to_stream(*stream_, run, static_cast<size_t>(c_ptr - run));
+				if (c_ptr == end)
+					break;
+				run = c_ptr + 1;
+
+				const auto c = *c_ptr;
 				switch (c)
 				{
 					case '"': print_to_stream(*stream_, R"(\")"sv); break;
@@ -16640,11 +20854,25 @@ TOML_IMPL_NAMESPACE_START
 		else
 		{
 			utf8_decoder decoder;
-			const char* cp_start = str.data();
-			const char* cp_end	 = cp_start;
-			for (auto c : str)
+			const char* const end = str.data() + str.length();
+			const char* cp_start  = str.data();
+			const char* cp_end	  = cp_start;
+			while (cp_end != end)
 			{
-				decoder(c);
+				// between codepoints, runs of characters that don't need escaping are written in one go
+				if (decoder.has_code_point())
+				{
+					cp_end = find_string_escape_char(cp_start, end);
+					if (cp_end != cp_start)
+					{
+						print_to_stream(*stream_, cp_start, static_cast<size_t>(cp_end - cp_start));
+						cp_start = cp_end;
+					}
+					if (cp_end == end)
+						break;
+				}
+
+				decoder(*cp_end);
 				cp_end++;
 
 				// if the decoder encounters malformed unicode just emit raw bytes and
@@ -16718,7 +20946,7 @@ TOML_IMPL_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	void formatter::print(const value<std::string>& val)
 	{
-		print_string(val.get());
+		print_string(val.view());
 	}
 
 	TOML_EXTERNAL_LINKAGE
@@ -16933,9 +21161,14 @@ TOML_ANON_NAMESPACE_START
 				if (arr.empty())
 					return 2u;		// "[]"
 				size_t weight = 3u; // "[ ]"
-				for (auto& elem : arr)
+				for (size_t i = 0; i < arr.size(); i++)
 				{
-					weight += toml_formatter_count_inline_columns(elem, line_wrap_cols) + 2u; // +  ", "
+					const auto elem_weight = impl::visit_array_element(
+						arr,
+						i,
+						[&](const toml::node& elem) noexcept
+						{ return toml_formatter_count_inline_columns(elem, line_wrap_cols); });
+					weight += elem_weight + 2u; // +  ", "
 					if (weight >= line_wrap_cols)
 						break;
 				}
@@ -16946,7 +21179,7 @@ TOML_ANON_NAMESPACE_START
 			{
 				// todo: proper utf8 decoding?
 				// todo: tab awareness?
-				auto& str = (*reinterpret_cast<const value<std::string>*>(&node)).get();
+				const auto str = (*reinterpret_cast<const value<std::string>*>(&node)).view();
 				return str.length() + 2u; // + ""
 			}
 
@@ -17096,15 +21329,20 @@ TOML_NAMESPACE_START
 				print_indent();
 			}
 
-			auto& v			= arr[i];
-			const auto type = v.type();
-			TOML_ASSUME(type != node_type::none);
-			switch (type)
-			{
-				case node_type::table: print_inline(*reinterpret_cast<const table*>(&v)); break;
-				case node_type::array: print(*reinterpret_cast<const array*>(&v)); break;
-				default: print_value(v, type);
-			}
+			impl::visit_array_element(
+				arr,
+				i,
+				[&](const node& v)
+				{
+					const auto type = v.type();
+					TOML_ASSUME(type != node_type::none);
+					switch (type)
+					{
+						case node_type::table: print_inline(*reinterpret_cast<const table*>(&v)); break;
+						case node_type::array: print(*reinterpret_cast<const array*>(&v)); break;
+						default: print_value(v, type);
+					}
+				});
 		}
 		if (multiline)
 		{
@@ -17127,7 +21365,10 @@ TOML_NAMESPACE_START
 			if (!arr || !arr->is_array_of_tables())
 				return false;
 
-			return !reinterpret_cast<const table*>(&(*arr)[0])->is_inline();
+			return impl::visit_array_element(*arr,
+											 0,
+											 [](const node& elem) noexcept
+											 { return !reinterpret_cast<const table*>(&elem)->is_inline(); });
 		};
 
 		// values, arrays, and inline tables/table arrays
@@ -17247,7 +21488,9 @@ TOML_NAMESPACE_START
 				print_key_path();
 				print_unformatted("]]"sv);
 				pending_table_separator_ = true;
-				print(*reinterpret_cast<const table*>(&arr[i]));
+				impl::visit_array_element(arr,
+										  i,
+										  [&](const node& elem) { print(*reinterpret_cast<const table*>(&elem)); });
 			}
 
 			key_path_.pop_back();
@@ -17377,15 +21620,20 @@ TOML_NAMESPACE_START
 			print_newline(true);
 			print_indent();
 
-			auto& v			= arr[i];
-			const auto type = v.type();
-			TOML_ASSUME(type != node_type::none);
-			switch (type)
-			{
-				case node_type::table: print(*reinterpret_cast<const table*>(&v)); break;
-				case node_type::array: print(*reinterpret_cast<const array*>(&v)); break;
-				default: print_value(v, type);
-			}
+			impl::visit_array_element(
+				arr,
+				i,
+				[&](const node& v)
+				{
+					const auto type = v.type();
+					TOML_ASSUME(type != node_type::none);
+					switch (type)
+					{
+						case node_type::table: print(*reinterpret_cast<const table*>(&v)); break;
+						case node_type::array: print(*reinterpret_cast<const array*>(&v)); break;
+						default: print_value(v, type);
+					}
+				});
 		}
 		if (indent_array_elements())
 			decrease_indent();
@@ -17441,14 +21689,15 @@ TOML_NAMESPACE_START
 	TOML_EXTERNAL_LINKAGE
 	void yaml_formatter::print_yaml_string(const value<std::string>& str)
 	{
-		if (str->empty())
+		const auto text = str.view();
+		if (text.empty())
 		{
 			base::print(str);
 			return;
 		}
 
 		bool contains_newline = false;
-		for (auto c = str->c_str(), e = str->c_str() + str->length(); c < e && !contains_newline; c++)
+		for (auto c = text.data(), e = text.data() + text.length(); c < e && !contains_newline; c++)
 			contains_newline = *c == '\n';
 
 		if (contains_newline)
@@ -17457,8 +21706,8 @@ TOML_NAMESPACE_START
 
 			increase_indent();
 
-			auto line_end  = str->c_str() - 1u;
-			const auto end = str->c_str() + str->length();
+			auto line_end  = text.data() - 1u;
+			const auto end = text.data() + text.length();
 			while (line_end != end)
 			{
 				auto line_start = line_end + 1u;
@@ -17477,7 +21726,7 @@ TOML_NAMESPACE_START
 			decrease_indent();
 		}
 		else
-			print_string(*str, false, true);
+			print_string(text, false, true);
 	}
 
 	TOML_EXTERNAL_LINKAGE
@@ -17531,7 +21780,7 @@ TOML_NAMESPACE_START
 
 		increase_indent();
 
-		for (auto&& v : arr)
+		for (size_t i = 0; i < arr.size(); i++)
 		{
 			if (!parent_is_array)
 			{
@@ -17542,15 +21791,23 @@ TOML_NAMESPACE_START
 
 			print_unformatted("- "sv);
 
-			const auto type = v.type();
-			TOML_ASSUME(type != node_type::none);
-			switch (type)
-			{
-				case node_type::table: print(*reinterpret_cast<const table*>(&v), true); break;
-				case node_type::array: print(*reinterpret_cast<const array*>(&v), true); break;
-				case node_type::string: print_yaml_string(*reinterpret_cast<const value<std::string>*>(&v)); break;
-				default: print_value(v, type);
-			}
+			impl::visit_array_element(
+				arr,
+				i,
+				[&](const node& v)
+				{
+					const auto type = v.type();
+					TOML_ASSUME(type != node_type::none);
+					switch (type)
+					{
+						case node_type::table: print(*reinterpret_cast<const table*>(&v), true); break;
+						case node_type::array: print(*reinterpret_cast<const array*>(&v), true); break;
+						case node_type::string:
+							print_yaml_string(*reinterpret_cast<const value<std::string>*>(&v));
+							break;
+						default: print_value(v, type);
+					}
+				});
 		}
 
 		decrease_indent();
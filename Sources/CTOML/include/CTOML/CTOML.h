@@ -29,6 +29,12 @@ extern "C" {
 	struct CTOMLValue;
 	typedef struct CTOMLValue CTOMLValue;
 
+	struct CTOMLTableDiff;
+	typedef struct CTOMLTableDiff CTOMLTableDiff;
+
+	struct CTOMLLayeredView;
+	typedef struct CTOMLLayeredView CTOMLLayeredView;
+
 	/// The position in the TOML document at which a parsing error occurred.
 	struct CTOMLSourcePosition {
 
@@ -124,6 +130,103 @@ extern "C" {
 
 	typedef enum CTOMLNodeType CTOMLNodeType;
 
+	/// Options that change how \c tableCreateFromString parses a TOML document.
+	enum CTOMLParseOptions {
+		/// Allocate the document's nodes, keys and container storage from a single arena. Parsing makes far fewer
+		/// calls to \c malloc , and \c tableDestroy releases the arena in one go instead of freeing those blocks one
+		/// by one. Destroying the table still runs every node's destructor, and string values too long for
+		/// \c std::string to keep inline still get their own heap allocation (see \c ctomlParseStringViews ).
+		ctomlParseArena = 1 << 0,
+
+		/// Don't record where each node and key came from in the document. Parsing does less work for every node
+		/// and key, but \c CTOMLParseError still reports exactly where a parse error is.
+		ctomlParseNoSourceRegions = 1 << 1,
+
+		/// Store string values longer than \c std::string keeps inline, and that are written in the document without
+		/// escape sequences, as references to a copy of the document kept in the table's arena instead of copying each
+		/// of them. Implies \c ctomlParseArena .
+		ctomlParseStringViews = 1 << 2,
+
+		/// Check floats and long strings that contain escape sequences or line breaks while parsing, but only convert
+		/// them the first time they're read (by \c nodeAsDouble , \c nodeAsString , a conversion, and so on). Implies
+		/// \c ctomlParseStringViews .
+		ctomlParseLazyValues = 1 << 3,
+
+		/// Return the same table every time the same document is parsed (with the same options) while it's in a
+		/// process-wide cache of recently parsed documents, instead of parsing it again. The table is reference
+		/// counted by \c tableDestroy and must not be modified. Implies \c ctomlParseArena ; see
+		/// \c ctomlSetSharedTableCacheLimit .
+		ctomlParseShared = 1 << 4
+	};
+
+	typedef enum CTOMLParseOptions CTOMLParseOptions;
+
+	/// How a key differs between the tables compared by \c tableDiff .
+	enum CTOMLChangeKind {
+		/// The key is only in the new table.
+		ctomlKeyAdded,
+
+		/// The key is only in the old table.
+		ctomlKeyRemoved,
+
+		/// The key is in both tables, with different values.
+		ctomlKeyChanged
+	} __attribute__((enum_extensibility(closed)));
+
+	typedef enum CTOMLChangeKind CTOMLChangeKind;
+
+	/// What \c tableMergeInto does with a key that's in both tables, unless it's a table in both (those are always
+	/// merged key by key).
+	enum CTOMLMergePolicy {
+		/// The value being merged in replaces the existing one.
+		ctomlMergeOverride,
+
+		/// The existing value is kept.
+		ctomlMergeKeep,
+
+		/// Like \c ctomlMergeOverride , except that arrays in both are joined, with the elements being merged in
+		/// after the existing ones.
+		ctomlMergeAppendArrays,
+
+		/// Nothing is merged, and \c tableMergeInto fails.
+		ctomlMergeErrorOnConflict
+	} __attribute__((enum_extensibility(closed)));
+
+	typedef enum CTOMLMergePolicy CTOMLMergePolicy;
+
+	/// Allocates \c size bytes, like \c malloc . \c context is the value passed to \c ctomlSetAllocator .
+	typedef void * _Nullable (*CTOMLMallocFunction)(size_t size, void * _Nullable context);
+
+	/// Resizes \c ptr to \c size bytes, like \c realloc .
+	typedef void * _Nullable (*CTOMLReallocFunction)(
+		void * _Nullable ptr, size_t size, void * _Nullable context);
+
+	/// Frees \c ptr , like \c free .
+	typedef void (*CTOMLFreeFunction)(void * _Nullable ptr, void * _Nullable context);
+
+	// MARK: - Allocator
+
+	/// Routes CTOML's allocations, and toml++'s node, key and container allocations, through
+	/// \c mallocFunction , \c reallocFunction and \c freeFunction . Passing \c NULL for any of them restores
+	/// \c malloc , \c realloc and \c free . The characters of string values too long for \c std::string to keep
+	/// inline, the parser's scratch buffers and CTOML's own bookkeeping (such as the \c ctomlParseShared cache)
+	/// still come from \c operator \c new .
+	///
+	/// Set the allocator before calling any other CTOML function, and don't call this while another thread is
+	/// using CTOML. Calling it again replaces the functions in place, so memory returned by CTOML (strings, key
+	/// arrays, values from \c nodeAs* ) and tables, arrays and nodes created while one allocator was installed
+	/// must be released before another one is installed.
+	/// @param mallocFunction Must return memory aligned like \c malloc does.
+	/// @param context Passed unchanged to every call of the three functions.
+	void ctomlSetAllocator(
+		CTOMLMallocFunction _Nullable mallocFunction,
+		CTOMLReallocFunction _Nullable reallocFunction,
+		CTOMLFreeFunction _Nullable freeFunction,
+		void * _Nullable context);
+
+	/// Frees memory returned by a CTOML function.
+	void ctomlFree(void * _Nullable ptr);
+
 #pragma clang assume_nonnull begin
 
 	// MARK: - Array - Creation and Deletion
@@ -144,6 +247,9 @@ extern "C" {
 	/// The amount of elements in \c array .
 	size_t arraySize(CTOMLArray * array);
 
+	/// Stores \c array compactly if its elements allow it, returning whether they are stored that way.
+	bool arrayCompact(CTOMLArray * array);
+
 	// MARK: - Array - Value Manipulation - Deletion
 	/// Clears all the values in \c array .
 	/// @param array The \c toml::array to clear.
@@ -220,10 +326,76 @@ extern "C" {
 
 	/// Creates a \c toml::table from a string containing a TOML document.
 	/// @param tomlStr The string containing the TOML document.
+	/// @param options A combination of \c CTOMLParseOptions .
 	/// @param errorPointer Te pointer that will contain the \c CTOMLParseError if an error occurs
 	/// during parsing.
 	CTOMLTable * _Nullable tableCreateFromString(
-		const char * _Nonnull tomlStr, CTOMLParseError * _Nonnull errorPointer);
+		const char * _Nonnull tomlStr, uint64_t options, CTOMLParseError * _Nonnull errorPointer);
+
+	/// Creates a \c toml::table from the TOML document in the file at \c path , like \c tableCreateFromString .
+	///
+	/// If \c cacheDirectory isn't \c NULL , a snapshot of the table (see \c tableSaveSnapshot ) is saved in that
+	/// directory under a hash of the file's contents, and loaded instead of parsing the file again as long as its
+	/// contents don't change. Tables loaded from the cache are allocated like ones parsed with
+	/// \c ctomlParseStringViews whatever \c options are, and don't have source regions. Snapshots are written to
+	/// a temporary file and renamed into place, so several processes can share a cache directory. The directory
+	/// isn't used with \c ctomlParseShared .
+	/// @param errorPointer The pointer that will contain the \c CTOMLParseError if the file can't be read or an
+	/// error occurs during parsing.
+	CTOMLTable * _Nullable tableCreateFromFile(
+		const char * _Nonnull path,
+		uint64_t options,
+		const char * _Nullable cacheDirectory,
+		CTOMLParseError * _Nonnull errorPointer);
+
+	/// Destroys \c table , which must have been returned by \c tableCreate , \c tableCreateFromString ,
+	/// \c tableCreateFromFile , \c tableOpenSnapshot or \c tableCreateSharedImage . If \c table was parsed with
+	/// \c ctomlParseArena , its arena is released as well. A table parsed with \c ctomlParseShared is only freed
+	/// once every call that returned it has been matched by a \c tableDestroy and it has left the cache.
+	void tableDestroy(CTOMLTable * table);
+
+	/// Loads a table saved with \c tableSaveSnapshot , which is much faster than parsing the document again.
+	/// The table is allocated like one parsed with \c ctomlParseStringViews and must be destroyed with
+	/// \c tableDestroy . Returns \c NULL if \c path can't be read, isn't a snapshot written by this version of
+	/// CTOML on a machine with the same byte order, or has been truncated or damaged since it was written.
+	CTOMLTable * _Nullable tableOpenSnapshot(const char * _Nonnull path);
+
+	/// Saves \c table to the file at \c path in a binary format that \c tableOpenSnapshot loads without parsing,
+	/// returning whether it was written. Source regions aren't saved.
+	bool tableSaveSnapshot(CTOMLTable * _Nonnull table, const char * _Nonnull path);
+
+	/// Copies \c table into memory that is shared with the processes forked after this call and is read-only,
+	/// so that a large document parsed once before forking workers takes up memory only once, however many of
+	/// them there are. The workers use the returned table as it is, since their copy of the mapping is at the same
+	/// address. Modifying it crashes. Calling \c tableDestroy unmaps it from that process only, and the memory is
+	/// freed once every process has done that or exited.
+	///
+	/// Returns \c NULL if the memory can't be mapped, which is always the case on Windows.
+	CTOMLTable * _Nullable tableCreateSharedImage(CTOMLTable * _Nonnull table);
+
+	/// Freezes \c table so that copying it, or a table or array in it, with \c copyNode takes constant time: the
+	/// copy shares everything with the original until one of them is modified, which copies only the tables and
+	/// arrays on the way to what changed. Getting a node from a frozen table or array (with \c tableGetNode or
+	/// \c arrayGetNode ) counts as modifying it, since the node could be modified through what's returned. Nodes
+	/// gotten from \c table before freezing it mustn't be used to modify it afterwards.
+	///
+	/// Returns \c false (and leaves \c table as it is) if \c table was parsed with \c ctomlParseArena ,
+	/// \c ctomlParseStringViews , \c ctomlParseLazyValues or \c ctomlParseShared , or came from
+	/// \c tableOpenSnapshot or \c tableCreateSharedImage , since copies could outlive the memory it's in.
+	bool tableFreeze(CTOMLTable * _Nonnull table);
+
+	/// Sets the most documents parsed with \c ctomlParseShared that are kept to be shared (256 by default),
+	/// evicting the least recently used ones past that. \c 0 turns sharing off.
+	void ctomlSetSharedTableCacheLimit(size_t limit);
+
+	/// Destroys \c table like \c tableDestroy , but on a background thread, so that the caller doesn't wait for
+	/// a large document to be freed. Documents are taken apart one table or array at a time, so deeply nested
+	/// ones don't overflow the stack.
+	void tableDestroyDeferred(CTOMLTable * table);
+
+	/// Blocks until every table passed to \c tableDestroyDeferred so far has been freed. Call this before
+	/// replacing the functions passed to \c ctomlSetAllocator if tables might still be waiting to be freed.
+	void tableWaitForDeferredDestruction();
 
 	// MARK: - Table - Information
 
@@ -259,6 +431,10 @@ extern "C" {
 	/// @param table The \c toml::table to clear.
 	void tableClear(CTOMLTable * table);
 
+	/// Moves everything in \c table into contiguous memory in depth-first order, which makes walking it
+	/// faster. Pointers to anything inside \c table are invalidated.
+	void tableCompact(CTOMLTable * table);
+
 	/// Inserts \c integer into \c table at \c key .
 	void tableInsertInt(CTOMLTable * table, const char * key, int64_t integer, uint16_t flags);
 
@@ -287,6 +463,88 @@ extern "C" {
 	/// Remove the element at \c key from \c table .
 	void tableRemoveElement(CTOMLTable * table, const char * key);
 
+	// MARK: - Table - Diff and Patch
+
+	/// Compares \c oldTable with \c newTable , returning the keys that were added, removed or changed, which must be
+	/// destroyed with \c tableDiffDestroy . Both tables are walked together in key order, and tables in both are
+	/// compared key by key, so a change deep in a table is reported by its full path rather than as a change to the
+	/// table. Arrays are compared as a whole. Tables that share their contents because one was copied from the other
+	/// after \c tableFreeze are skipped without being walked, so diffing two versions of a frozen document takes
+	/// time proportional to what changed.
+	CTOMLTableDiff * _Nonnull tableDiff(CTOMLTable * _Nonnull oldTable, CTOMLTable * _Nonnull newTable);
+
+	/// The number of keys in \c diff .
+	size_t tableDiffSize(CTOMLTableDiff * _Nonnull diff);
+
+	/// How the key at \c index in \c diff changed.
+	CTOMLChangeKind tableDiffKind(CTOMLTableDiff * _Nonnull diff, size_t index);
+
+	/// The path of the key at \c index in \c diff from the root table, written as a TOML dotted key (keys that
+	/// aren't bare are quoted). The string belongs to \c diff .
+	const char * _Nonnull tableDiffPath(CTOMLTableDiff * _Nonnull diff, size_t index);
+
+	/// The new value of the key at \c index in \c diff , or \c NULL if it was removed. The node belongs to
+	/// \c diff .
+	const CTOMLNode * _Nullable tableDiffValue(CTOMLTableDiff * _Nonnull diff, size_t index);
+
+	/// Applies \c diff to \c table , so that a table equal to the old table given to \c tableDiff becomes equal
+	/// to the new one. Tables on the way to an added or changed key are created if they're missing (or aren't
+	/// tables), and removing a key that isn't there does nothing. \c diff can be applied any number of times.
+	void tablePatch(CTOMLTable * _Nonnull table, CTOMLTableDiff * _Nonnull diff);
+
+	/// Destroys \c diff , which must have been returned by \c tableDiff .
+	void tableDiffDestroy(CTOMLTableDiff * _Nonnull diff);
+
+	// MARK: - Table - Merging
+
+	/// Merges \c source into \c destination in a single pass, merging tables that are in both key by key and
+	/// resolving any other key that's in both according to \c policy . The values in \c source are moved rather
+	/// than copied, so \c source is left empty, unless it's in memory \c destination can't take values from (it was
+	/// parsed with \c ctomlParseArena , \c ctomlParseStringViews , \c ctomlParseLazyValues or
+	/// \c ctomlParseShared , or came from \c tableOpenSnapshot or \c tableCreateSharedImage ), in which case they're
+	/// copied and \c source is left as it was.
+	///
+	/// Returns \c false if \c policy is \c ctomlMergeErrorOnConflict and a key is in both tables, leaving both as
+	/// they were. If \c conflictPath isn't \c NULL , it's then set to the key's path as a TOML dotted key, which
+	/// must be freed with \c ctomlFree .
+	bool tableMergeInto(
+		CTOMLTable * _Nonnull destination,
+		CTOMLTable * _Nonnull source,
+		CTOMLMergePolicy policy,
+		char * _Nullable * _Nullable conflictPath);
+
+	// MARK: - Table - Layered Views
+
+	/// Creates a view of \c layers as if they had been merged into one table in order with \c ctomlMergeOverride ,
+	/// without merging or copying anything. Lookups probe the layers from the last one down, and the view must be
+	/// destroyed with \c layeredViewDestroy before any of the tables are changed or destroyed. If \c cacheMisses is
+	/// \c true , paths that aren't in any layer are remembered so that looking them up again doesn't probe the
+	/// layers, and the view can then only be used from one thread at a time.
+	CTOMLLayeredView * _Nonnull layeredViewCreate(
+		CTOMLTable * _Nonnull const * _Nonnull layers, size_t count, bool cacheMisses);
+
+	/// Retrieves the value at \c key from the highest layer of \c view that has it.
+	const CTOMLNode * _Nullable layeredViewGetNode(CTOMLLayeredView * _Nonnull view, const char * _Nonnull key);
+
+	/// Retrieves the value at the path made of the \c count keys in \c keys from the highest layer of \c view
+	/// that has it. A path that goes through a value other than a table in a layer isn't looked up in the layers
+	/// below it, as merging would have replaced their tables. A table that's in more than one layer is returned
+	/// from the highest of them, so look its keys up through \c view .
+	const CTOMLNode * _Nullable layeredViewGetNodeAtPath(
+		CTOMLLayeredView * _Nonnull view, const char * _Nonnull const * _Nonnull keys, size_t count);
+
+	/// Retrieves the keys of the table at the path made of the \c count keys in \c path (the root table if
+	/// \c count is 0), sorted and taken from every layer it's in, setting \c size to the number of keys. The keys
+	/// and the array must be freed with \c ctomlFree .
+	char * _Nonnull * _Nonnull layeredViewGetKeys(
+		CTOMLLayeredView * _Nonnull view,
+		const char * _Nonnull const * _Nullable path,
+		size_t count,
+		size_t * _Nonnull size);
+
+	/// Destroys \c view , which must have been returned by \c layeredViewCreate .
+	void layeredViewDestroy(CTOMLLayeredView * _Nonnull view);
+
 	// MARK: - Table Conversion
 
 	/// Convert \c table to a TOML document.
@@ -302,9 +560,18 @@ extern "C" {
 	/// The TOML type of \c node .
 	CTOMLNodeType nodeType(CTOMLNode * node);
 
-	/// Copies \c n and returns the copy.
+	/// Copies \c n and returns the copy. Copying a table frozen with \c tableFreeze , or anything in one, takes
+	/// constant time.
 	CTOMLNode * copyNode(CTOMLNode * n);
 
+	/// A 64-bit hash of \c node and everything in it, which is the same for nodes that are equal (so tables that
+	/// are equal hash the same however they were written) and doesn't change between runs on machines with the same
+	/// byte order. \c node can be a \c CTOMLTable or \c CTOMLArray too. The hashes of the tables and arrays in a
+	/// table frozen with \c tableFreeze are cached, so hashing it again after changing it only visits what was
+	/// changed and the tables and arrays on the way to it. Frozen tables that have been hashed are compared by their
+	/// hashes first by \c tableEqual .
+	uint64_t nodeHash(CTOMLNode * _Nonnull node);
+
 	// MARK: - Date, Time, and Date Time Conversion
 	/// Convert \c date to TOML.
 	const char * _Nonnull cTOMLDateToTOML(CTOMLDate date);
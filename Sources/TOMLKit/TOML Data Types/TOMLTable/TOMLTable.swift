@@ -220,7 +220,7 @@ public final class TOMLTable:
 	public init(string: String) throws {
 		let errorPointer = UnsafeMutablePointer<CTOMLParseError>.allocate(capacity: 1)
 
-		guard let table = string.withCString({ tableCreateFromString($0, errorPointer) }) else {
+		guard let table = string.withCString({ tableCreateFromString($0, 0, errorPointer) }) else {
 			throw TOMLParseError(cTOMLParseError: errorPointer.pointee)
 		}
 
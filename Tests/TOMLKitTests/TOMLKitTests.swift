@@ -9,6 +9,7 @@
 // XCTAssertEqual tells you "<huge TOMLTable> is not equal to <other huge TOMLTable>"
 // import CustomDump
 import Checkit
+import CTOML
 import Foundation
 @testable import TOMLKit
 import XCTest
@@ -73,6 +74,71 @@ time = 04:27:05.000000294
 	data = 'Yic='
 """
 
+/// Parses `string` like `TOMLTable(string:)`, with `CTOMLParseOptions` that it doesn't expose.
+func parseTable(_ string: String, options: [CTOMLParseOptions] = []) throws -> TOMLTable {
+	let errorPointer = UnsafeMutablePointer<CTOMLParseError>.allocate(capacity: 1)
+	defer { errorPointer.deallocate() }
+
+	let flags = options.reduce(UInt64(0)) { $0 | UInt64($1.rawValue) }
+	guard let table = string.withCString({ tableCreateFromString($0, flags, errorPointer) }) else {
+		throw TOMLParseError(cTOMLParseError: errorPointer.pointee)
+	}
+
+	return TOMLTable(tablePointer: table)
+}
+
+/// Calls `body` with `strings` as an array of C strings (or `nil` if there are none), which is only valid during
+/// the call.
+func withCStrings<Result>(
+	_ strings: [String],
+	_ body: (UnsafePointer<UnsafePointer<CChar>>?) throws -> Result
+) rethrows -> Result {
+	let pointers = strings.map { UnsafePointer(strdup($0)!) }
+	defer { pointers.forEach { free(UnsafeMutablePointer(mutating: $0)) } }
+	return try pointers.withUnsafeBufferPointer { try body($0.baseAddress) }
+}
+
+/// Counts the calls `testCustomAllocator` sees to the functions it passes to `ctomlSetAllocator`, which can
+/// come from the thread `tableDestroyDeferred` frees tables on.
+final class AllocationCounter {
+	private let lock = NSLock()
+	private(set) var allocations = 0
+	private(set) var frees = 0
+
+	func allocated() {
+		self.lock.lock()
+		defer { self.lock.unlock() }
+		self.allocations += 1
+	}
+
+	func freed() {
+		self.lock.lock()
+		defer { self.lock.unlock() }
+		self.frees += 1
+	}
+
+	/// Routes CTOML's allocations through `malloc`, `realloc` and `free`, counting them.
+	func install() {
+		ctomlSetAllocator(
+			{ size, context in
+				Unmanaged<AllocationCounter>.fromOpaque(context!).takeUnretainedValue().allocated()
+				return malloc(size)
+			},
+			{ pointer, size, context in
+				if pointer == nil {
+					Unmanaged<AllocationCounter>.fromOpaque(context!).takeUnretainedValue().allocated()
+				}
+				return realloc(pointer, size)
+			},
+			{ pointer, context in
+				if pointer != nil { Unmanaged<AllocationCounter>.fromOpaque(context!).takeUnretainedValue().freed() }
+				free(pointer)
+			},
+			Unmanaged.passUnretained(self).toOpaque()
+		)
+	}
+}
+
 final class TOMLKitTests: XCTestCase {
 	let testTable = [
 		"String": "Hello, World!",
@@ -413,6 +479,928 @@ final class TOMLKitTests: XCTestCase {
 		XCTAssertEqual(self.testTable.convert(to: .yaml), expectedYAML)
 	}
 
+	func testStringEscaping() throws {
+		let table: TOMLTable = [
+			"escaped": "C:\\path\\to \"file\"\t\u{1} and été",
+			"plain": String(repeating: "abcdefgh", count: 8),
+		]
+
+		let expectedTOML = #"""
+		escaped = "C:\\path\\to \"file\"\t\u0001 and \u00E9t\u00E9"
+		plain = "abcdefghabcdefghabcdefghabcdefghabcdefghabcdefghabcdefghabcdefgh"
+		"""#
+
+		XCTAssertEqual(table.convert(options: []), expectedTOML)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+	}
+
+	func testLargeHomogeneousArrays() throws {
+		let toml = """
+		ints = [\((0..<100).map(String.init).joined(separator: ", "))]
+		floats = [\((0..<100).map { "\($0).5" }.joined(separator: ", "))]
+		"""
+
+		let table = try TOMLTable(string: toml)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		let ints = table["ints"]!.array!
+		XCTAssertEqual(ints.count, 100)
+		XCTAssertEqual(ints[42].int!, 42)
+		XCTAssertEqual(table["floats"]![99]!.double!, 99.5)
+
+		// An array that stops being homogeneous partway through is still read in full.
+		let integers = (0..<40).map(String.init).joined(separator: ", ")
+		let mixed = try TOMLTable(string: "mixed = [\(integers), 40.5, \"41\"]")
+		let elements = mixed["mixed"]!.array!
+		XCTAssertEqual(elements.count, 42)
+		XCTAssertEqual(elements[39].int!, 39)
+		XCTAssertEqual(elements[40].double!, 40.5)
+		XCTAssertEqual(elements[41].string!, "41")
+		XCTAssertEqual(try TOMLTable(string: mixed.convert()), mixed)
+
+		// Mixing in another type has to fall back to regular storage.
+		ints.append("101")
+		XCTAssertEqual(ints.count, 101)
+		XCTAssertEqual(ints[0].int!, 0)
+		XCTAssertEqual(ints[100].string!, "101")
+	}
+
+	func testArraysOfSameShapedTables() throws {
+		let toml = (0..<50).map { "[[endpoint]]\nname = \"svc-\($0)\"\nport = \(8000 + $0)\n" }.joined(separator: "\n")
+
+		let table = try TOMLTable(string: toml)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		var endpoints = table["endpoint"]!.array!
+		XCTAssertEqual(endpoints.count, 50)
+		XCTAssertEqual(endpoints[42]["name"]!.string!, "svc-42")
+		XCTAssertEqual(endpoints[49]["port"]!.int!, 8049)
+
+		endpoints[42]["port"] = 1
+		XCTAssertEqual(endpoints[42]["port"]!.int!, 1)
+		XCTAssertEqual(table["endpoint"]![42]!["port"]!.int!, 1)
+	}
+
+	func testArenaParsing() throws {
+		let toml = """
+		name = "a string value that's too long for std::string to keep inline"
+		ports = [8000, 8001]
+
+		[server]
+		host = "localhost"
+		"""
+
+		let table = try parseTable(toml, options: [ctomlParseArena])
+		XCTAssertEqual(table, try TOMLTable(string: toml))
+		XCTAssertEqual(table["server"]!["host"]!.string!, "localhost")
+
+		// Values inserted after parsing come from the heap, next to the arena's blocks.
+		let server = table["server"]!.table!
+		server["port"] = 8080
+		server["host"] = "a replacement that's also too long to be kept inline"
+		table["ports"]!.array!.append(8002)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+		XCTAssertEqual(server["port"]!.int!, 8080)
+		XCTAssertEqual(table["ports"]![2]!.int!, 8002)
+
+		tableDestroy(table.tablePointer)
+	}
+
+	func testCustomAllocator() throws {
+		let counter = AllocationCounter()
+		counter.install()
+		defer { ctomlSetAllocator(nil, nil, nil, nil) }
+
+		// Only the C API is used here, since the wrappers don't free everything CTOML returns.
+		for options in [[], [ctomlParseArena]] as [[CTOMLParseOptions]] {
+			let before = counter.allocations
+			let table = try parseTable("a = 1\nb = 'x'\n[t]\nc = [1, 2, 3]\nd = { e = 1.5 }\n", options: options)
+			XCTAssertTrue(tableContains(table.tablePointer, "t"))
+
+			let json = tableConvertToJSON(table.tablePointer, 0)!
+			XCTAssertGreaterThan(counter.allocations, before)
+			XCTAssertGreaterThan(counter.allocations, counter.frees)
+
+			ctomlFree(json)
+			tableDestroy(table.tablePointer)
+			XCTAssertEqual(counter.frees, counter.allocations)
+		}
+	}
+
+	func testWideTables() throws {
+		// Tables with 16 or more keys are also indexed by a hash table, which has to keep up with every change.
+		let toml = (0..<40).map { "key\($0) = \($0)" }.joined(separator: "\n")
+		let table = try TOMLTable(string: toml)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+		XCTAssertEqual(table.keys, (0..<40).map { "key\($0)" }.sorted())
+
+		for i in 0..<40 {
+			XCTAssertEqual(table["key\(i)"]!.int!, i)
+		}
+		XCTAssertNil(table["key40"])
+
+		for i in stride(from: 0, to: 40, by: 2) {
+			table.remove(at: "key\(i)")
+		}
+		table["key40"] = "added"
+		XCTAssertEqual(table.count, 21)
+		XCTAssertNil(table["key0"])
+		XCTAssertEqual(table["key39"]!.int!, 39)
+		XCTAssertEqual(table["key40"]!.string!, "added")
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		// The index keeps working once the table shrinks back under the threshold.
+		for i in stride(from: 1, to: 33, by: 2) {
+			table.remove(at: "key\(i)")
+		}
+		XCTAssertEqual(table.keys, ["key33", "key35", "key37", "key39", "key40"])
+		XCTAssertEqual(table["key35"]!.int!, 35)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+	}
+
+	func testSmallTables() throws {
+		// Tables with at most 8 keys are stored in a flat array, and move to a map when they grow past that.
+		let table = try TOMLTable(string: "b = 2\na = 1\n[inline]\nx = { z = 3, y = 2 }\n")
+		XCTAssertEqual(table.keys, ["a", "b", "inline"])
+		XCTAssertEqual(table["inline"]!["x"]!["y"]!.int!, 2)
+
+		for i in 0..<12 {
+			table["k\(i)"] = i
+		}
+		XCTAssertEqual(table.count, 15)
+		XCTAssertEqual(table["k11"]!.int!, 11)
+		XCTAssertEqual(table["a"]!.int!, 1)
+
+		for i in 0..<12 {
+			table.remove(at: "k\(i)")
+		}
+		XCTAssertEqual(table.keys, ["a", "b", "inline"])
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+		XCTAssertEqual(table, try TOMLTable(string: "a = 1\nb = 2\n[inline]\nx = { y = 2, z = 3 }\n"))
+	}
+
+	func testInternedKeys() throws {
+		// Each key is stored once per document and shared by every table that uses it.
+		let toml = (0..<20).map { "[server\($0)]\nhost = \"h\($0)\"\nport = \($0)\n" }.joined(separator: "\n")
+
+		for options in [[], [ctomlParseArena]] as [[CTOMLParseOptions]] {
+			let table = try parseTable(toml, options: options)
+			let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+
+			// Changing one table's keys leaves the others, and the copy, alone.
+			let first = table["server0"]!.table!
+			first.remove(at: "host")
+			first["hostname"] = "renamed"
+			XCTAssertEqual(first.keys, ["hostname", "port"])
+			XCTAssertEqual(table["server1"]!.table!.keys, ["host", "port"])
+			XCTAssertEqual(copy["server0"]!.table!.keys, ["host", "port"])
+			XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+			// The copy's keys outlive the document they came from, even when it was parsed into an arena.
+			tableDestroy(table.tablePointer)
+			XCTAssertEqual(copy.count, 20)
+			XCTAssertEqual(copy["server19"]!["host"]!.string!, "h19")
+			XCTAssertEqual(try TOMLTable(string: copy.convert()), copy)
+			tableDestroy(copy.tablePointer)
+		}
+	}
+
+	func testParsingWithoutSourceRegions() throws {
+		let toml = """
+		title = "regions"
+		ports = [8000, 8001, 8002]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+
+		[[jobs]]
+		name = "build"
+		"""
+
+		let table = try parseTable(toml, options: [ctomlParseNoSourceRegions])
+		XCTAssertEqual(table, try TOMLTable(string: toml))
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+		XCTAssertEqual(table["server"]!["limits"]!["memory"]!.int!, 512)
+		tableDestroy(table.tablePointer)
+
+		// Parse errors still say where they are.
+		XCTAssertThrowsError(try parseTable("a = 1\nb = [1,,2]\n", options: [ctomlParseNoSourceRegions])) { error in
+			let error = error as! TOMLParseError
+			XCTAssertEqual(error.source.begin.line, 2)
+			XCTAssertEqual(error.source.begin.column, 8)
+		}
+	}
+
+	func testParsingTheSameFileTwice() throws {
+		// Documents parsed from the same path share one stored copy of it.
+		let url = FileManager.default.temporaryDirectory
+			.appendingPathComponent("TOMLKitTests-\(UUID().uuidString).toml")
+		try "name = \"first\"\nports = [1, 2, 3]\n[server]\nhost = \"localhost\"\n"
+			.write(to: url, atomically: true, encoding: .utf8)
+		defer { try? FileManager.default.removeItem(at: url) }
+
+		let errorPointer = UnsafeMutablePointer<CTOMLParseError>.allocate(capacity: 1)
+		defer { errorPointer.deallocate() }
+
+		let first = TOMLTable(tablePointer: try XCTUnwrap(tableCreateFromFile(url.path, 0, nil, errorPointer)))
+		let second = TOMLTable(tablePointer: try XCTUnwrap(tableCreateFromFile(url.path, 0, nil, errorPointer)))
+		XCTAssertEqual(first, second)
+		XCTAssertEqual(try TOMLTable(string: first.convert()), first)
+
+		// Nodes copied out of one of them keep working once it's destroyed.
+		let server = TOMLTable(tablePointer: copyNode(first["server"]!.table!.tablePointer))
+		tableDestroy(first.tablePointer)
+		XCTAssertEqual(server["host"]!.string!, "localhost")
+		XCTAssertEqual(server, second["server"]!.table!)
+		XCTAssertEqual(try TOMLTable(string: second.convert()), second)
+
+		tableDestroy(server.tablePointer)
+		tableDestroy(second.tablePointer)
+	}
+
+	func testErrorPositionsAfterMultibyteCharactersAndCRLF() throws {
+		// Columns count characters rather than bytes, and "\r\n" ends a line like "\n" does.
+		let documents = [
+			("s = \"Ünïcødé\" x\n", 1, 15),
+			("s = \"日本語\" x\r\n", 1, 11),
+			("a = 1\r\n\r\ns = \"日本\" = 2\r\n", 3, 10),
+			("# ü\r\nkey = 1\r\nkey = 2\r\n", 3, 7),
+		]
+
+		for (toml, line, column) in documents {
+			for options in [[], [ctomlParseNoSourceRegions]] as [[CTOMLParseOptions]] {
+				XCTAssertThrowsError(try parseTable(toml, options: options)) { error in
+					let error = error as! TOMLParseError
+					XCTAssertEqual(error.source.begin.line, line)
+					XCTAssertEqual(error.source.begin.column, column)
+				}
+			}
+		}
+	}
+
+	func testStringViewParsing() throws {
+		let long = "a string value that's long enough to be kept as a view of the document"
+		let toml = """
+		name = "\(long)"
+		escaped = "a long string with an escape sequence\\tso it has to be copied"
+		names = ["\(long)", "\(long)"]
+
+		[[entry]]
+		description = "\(long)"
+		"""
+
+		let table = try parseTable(toml, options: [ctomlParseStringViews])
+		XCTAssertEqual(table, try TOMLTable(string: toml))
+		XCTAssertEqual(table["name"]!.string!, long)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		// Copies own their strings, so they outlive the document they were parsed from.
+		let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+		table["name"] = "replaced"
+		tableDestroy(table.tablePointer)
+		XCTAssertEqual(copy["name"]!.string!, long)
+		XCTAssertEqual(copy["entry"]![0]!["description"]!.string!, long)
+		XCTAssertEqual(try TOMLTable(string: copy.convert()), copy)
+		tableDestroy(copy.tablePointer)
+
+		// An empty document leaves nothing to copy.
+		for options in [[ctomlParseStringViews], [ctomlParseLazyValues]] as [[CTOMLParseOptions]] {
+			let empty = try parseTable("", options: options)
+			XCTAssertEqual(empty.count, 0)
+			tableDestroy(empty.tablePointer)
+		}
+	}
+
+	func testLazyValueParsing() throws {
+		let toml = """
+		f = 3.14159
+		g = 1e300
+		i = inf
+		s = "line one\\nline two, which is long enough not to be kept inline"
+		m = \"\"\"
+		a multi-line string
+		that is long enough to be converted later\"\"\"
+		floats = [\((0..<20).map { "\($0).5" }.joined(separator: ", "))]
+
+		[t]
+		x = 6.02e23
+		"""
+
+		let lazy = try parseTable(toml, options: [ctomlParseLazyValues])
+		let eager = try TOMLTable(string: toml)
+		XCTAssertEqual(lazy, eager)
+		XCTAssertEqual(lazy.convert(), eager.convert())
+		XCTAssertEqual(try TOMLTable(string: lazy.convert()), lazy)
+
+		// Values read back the same the first time they're converted as they do later.
+		let other = try parseTable(toml, options: [ctomlParseLazyValues])
+		XCTAssertEqual(other["f"]!.double!, 3.14159)
+		XCTAssertEqual(other["s"]!.string!, "line one\nline two, which is long enough not to be kept inline")
+		XCTAssertEqual(other["t"]!["x"]!.double!, 6.02e23)
+		XCTAssertEqual(other["floats"]![19]!.double!, 19.5)
+		XCTAssertEqual(other, eager)
+
+		tableDestroy(lazy.tablePointer)
+		tableDestroy(other.tablePointer)
+	}
+
+	func testTablesOfScalars() throws {
+		// The scalars in these tables are allocated together in shared chunks.
+		let toml = (0..<200).map {
+			"[t\($0)]\na = \($0)\nb = \($0).5\nc = true\nd = 2021-05-20\ne = 04:27:05\nf = 2021-05-20T04:27:05Z\n"
+		}.joined(separator: "\n")
+
+		let table = try parseTable(toml)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		for i in stride(from: 0, to: 200, by: 2) {
+			let t = table["t\(i)"]!.table!
+			t.remove(at: "a")
+			t["z"] = -i
+			t["b"] = "replaced"
+		}
+		for i in stride(from: 0, to: 200, by: 3) {
+			table.remove(at: "t\(i)")
+		}
+		XCTAssertEqual(table["t199"]!["a"]!.int!, 199)
+		XCTAssertEqual(table["t2"]!["z"]!.int!, -2)
+		XCTAssertEqual(table["t2"]!["b"]!.string!, "replaced")
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		// A copy's scalars don't depend on the chunks the original's came from.
+		let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+		tableDestroy(table.tablePointer)
+		XCTAssertEqual(copy["t1"]!["b"]!.double!, 1.5)
+		XCTAssertEqual(
+			copy["t1"]!["f"]!.dateTime!,
+			TOMLDateTime(
+				date: TOMLDate(year: 2021, month: 5, day: 20),
+				time: TOMLTime(hour: 4, minute: 27, second: 5, nanoSecond: 0),
+				offset: TOMLTimeOffset(offset: 0)
+			)
+		)
+		XCTAssertEqual(try TOMLTable(string: copy.convert()), copy)
+		tableDestroy(copy.tablePointer)
+	}
+
+	func testCompaction() throws {
+		let toml = """
+		title = "compact"
+		ports = [8000, 8001, 8002]
+		mixed = [1, 'two', 3.0]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+
+		[[jobs]]
+		name = "build"
+		steps = ['a', 'b']
+
+		[[jobs]]
+		name = "test"
+		steps = ['c']
+		"""
+
+		let table = try parseTable(toml)
+		let uncompacted = try parseTable(toml)
+		tableCompact(table.tablePointer)
+		XCTAssertEqual(table, uncompacted)
+		XCTAssertEqual(table.convert(), uncompacted.convert())
+
+		// Compacted tables and arrays can still be modified.
+		let server = table["server"]!.table!
+		server["port"] = 8080
+		server.remove(at: "host")
+		arrayInsertInt(table["ports"]!.array!.arrayPointer, 3, 8003, 0)
+		XCTAssertEqual(table["ports"]![3]!.int!, 8003)
+		XCTAssertEqual(table["server"]!["port"]!.int!, 8080)
+		XCTAssertFalse(tableContains(server.tablePointer, "host"))
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		tableCompact(table.tablePointer)
+		XCTAssertEqual(try TOMLTable(string: table.convert()), table)
+
+		// Arrays of different types can't be stored compactly; arrays of integers can.
+		XCTAssertFalse(arrayCompact(table["mixed"]!.array!.arrayPointer))
+
+		let integers = try parseTable("a = [\((0..<40).map(String.init).joined(separator: ", "))]")
+		let a = integers["a"]!.array!.arrayPointer
+		arrayInsertInt(a, 40, 40, 0)
+		XCTAssertTrue(arrayCompact(a))
+		XCTAssertEqual(arraySize(a), 41)
+		XCTAssertEqual(integers["a"]![40]!.int!, 40)
+		arrayInsertInt(a, 0, -1, 0)
+		XCTAssertEqual(integers["a"]![0]!.int!, -1)
+		XCTAssertEqual(integers["a"]![41]!.int!, 40)
+		XCTAssertEqual(try TOMLTable(string: integers.convert()), integers)
+
+		tableDestroy(table.tablePointer)
+		tableDestroy(uncompacted.tablePointer)
+		tableDestroy(integers.tablePointer)
+	}
+
+	func testDeferredDestruction() throws {
+		let toml = """
+		title = "a string value that's too long for std::string to keep inline"
+		ports = [8000, 8001, 8002]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+
+		[[jobs]]
+		name = "build"
+		steps = ['a', 'b']
+		"""
+
+		let counter = AllocationCounter()
+		counter.install()
+		defer { ctomlSetAllocator(nil, nil, nil, nil) }
+
+		let kept = try parseTable(toml)
+		for options in [[], [ctomlParseArena]] as [[CTOMLParseOptions]] {
+			for _ in 0..<20 {
+				tableDestroyDeferred(try parseTable(toml, options: options).tablePointer)
+			}
+		}
+		let deep = try parseTable("a = " + String(repeating: "[", count: 200) + String(repeating: "]", count: 200))
+		tableDestroyDeferred(deep.tablePointer)
+		tableWaitForDeferredDestruction()
+
+		// Tables that weren't passed to tableDestroyDeferred are left alone.
+		XCTAssertEqual(kept["server"]!["host"]!.string!, "localhost")
+		XCTAssertEqual(try TOMLTable(string: toml), kept)
+		tableDestroyDeferred(kept.tablePointer)
+		tableWaitForDeferredDestruction()
+		XCTAssertEqual(counter.frees, counter.allocations)
+	}
+
+	func testSnapshots() throws {
+		let toml = """
+		title = "a string value that's too long for std::string to keep inline"
+		ports = [8000, 8001, 8002]
+		mixed = [1, 'two', 3.0]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+		started = 2021-05-20T04:27:05Z
+		"""
+
+		let table = try parseTable(toml)
+		let url = FileManager.default.temporaryDirectory.appendingPathComponent("TOMLKitTests-\(UUID()).snapshot")
+		let damagedURL = url.appendingPathExtension("damaged")
+		defer {
+			try? FileManager.default.removeItem(at: url)
+			try? FileManager.default.removeItem(at: damagedURL)
+		}
+
+		XCTAssertTrue(tableSaveSnapshot(table.tablePointer, url.path))
+		let loaded = TOMLTable(tablePointer: try XCTUnwrap(tableOpenSnapshot(url.path)))
+		XCTAssertEqual(loaded, table)
+		XCTAssertEqual(try TOMLTable(string: loaded.convert()), table)
+		tableDestroy(loaded.tablePointer)
+
+		// Truncated and damaged snapshots aren't loaded.
+		let bytes = try Data(contentsOf: url)
+		for length in 0..<bytes.count {
+			try bytes.prefix(length).write(to: damagedURL)
+			XCTAssertNil(tableOpenSnapshot(damagedURL.path), "truncated to \(length) bytes")
+		}
+		for index in 0..<bytes.count {
+			var damaged = bytes
+			damaged[index] ^= 0x10
+			try damaged.write(to: damagedURL)
+			XCTAssertNil(tableOpenSnapshot(damagedURL.path), "byte \(index) changed")
+		}
+
+		XCTAssertNil(tableOpenSnapshot(url.appendingPathExtension("missing").path))
+		tableDestroy(table.tablePointer)
+	}
+
+	func testSharedTableCacheEviction() throws {
+		ctomlSetSharedTableCacheLimit(2)
+		defer {
+			ctomlSetSharedTableCacheLimit(0)
+			ctomlSetSharedTableCacheLimit(256)
+		}
+
+		func parseShared(_ name: String) throws -> OpaquePointer {
+			let toml = "name = \"\(name)\"\nports = [8000, 8001]\n[server]\nhost = \"localhost\"\n"
+			return try parseTable(toml, options: [ctomlParseShared]).tablePointer
+		}
+
+		// The same document parsed again is the same table while it's cached.
+		let a = try parseShared("a")
+		XCTAssertEqual(try parseShared("a"), a)
+		tableDestroy(a)
+
+		// Parsing two others evicts it, but it stays valid while it's still held.
+		let b = try parseShared("b")
+		let c = try parseShared("c")
+		let newA = try parseShared("a")
+		XCTAssertNotEqual(newA, a)
+		XCTAssertEqual(TOMLTable(tablePointer: a)["name"]!.string!, "a")
+		XCTAssertEqual(TOMLTable(tablePointer: a)["server"]!["host"]!.string!, "localhost")
+		XCTAssertTrue(tableEqual(a, newA))
+		tableDestroy(a)
+
+		// Parsing "c" again makes "a" the least recently used, so it's the one evicted next.
+		let sameC = try parseShared("c")
+		XCTAssertEqual(sameC, c)
+		let d = try parseShared("d")
+		let thirdA = try parseShared("a")
+		XCTAssertNotEqual(thirdA, newA)
+		XCTAssertEqual(TOMLTable(tablePointer: b)["name"]!.string!, "b")
+
+		for table in [b, c, sameC, newA, d, thirdA] {
+			tableDestroy(table)
+		}
+	}
+
+	func testSharedImages() throws {
+		let toml = """
+		title = "a string value that's too long for std::string to keep inline"
+		ports = [\((0..<100).map(String.init).joined(separator: ", "))]
+		mixed = [1, 'two', 3.0]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+		started = 2021-05-20T04:27:05Z
+		"""
+
+		let table = try parseTable(toml)
+		#if os(Windows)
+			XCTAssertNil(tableCreateSharedImage(table.tablePointer))
+		#else
+			let image = TOMLTable(tablePointer: try XCTUnwrap(tableCreateSharedImage(table.tablePointer)))
+			tableDestroy(table.tablePointer)
+			XCTAssertEqual(image, try TOMLTable(string: toml))
+			XCTAssertEqual(try TOMLTable(string: image.convert()), image)
+			XCTAssertEqual(image["ports"]![99]!.int!, 99)
+
+			// The image is read-only, so it can't be frozen to share it with copies, and is modified by copying it.
+			XCTAssertFalse(tableFreeze(image.tablePointer))
+			let copy = TOMLTable(tablePointer: copyNode(image.tablePointer))
+			copy["server"]!.table!["host"] = "example.com"
+			copy.remove(at: "ports")
+			XCTAssertEqual(image["server"]!["host"]!.string!, "localhost")
+			XCTAssertEqual(image, try TOMLTable(string: toml))
+
+			tableDestroy(copy.tablePointer)
+			tableDestroy(image.tablePointer)
+		#endif
+	}
+
+	func testModifyingFrozenCopies() throws {
+		let toml = """
+		ports = [8000, 8001, 8002]
+		ids = [\((0..<40).map(String.init).joined(separator: ", "))]
+
+		[server]
+		host = "localhost"
+		limits = { cpu = 2.5, memory = 512 }
+
+		[[jobs]]
+		name = "build"
+		steps = ['a', 'b']
+
+		[[jobs]]
+		name = "test"
+		steps = ['c']
+		"""
+
+		let table = try parseTable(toml)
+		XCTAssertTrue(tableFreeze(table.tablePointer))
+
+		// Arrays (including packed ones) and nested tables of a copy are modified without changing the original.
+		let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+		copy["ports"]!.array!.insert(9000, at: 1)
+		copy["ports"]!.array!.remove(at: 3)
+		copy["ids"]!.array!.remove(at: 0)
+		copy["ids"]!.array!.insert(-1, at: 20)
+		copy["ids"]!.array![0] = "replaced"
+		copy["jobs"]!.array!.insert(TOMLTable(["name": "lint"]), at: 0)
+		copy["jobs"]!.array!.remove(at: 2)
+		copy["jobs"]!.array![1].table!["name"] = "compile"
+		copy["jobs"]!.array![1].table!["steps"]!.array!.insert("z", at: 1)
+		copy["server"]!.table!["limits"]!.table!["cpu"] = 4
+		copy["server"]!.table!.remove(at: "host")
+
+		XCTAssertEqual(table, try TOMLTable(string: toml))
+		XCTAssertEqual(copy["ports"]!.array!.count, 3)
+		XCTAssertEqual(copy["ports"]![1]!.int!, 9000)
+		XCTAssertEqual(copy["ports"]![2]!.int!, 8001)
+		XCTAssertEqual(copy["ids"]![0]!.string!, "replaced")
+		XCTAssertEqual(copy["ids"]![20]!.int!, -1)
+		XCTAssertEqual(copy["ids"]![39]!.int!, 39)
+		XCTAssertEqual(copy["jobs"]!.array!.count, 2)
+		XCTAssertEqual(copy["jobs"]![0]!["name"]!.string!, "lint")
+		XCTAssertEqual(copy["jobs"]![1]!["name"]!.string!, "compile")
+		XCTAssertEqual(copy["jobs"]![1]!["steps"]![1]!.string!, "z")
+		XCTAssertEqual(copy["server"]!["limits"]!["cpu"]!.int!, 4)
+		XCTAssertNil(copy["server"]!["host"])
+		XCTAssertEqual(try TOMLTable(string: copy.convert()), copy)
+
+		// Modifying the original doesn't change a copy either.
+		let secondCopy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+		table["ids"]!.array!.remove(at: 39)
+		table["jobs"]!.array![0].table!["name"] = "changed"
+		XCTAssertEqual(secondCopy, try TOMLTable(string: toml))
+
+		tableDestroy(table.tablePointer)
+		tableDestroy(copy.tablePointer)
+		tableDestroy(secondCopy.tablePointer)
+	}
+
+	func testNodeHashes() throws {
+		let toml = "title = 'x'\nports = [1, 2, 3]\n\n[server]\nhost = 'localhost'\nport = 8080\n"
+
+		// Equal tables hash the same, however they were written or parsed.
+		let table = try parseTable(toml)
+		let hash = nodeHash(table.tablePointer)
+		for (document, options) in [
+			("server = { port = 0x1F90, host = \"localhost\" }\nports = [1, 2, 3]\ntitle = \"x\"\n", []),
+			("title = 'x'\nserver.host = 'localhost'\nserver.port = 8080\nports = [1, 2, 3]\n", []),
+			(toml, [ctomlParseArena]),
+		] as [(String, [CTOMLParseOptions])] {
+			let other = try parseTable(document, options: options)
+			XCTAssertEqual(other, table)
+			XCTAssertEqual(nodeHash(other.tablePointer), hash, document)
+			tableDestroy(other.tablePointer)
+		}
+
+		let floats = try parseTable("title = 'x'\nports = [1.0, 2, 3]\n\n[server]\nhost = 'localhost'\nport = 8080\n")
+		XCTAssertNotEqual(nodeHash(floats.tablePointer), hash)
+		tableDestroy(floats.tablePointer)
+
+		// The hash changes with the table, and goes back when the change is undone.
+		table["server"]!.table!["port"] = 8081
+		XCTAssertNotEqual(nodeHash(table.tablePointer), hash)
+		table["server"]!.table!["port"] = 8080
+		XCTAssertEqual(nodeHash(table.tablePointer), hash)
+
+		// Frozen tables cache their hashes, which have to be updated by changes to copies.
+		XCTAssertTrue(tableFreeze(table.tablePointer))
+		XCTAssertEqual(nodeHash(table.tablePointer), hash)
+		let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+		copy["ports"]!.array!.append(4)
+		XCTAssertNotEqual(nodeHash(copy.tablePointer), hash)
+		XCTAssertEqual(nodeHash(table.tablePointer), hash)
+		copy["ports"]!.array!.remove(at: 3)
+		XCTAssertEqual(nodeHash(copy.tablePointer), hash)
+		XCTAssertEqual(copy, table)
+
+		tableDestroy(table.tablePointer)
+		tableDestroy(copy.tablePointer)
+	}
+
+	func testDiffAndPatch() throws {
+		let old = try parseTable("""
+		title = "old"
+		removed = 1
+		same = [1, 2]
+
+		[server]
+		host = "localhost"
+		port = 8080
+
+		[server.tls]
+		enabled = false
+
+		["a b"]
+		c = 1
+		""")
+		let new = try parseTable("""
+		title = "new"
+		same = [1, 2]
+		added = { x = 1 }
+
+		[server]
+		host = "localhost"
+		port = 8081
+		name = "n"
+
+		[server.tls]
+		enabled = true
+
+		["a b"]
+		""")
+
+		let diff = tableDiff(old.tablePointer, new.tablePointer)
+		defer { tableDiffDestroy(diff) }
+
+		let paths = (0..<tableDiffSize(diff)).map { String(cString: tableDiffPath(diff, $0)) }
+		let kinds = (0..<tableDiffSize(diff)).map { tableDiffKind(diff, $0) }
+		XCTAssertEqual(
+			paths,
+			["\"a b\".c", "added", "removed", "server.name", "server.port", "server.tls.enabled", "title"]
+		)
+		XCTAssertEqual(kinds, [.removed, .added, .removed, .added, .changed, .changed, .changed] as [CTOMLChangeKind])
+		XCTAssertNil(tableDiffValue(diff, 0))
+		XCTAssertEqual(nodeAsInt(try XCTUnwrap(tableDiffValue(diff, 4)))?.pointee, 8081)
+
+		// Patching a copy of the old table turns it into the new one, however many times it's applied.
+		let patched = TOMLTable(tablePointer: copyNode(old.tablePointer))
+		tablePatch(patched.tablePointer, diff)
+		XCTAssertEqual(patched, new)
+		tablePatch(patched.tablePointer, diff)
+		XCTAssertEqual(patched, new)
+
+		let copy = copyNode(old.tablePointer)!
+		let unchanged = tableDiff(old.tablePointer, copy)
+		XCTAssertEqual(tableDiffSize(unchanged), 0)
+		tableDiffDestroy(unchanged)
+		tableDestroy(copy)
+
+		tableDestroy(old.tablePointer)
+		tableDestroy(new.tablePointer)
+		tableDestroy(patched.tablePointer)
+	}
+
+	func testMergePolicies() throws {
+		let destinationTOML = """
+		name = "destination"
+		ports = [1, 2]
+		scalar = 1
+		table = { x = 1 }
+
+		[server]
+		host = "localhost"
+		port = 8080
+		"""
+		let sourceTOML = """
+		name = "source"
+		ports = [3]
+		scalar = { y = 2 }
+		table = 5
+		extra = true
+
+		[server]
+		port = 9090
+		timeout = 30
+		"""
+
+		// Tables in both are merged key by key whatever the policy is; other keys in both follow it.
+		let merged: [(CTOMLMergePolicy, String)] = [
+			(.override, "name = 'source'\nports = [3]\nscalar = { y = 2 }\ntable = 5\n"),
+			(.keep, "name = 'destination'\nports = [1, 2]\nscalar = 1\ntable = { x = 1 }\n"),
+			(.appendArrays, "name = 'source'\nports = [1, 2, 3]\nscalar = { y = 2 }\ntable = 5\n"),
+		]
+		for (policy, keys) in merged {
+			let port = policy == .keep ? 8080 : 9090
+			let expected = try parseTable(
+				keys + "extra = true\n[server]\nhost = 'localhost'\nport = \(port)\ntimeout = 30\n"
+			)
+
+			// Values are moved out of heap-allocated sources, and copied out of arenas.
+			for options in [[], [ctomlParseArena]] as [[CTOMLParseOptions]] {
+				let destination = try parseTable(destinationTOML)
+				let source = try parseTable(sourceTOML, options: options)
+				XCTAssertTrue(tableMergeInto(destination.tablePointer, source.tablePointer, policy, nil))
+				XCTAssertEqual(destination, expected, "\(policy)")
+				XCTAssertEqual(tableSize(source.tablePointer), options.isEmpty ? 0 : 6)
+				tableDestroy(destination.tablePointer)
+				tableDestroy(source.tablePointer)
+			}
+			tableDestroy(expected.tablePointer)
+		}
+
+		// Conflicts leave both tables alone, and report the first key in both.
+		let destination = try parseTable(destinationTOML)
+		let source = try parseTable(sourceTOML)
+		var conflictPath: UnsafeMutablePointer<CChar>?
+		XCTAssertFalse(tableMergeInto(destination.tablePointer, source.tablePointer, .errorOnConflict, &conflictPath))
+		XCTAssertEqual(String(cString: try XCTUnwrap(conflictPath)), "name")
+		ctomlFree(conflictPath)
+		XCTAssertEqual(destination, try TOMLTable(string: destinationTOML))
+		XCTAssertEqual(source, try TOMLTable(string: sourceTOML))
+
+		let nested = try parseTable("[t.u]\nx = 2\n")
+		let other = try parseTable("[t.u]\nx = 1\n")
+		XCTAssertFalse(tableMergeInto(nested.tablePointer, other.tablePointer, .errorOnConflict, &conflictPath))
+		XCTAssertEqual(String(cString: try XCTUnwrap(conflictPath)), "t.u.x")
+		ctomlFree(conflictPath)
+
+		// Without conflicts, it merges like the others.
+		let separate = try parseTable("a = 1\n[t]\nx = 1\n")
+		let more = try parseTable("b = 2\n[t]\ny = 2\n")
+		XCTAssertTrue(tableMergeInto(separate.tablePointer, more.tablePointer, .errorOnConflict, nil))
+		XCTAssertEqual(separate, try TOMLTable(string: "a = 1\nb = 2\n[t]\nx = 1\ny = 2\n"))
+
+		for table in [destination, source, nested, other, separate, more] {
+			tableDestroy(table.tablePointer)
+		}
+	}
+
+	func testLayeredViews() throws {
+		let base = try parseTable("""
+		name = "base"
+		port = 80
+		log = { level = "info", file = "a.log" }
+		database = { host = "db", port = 5432 }
+		""")
+		let environment = try parseTable("port = 8080\nlog = { level = 'debug' }\ndatabase = 'sqlite'\n")
+		let local = try parseTable("name = 'local'\n")
+
+		func keys(_ view: OpaquePointer, _ path: [String]) -> [String] {
+			var size = 0
+			let keys = withCStrings(path) { layeredViewGetKeys(view, $0, path.count, &size) }
+			defer { ctomlFree(keys) }
+			return (0..<size).map { index in
+				defer { ctomlFree(keys[index]) }
+				return String(cString: keys[index])
+			}
+		}
+
+		for cacheMisses in [false, true] {
+			let view = [base, environment, local].map(\.tablePointer).withUnsafeBufferPointer {
+				layeredViewCreate($0.baseAddress!, $0.count, cacheMisses)
+			}
+			defer { layeredViewDestroy(view) }
+
+			// Upper layers shadow lower ones, down to the keys of tables in more than one layer.
+			XCTAssertEqual(String(cString: nodeAsString(try XCTUnwrap(layeredViewGetNode(view, "name")))!), "local")
+			XCTAssertEqual(nodeAsInt(try XCTUnwrap(layeredViewGetNode(view, "port")))?.pointee, 8080)
+			let level = withCStrings(["log", "level"]) { layeredViewGetNodeAtPath(view, $0!, 2) }
+			let file = withCStrings(["log", "file"]) { layeredViewGetNodeAtPath(view, $0!, 2) }
+			XCTAssertEqual(String(cString: nodeAsString(try XCTUnwrap(level))!), "debug")
+			XCTAssertEqual(String(cString: nodeAsString(try XCTUnwrap(file))!), "a.log")
+
+			// A value that isn't a table hides the tables below it, and missing paths stay missing.
+			for _ in 0..<2 {
+				XCTAssertNil(withCStrings(["database", "host"]) { layeredViewGetNodeAtPath(view, $0!, 2) })
+				XCTAssertNil(withCStrings(["missing", "x"]) { layeredViewGetNodeAtPath(view, $0!, 2) })
+				XCTAssertNil(layeredViewGetNode(view, "missing"))
+			}
+
+			// Keys in more than one layer are listed once.
+			XCTAssertEqual(keys(view, []), ["database", "log", "name", "port"])
+			XCTAssertEqual(keys(view, ["log"]), ["file", "level"])
+			XCTAssertEqual(keys(view, ["database"]), [])
+		}
+
+		for table in [base, environment, local] {
+			tableDestroy(table.tablePointer)
+		}
+	}
+
+	func testModifyingElementsOfFrozenCopies() throws {
+		for count in [2, 40] {
+			let jobs = (0..<count).map { "[[jobs]]\nname = 'j\($0)'\nsteps = [1, 2]\n" }
+			let toml = "x = [[1, 2], [3, 4]]\n\n" + jobs.joined(separator: "\n")
+
+			// Tables and arrays in an array are changed without changing the array first, in the copy and then in
+			// the original.
+			for changeCopy in [true, false] {
+				let table = try parseTable(toml)
+				XCTAssertTrue(tableFreeze(table.tablePointer))
+				let copy = TOMLTable(tablePointer: copyNode(table.tablePointer))
+				let (changed, unchanged) = changeCopy ? (copy, table) : (table, copy)
+
+				changed["jobs"]!.array![1].table!["name"] = "changed"
+				changed["jobs"]!.array![0].table!["steps"]!.array!.append(3)
+				changed["x"]!.array![1].array![0] = 30
+
+				XCTAssertEqual(unchanged, try TOMLTable(string: toml))
+				XCTAssertEqual(changed["jobs"]![1]!["name"]!.string!, "changed")
+				XCTAssertEqual(changed["jobs"]![0]!["steps"]![2]!.int!, 3)
+				XCTAssertEqual(changed["x"]![1]![0]!.int!, 30)
+
+				tableDestroy(table.tablePointer)
+				tableDestroy(copy.tablePointer)
+			}
+		}
+	}
+
+	func testFreezingAfterChangingTheAllocator() throws {
+		let toml = "a = 1\n[t]\nx = [1, 2]\n"
+
+		// Tables parsed without options can be frozen whichever allocator was installed when they were parsed.
+		let before = try parseTable(toml)
+		let arena = try parseTable(toml, options: [ctomlParseArena])
+		let counter = AllocationCounter()
+		counter.install()
+		XCTAssertTrue(tableFreeze(before.tablePointer))
+		XCTAssertFalse(tableFreeze(arena.tablePointer))
+
+		let during = try parseTable(toml)
+		ctomlSetAllocator(nil, nil, nil, nil)
+		XCTAssertTrue(tableFreeze(during.tablePointer))
+
+		let copy = TOMLTable(tablePointer: copyNode(during.tablePointer))
+		copy["t"]!["x"]!.array!.append(3)
+		XCTAssertEqual(during, before)
+		XCTAssertEqual(copy["t"]!["x"]![2]!.int!, 3)
+
+		for table in [before, arena, during, copy] {
+			tableDestroy(table.tablePointer)
+		}
+	}
+
 	// https://github.com/LebJe/TOMLKit/issues/12
 	func testIssue12() throws {
 		let string = "[[apps.test]]"